@@ -0,0 +1,630 @@
+#include "Benchmark.h"
+#include "CpuTopology.h"
+#include "MiningThreadData.h"
+#include "RandomXManager.h"
+#include "HexCodec.h"
+#include "Utils.h"
+#include "Job.h"
+#include "picojson.h"
+#include "randomx.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+namespace Benchmark {
+    // A fixed seed and a real block hashing blob (nonce at bytes 39..42)
+    static const char* SEED_HASH = "b0e9b6f3c7a2d4e85f1c3a9b7d6e2f4a8c5b1d3e7f9a2c4b6d8e0f1a3c5b7d9e";
+    static const char* BLOB =
+        "0b0b98bea7e805e0010a2126d287a2a0cc833d312cb786385a7c2f9de69d25537f584a9bc9977b00000000666fd8753bf61a8631f12984e3fd44f4014eca629276817b56f32e9b68bd82f416";
+    static const char* TARGET = "00000000";   // Met by no hash, so no shares are reported
+    static constexpr uint64_t MAX_HASHES = 1ULL << 32;   // One pass of the 32-bit nonce
+
+    using Clock = std::chrono::steady_clock;
+
+    enum class DatasetSource { Built, Loaded, Reused };
+
+    struct DatasetInit {
+        DatasetSource source = DatasetSource::Reused;
+        double seconds = 0.0;
+        bool largePages = false;
+    };
+
+    static double secondsBetween(Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double>(to - from).count();
+    }
+
+    static const char* sourceName(DatasetSource source) {
+        switch (source) {
+            case DatasetSource::Built: return "built";
+            case DatasetSource::Loaded: return "loaded";
+            default: return "reused";
+        }
+    }
+
+    bool parseCount(const std::string& text, uint64_t& count) {
+        if (text.empty() || !isdigit(static_cast<unsigned char>(text[0]))) {
+            return false;
+        }
+        size_t used = 0;
+        uint64_t value;
+        try {
+            value = std::stoull(text, &used);
+        } catch (const std::exception&) {
+            return false;
+        }
+        std::string suffix = text.substr(used);
+        if (suffix == "K" || suffix == "k") {
+            value *= 1000;
+        } else if (suffix == "M" || suffix == "m") {
+            value *= 1000000;
+        } else if (!suffix.empty()) {
+            return false;
+        }
+        count = value;
+        return count > 0;
+    }
+
+    static bool prepareDataset(DatasetInit& init) {
+        RandomXManager::DatasetStats before = RandomXManager::getDatasetStats();
+        auto start = Clock::now();
+        if (!RandomXManager::initialize(SEED_HASH)) {
+            return false;
+        }
+        init.seconds = secondsBetween(start, Clock::now());
+        RandomXManager::DatasetStats after = RandomXManager::getDatasetStats();
+        init.source = after.builds > before.builds ? DatasetSource::Built :
+                      after.loads > before.loads ? DatasetSource::Loaded : DatasetSource::Reused;
+        init.largePages = after.largePages;
+        return true;
+    }
+
+    // One timed pass: the threads claim nonces 0..hashes-1 from a shared counter
+    // and hash them like the mining loop does. Timing starts once every VM exists.
+    // Thread t runs on cpus[t] if cpus is not empty.
+    static bool measure(const std::vector<MiningThreadData*>& workers, uint64_t hashes, const std::vector<int>& cpus,
+                        Clock::time_point benchmarkStart, Result& result) {
+        const int threads = static_cast<int>(workers.size());
+        std::atomic<uint64_t> nextNonce(0);
+        std::atomic<int> ready(0);
+        std::atomic<int> done(0);
+        std::atomic<bool> failed(false);
+        std::atomic<bool> go(false);
+        std::vector<Clock::time_point> firstHash(threads), finished(threads);
+        std::vector<uint64_t> counts(threads, 0);
+
+        std::vector<std::thread> pool;
+        for (int t = 0; t < threads; t++) {
+            pool.emplace_back([&, t]() {
+                MiningThreadData* data = workers[t];
+                if (!cpus.empty()) {
+                    CpuTopology::pinCurrentThread(cpus[t]);
+                }
+                if (!data->initializeVM()) {
+                    failed = true;
+                }
+                ready++;
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                if (failed) {
+                    done++;
+                    return;
+                }
+
+                Job job("benchmark", BLOB, TARGET, 1, SEED_HASH);
+                uint64_t count = 0;
+                for (;;) {
+                    uint64_t nonce = nextNonce.fetch_add(1, std::memory_order_relaxed);
+                    if (nonce >= hashes) break;
+                    job.setNonce(static_cast<uint32_t>(nonce));
+                    std::vector<uint8_t> input = job.getBlobBytes();
+                    data->calculateHash(input, job.getNonce(), TARGET);
+                    data->incrementHashCount();
+                    if (count++ == 0) {
+                        firstHash[t] = Clock::now();
+                    }
+                }
+                finished[t] = Clock::now();
+                counts[t] = count;
+                done++;
+            });
+        }
+
+        while (ready.load() < threads) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        EnergyMeter::Reading energyStart = EnergyMeter::read();
+        auto start = Clock::now();
+        go.store(true, std::memory_order_release);
+        // Energy is read every second while the threads run, so no counter wrap is missed
+        if (EnergyMeter::isActive()) {
+            auto lastRead = start;
+            while (done.load() < threads) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                if (Clock::now() - lastRead >= std::chrono::seconds(1)) {
+                    EnergyMeter::read();
+                    lastRead = Clock::now();
+                }
+            }
+        }
+        EnergyMeter::Reading energyEnd = EnergyMeter::read();
+        for (auto& thread : pool) {
+            thread.join();
+        }
+        if (failed) {
+            threadSafePrint("Benchmark failed: could not create a RandomX VM on every thread", true);
+            return false;
+        }
+
+        result.threads = threads;
+        result.hashes = hashes;
+        result.perThread.clear();
+        Clock::time_point end = start, first = Clock::time_point::max();
+        for (int t = 0; t < threads; t++) {
+            ThreadResult thread;
+            thread.threadId = t;
+            thread.hashes = counts[t];
+            thread.seconds = secondsBetween(start, finished[t]);
+            thread.hashrate = thread.seconds > 0.0 ? counts[t] / thread.seconds : 0.0;
+            if (counts[t] > 0) {
+                thread.firstHashSeconds = secondsBetween(start, firstHash[t]);
+                first = (std::min)(first, firstHash[t]);
+            }
+            end = (std::max)(end, finished[t]);
+            result.perThread.push_back(thread);
+        }
+        result.seconds = secondsBetween(start, end);
+        result.hashrate = result.seconds > 0.0 ? hashes / result.seconds : 0.0;
+        result.timeToFirstHash = first == Clock::time_point::max() ? 0.0 : secondsBetween(benchmarkStart, first);
+        result.energy = EnergyMeter::between(energyStart, energyEnd, hashes);
+        return true;
+    }
+
+    // RandomX's own first test vector, hashed in light mode before anything is
+    // timed. The dataset and light mode hashes agree even when both come from a
+    // miscompiled or modified library; this catches that.
+    static bool checkTestVector() {
+        static const char KEY[] = "test key 000";
+        static const char INPUT[] = "This is a test";
+        static const char* EXPECTED = "639183aae1bf4c9a35884cb46b09cad9175f04efd7684e7262a0ac1c2f0b4e3f";
+
+        randomx_flags flags = randomx_get_flags();
+        randomx_cache* cache = randomx_alloc_cache(flags);
+        if (!cache) {
+            threadSafePrint("Benchmark failed: could not allocate a RandomX cache for the test vector", true);
+            return false;
+        }
+        randomx_init_cache(cache, KEY, sizeof(KEY) - 1);
+        randomx_vm* vm = randomx_create_vm(flags, cache, nullptr);
+        std::string hashHex;
+        if (vm) {
+            uint8_t hash[RANDOMX_HASH_SIZE];
+            randomx_calculate_hash(vm, INPUT, sizeof(INPUT) - 1, hash);
+            hashHex = HexCodec::encode(hash, sizeof(hash));
+            randomx_destroy_vm(vm);
+        }
+        randomx_release_cache(cache);
+
+        if (hashHex != EXPECTED) {
+            threadSafePrint("Benchmark failed: RandomX test vector mismatch, this build does not compute "
+                "Monero's RandomX (got " + (hashHex.empty() ? std::string("no VM") : hashHex) +
+                ", expected " + EXPECTED + ")", true);
+            return false;
+        }
+        threadSafePrint("RandomX test vector OK", true);
+        return true;
+    }
+
+    // Hashes the final nonce again on a dataset VM and on a light (cache only) VM.
+    // A mismatch means a corrupt dataset, e.g. a damaged cache file on disk.
+    static bool verifyFinalHash(MiningThreadData* data, uint32_t nonce, std::string& hashHex) {
+        Job job("benchmark", BLOB, TARGET, 1, SEED_HASH);
+        job.setNonce(nonce);
+        std::vector<uint8_t> input = job.getBlobBytes();
+        data->calculateHash(input, nonce, TARGET);
+        std::vector<uint8_t> fast = RandomXManager::getLastHash();
+        hashHex = HexCodec::encode(fast);
+
+        threadSafePrint("Verifying the final hash in light mode...", true);
+        std::vector<uint8_t> light(RANDOMX_HASH_SIZE);
+        if (!RandomXManager::lightHash(SEED_HASH, input.data(), input.size(), light.data())) {
+            return false;
+        }
+        return light == fast;
+    }
+
+    static std::string formatReport(const Result& result, const DatasetInit& init, uint32_t finalNonce,
+                                    const std::string& finalHash, bool verified) {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2);
+        ss << "\nBenchmark: " << result.hashes << " hashes on " << result.threads << " threads" << std::endl;
+        ss << "  Dataset: ";
+        if (init.source == DatasetSource::Built) {
+            ss << "built in " << init.seconds << " s";
+        } else if (init.source == DatasetSource::Loaded) {
+            ss << "loaded from disk in " << init.seconds << " s";
+        } else {
+            ss << "already initialized";
+        }
+        ss << (init.largePages ? ", huge pages" : ", normal pages") << std::endl;
+        ss << "  Time to first hash: " << result.timeToFirstHash << " s" << std::endl;
+        ss << "  Hashrate: " << result.hashrate << " H/s over " << result.seconds << " s" << std::endl;
+        if (result.energy.available) {
+            ss << "  Power: " << EnergyMeter::summary(result.energy) << std::endl;
+        }
+        for (const auto& thread : result.perThread) {
+            ss << "  Thread " << thread.threadId << ": " << thread.hashes << " hashes, "
+               << thread.hashrate << " H/s, first hash after " << std::setprecision(3)
+               << thread.firstHashSeconds << " s" << std::setprecision(2) << std::endl;
+        }
+        ss << "  Final hash (nonce " << finalNonce << "): " << finalHash
+           << (verified ? " (verified)" : " (MISMATCH with light mode)");
+        return ss.str();
+    }
+
+    static std::string formatJson(const Result& result, const DatasetInit& init, uint32_t finalNonce,
+                                  const std::string& finalHash, bool verified) {
+        picojson::object dataset;
+        dataset["source"] = picojson::value(std::string(sourceName(init.source)));
+        dataset["seconds"] = picojson::value(init.seconds);
+        dataset["huge_pages"] = picojson::value(init.largePages);
+
+        picojson::array threads;
+        for (const auto& thread : result.perThread) {
+            picojson::object entry;
+            entry["id"] = picojson::value(static_cast<double>(thread.threadId));
+            entry["hashes"] = picojson::value(static_cast<double>(thread.hashes));
+            entry["seconds"] = picojson::value(thread.seconds);
+            entry["hashrate"] = picojson::value(thread.hashrate);
+            entry["first_hash_seconds"] = picojson::value(thread.firstHashSeconds);
+            threads.push_back(picojson::value(entry));
+        }
+
+        picojson::object report;
+        report["seed_hash"] = picojson::value(std::string(SEED_HASH));
+        report["hashes"] = picojson::value(static_cast<double>(result.hashes));
+        report["threads"] = picojson::value(static_cast<double>(result.threads));
+        report["seconds"] = picojson::value(result.seconds);
+        report["hashrate"] = picojson::value(result.hashrate);
+        report["time_to_first_hash"] = picojson::value(result.timeToFirstHash);
+        report["dataset"] = picojson::value(dataset);
+        if (result.energy.available) {
+            picojson::object energy;
+            energy["joules"] = picojson::value(result.energy.joules);
+            energy["watts"] = picojson::value(result.energy.watts());
+            energy["package_watts"] = picojson::value(result.energy.packageWatts);
+            if (result.energy.hasDram) energy["dram_watts"] = picojson::value(result.energy.dramWatts);
+            energy["hashes_per_joule"] = picojson::value(result.energy.hashesPerJoule);
+            report["energy"] = picojson::value(energy);
+        }
+        report["per_thread"] = picojson::value(threads);
+        report["final_nonce"] = picojson::value(static_cast<double>(finalNonce));
+        report["final_hash"] = picojson::value(finalHash);
+        report["verified"] = picojson::value(verified);
+        return picojson::value(report).serialize();
+    }
+
+    static void writeJson(const std::string& jsonFile, const std::string& json) {
+        if (jsonFile.empty()) {
+            return;
+        }
+        if (jsonFile == "-") {
+            threadSafePrint(json, false);   // Behind the report, still queued in the logger
+            return;
+        }
+        std::ofstream file(jsonFile);
+        file << json << std::endl;
+        if (!file) {
+            threadSafePrint("Failed to write benchmark JSON to " + jsonFile, true);
+        }
+    }
+
+    bool run(uint64_t hashes, int threads, CpuTopology::Policy policy, const std::string& jsonFile) {
+        auto benchmarkStart = Clock::now();
+        if (hashes == 0 || hashes > MAX_HASHES) {
+            threadSafePrint("Benchmark hash count must be between 1 and " + std::to_string(MAX_HASHES), true);
+            return false;
+        }
+        if (threads <= 0) {
+            threads = (std::max)(1u, std::thread::hardware_concurrency());
+        }
+        if (!checkTestVector()) {
+            return false;
+        }
+
+        threadSafePrint("Benchmark: preparing the RandomX dataset for seed " + std::string(SEED_HASH), true);
+        DatasetInit init;
+        if (!prepareDataset(init)) {
+            threadSafePrint("Benchmark failed: RandomX initialization failed", true);
+            return false;
+        }
+
+        std::vector<MiningThreadData*> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.push_back(new MiningThreadData(t));
+        }
+
+        Result result;
+        bool ok = measure(workers, hashes, CpuTopology::plan(policy, threads), benchmarkStart, result);
+        if (ok) {
+            uint32_t finalNonce = static_cast<uint32_t>(hashes - 1);
+            std::string finalHash;
+            bool verified = verifyFinalHash(workers[0], finalNonce, finalHash);
+            threadSafePrint(formatReport(result, init, finalNonce, finalHash, verified), true);
+            writeJson(jsonFile, formatJson(result, init, finalNonce, finalHash, verified));
+            ok = verified;
+        }
+
+        for (auto* data : workers) {
+            delete data;
+        }
+        RandomXManager::cleanup();
+        return ok;
+    }
+
+    struct ScalingPoint {
+        int threads = 0;
+        double hashrate = 0.0;
+        double marginal = 0.0;         // H/s gained per thread added since the previous point
+        double watts = 0.0;            // Package and DRAM; 0 without RAPL
+        double hashesPerJoule = 0.0;
+    };
+
+    struct ScalingCurve {
+        CpuTopology::Policy policy = CpuTopology::Policy::None;
+        std::vector<ScalingPoint> points;
+    };
+
+    struct ScalingChoice {
+        const ScalingCurve* curve = nullptr;
+        const ScalingPoint* point = nullptr;
+    };
+
+    // Highest hashrate, fewest threads within 2% of it (saves power and leaves
+    // cores free) and, with RAPL, most hashes per joule
+    struct ScalingAdvice {
+        ScalingChoice best, lean, efficient;
+    };
+
+    // Every count up to 8, then about 16 evenly spaced counts up to the maximum
+    static std::vector<int> scalingCounts(int maxThreads) {
+        std::vector<int> counts;
+        int step = (std::max)(1, (maxThreads + 15) / 16);
+        for (int n = 1; n <= maxThreads; n++) {
+            if (n <= 8 || n % step == 0 || n == maxThreads) {
+                counts.push_back(n);
+            }
+        }
+        return counts;
+    }
+
+    static bool measurePoint(int threads, uint64_t hashes, CpuTopology::Policy policy, Result& result) {
+        std::vector<MiningThreadData*> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.push_back(new MiningThreadData(t));
+        }
+        bool ok = measure(workers, hashes, CpuTopology::plan(policy, threads), Clock::now(), result);
+        for (auto* data : workers) {
+            delete data;
+        }
+        return ok;
+    }
+
+    static ScalingAdvice advise(const std::vector<ScalingCurve>& curves) {
+        ScalingAdvice advice;
+        for (const auto& curve : curves) {
+            for (const auto& point : curve.points) {
+                if (!advice.best.point || point.hashrate > advice.best.point->hashrate) {
+                    advice.best = ScalingChoice{ &curve, &point };
+                }
+                if (point.hashesPerJoule > 0.0 &&
+                    (!advice.efficient.point || point.hashesPerJoule > advice.efficient.point->hashesPerJoule)) {
+                    advice.efficient = ScalingChoice{ &curve, &point };
+                }
+            }
+        }
+        advice.lean = advice.best;
+        if (!advice.best.point) {
+            return advice;
+        }
+        for (const auto& curve : curves) {
+            for (const auto& point : curve.points) {
+                if (point.hashrate >= advice.best.point->hashrate * 0.98 && point.threads < advice.lean.point->threads) {
+                    advice.lean = ScalingChoice{ &curve, &point };
+                }
+            }
+        }
+        return advice;
+    }
+
+    static std::string formatChoice(const ScalingChoice& choice) {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(1) << "--threads " << choice.point->threads << " --affinity "
+           << CpuTopology::policyName(choice.curve->policy) << " (" << choice.point->hashrate << " H/s";
+        if (choice.point->hashesPerJoule > 0.0) {
+            ss << ", " << choice.point->watts << " W, " << std::setprecision(2) << choice.point->hashesPerJoule << " H/J";
+        }
+        ss << ")";
+        return ss.str();
+    }
+
+    static std::string formatScaling(const std::vector<ScalingCurve>& curves, uint64_t hashesPerThread,
+                                     const ScalingAdvice& advice, bool energy) {
+        const CpuTopology::Topology& host = CpuTopology::get();
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(1);
+        ss << "\nThread scaling: " << hashesPerThread << " hashes per thread" << std::endl;
+        ss << "  CPUs: " << host.cpus.size() << " logical, " << host.cores << " cores, " << host.packages
+           << (host.packages == 1 ? " package" : " packages") << (host.smt() ? ", SMT" : "");
+        if (host.l3Bytes > 0) {
+            // Each mining thread works in a 2 MB scratchpad that wants to stay in L3
+            ss << ", L3 " << (host.l3Bytes >> 20) << " MB (" << (host.l3Bytes >> 21) << " scratchpads)";
+        }
+        ss << std::endl;
+
+        for (const auto& curve : curves) {
+            ss << "  Affinity " << CpuTopology::policyName(curve.policy) << ":" << std::endl;
+            ss << "    Threads        H/s   H/s/thread   Marginal" << (energy ? "      Watts      H/J" : "") << std::endl;
+            for (const auto& point : curve.points) {
+                ss << "    " << std::setw(7) << point.threads << std::setw(11) << point.hashrate
+                   << std::setw(13) << (point.hashrate / point.threads)
+                   << std::setw(11) << std::showpos << point.marginal << std::noshowpos;
+                if (energy) {
+                    ss << std::setw(11) << point.watts << std::setw(9) << std::setprecision(2) << point.hashesPerJoule
+                       << std::setprecision(1);
+                }
+                ss << std::endl;
+            }
+        }
+        if (!advice.best.point) {
+            return ss.str();
+        }
+
+        ss << "  Recommended: " << formatChoice(advice.best);
+        if (advice.lean.point != advice.best.point) {
+            ss << std::endl << "  Within 2% on fewer threads: " << formatChoice(advice.lean);
+        }
+        if (advice.efficient.point && advice.efficient.point != advice.best.point) {
+            ss << std::endl << "  Most efficient: " << formatChoice(advice.efficient);
+        }
+        return ss.str();
+    }
+
+    static std::string formatScalingJson(const std::vector<ScalingCurve>& curves, uint64_t hashesPerThread,
+                                         const ScalingAdvice& advice, bool energy, bool verified) {
+        const CpuTopology::Topology& host = CpuTopology::get();
+        picojson::object topology;
+        topology["cpus"] = picojson::value(static_cast<double>(host.cpus.size()));
+        topology["cores"] = picojson::value(static_cast<double>(host.cores));
+        topology["packages"] = picojson::value(static_cast<double>(host.packages));
+        topology["l3_bytes"] = picojson::value(static_cast<double>(host.l3Bytes));
+
+        picojson::array curveList;
+        for (const auto& curve : curves) {
+            picojson::array points;
+            for (const auto& point : curve.points) {
+                picojson::object entry;
+                entry["threads"] = picojson::value(static_cast<double>(point.threads));
+                entry["hashrate"] = picojson::value(point.hashrate);
+                entry["marginal"] = picojson::value(point.marginal);
+                if (energy) {
+                    entry["watts"] = picojson::value(point.watts);
+                    entry["hashes_per_joule"] = picojson::value(point.hashesPerJoule);
+                }
+                points.push_back(picojson::value(entry));
+            }
+            picojson::object entry;
+            entry["affinity"] = picojson::value(std::string(CpuTopology::policyName(curve.policy)));
+            entry["points"] = picojson::value(points);
+            curveList.push_back(picojson::value(entry));
+        }
+
+        auto choice = [](const ScalingChoice& picked) {
+            picojson::object entry;
+            if (picked.point) {
+                entry["threads"] = picojson::value(static_cast<double>(picked.point->threads));
+                entry["affinity"] = picojson::value(std::string(CpuTopology::policyName(picked.curve->policy)));
+                entry["hashrate"] = picojson::value(picked.point->hashrate);
+                if (picked.point->hashesPerJoule > 0.0) {
+                    entry["watts"] = picojson::value(picked.point->watts);
+                    entry["hashes_per_joule"] = picojson::value(picked.point->hashesPerJoule);
+                }
+            }
+            return picojson::value(entry);
+        };
+
+        picojson::object report;
+        report["seed_hash"] = picojson::value(std::string(SEED_HASH));
+        report["hashes_per_thread"] = picojson::value(static_cast<double>(hashesPerThread));
+        report["topology"] = picojson::value(topology);
+        report["curves"] = picojson::value(curveList);
+        report["recommended"] = choice(advice.best);
+        report["lean"] = choice(advice.lean);
+        if (energy) {
+            report["efficient"] = choice(advice.efficient);
+        }
+        report["verified"] = picojson::value(verified);
+        return picojson::value(report).serialize();
+    }
+
+    bool runScaling(uint64_t hashesPerThread, int maxThreads, const std::string& jsonFile) {
+        const CpuTopology::Topology& host = CpuTopology::get();
+        if (maxThreads <= 0) {
+            maxThreads = static_cast<int>(host.cpus.size());
+        }
+        if (hashesPerThread == 0 || hashesPerThread * maxThreads > MAX_HASHES) {
+            threadSafePrint("Scaling benchmark needs 1 to " + std::to_string(MAX_HASHES / maxThreads) +
+                " hashes per thread", true);
+            return false;
+        }
+        if (!checkTestVector()) {
+            return false;
+        }
+
+        threadSafePrint("Scaling benchmark: preparing the RandomX dataset for seed " + std::string(SEED_HASH), true);
+        DatasetInit init;
+        if (!prepareDataset(init)) {
+            threadSafePrint("Benchmark failed: RandomX initialization failed", true);
+            return false;
+        }
+
+        // Pinned to cores first (no SMT siblings until every core has a thread) and
+        // to both siblings of a core first; the latter only differs with SMT
+        std::vector<ScalingCurve> curves(1);
+        curves.push_back(ScalingCurve());
+        curves.back().policy = CpuTopology::Policy::Cores;
+        if (host.smt()) {
+            curves.push_back(ScalingCurve());
+            curves.back().policy = CpuTopology::Policy::Compact;
+        }
+
+        bool ok = true;
+        for (auto& curve : curves) {
+            ScalingPoint previous;
+            for (int threads : scalingCounts(maxThreads)) {
+                Result result;
+                if (!measurePoint(threads, hashesPerThread * threads, curve.policy, result)) {
+                    ok = false;
+                    break;
+                }
+                ScalingPoint point;
+                point.threads = threads;
+                point.hashrate = result.hashrate;
+                point.marginal = (point.hashrate - previous.hashrate) / (threads - previous.threads);
+                point.watts = result.energy.watts();
+                point.hashesPerJoule = result.energy.hashesPerJoule;
+                curve.points.push_back(point);
+                previous = point;
+                std::stringstream ss;
+                ss << std::fixed << std::setprecision(1) << "Affinity " << CpuTopology::policyName(curve.policy)
+                   << ", " << threads << " threads: " << point.hashrate << " H/s";
+                if (result.energy.available) {
+                    ss << ", " << EnergyMeter::summary(result.energy);
+                }
+                threadSafePrint(ss.str(), true);
+            }
+        }
+
+        // One hash checked against light mode, as in the plain benchmark
+        bool verified = false;
+        if (ok) {
+            MiningThreadData verifier(0);
+            std::string hashHex;
+            verified = verifier.initializeVM() && verifyFinalHash(&verifier, 0, hashHex);
+            if (!verified) {
+                threadSafePrint("Dataset check FAILED: the hash differs from light mode", true);
+            }
+
+            ScalingAdvice advice = advise(curves);
+            bool energy = EnergyMeter::isActive();
+            threadSafePrint(formatScaling(curves, hashesPerThread, advice, energy), true);
+            writeJson(jsonFile, formatScalingJson(curves, hashesPerThread, advice, energy, verified));
+        }
+        RandomXManager::cleanup();
+        return ok && verified;
+    }
+}
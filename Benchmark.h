@@ -0,0 +1,49 @@
+#pragma once
+
+#include "CpuTopology.h"
+#include "EnergyMeter.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Offline benchmark (--benchmark N): checks RandomX's published test vector, which
+// fails the run on a mismatch, then builds the RandomX dataset for a fixed seed
+// and hashes a fixed block blob on every configured thread through the normal
+// mining path, nonces 0..N-1, without a pool. The final nonce is then hashed again
+// in light mode, which needs no dataset, and the two results must agree. Repeat
+// runs with the same N give the same final hash, so it can be compared between
+// builds.
+namespace Benchmark {
+    struct ThreadResult {
+        int threadId = 0;
+        uint64_t hashes = 0;
+        double seconds = 0.0;          // From the start signal to the thread's last hash
+        double hashrate = 0.0;
+        double firstHashSeconds = 0.0; // From the start signal to the thread's first hash
+    };
+
+    struct Result {
+        int threads = 0;
+        uint64_t hashes = 0;
+        double seconds = 0.0;          // Wall time of the timed pass
+        double hashrate = 0.0;
+        double timeToFirstHash = 0.0;  // From the benchmark start, dataset included
+        EnergyMeter::Power energy;     // Over the timed pass, when RAPL is readable
+        std::vector<ThreadResult> perThread;
+    };
+
+    // "1000000", "250K" or "1M"
+    bool parseCount(const std::string& text, uint64_t& count);
+
+    // Runs the benchmark with threads placed by 'policy' and prints the report;
+    // also writes it as JSON to jsonFile unless that is empty ("-" for stdout)
+    bool run(uint64_t hashes, int threads, CpuTopology::Policy policy, const std::string& jsonFile);
+
+    // Thread scaling sweep (--bench-scaling N): the benchmark at 1..maxThreads
+    // threads (0: every logical CPU), unpinned, pinned one per core first and, with
+    // SMT, pinned to both siblings of a core first. Prints the hashrate and the
+    // marginal gain of each added thread per policy, and the best --threads and
+    // --affinity for this host; with RAPL also the watts, hashes per joule and the
+    // most efficient setting.
+    bool runScaling(uint64_t hashesPerThread, int maxThreads, const std::string& jsonFile);
+}
@@ -1,9 +1,11 @@
 #include "Config.h"
 #include "Globals.h"
+#include "Benchmark.h"
 #include <iostream>
 #include <string>
 #include <thread>
 #include <sstream>
+#include <algorithm>
 
 Config config;
 
@@ -27,13 +29,89 @@ bool Config::parseCommandLine(int argc, char* argv[]) {
             }
         }
         else if (arg == "--pool" && i + 1 < argc) {
-            std::string poolArg = argv[++i];
-            size_t colonPos = poolArg.find(':');
-            if (colonPos != std::string::npos) {
-                poolAddress = poolArg.substr(0, colonPos);
-                poolPort = std::stoi(poolArg.substr(colonPos + 1));
+            addPool(argv[++i], static_cast<int>(pools.size()));
+        }
+        else if (arg == "--job-timeout" && i + 1 < argc) {
+            jobTimeoutSec = std::stoi(argv[++i]);
+        }
+        else if (arg == "--keepalive" && i + 1 < argc) {
+            keepaliveSec = std::stoi(argv[++i]);
+        }
+        else if (arg == "--idle-timeout" && i + 1 < argc) {
+            idleTimeoutSec = std::stoi(argv[++i]);
+        }
+        else if (arg == "--job-grace" && i + 1 < argc) {
+            jobGraceSec = std::stoi(argv[++i]);
+        }
+        else if (arg == "--share-journal" && i + 1 < argc) {
+            shareJournalFile = argv[++i];
+        }
+        else if (arg == "--no-share-journal") {
+            shareJournalFile.clear();
+        }
+        else if (arg == "--proxy") {
+            proxyMode = true;
+        }
+        else if (arg == "--proxy-bind" && i + 1 < argc) {
+            proxyBindAddress = argv[++i];
+        }
+        else if (arg == "--proxy-port" && i + 1 < argc) {
+            proxyPort = std::stoi(argv[++i]);
+        }
+        else if (arg == "--proxy-verify-threads" && i + 1 < argc) {
+            proxyVerifyThreads = std::stoi(argv[++i]);
+        }
+        else if (arg == "--proxy-share-interval" && i + 1 < argc) {
+            proxyShareInterval = std::stoi(argv[++i]);
+        }
+        else if (arg == "--capture" && i + 1 < argc) {
+            captureFile = argv[++i];
+        }
+        else if (arg == "--replay" && i + 1 < argc) {
+            replayFile = argv[++i];
+        }
+        else if (arg == "--replay-speed" && i + 1 < argc) {
+            replaySpeed = std::stod(argv[++i]);
+        }
+        else if (arg == "--daemon" && i + 1 < argc) {
+            daemonAddress = argv[++i];
+        }
+        else if (arg == "--daemon-zmq" && i + 1 < argc) {
+            daemonZmqAddress = argv[++i];
+        }
+        else if (arg == "--split" && i + 1 < argc) {
+            addSplit(argv[++i]);
+        }
+        else if (arg == "--api-port" && i + 1 < argc) {
+            apiPort = std::stoi(argv[++i]);
+        }
+        else if (arg == "--api-bind" && i + 1 < argc) {
+            apiBindAddress = argv[++i];
+        }
+        else if (arg == "--api-token" && i + 1 < argc) {
+            apiToken = argv[++i];
+        }
+        else if (arg == "--perf-counters") {
+            perfCounters = true;
+        }
+        else if (arg == "--benchmark" && i + 1 < argc) {
+            if (!Benchmark::parseCount(argv[++i], benchmarkHashes)) {
+                std::cerr << "Invalid benchmark hash count: " << argv[i] << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--benchmark-json" && i + 1 < argc) {
+            benchmarkJsonFile = argv[++i];
+        }
+        else if (arg == "--bench-scaling" && i + 1 < argc) {
+            if (!Benchmark::parseCount(argv[++i], benchScalingHashes)) {
+                std::cerr << "Invalid hashes per thread: " << argv[i] << std::endl;
+                return false;
             }
         }
+        else if (arg == "--affinity" && i + 1 < argc) {
+            affinity = argv[++i];
+        }
         else if (arg == "--wallet" && i + 1 < argc) {
             walletAddress = argv[++i];
         }
@@ -50,6 +128,86 @@ bool Config::parseCommandLine(int argc, char* argv[]) {
     return true;
 }
 
+bool Config::addPool(const std::string& addressPort, int priority) {
+    size_t colonPos = addressPort.rfind(':');
+    if (colonPos == std::string::npos || colonPos == 0) {
+        std::cerr << "Invalid pool (expected ADDRESS:PORT): " << addressPort << std::endl;
+        return false;
+    }
+    PoolEndpoint pool(addressPort.substr(0, colonPos), std::stoi(addressPort.substr(colonPos + 1)), priority);
+    if (pool.port <= 0 || pool.port > 65535) {
+        std::cerr << "Invalid pool port: " << addressPort << std::endl;
+        return false;
+    }
+
+    // The first pool given also becomes the primary pool address
+    if (pools.empty()) {
+        poolAddress = pool.address;
+        poolPort = pool.port;
+    }
+    pools.push_back(pool);
+    return true;
+}
+
+std::vector<PoolEndpoint> Config::getPoolList() const {
+    std::vector<PoolEndpoint> list = pools;
+    if (list.empty()) {
+        list.emplace_back(poolAddress, poolPort, 0);
+    }
+    std::stable_sort(list.begin(), list.end(), [](const PoolEndpoint& a, const PoolEndpoint& b) {
+        return a.priority < b.priority;
+    });
+    return list;
+}
+
+bool Config::addSplit(const std::string& spec) {
+    std::vector<std::string> fields;
+    std::stringstream ss(spec);
+    std::string field;
+    while (std::getline(ss, field, ',')) {
+        fields.push_back(field);
+    }
+    size_t colonPos = fields.empty() ? std::string::npos : fields[0].rfind(':');
+    if (fields.size() < 2 || fields.size() > 4 || colonPos == std::string::npos || colonPos == 0) {
+        std::cerr << "Invalid split (expected ADDRESS:PORT,WEIGHT[,WALLET[,WORKER]]): " << spec << std::endl;
+        return false;
+    }
+
+    SplitEndpoint split;
+    split.address = fields[0].substr(0, colonPos);
+    try {
+        split.port = std::stoi(fields[0].substr(colonPos + 1));
+        split.weight = std::stoi(fields[1]);
+    } catch (const std::exception&) {
+        std::cerr << "Invalid split: " << spec << std::endl;
+        return false;
+    }
+    if (split.port <= 0 || split.port > 65535) {
+        std::cerr << "Invalid split port: " << spec << std::endl;
+        return false;
+    }
+    if (split.weight <= 0 || getMainWeight() - split.weight <= 0) {
+        std::cerr << "Invalid split weight: " << spec << " (splits must leave the main pool some of 100%)" << std::endl;
+        return false;
+    }
+    if (splits.size() >= MiningConstants::MAX_SPLIT_ENDPOINTS) {
+        std::cerr << "Too many splits, at most " << MiningConstants::MAX_SPLIT_ENDPOINTS << std::endl;
+        return false;
+    }
+    if (fields.size() > 2) split.wallet = fields[2];
+    if (fields.size() > 3) split.worker = fields[3];
+    splits.push_back(split);
+    return true;
+}
+
+int Config::getMainWeight() const {
+    int weight = 100;
+    for (const auto& split : splits) {
+        weight -= split.weight;
+    }
+    return weight;
+}
+
 bool validateConfig(const Config& config) {
     if (config.walletAddress.empty()) {
         std::cerr << "Error: Wallet address is required" << std::endl;
@@ -4,7 +4,30 @@
 #include <fstream>
 #include <iostream>
 #include <thread>
+#include <vector>
 #include "Globals.h"
+#include "Constants.h"
+
+// A pool entry from the failover list; lower priority values are preferred
+struct PoolEndpoint {
+    std::string address;
+    int port;
+    int priority;
+
+    PoolEndpoint(const std::string& a = "", int p = 0, int prio = 0)
+        : address(a), port(p), priority(prio) {}
+};
+
+// An extra pool/wallet endpoint that gets a share of the hashpower; the main pool
+// list gets the rest. Empty wallet, worker and password default to the main ones.
+struct SplitEndpoint {
+    std::string address;
+    int port = 0;
+    int weight = 0;       // Percent of the hashpower
+    std::string wallet;
+    std::string worker;
+    std::string password;
+};
 
 class Config {
 public:
@@ -18,6 +41,31 @@ public:
     std::string logFileName;
     bool debugMode;
     bool useLogFile;
+    std::vector<PoolEndpoint> pools;  // Failover list; empty means poolAddress:poolPort only
+    int jobTimeoutSec;
+    int keepaliveSec;     // 0 disables stratum keepalived requests
+    int idleTimeoutSec;   // 0 disables the application-level idle timeout
+    int jobGraceSec;      // Keep mining the last job this long after losing the pool
+    std::string shareJournalFile;  // Empty disables the share journal
+    bool proxyMode;                // Serve downstream miners instead of mining
+    std::string proxyBindAddress;
+    int proxyPort;
+    int proxyVerifyThreads;        // Light-mode RandomX threads checking downstream shares; 0 disables
+    int proxyShareInterval;        // Vardiff aims for one share per miner this often; 0 disables
+    std::string captureFile;       // Records the raw stratum session; empty disables
+    std::string replayFile;        // Mines against a recorded session instead of a pool
+    double replaySpeed;            // Replay pace relative to the recording
+    std::string daemonAddress;     // monerod RPC HOST:PORT for solo mining; empty mines on pools
+    std::string daemonZmqAddress;  // monerod --zmq-pub HOST:PORT; empty polls the chain tip
+    std::vector<SplitEndpoint> splits;  // Weighted extra endpoints mined alongside the main pool
+    int apiPort;                   // HTTP stats and control API; 0 disables
+    std::string apiBindAddress;
+    std::string apiToken;          // Required as a Bearer token when set
+    bool perfCounters;             // Per-thread hardware counters via perf_event_open
+    uint64_t benchmarkHashes;      // Offline benchmark instead of mining; 0 mines
+    std::string benchmarkJsonFile; // Benchmark report as JSON, "-" for stdout
+    uint64_t benchScalingHashes;   // Hashes per thread at each point of a scaling sweep; 0 mines
+    std::string affinity;          // Mining thread placement: none, cores or compact
 
     Config() : 
         poolAddress("xmr-eu1.nanopool.org"),
@@ -29,19 +77,81 @@ public:
         numThreads(1),
         logFileName("monerominer.log"),
         debugMode(false),
-        useLogFile(true) {}
+        useLogFile(true),
+        jobTimeoutSec(NetworkConstants::DEFAULT_JOB_TIMEOUT_SEC),
+        keepaliveSec(NetworkConstants::DEFAULT_KEEPALIVE_SEC),
+        idleTimeoutSec(NetworkConstants::DEFAULT_IDLE_TIMEOUT_SEC),
+        jobGraceSec(MiningConstants::DEFAULT_JOB_GRACE_SEC),
+        shareJournalFile("shares.journal"),
+        proxyMode(false),
+        proxyBindAddress("0.0.0.0"),
+        proxyPort(NetworkConstants::DEFAULT_PROXY_PORT),
+        proxyVerifyThreads(NetworkConstants::DEFAULT_PROXY_VERIFY_THREADS),
+        proxyShareInterval(NetworkConstants::DEFAULT_PROXY_SHARE_INTERVAL_SEC),
+        replaySpeed(1.0),
+        apiPort(NetworkConstants::DEFAULT_API_PORT),
+        apiBindAddress("127.0.0.1"),
+        perfCounters(false),
+        benchmarkHashes(0),
+        benchScalingHashes(0),
+        affinity("none") {}
 
     bool parseCommandLine(int argc, char* argv[]);
+    bool addPool(const std::string& addressPort, int priority);
+    std::vector<PoolEndpoint> getPoolList() const;
+    bool addSplit(const std::string& spec);  // HOST:PORT,WEIGHT[,WALLET[,WORKER]]
+    int getMainWeight() const;               // 100 minus the split weights
 
     void printConfig() {
         std::cout << "Current configuration:" << std::endl;
-        std::cout << "Pool address: " << poolAddress << ":" << poolPort << std::endl;
+        for (const auto& pool : getPoolList()) {
+            std::cout << "Pool address: " << pool.address << ":" << pool.port
+                      << " (priority " << pool.priority << ")" << std::endl;
+        }
+        std::cout << "Job timeout: " << jobTimeoutSec << "s" << std::endl;
+        std::cout << "Job grace period: " << jobGraceSec << "s" << std::endl;
+        std::cout << "Keepalive: " << keepaliveSec << "s, idle timeout: " << idleTimeoutSec << "s" << std::endl;
         std::cout << "Wallet: " << walletAddress << std::endl;
         std::cout << "Worker name: " << workerName << std::endl;
         std::cout << "User agent: " << userAgent << std::endl;
-        std::cout << "Number of threads: " << numThreads << std::endl;
+        for (const auto& split : splits) {
+            std::cout << "Split: " << split.address << ":" << split.port << " gets " << split.weight << "%"
+                      << (split.wallet.empty() ? "" : " for wallet " + split.wallet) << std::endl;
+        }
+        if (!splits.empty()) {
+            std::cout << "Main pool gets " << getMainWeight() << "%" << std::endl;
+        }
+        if (!daemonAddress.empty()) {
+            std::cout << "Solo mining: daemon " << daemonAddress << ", "
+                      << (daemonZmqAddress.empty() ? "polling for blocks" : "ZMQ feed " + daemonZmqAddress) << std::endl;
+        }
+        if (proxyMode) {
+            std::cout << "Proxy mode: listening on " << proxyBindAddress << ":" << proxyPort
+                      << ", " << proxyVerifyThreads << " share verification threads" << std::endl;
+            std::cout << "Proxy vardiff: " << (proxyShareInterval > 0 ?
+                "one share per " + std::to_string(proxyShareInterval) + "s" : std::string("disabled")) << std::endl;
+        } else {
+            std::cout << "Number of threads: " << numThreads << std::endl;
+        }
         std::cout << "Debug mode: " << (debugMode ? "enabled" : "disabled") << std::endl;
         std::cout << "Log file: " << (useLogFile ? logFileName : "disabled") << std::endl;
+        std::cout << "Share journal: " << (shareJournalFile.empty() ? "disabled" : shareJournalFile) << std::endl;
+        if (!captureFile.empty()) {
+            std::cout << "Stratum capture: " << captureFile << std::endl;
+        }
+        if (apiPort > 0) {
+            std::cout << "HTTP API: " << apiBindAddress << ":" << apiPort
+                      << (apiToken.empty() ? "" : " (token required)") << std::endl;
+        }
+        if (affinity != "none") {
+            std::cout << "Thread affinity: " << affinity << std::endl;
+        }
+        if (perfCounters) {
+            std::cout << "Performance counters: enabled" << std::endl;
+        }
+        if (!replayFile.empty()) {
+            std::cout << "Replaying: " << replayFile << " at " << replaySpeed << "x" << std::endl;
+        }
     }
 };
 
@@ -0,0 +1,285 @@
+#include "Connector.h"
+#include "Globals.h"
+#include "Constants.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include "Sockets.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <cerrno>
+#endif
+
+namespace Connector {
+    struct Address {
+        sockaddr_storage storage = {};
+        socklen_t length = 0;
+        int family = AF_UNSPEC;
+        std::string text;
+    };
+
+    struct CacheEntry {
+        std::vector<Address> addresses;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    static std::mutex cacheMutex;
+    static std::unordered_map<std::string, CacheEntry> cache;   // Keyed by "host:port"
+
+    static double msSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static bool setBlocking(SOCKET sock, bool blocking) {
+#ifdef _WIN32
+        u_long mode = blocking ? 0 : 1;
+        return ioctlsocket(sock, FIONBIO, &mode) == 0;
+#else
+        int flags = fcntl(sock, F_GETFL, 0);
+        return flags >= 0 && fcntl(sock, F_SETFL, blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK)) == 0;
+#endif
+    }
+
+    static int lastError() {
+#ifdef _WIN32
+        return WSAGetLastError();
+#else
+        return errno;
+#endif
+    }
+
+    static bool inProgress(int error) {
+#ifdef _WIN32
+        return error == WSAEWOULDBLOCK;
+#else
+        return error == EINPROGRESS;
+#endif
+    }
+
+    static std::string addressText(const sockaddr* addr, socklen_t length) {
+        char host[NI_MAXHOST] = {};
+        if (getnameinfo(addr, length, host, sizeof(host), nullptr, 0, NI_NUMERICHOST) != 0) {
+            return "?";
+        }
+        return addr->sa_family == AF_INET6 ? "[" + std::string(host) + "]" : std::string(host);
+    }
+
+    // Alternates address families, starting with the one the resolver put first (RFC 8305 section 4)
+    static std::vector<Address> interleave(const std::vector<Address>& sorted) {
+        std::vector<Address> first, second;
+        for (const auto& address : sorted) {
+            (address.family == sorted.front().family ? first : second).push_back(address);
+        }
+        std::vector<Address> ordered;
+        for (size_t i = 0; i < (std::max)(first.size(), second.size()); i++) {
+            if (i < first.size()) ordered.push_back(first[i]);
+            if (i < second.size()) ordered.push_back(second[i]);
+        }
+        return ordered;
+    }
+
+    // Cached addresses while fresh; on a resolver failure stale ones still beat nothing
+    static bool resolve(const std::string& host, const std::string& port,
+                        std::vector<Address>& addresses, bool& cached) {
+        std::string key = host + ":" + port;
+        auto now = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            auto it = cache.find(key);
+            if (it != cache.end() && now < it->second.expires) {
+                addresses = it->second.addresses;
+                cached = true;
+                return true;
+            }
+        }
+
+        struct addrinfo hints = {}, *result = nullptr;
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_protocol = IPPROTO_TCP;
+        int status = getaddrinfo(host.c_str(), port.c_str(), &hints, &result);
+        if (status != 0) {
+            std::string errorMsg = gai_strerrorA(status);
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            auto it = cache.find(key);
+            if (it == cache.end()) {
+                threadSafePrint("getaddrinfo failed for " + host + ": " + errorMsg, true);
+                return false;
+            }
+            threadSafePrint("getaddrinfo failed for " + host + " (" + errorMsg + "), using expired addresses", true);
+            addresses = it->second.addresses;
+            cached = true;
+            return true;
+        }
+
+        std::vector<Address> sorted;
+        for (struct addrinfo* ptr = result; ptr != nullptr; ptr = ptr->ai_next) {
+            if (ptr->ai_addrlen > sizeof(sockaddr_storage)) continue;
+            Address address;
+            std::memcpy(&address.storage, ptr->ai_addr, ptr->ai_addrlen);
+            address.length = static_cast<socklen_t>(ptr->ai_addrlen);
+            address.family = ptr->ai_family;
+            address.text = addressText(ptr->ai_addr, address.length);
+            sorted.push_back(address);
+        }
+        freeaddrinfo(result);
+        if (sorted.empty()) {
+            return false;
+        }
+
+        addresses = interleave(sorted);
+        cached = false;
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        cache[key] = { addresses, now + std::chrono::seconds(NetworkConstants::DNS_CACHE_TTL_SEC) };
+        return true;
+    }
+
+    struct Pending {
+        SOCKET socket;
+        size_t attempt;   // Index into 'attempts'
+        std::chrono::steady_clock::time_point start;
+    };
+
+    // Starts a new attempt every CONNECT_ATTEMPT_DELAY_MS, or as soon as one fails,
+    // and keeps the first connection that completes
+    static SOCKET race(const std::vector<Address>& addresses, std::vector<Attempt>& attempts) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(NetworkConstants::CONNECT_TIMEOUT_SEC);
+        std::vector<Pending> pending;
+        size_t next = 0;
+        auto nextStart = std::chrono::steady_clock::now();
+        SOCKET winner = INVALID_SOCKET;
+
+        auto fail = [&](size_t attempt, std::chrono::steady_clock::time_point start, int error) {
+            attempts[attempt].ms = msSince(start);
+            attempts[attempt].error = error;
+            nextStart = std::chrono::steady_clock::now();
+        };
+
+        while (winner == INVALID_SOCKET && std::chrono::steady_clock::now() < deadline &&
+               (next < addresses.size() || !pending.empty())) {
+            auto now = std::chrono::steady_clock::now();
+            if (next < addresses.size() && (pending.empty() || now >= nextStart)) {
+                const Address& address = addresses[next++];
+                Attempt attempt;
+                attempt.address = address.text;
+                attempts.push_back(attempt);
+                size_t index = attempts.size() - 1;
+
+                SOCKET sock = socket(address.family, SOCK_STREAM, IPPROTO_TCP);
+                if (sock == INVALID_SOCKET || !setBlocking(sock, false)) {
+                    fail(index, now, lastError());
+                    if (sock != INVALID_SOCKET) closesocket(sock);
+                    continue;
+                }
+                if (::connect(sock, reinterpret_cast<const sockaddr*>(&address.storage), address.length) != SOCKET_ERROR) {
+                    attempts[index].ms = msSince(now);
+                    attempts[index].connected = true;
+                    winner = sock;
+                    break;
+                }
+                int error = lastError();
+                if (!inProgress(error)) {
+                    fail(index, now, error);
+                    closesocket(sock);
+                    continue;
+                }
+                pending.push_back({ sock, index, now });
+                nextStart = now + std::chrono::milliseconds(NetworkConstants::CONNECT_ATTEMPT_DELAY_MS);
+            }
+
+            // Wait for a connection to complete, until the next attempt is due
+            auto waitUntil = next < addresses.size() ? (std::min)(nextStart, deadline) : deadline;
+            auto waitMs = (std::max)(std::chrono::milliseconds(0),
+                std::chrono::ceil<std::chrono::milliseconds>(waitUntil - std::chrono::steady_clock::now()));
+            std::vector<pollfd> fds(pending.size());
+            for (size_t i = 0; i < pending.size(); i++) {
+                fds[i].fd = pending[i].socket;
+                fds[i].events = POLLOUT;   // A failed connect sets POLLERR or POLLHUP as well
+            }
+            if (pollSockets(fds, static_cast<int>(waitMs.count())) <= 0) {
+                continue;
+            }
+
+            std::vector<Pending> stillPending;
+            for (size_t i = 0; i < pending.size(); i++) {
+                const Pending& p = pending[i];
+                if (fds[i].revents == 0) {
+                    stillPending.push_back(p);
+                    continue;
+                }
+                int error = 0;
+                socklen_t length = sizeof(error);
+                getsockopt(p.socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &length);
+                if (error == 0 && winner == INVALID_SOCKET) {
+                    attempts[p.attempt].ms = msSince(p.start);
+                    attempts[p.attempt].connected = true;
+                    winner = p.socket;
+                } else {
+                    fail(p.attempt, p.start, error);
+                    closesocket(p.socket);
+                }
+            }
+            pending.swap(stillPending);
+        }
+
+        // Attempts still in flight lose the race, or time out
+        for (const auto& p : pending) {
+            attempts[p.attempt].ms = msSince(p.start);
+            closesocket(p.socket);
+        }
+        if (winner != INVALID_SOCKET && !setBlocking(winner, true)) {
+            closesocket(winner);
+            winner = INVALID_SOCKET;
+        }
+        return winner;
+    }
+
+    int pollSockets(std::vector<pollfd>& fds, int timeoutMs) {
+#ifdef _WIN32
+        return WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), timeoutMs);
+#else
+        return ::poll(fds.data(), static_cast<nfds_t>(fds.size()), timeoutMs);
+#endif
+    }
+
+    SOCKET connect(const std::string& host, const std::string& port, std::vector<Attempt>& attempts) {
+        std::vector<Address> addresses;
+        bool cached = false;
+        if (!resolve(host, port, addresses, cached)) {
+            return INVALID_SOCKET;
+        }
+        SOCKET sock = race(addresses, attempts);
+        if (sock == INVALID_SOCKET && cached) {
+            // The host may have moved; resolve again before giving up
+            forget(host, port);
+            if (resolve(host, port, addresses, cached)) {
+                sock = race(addresses, attempts);
+            }
+        }
+        return sock;
+    }
+
+    void forget(const std::string& host, const std::string& port) {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        cache.erase(host + ":" + port);
+    }
+
+    std::string describe(const std::vector<Attempt>& attempts) {
+        std::string text;
+        for (const auto& attempt : attempts) {
+            if (!text.empty()) text += ", ";
+            text += attempt.address + " ";
+            if (attempt.connected) {
+                text += "connected in " + std::to_string(static_cast<int>(attempt.ms)) + " ms";
+            } else if (attempt.error != 0) {
+                text += "failed (" + std::to_string(attempt.error) + ") after " +
+                        std::to_string(static_cast<int>(attempt.ms)) + " ms";
+            } else {
+                text += "abandoned after " + std::to_string(static_cast<int>(attempt.ms)) + " ms";
+            }
+        }
+        return text;
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Sockets.h"
+#include <string>
+#include <vector>
+
+// Outgoing TCP connections: resolved addresses are cached for a few minutes so
+// reconnects skip DNS, and the addresses are raced Happy Eyeballs style (RFC 8305),
+// alternating IPv6 and IPv4 with a short stagger, so one dead address cannot
+// stall a connect for a full TCP timeout.
+namespace Connector {
+    struct Attempt {
+        std::string address;    // Numeric address tried
+        double ms = 0.0;        // Until connected or failed, or until abandoned
+        int error = 0;          // Socket error if the attempt failed
+        bool connected = false;
+    };
+
+    // Returns a connected blocking socket, or INVALID_SOCKET. 'attempts' gets
+    // every address tried, in start order.
+    SOCKET connect(const std::string& host, const std::string& port, std::vector<Attempt>& attempts);
+
+    // Drops the cached addresses of a host
+    void forget(const std::string& host, const std::string& port);
+
+    // poll() on POSIX, WSAPoll on Windows: unlike select, any socket value works
+    // (no FD_SETSIZE limit). Returns the ready count, 0 on timeout, < 0 on error.
+    int pollSockets(std::vector<pollfd>& fds, int timeoutMs);
+
+    // "[2001:db8::1] abandoned after 250 ms, 192.0.2.1 connected in 30 ms" for the log
+    std::string describe(const std::vector<Attempt>& attempts);
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 // Mining-specific constants
@@ -15,9 +16,15 @@ namespace MiningConstants {
     static constexpr int STATS_INTERVAL_MS = 2500;
     static constexpr int MAX_MINING_THREADS = 64;
     static constexpr int THREAD_PAUSE_TIME = 100;  // Milliseconds to pause when no jobs available
+    static constexpr int HASHRATE_SHORT_WINDOW_SEC = 10;      // Hashrate averages shown in the stats
     static constexpr int HASHRATE_AVERAGING_WINDOW_SIZE = 60;  // 60 seconds
+    static constexpr int HASHRATE_LONG_WINDOW_SEC = 900;
     static constexpr int JOB_QUEUE_SIZE = 2;
     static constexpr int SHARE_SUBMISSION_RETRIES = 3;
+    static constexpr size_t MAX_PENDING_SHARES = 256;       // Shares queued while disconnected
+    static constexpr int DEFAULT_JOB_GRACE_SEC = 120;        // Keep mining the last job this long after a disconnect
+    static constexpr size_t MAX_SPLIT_ENDPOINTS = 8;         // Weighted endpoints besides the main pool
+    static constexpr int SPLIT_SLICE_MS = 2000;              // Threads are reassigned between endpoints this often
 }
 
 // RandomX algorithm constants
@@ -36,6 +43,78 @@ namespace NetworkConstants {
     static constexpr int SOCKET_TIMEOUT_SEC = 30;
     static constexpr int MAX_RECEIVE_BUFFER = 8192;
     static constexpr int MAX_SEND_BUFFER = 4096;
+
+    // Multi-pool failover. Pools only send work on new blocks and difficulty changes;
+    // blocks average 2 minutes, but 10 minute gaps are routine.
+    static constexpr int DEFAULT_JOB_TIMEOUT_SEC = 1200;  // Fail over if no job arrives within this time
+    static constexpr int POOL_FAILURE_COOLDOWN_SEC = 30;  // Skip a failed pool for this long
+    static constexpr int STANDBY_RETRY_SEC = 10;          // Delay between standby connection attempts
+
+    // Dead connection detection
+    static constexpr int DEFAULT_KEEPALIVE_SEC = 30;      // Send keepalived after this much silence
+    static constexpr int DEFAULT_IDLE_TIMEOUT_SEC = 60;   // Connection is dead after this much silence
+    static constexpr int TCP_KEEPALIVE_IDLE_SEC = 10;     // OS keepalive probes start after this idle time
+    static constexpr int TCP_KEEPALIVE_INTERVAL_SEC = 5;
+    static constexpr int TCP_KEEPALIVE_COUNT = 3;
+    static constexpr int TCP_USER_TIMEOUT_MS = 20000;     // Max time sent data may stay unacknowledged
+
+    // Reconnects and share submission
+    static constexpr int RECONNECT_BACKOFF_BASE_MS = 1000;
+    static constexpr int RECONNECT_BACKOFF_MAX_MS = 60000;
+    static constexpr int SUBMIT_TIMEOUT_SEC = 10;
+
+    // Outgoing connections
+    static constexpr int CONNECT_ATTEMPT_DELAY_MS = 250;      // Stagger between racing address attempts
+    static constexpr int CONNECT_TIMEOUT_SEC = 10;
+    static constexpr int DNS_CACHE_TTL_SEC = 300;             // getaddrinfo gives no TTL, so a fixed one
+
+    // Stratum proxy mode
+    static constexpr int DEFAULT_PROXY_PORT = 3333;
+    static constexpr size_t PROXY_MAX_MINERS = 256;           // One per value of the fixed nonce byte
+    static constexpr size_t PROXY_MAX_CONNECTIONS = 1024;     // Including connections not yet logged in
+    static constexpr int PROXY_RELAY_THREADS = 8;             // Concurrent upstream share submissions
+    static constexpr size_t PROXY_MAX_RELAY_QUEUE = 1024;     // Shares waiting for a relay thread
+    static constexpr size_t PROXY_MAX_SEND_BACKLOG = 1 << 20; // Unsent bytes before a miner is dropped
+    static constexpr size_t PROXY_MAX_LINE = 16384;
+    static constexpr int PROXY_LOGIN_TIMEOUT_SEC = 30;
+    static constexpr int PROXY_MINER_IDLE_TIMEOUT_SEC = 600;
+    static constexpr int PROXY_STATS_INTERVAL_SEC = 60;
+
+    // Proxy share verification
+    static constexpr int DEFAULT_PROXY_VERIFY_THREADS = 2;
+    static constexpr size_t PROXY_VERIFY_QUEUE = 256;          // Shares waiting for verification
+    static constexpr size_t PROXY_VERIFY_SAMPLE_FROM = 64;     // Queue depth where sampling starts
+    static constexpr double PROXY_VERIFY_MIN_SAMPLE_RATE = 0.1;
+    static constexpr int PROXY_VERIFY_TRUST_SHARES = 8;        // Always verify a miner's first shares
+    static constexpr int PROXY_MAX_INVALID_SHARES = 5;         // Disconnect a miner after this many
+    static constexpr int PROXY_VERIFY_WINDOW_SEC = 10;
+
+    // Proxy variable difficulty
+    static constexpr int DEFAULT_PROXY_SHARE_INTERVAL_SEC = 30;  // 0 sends miners the upstream target
+    static constexpr uint64_t VARDIFF_START_DIFFICULTY = 10000;
+    static constexpr uint64_t VARDIFF_MIN_DIFFICULTY = 1000;
+    static constexpr int VARDIFF_WINDOW_SEC = 600;
+    static constexpr size_t VARDIFF_WINDOW_SHARES = 32;
+    static constexpr int VARDIFF_RETARGET_SHARES = 16;         // Retarget early after this many shares
+    static constexpr double VARDIFF_MAX_STEP = 4.0;            // Largest change per retarget
+    static constexpr double VARDIFF_TOLERANCE = 0.2;           // Smaller changes are not worth a new job
+    static constexpr size_t PROXY_MINER_JOB_HISTORY = 8;       // Job notifications a miner may still submit to
+
+    // Stratum capture replay
+    static constexpr int REPLAY_DRAIN_MS = 2000;               // Mining continues this long after the last job
+
+    // Solo mining against a monerod daemon
+    static constexpr int DAEMON_POLL_MS = 1000;                // Chain tip polling when there is no ZMQ feed
+    static constexpr int DAEMON_TEMPLATE_REFRESH_SEC = 30;     // Picks up new transactions between blocks
+    static constexpr int DAEMON_ZMQ_RETRY_SEC = 10;
+    static constexpr int DAEMON_RPC_TIMEOUT_SEC = 10;
+    static constexpr size_t DAEMON_TEMPLATE_HISTORY = 4;       // Templates a found block may still belong to
+
+    // HTTP stats and control API
+    static constexpr int DEFAULT_API_PORT = 0;                 // 0 disables the API
+    static constexpr size_t API_MAX_CONNECTIONS = 16;
+    static constexpr size_t API_MAX_REQUEST = 16384;           // Headers and body
+    static constexpr int API_IDLE_TIMEOUT_SEC = 10;
 }
 
 // Default configuration values
@@ -62,5 +141,4 @@ namespace DefaultConfig {
 
 // Mining configuration
 #define JOB_QUEUE_SIZE 2
-#define HASHRATE_AVERAGING_WINDOW_SIZE 60  // 60 seconds
 #define THREAD_PAUSE_TIME 100              // Milliseconds to pause when no jobs available 
\ No newline at end of file
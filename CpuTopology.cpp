@@ -0,0 +1,181 @@
+#include "CpuTopology.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <fstream>
+#endif
+
+namespace CpuTopology {
+    static Topology topology;
+    static std::once_flag detected;
+
+#ifdef _WIN32
+    static void detect() {
+        DWORD length = 0;
+        GetLogicalProcessorInformation(nullptr, &length);
+        std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+        if (info.empty() || !GetLogicalProcessorInformation(info.data(), &length)) {
+            return;
+        }
+
+        // Packages first, so each core can be matched to its package mask
+        std::vector<ULONG_PTR> packageMasks;
+        for (const auto& entry : info) {
+            if (entry.Relationship == RelationProcessorPackage) {
+                packageMasks.push_back(entry.ProcessorMask);
+            } else if (entry.Relationship == RelationCache && entry.Cache.Level == 3) {
+                topology.l3Bytes = (std::max)(topology.l3Bytes, static_cast<uint64_t>(entry.Cache.Size));
+            }
+        }
+        for (const auto& entry : info) {
+            if (entry.Relationship != RelationProcessorCore) continue;
+            int package = 0;
+            for (size_t p = 0; p < packageMasks.size(); p++) {
+                if (packageMasks[p] & entry.ProcessorMask) package = static_cast<int>(p);
+            }
+            for (int bit = 0; bit < static_cast<int>(sizeof(ULONG_PTR) * 8); bit++) {
+                if (entry.ProcessorMask & (static_cast<ULONG_PTR>(1) << bit)) {
+                    topology.cpus.push_back(Cpu{ bit, topology.cores, package });
+                }
+            }
+            topology.cores++;
+        }
+        topology.packages = (std::max)(1, static_cast<int>(packageMasks.size()));
+    }
+#else
+    static int readNumber(const std::string& path, int fallback) {
+        std::ifstream file(path);
+        int value;
+        return file >> value ? value : fallback;
+    }
+
+    // "32768K" and the like
+    static uint64_t readCacheSize(const std::string& path) {
+        std::ifstream file(path);
+        uint64_t value = 0;
+        char unit = 0;
+        if (!(file >> value)) return 0;
+        file >> unit;
+        return unit == 'K' ? value << 10 : unit == 'M' ? value << 20 : value;
+    }
+
+    static void detect() {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+            return;
+        }
+
+        // core_id is only unique within a package
+        std::map<std::pair<int, int>, int> coreIndex;
+        std::map<int, int> packages;
+        for (int id = 0; id < CPU_SETSIZE; id++) {
+            if (!CPU_ISSET(id, &allowed)) continue;
+            std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(id) + "/topology/";
+            int package = readNumber(base + "physical_package_id", 0);
+            int coreId = readNumber(base + "core_id", id);
+            auto key = std::make_pair(package, coreId);
+            if (coreIndex.find(key) == coreIndex.end()) {
+                int index = static_cast<int>(coreIndex.size());
+                coreIndex[key] = index;
+            }
+            packages[package]++;
+            topology.cpus.push_back(Cpu{ id, coreIndex[key], package });
+        }
+        topology.cores = static_cast<int>(coreIndex.size());
+        topology.packages = (std::max)(1, static_cast<int>(packages.size()));
+
+        for (int index = 0; index < 8; index++) {
+            std::string base = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/";
+            if (readNumber(base + "level", 0) == 3) {
+                topology.l3Bytes = readCacheSize(base + "size");
+            }
+        }
+    }
+#endif
+
+    const Topology& get() {
+        std::call_once(detected, []() {
+            detect();
+            // Without topology information every logical CPU counts as a core
+            if (topology.cpus.empty()) {
+                int count = static_cast<int>((std::max)(1u, std::thread::hardware_concurrency()));
+                for (int id = 0; id < count; id++) {
+                    topology.cpus.push_back(Cpu{ id, id, 0 });
+                }
+                topology.cores = count;
+                topology.packages = 1;
+            }
+            std::sort(topology.cpus.begin(), topology.cpus.end(), [](const Cpu& a, const Cpu& b) {
+                return a.core != b.core ? a.core < b.core : a.id < b.id;
+            });
+        });
+        return topology;
+    }
+
+    bool parsePolicy(const std::string& name, Policy& policy) {
+        if (name == "none") policy = Policy::None;
+        else if (name == "cores") policy = Policy::Cores;
+        else if (name == "compact") policy = Policy::Compact;
+        else return false;
+        return true;
+    }
+
+    const char* policyName(Policy policy) {
+        switch (policy) {
+            case Policy::Cores: return "cores";
+            case Policy::Compact: return "compact";
+            default: return "none";
+        }
+    }
+
+    std::vector<int> plan(Policy policy, int threads) {
+        std::vector<int> cpus;
+        if (policy == Policy::None) {
+            return cpus;
+        }
+        const Topology& host = get();
+        std::vector<int> order;
+        if (policy == Policy::Compact) {
+            for (const auto& cpu : host.cpus) {
+                order.push_back(cpu.id);
+            }
+        } else {
+            // The n-th sibling of every core before any core's (n+1)-th
+            std::vector<int> siblingsSeen(host.cores, 0);
+            std::vector<std::pair<int, int>> ranked;   // (sibling rank, position in cpus)
+            for (size_t i = 0; i < host.cpus.size(); i++) {
+                ranked.emplace_back(siblingsSeen[host.cpus[i].core]++, static_cast<int>(i));
+            }
+            std::stable_sort(ranked.begin(), ranked.end(),
+                [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first < b.first; });
+            for (const auto& entry : ranked) {
+                order.push_back(host.cpus[entry.second].id);
+            }
+        }
+        for (int t = 0; t < threads; t++) {
+            cpus.push_back(order[t % order.size()]);
+        }
+        return cpus;
+    }
+
+    bool pinCurrentThread(int cpu) {
+#ifdef _WIN32
+        if (cpu < 0 || cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8)) return false;
+        return SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu) != 0;
+#else
+        if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Logical CPUs this process may run on, grouped into physical cores, and thread
+// pinning. Used to place mining threads (--affinity) and by the scaling benchmark.
+namespace CpuTopology {
+    struct Cpu {
+        int id = 0;        // Logical CPU number, as the OS numbers them
+        int core = 0;      // Physical core index, unique across packages
+        int package = 0;
+    };
+
+    struct Topology {
+        std::vector<Cpu> cpus;     // Sorted by core, then logical CPU
+        int cores = 0;
+        int packages = 0;
+        uint64_t l3Bytes = 0;      // One L3 cache (CPU 0's on Linux); 0 if unknown
+        bool smt() const { return static_cast<int>(cpus.size()) > cores; }
+    };
+
+    // None leaves placement to the OS. Cores puts one thread on each physical core
+    // before using SMT siblings; Compact fills both siblings of a core first.
+    enum class Policy { None, Cores, Compact };
+
+    const Topology& get();     // Detected on first use
+    bool parsePolicy(const std::string& name, Policy& policy);
+    const char* policyName(Policy policy);
+
+    // Logical CPU for each of 'threads' threads, wrapping if there are more threads
+    // than CPUs; empty for Policy::None
+    std::vector<int> plan(Policy policy, int threads);
+    bool pinCurrentThread(int cpu);
+}
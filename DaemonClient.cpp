@@ -0,0 +1,386 @@
+#include "DaemonClient.h"
+#include "PoolClient.h"
+#include "ZmqSubscriber.h"
+#include "Connector.h"
+#include "Globals.h"
+#include "Config.h"
+#include "Constants.h"
+#include "Job.h"
+#include "picojson.h"
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "Sockets.h"
+
+namespace DaemonClient {
+    static const std::string CHAIN_TOPIC = "json-minimal-chain_main";
+
+    // A template a found block may belong to; the block is the template blob with the nonce in place
+    struct BlockTemplate {
+        std::string jobId;
+        std::string blob;
+        uint64_t height = 0;
+    };
+
+    static std::string rpcHost;
+    static int rpcPort = 0;
+    static std::string zmqHost;
+    static int zmqPort = 0;   // 0: no ZMQ feed, poll the chain tip
+
+    static std::mutex templateMutex;
+    static std::deque<BlockTemplate> templates;   // Newest last, guarded by templateMutex
+    static uint64_t templateCounter = 0;
+    static std::string chainTip;                  // prev_hash of the current template (listener thread)
+    static std::atomic<bool> refreshRequested(false);
+
+    static std::mutex statsMutex;
+    static Stats stats;   // Guarded by statsMutex
+
+    static double msSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // "host:port", optionally with a tcp:// or http:// scheme as monerod prints them
+    static bool splitEndpoint(std::string endpoint, std::string& host, int& port) {
+        for (const char* scheme : { "tcp://", "http://" }) {
+            if (endpoint.rfind(scheme, 0) == 0) {
+                endpoint = endpoint.substr(strlen(scheme));
+            }
+        }
+        size_t colon = endpoint.rfind(':');
+        if (colon == std::string::npos || colon == 0) {
+            return false;
+        }
+        host = endpoint.substr(0, colon);
+        try {
+            port = std::stoi(endpoint.substr(colon + 1));
+        } catch (const std::exception&) {
+            return false;
+        }
+        return port > 0 && port <= 65535;
+    }
+
+    static SOCKET openConnection() {
+        std::vector<Connector::Attempt> attempts;
+        SOCKET sock = Connector::connect(rpcHost, std::to_string(rpcPort), attempts);
+        if (sock != INVALID_SOCKET) {
+            int optval = 1;
+            setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<char*>(&optval), sizeof(optval));
+        }
+        return sock;
+    }
+
+    // POSTs a JSON-RPC 2.0 call to /json_rpc on its own connection (safe from any
+    // thread) and returns the "result" object, or the error message
+    static bool rpcCall(const std::string& method, const picojson::value& params,
+                        picojson::object& result, std::string& error) {
+        picojson::object request;
+        request["jsonrpc"] = picojson::value("2.0");
+        request["id"] = picojson::value("0");
+        request["method"] = picojson::value(method);
+        request["params"] = params;
+        std::string body = picojson::value(request).serialize();
+        std::string http = "POST /json_rpc HTTP/1.1\r\n"
+                           "Host: " + rpcHost + ":" + std::to_string(rpcPort) + "\r\n"
+                           "Content-Type: application/json\r\n"
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                           "Connection: close\r\n\r\n" + body;
+
+        SOCKET sock = openConnection();
+        if (sock == INVALID_SOCKET) {
+            error = "cannot connect to " + rpcHost + ":" + std::to_string(rpcPort);
+            return false;
+        }
+        if (send(sock, http.c_str(), static_cast<int>(http.size()), 0) == SOCKET_ERROR) {
+            closesocket(sock);
+            error = "send failed: " + std::to_string(WSAGetLastError());
+            return false;
+        }
+
+        // Read until the body is complete or the daemon closes the connection
+        std::string response;
+        size_t headerEnd = std::string::npos;
+        size_t contentLength = std::string::npos;
+        char data[NetworkConstants::MAX_RECEIVE_BUFFER];
+        while (true) {
+            fd_set readSet;
+            FD_ZERO(&readSet);
+            FD_SET(sock, &readSet);
+            struct timeval timeout = { NetworkConstants::DAEMON_RPC_TIMEOUT_SEC, 0 };
+            if (select(static_cast<int>(sock) + 1, &readSet, nullptr, nullptr, &timeout) <= 0) {
+                closesocket(sock);
+                error = "timeout waiting for " + method;
+                return false;
+            }
+            int n = recv(sock, data, sizeof(data), 0);
+            if (n <= 0) break;
+            response.append(data, n);
+            if (headerEnd == std::string::npos && (headerEnd = response.find("\r\n\r\n")) != std::string::npos) {
+                std::string headers = response.substr(0, headerEnd);
+                for (char& c : headers) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+                size_t pos = headers.find("\r\ncontent-length:");
+                if (pos != std::string::npos) {
+                    contentLength = std::strtoull(headers.c_str() + pos + 17, nullptr, 10);
+                }
+            }
+            if (headerEnd != std::string::npos && contentLength != std::string::npos &&
+                response.size() >= headerEnd + 4 + contentLength) {
+                break;
+            }
+        }
+        closesocket(sock);
+
+        if (headerEnd == std::string::npos || response.compare(0, 5, "HTTP/") != 0) {
+            error = "malformed HTTP response to " + method;
+            return false;
+        }
+        size_t space = response.find(' ');
+        int status = space != std::string::npos ? std::atoi(response.c_str() + space + 1) : 0;
+        if (status != 200) {
+            error = "HTTP " + std::to_string(status) + " for " + method;
+            return false;
+        }
+
+        picojson::value v;
+        std::string parseError = picojson::parse(v, response.substr(headerEnd + 4));
+        if (!parseError.empty() || !v.is<picojson::object>()) {
+            error = "invalid JSON in response to " + method;
+            return false;
+        }
+        const picojson::object& obj = v.get<picojson::object>();
+        auto errorIt = obj.find("error");
+        if (errorIt != obj.end() && errorIt->second.is<picojson::object>()) {
+            const picojson::object& errorObj = errorIt->second.get<picojson::object>();
+            auto message = errorObj.find("message");
+            error = message != errorObj.end() && message->second.is<std::string>()
+                ? message->second.get<std::string>() : errorIt->second.serialize();
+            return false;
+        }
+        auto resultIt = obj.find("result");
+        if (resultIt == obj.end() || !resultIt->second.is<picojson::object>()) {
+            error = "no result in response to " + method;
+            return false;
+        }
+        result = resultIt->second.get<picojson::object>();
+        return true;
+    }
+
+    static std::string getString(const picojson::object& obj, const std::string& key) {
+        auto it = obj.find(key);
+        return it != obj.end() && it->second.is<std::string>() ? it->second.get<std::string>() : std::string();
+    }
+
+    static double getNumber(const picojson::object& obj, const std::string& key) {
+        auto it = obj.find(key);
+        return it != obj.end() && it->second.is<double>() ? it->second.get<double>() : 0.0;
+    }
+
+    // Fetches a template and hands it to the miners as a new job. 'trigger' is
+    // when the block that prompted it was seen, for the latency figure.
+    static bool fetchTemplate(std::chrono::steady_clock::time_point trigger) {
+        picojson::object params;
+        params["wallet_address"] = picojson::value(config.walletAddress);
+        params["reserve_size"] = picojson::value(0.0);
+        picojson::object result;
+        std::string error;
+        if (!rpcCall("get_block_template", picojson::value(params), result, error)) {
+            threadSafePrint("Daemon: get_block_template failed: " + error, true);
+            PoolClient::setWorkSourceConnected(false);
+            return false;
+        }
+
+        std::string hashingBlob = getString(result, "blockhashing_blob");
+        std::string templateBlob = getString(result, "blocktemplate_blob");
+        std::string seedHash = getString(result, "seed_hash");
+        double difficulty = getNumber(result, "difficulty");
+        uint64_t height = static_cast<uint64_t>(getNumber(result, "height"));
+        if (hashingBlob.empty() || seedHash.empty() || difficulty < 1.0 || height == 0 ||
+            templateBlob.size() < (MiningConstants::NONCE_OFFSET + MiningConstants::NONCE_SIZE) * 2) {
+            threadSafePrint("Daemon: incomplete block template", true);
+            return false;
+        }
+
+        BlockTemplate block;
+        block.jobId = std::to_string(++templateCounter);
+        block.blob = templateBlob;
+        block.height = height;
+        {
+            std::lock_guard<std::mutex> lock(templateMutex);
+            templates.push_back(block);
+            if (templates.size() > NetworkConstants::DAEMON_TEMPLATE_HISTORY) {
+                templates.pop_front();
+            }
+        }
+        chainTip = getString(result, "prev_hash");
+
+        // The network difficulty as a stratum target; above 2^64 no hash could tell the difference
+        picojson::object job;
+        job["job_id"] = picojson::value(block.jobId);
+        job["blob"] = picojson::value(hashingBlob);
+        job["target"] = picojson::value(Job::difficultyToTarget(
+            difficulty >= 18446744073709551615.0 ? UINT64_MAX : static_cast<uint64_t>(difficulty)));
+        job["height"] = picojson::value(static_cast<double>(height));
+        job["seed_hash"] = picojson::value(seedHash);
+        job["algo"] = picojson::value("rx/0");
+        PoolClient::setWorkSourceConnected(true);
+        PoolClient::processNewJob(job);
+
+        double ms = msSince(trigger);
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.templates++;
+            stats.lastTemplateMs = ms;
+        }
+        threadSafePrint("Daemon: block template for height " + std::to_string(height) + ", difficulty " +
+            std::to_string(static_cast<uint64_t>(difficulty)) + " (" + std::to_string(ms) + " ms)", true);
+        return true;
+    }
+
+    // Sleeps for the poll interval, then asks the daemon for its chain tip.
+    // Returns true if the tip moved past the current template.
+    static bool pollChainTip() {
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(NetworkConstants::DAEMON_POLL_MS);
+        while (!PoolClient::shouldStop && !refreshRequested && std::chrono::steady_clock::now() < end) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+
+        picojson::object result;
+        std::string error;
+        if (!rpcCall("get_last_block_header", picojson::value(picojson::object()), result, error)) {
+            threadSafePrint("Daemon: get_last_block_header failed: " + error, true);
+            PoolClient::setWorkSourceConnected(false);
+            return false;
+        }
+        auto header = result.find("block_header");
+        if (header == result.end() || !header->second.is<picojson::object>()) {
+            return false;
+        }
+        std::string tip = getString(header->second.get<picojson::object>(), "hash");
+        return !tip.empty() && tip != chainTip;
+    }
+
+    // Waits up to a second for a chain notification. Returns true on a new block.
+    static bool waitForNotification(ZmqSubscriber& zmq) {
+        fd_set readSet;
+        FD_ZERO(&readSet);
+        FD_SET(zmq.getSocket(), &readSet);
+        struct timeval timeout = { 1, 0 };
+        if (select(static_cast<int>(zmq.getSocket()) + 1, &readSet, nullptr, nullptr, &timeout) <= 0) {
+            return false;
+        }
+
+        std::vector<std::string> messages;
+        if (!zmq.read(messages)) {
+            threadSafePrint("Daemon: ZMQ feed lost, polling the chain tip", true);
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.zmqConnected = false;
+        }
+        bool newBlock = false;
+        for (const auto& message : messages) {
+            // "json-minimal-chain_main:{"first_height":N,"first_prev_id":...,"ids":[...]}"
+            if (message.compare(0, CHAIN_TOPIC.size(), CHAIN_TOPIC) != 0) continue;
+            newBlock = true;
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.notifications++;
+            if (config.debugMode) {
+                threadSafePrint("Daemon: " + message, true);
+            }
+        }
+        return newBlock;
+    }
+
+    static PoolClient::ShareStatus submitBlock(const std::string& jobId, const std::string& nonce,
+                                               const std::string& result) {
+        BlockTemplate block;
+        {
+            std::lock_guard<std::mutex> lock(templateMutex);
+            for (const auto& candidate : templates) {
+                if (candidate.jobId == jobId) block = candidate;
+            }
+        }
+        if (block.jobId.empty() || nonce.size() != MiningConstants::NONCE_SIZE * 2) {
+            threadSafePrint("Daemon: block candidate for unknown template " + jobId, true);
+            return PoolClient::ShareStatus::Rejected;
+        }
+
+        // Header layout is shared with the hashing blob, so the nonce sits at the same offset
+        block.blob.replace(MiningConstants::NONCE_OFFSET * 2, nonce.size(), nonce);
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.blocksSubmitted++;
+        }
+
+        picojson::array params;
+        params.push_back(picojson::value(block.blob));
+        picojson::object response;
+        std::string error;
+        bool accepted = rpcCall("submit_block", picojson::value(params), response, error);
+        refreshRequested = true;
+        if (!accepted) {
+            threadSafePrint("Daemon: block at height " + std::to_string(block.height) + " rejected: " + error +
+                " (hash " + result + ")", true);
+            return PoolClient::ShareStatus::Rejected;
+        }
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.blocksAccepted++;
+        }
+        threadSafePrint("Daemon: block found at height " + std::to_string(block.height) + "! Hash " + result, true);
+        return PoolClient::ShareStatus::Accepted;
+    }
+
+    bool start() {
+        if (!splitEndpoint(config.daemonAddress, rpcHost, rpcPort)) {
+            threadSafePrint("Invalid daemon address (expected HOST:PORT): " + config.daemonAddress, true);
+            return false;
+        }
+        if (!config.daemonZmqAddress.empty() && !splitEndpoint(config.daemonZmqAddress, zmqHost, zmqPort)) {
+            threadSafePrint("Invalid daemon ZMQ address (expected HOST:PORT): " + config.daemonZmqAddress, true);
+            return false;
+        }
+
+        PoolClient::setWorkSource(submitBlock);
+        if (!fetchTemplate(std::chrono::steady_clock::now())) {
+            threadSafePrint("Cannot get a block template from the daemon at " + config.daemonAddress, true);
+            return false;
+        }
+        return true;
+    }
+
+    void jobListener() {
+        ZmqSubscriber zmq;
+        auto lastTemplate = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point lastZmqAttempt;
+
+        while (!PoolClient::shouldStop) {
+            auto now = std::chrono::steady_clock::now();
+            if (zmqPort > 0 && !zmq.isConnected() &&
+                now - lastZmqAttempt >= std::chrono::seconds(NetworkConstants::DAEMON_ZMQ_RETRY_SEC)) {
+                lastZmqAttempt = now;
+                if (zmq.connect(zmqHost, zmqPort, CHAIN_TOPIC)) {
+                    threadSafePrint("Daemon: subscribed to " + CHAIN_TOPIC + " on " + config.daemonZmqAddress, true);
+                    std::lock_guard<std::mutex> lock(statsMutex);
+                    stats.zmqConnected = true;
+                }
+            }
+
+            // Blocks missed while the feed was down are caught by the next template refresh
+            bool newBlock = zmq.isConnected() ? waitForNotification(zmq) : pollChainTip();
+            now = std::chrono::steady_clock::now();
+            bool refresh = now - lastTemplate >= std::chrono::seconds(NetworkConstants::DAEMON_TEMPLATE_REFRESH_SEC);
+            if ((newBlock || refresh || refreshRequested.exchange(false)) && fetchTemplate(now)) {
+                lastTemplate = now;
+            }
+        }
+    }
+
+    Stats getStats() {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        return stats;
+    }
+}
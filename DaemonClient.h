@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Solo mining work source: block templates from a monerod daemon's JSON-RPC
+// (get_block_template), refreshed as soon as the daemon's ZMQ chain feed
+// (json-minimal-chain_main) announces a new block, or by polling the chain tip
+// when no ZMQ endpoint is configured. Templates are turned into stratum-style
+// jobs for PoolClient::processNewJob, so mining threads see no difference;
+// found blocks come back through PoolClient::submitShare and go to submit_block.
+namespace DaemonClient {
+    struct Stats {
+        uint64_t templates = 0;
+        uint64_t notifications = 0;     // New-block notifications from ZMQ
+        double lastTemplateMs = 0.0;    // New block seen until its template was handed to the miners
+        uint64_t blocksSubmitted = 0;
+        uint64_t blocksAccepted = 0;
+        bool zmqConnected = false;
+    };
+
+    // Registers as the work source and fetches the first template
+    bool start();
+
+    // Job listener loop for daemon mode; runs until PoolClient::shouldStop
+    void jobListener();
+
+    Stats getStats();
+}
@@ -0,0 +1,180 @@
+#include "EnergyMeter.h"
+#include "Utils.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <vector>
+#ifdef __linux__
+#include <filesystem>
+#include <unistd.h>
+#endif
+
+namespace EnergyMeter {
+    struct Domain {
+        std::string name;          // "package-0", "dram", ...
+        std::string energyPath;
+        bool dram = false;
+        uint64_t maxRange = 0;     // Counter value at which energy_uj wraps to 0
+        uint64_t last = 0;         // Previous raw counter value
+        double joules = 0.0;       // Accumulated since start()
+    };
+
+    static std::vector<Domain> domains;      // Guarded by readMutex after start()
+    static std::atomic<bool> active(false);
+    static std::mutex readMutex;
+
+    static std::mutex powerMutex;
+    static Reading lastReading;              // Guarded by powerMutex
+    static uint64_t lastHashes = 0;          // Guarded by powerMutex
+    static Power power;                      // Guarded by powerMutex
+
+    static bool readMicrojoules(const std::string& path, uint64_t& value) {
+        std::ifstream file(path);
+        return static_cast<bool>(file >> value);
+    }
+
+#ifdef __linux__
+    static std::string readLine(const std::string& path) {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        return line;
+    }
+
+    // Packages and their DRAM subzones; core, uncore and psys overlap with them
+    static void findDomains(bool& denied) {
+        const std::filesystem::path root("/sys/class/powercap");
+        std::error_code ec;
+        for (std::filesystem::directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+            std::string zone = it->path().filename().string();
+            if (zone.compare(0, 11, "intel-rapl:") != 0) continue;   // Not intel-rapl-mmio, a copy of the package zone
+
+            Domain domain;
+            domain.name = readLine((it->path() / "name").string());
+            domain.dram = domain.name == "dram";
+            if (!domain.dram && domain.name.compare(0, 7, "package") != 0) continue;
+
+            domain.energyPath = (it->path() / "energy_uj").string();
+            // Root only since Linux 5.10, as power readings can leak secrets
+            if (access(domain.energyPath.c_str(), R_OK) != 0 || !readMicrojoules(domain.energyPath, domain.last)) {
+                denied = true;
+                continue;
+            }
+            readMicrojoules((it->path() / "max_energy_range_uj").string(), domain.maxRange);
+            domains.push_back(domain);
+        }
+        std::sort(domains.begin(), domains.end(), [](const Domain& a, const Domain& b) {
+            return a.dram != b.dram ? b.dram : a.energyPath < b.energyPath;
+        });
+    }
+#endif
+
+    bool start() {
+#ifdef __linux__
+        std::lock_guard<std::mutex> lock(readMutex);
+        bool denied = false;
+        domains.clear();
+        findDomains(denied);
+        if (domains.empty()) {
+            if (denied) {
+                threadSafePrint("RAPL energy counters are readable by root only; run as root or make "
+                    "/sys/class/powercap/intel-rapl:*/energy_uj readable to report power", true);
+            }
+            return false;
+        }
+        std::string names;
+        for (const auto& domain : domains) {
+            names += (names.empty() ? "" : ", ") + domain.name;
+        }
+        threadSafePrint("Energy metering: RAPL " + names, true);
+        active = true;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    bool isActive() {
+        return active;
+    }
+
+    Reading read() {
+        Reading reading;
+        reading.time = std::chrono::steady_clock::now();
+        if (!active) {
+            return reading;
+        }
+        std::lock_guard<std::mutex> lock(readMutex);
+        for (auto& domain : domains) {
+            uint64_t value;
+            if (readMicrojoules(domain.energyPath, value)) {
+                uint64_t delta;
+                if (value >= domain.last) {
+                    delta = value - domain.last;
+                } else {
+                    // Wrapped past max_energy_range_uj; without it, count from zero
+                    delta = domain.maxRange > domain.last ? domain.maxRange - domain.last + value : value;
+                }
+                domain.joules += delta / 1e6;
+                domain.last = value;
+            }
+            if (domain.dram) {
+                reading.dramJoules += domain.joules;
+                reading.hasDram = true;
+            } else {
+                reading.packageJoules += domain.joules;
+            }
+        }
+        reading.available = true;
+        return reading;
+    }
+
+    Power between(const Reading& from, const Reading& to, uint64_t hashes) {
+        Power result;
+        double seconds = std::chrono::duration<double>(to.time - from.time).count();
+        if (!from.available || !to.available || seconds <= 0.0) {
+            return result;
+        }
+        double packageJoules = to.packageJoules - from.packageJoules;
+        double dramJoules = to.dramJoules - from.dramJoules;
+        result.available = true;
+        result.hasDram = to.hasDram;
+        result.packageWatts = packageJoules / seconds;
+        result.dramWatts = dramJoules / seconds;
+        result.joules = packageJoules + dramJoules;
+        result.hashesPerJoule = result.joules > 0.0 ? hashes / result.joules : 0.0;
+        return result;
+    }
+
+    void update(uint64_t totalHashes) {
+        if (!active) {
+            return;
+        }
+        Reading reading = read();
+        std::lock_guard<std::mutex> lock(powerMutex);
+        // Rates need a previous reading; the first update only records one
+        if (lastReading.available) {
+            power = between(lastReading, reading, totalHashes - lastHashes);
+        }
+        lastReading = reading;
+        lastHashes = totalHashes;
+    }
+
+    Power getPower() {
+        std::lock_guard<std::mutex> lock(powerMutex);
+        return power;
+    }
+
+    std::string summary(const Power& power) {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(1) << power.watts() << " W";
+        if (power.hasDram) {
+            ss << " (package " << power.packageWatts << " W, DRAM " << power.dramWatts << " W)";
+        }
+        ss << " | " << std::setprecision(2) << power.hashesPerJoule << " H/J";
+        return ss.str();
+    }
+}
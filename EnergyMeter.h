@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Energy use from the Linux RAPL powercap interface (/sys/class/powercap/intel-rapl*,
+// also used by AMD Zen): every CPU package and, where the platform reports it,
+// DRAM. Turns the hashrate into watts and hashes per joule, so threads and
+// affinity can be tuned for efficiency. The counters cover the whole package, not
+// just this process. Without the interface, or without permission to read it,
+// the meter stays off and nothing reports power.
+namespace EnergyMeter {
+    // Energy used since start(), wraparound of the hardware counters included
+    struct Reading {
+        bool available = false;
+        bool hasDram = false;
+        double packageJoules = 0.0;   // All packages
+        double dramJoules = 0.0;
+        std::chrono::steady_clock::time_point time;
+    };
+
+    struct Power {
+        bool available = false;
+        bool hasDram = false;
+        double packageWatts = 0.0;
+        double dramWatts = 0.0;
+        double joules = 0.0;          // Package and DRAM over the interval
+        double hashesPerJoule = 0.0;
+
+        double watts() const { return packageWatts + dramWatts; }
+    };
+
+    bool start();     // Finds the RAPL domains; false if there are none to read
+    bool isActive();
+
+    // Reads every domain. A counter wraps after max_energy_range_uj (minutes at
+    // full load), so readings must come at least that often to stay exact.
+    Reading read();
+    Power between(const Reading& from, const Reading& to, uint64_t hashes);
+
+    // Power and efficiency over the interval since the previous update; called by
+    // the stats monitor each period with the total hash count
+    void update(uint64_t totalHashes);
+    Power getPower();
+
+    // "102.4 W (package 95.1 W, DRAM 7.3 W) | 41.3 H/J"
+    std::string summary(const Power& power);
+}
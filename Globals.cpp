@@ -7,6 +7,14 @@
 #include <sstream>
 #include <iomanip>
 #include <chrono>
+#include <fstream>
+#ifdef _WIN32
+#include <Windows.h>
+#include <Psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <unistd.h>
+#endif
 
 // Global variables definitions
 bool debugMode = false;
@@ -39,6 +47,10 @@ std::vector<MiningThreadData*> threadData;
 // Global configuration and stats
 GlobalStats globalStats;
 
+// Mining control
+std::atomic<bool> miningPaused(false);
+std::atomic<int> activeThreads(0);
+
 // RandomX globals
 randomx_cache* currentCache = nullptr;
 randomx_dataset* currentDataset = nullptr;
@@ -46,34 +58,19 @@ std::string currentSeedHash;
 std::mutex cacheMutex;
 std::mutex seedHashMutex;
 
-// Utility functions
-std::string bytesToHex(const std::vector<uint8_t>& bytes) {
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0');
-    for (uint8_t byte : bytes) {
-        ss << std::setw(2) << static_cast<int>(byte) << " ";
+uint64_t getResidentMemoryBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.WorkingSetSize;
     }
-    return ss.str();
-}
-
-std::string getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto now_c = std::chrono::system_clock::to_time_t(now);
-    char buffer[26];
-    ctime_s(buffer, sizeof(buffer), &now_c);
-    std::string timestamp(buffer);
-    timestamp = timestamp.substr(0, timestamp.length() - 1); // Remove newline
-    return timestamp;
-}
-
-void threadSafePrint(const std::string& message, bool toLogFile) {
-    std::lock_guard<std::mutex> consoleLock(consoleMutex);
-    std::cout << message << std::endl;
-
-    if (toLogFile && config.useLogFile) {
-        std::lock_guard<std::mutex> logLock(logfileMutex);
-        if (logFile.is_open()) {
-            logFile << getCurrentTimestamp() << " " << message << std::endl;
-        }
+    return 0;
+#else
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0, resident = 0;
+    if (statm >> size >> resident) {
+        return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
     }
-} 
\ No newline at end of file
+    return 0;
+#endif
+}
@@ -47,6 +47,10 @@ extern std::vector<MiningThreadData*> threadData;
 // Global configuration and stats
 extern GlobalStats globalStats;
 
+// Mining control (HTTP API); the mining threads check it before each hash
+extern std::atomic<bool> miningPaused;
+extern std::atomic<int> activeThreads;   // Threads with a lower id mine, the others idle
+
 // RandomX globals
 extern randomx_cache* currentCache;
 extern randomx_dataset* currentDataset;
@@ -55,6 +59,5 @@ extern std::mutex cacheMutex;
 extern std::mutex seedHashMutex;
 
 // Utility functions
-std::string bytesToHex(const std::vector<uint8_t>& bytes);
 std::string getCurrentTimestamp();
 void threadSafePrint(const std::string& message, bool toLogFile); 
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "HashTiming.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace HashTiming {
+    static constexpr int SUB_BUCKET_BITS = 7;
+    static constexpr uint64_t SUB_BUCKETS = 1ULL << SUB_BUCKET_BITS;
+    static constexpr uint64_t HALF_SUB_BUCKETS = SUB_BUCKETS / 2;
+    static constexpr int MAX_MAGNITUDE = 44;          // 2^44 ticks, over an hour at 4 GHz
+    static constexpr uint64_t MAX_TICKS = (1ULL << MAX_MAGNITUDE) - 1;
+    static constexpr size_t BUCKET_COUNT = (MAX_MAGNITUDE - SUB_BUCKET_BITS + 2) * HALF_SUB_BUCKETS;
+    static constexpr int CALIBRATION_MS = 50;
+
+#ifdef MONEROMINER_HASH_TIMING
+    thread_local Histogram* current = nullptr;
+
+    // The TSC runs at a constant rate on every CPU this miner targets, so one
+    // measurement against the steady clock holds for the whole run
+    static double calibrate() {
+        auto clockStart = std::chrono::steady_clock::now();
+        uint64_t tscStart = startStamp();
+        std::this_thread::sleep_for(std::chrono::milliseconds(CALIBRATION_MS));
+        uint64_t tscEnd = endStamp();
+        double elapsedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - clockStart).count();
+        return tscEnd > tscStart ? elapsedNs / static_cast<double>(tscEnd - tscStart) : 1.0;
+    }
+#endif
+
+    double nsPerTick() {
+#ifdef MONEROMINER_HASH_TIMING
+        static const double value = calibrate();
+        return value;
+#else
+        return 1.0;
+#endif
+    }
+
+    Histogram::Histogram() : counts(new std::atomic<uint64_t>[BUCKET_COUNT]) {
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            counts[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Same layout as LatencyHistogram, over ticks instead of microseconds
+    size_t Histogram::indexOf(uint64_t ticks) {
+        if (ticks < SUB_BUCKETS) {
+            return static_cast<size_t>(ticks);
+        }
+        ticks = (std::min)(ticks, MAX_TICKS);
+        int magnitude = 63;
+        while (!(ticks >> magnitude)) magnitude--;
+        int shift = magnitude - (SUB_BUCKET_BITS - 1);
+        uint64_t subBucket = ticks >> shift;
+        return static_cast<size_t>((shift + 1) * HALF_SUB_BUCKETS + (subBucket - HALF_SUB_BUCKETS));
+    }
+
+    uint64_t Histogram::highestEquivalent(size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        int shift = static_cast<int>(index / HALF_SUB_BUCKETS) - 1;
+        uint64_t subBucket = index % HALF_SUB_BUCKETS + HALF_SUB_BUCKETS;
+        return ((subBucket + 1) << shift) - 1;
+    }
+
+    Percentiles Histogram::percentiles() const {
+        // Snapshot first; the owner keeps recording meanwhile
+        std::unique_ptr<uint64_t[]> snapshot(new uint64_t[BUCKET_COUNT]);
+        uint64_t count = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            snapshot[i] = counts[i].load(std::memory_order_relaxed);
+            count += snapshot[i];
+        }
+
+        Percentiles result;
+        result.count = count;
+        if (count == 0) {
+            return result;
+        }
+        double scale = nsPerTick();
+        uint64_t maxValue = maxTicks.load(std::memory_order_relaxed);
+        const double ranks[] = { 50.0, 99.0, 99.9 };
+        double* outputs[] = { &result.p50Ns, &result.p99Ns, &result.p999Ns };
+        size_t next = 0;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT && next < 3; i++) {
+            seen += snapshot[i];
+            while (next < 3 && seen >= (std::max)(static_cast<uint64_t>(std::ceil(ranks[next] / 100.0 * count)), uint64_t(1))) {
+                *outputs[next] = static_cast<double>((std::min)(highestEquivalent(i), (std::max)(maxValue, uint64_t(1)))) * scale;
+                next++;
+            }
+        }
+        result.maxNs = static_cast<double>(maxValue) * scale;
+        return result;
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// Per-hash latency of the RandomX hash call, timed with the TSC and kept per
+// mining thread. Average hashrate hides the tail: SMT siblings fighting over a
+// core, page faults and dataset reads from a remote NUMA node show up as a long
+// p99/p99.9. Built only with MONEROMINER_HASH_TIMING defined; otherwise
+// HASH_TIMING_SCOPE expands to nothing and the hash path is unchanged.
+#if defined(MONEROMINER_HASH_TIMING) && (defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__))
+#define HASH_TIMING_TSC 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#elif defined(MONEROMINER_HASH_TIMING)
+#include <chrono>
+#endif
+
+namespace HashTiming {
+#ifdef MONEROMINER_HASH_TIMING
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+
+    struct Percentiles {
+        uint64_t count = 0;
+        double p50Ns = 0.0;
+        double p99Ns = 0.0;
+        double p999Ns = 0.0;
+        double maxNs = 0.0;
+    };
+
+    // Nanoseconds per TSC tick, measured against the steady clock on first use
+    double nsPerTick();
+
+    // Log-linear buckets of TSC ticks, 128 per power of two, so values are kept to
+    // within 1%. One thread records with relaxed stores and no locked instructions;
+    // any thread may read percentiles while it does.
+    class Histogram {
+    public:
+        Histogram();
+
+        void record(uint64_t ticks) {
+            std::atomic<uint64_t>& bucket = counts[indexOf(ticks)];
+            bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            total.store(total.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            if (ticks > maxTicks.load(std::memory_order_relaxed)) {
+                maxTicks.store(ticks, std::memory_order_relaxed);
+            }
+        }
+
+        Percentiles percentiles() const;
+
+    private:
+        static size_t indexOf(uint64_t ticks);
+        static uint64_t highestEquivalent(size_t index);
+
+        std::unique_ptr<std::atomic<uint64_t>[]> counts;
+        std::atomic<uint64_t> total{0};
+        std::atomic<uint64_t> maxTicks{0};
+    };
+
+#ifdef MONEROMINER_HASH_TIMING
+    // Histogram the calling thread's hashes go to; null leaves them untimed
+    extern thread_local Histogram* current;
+
+    inline void bind(Histogram* histogram) { current = histogram; }
+
+    // lfence keeps earlier work out of the start stamp; rdtscp waits for the hash
+    // to retire before the end stamp
+    inline uint64_t startStamp() {
+#ifdef HASH_TIMING_TSC
+        _mm_lfence();
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    inline uint64_t endStamp() {
+#ifdef HASH_TIMING_TSC
+        unsigned int aux;
+        uint64_t stamp = __rdtscp(&aux);
+        _mm_lfence();
+        return stamp;
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    class Scope {
+    public:
+        Scope() : start(startStamp()) {}
+        ~Scope() {
+            uint64_t end = endStamp();
+            if (current && end > start) {
+                current->record(end - start);
+            }
+        }
+
+    private:
+        uint64_t start;
+    };
+#endif
+}
+
+#ifdef MONEROMINER_HASH_TIMING
+#define HASH_TIMING_SCOPE() HashTiming::Scope hashTimingScope
+#else
+#define HASH_TIMING_SCOPE()
+#endif
@@ -0,0 +1,55 @@
+#include "HashrateWindow.h"
+#include "Constants.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+    // One slot per second of the longest window, plus the second being filled
+    constexpr size_t SLOT_COUNT = MiningConstants::HASHRATE_LONG_WINDOW_SEC + 1;
+
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+}
+
+uint64_t HashrateWindow::nowSecond() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now() - epoch).count());
+}
+
+HashrateWindow::HashrateWindow()
+    : slots(new Slot[SLOT_COUNT]), startSecond(nowSecond()), currentSecond(UINT64_MAX), current(nullptr) {}
+
+void HashrateWindow::add(uint64_t hashes) {
+    uint64_t second = nowSecond();
+    if (second != currentSecond) {
+        // Reclaim the slot: readers see it invalid until the count is reset
+        current = &slots[second % SLOT_COUNT];
+        current->second.store(UINT64_MAX, std::memory_order_relaxed);
+        current->count.store(0, std::memory_order_relaxed);
+        current->second.store(second, std::memory_order_release);
+        currentSecond = second;
+    }
+    // Single writer, so no read-modify-write is needed
+    current->count.store(current->count.load(std::memory_order_relaxed) + hashes, std::memory_order_relaxed);
+}
+
+double HashrateWindow::rate(int seconds) const {
+    uint64_t now = nowSecond();
+    uint64_t span = (std::min)(static_cast<uint64_t>((std::max)(seconds, 1)), static_cast<uint64_t>(SLOT_COUNT - 1));
+    span = (std::min)(span, now - startSecond);
+    if (span == 0) {
+        return 0.0;
+    }
+
+    uint64_t total = 0;
+    for (uint64_t second = now - span; second < now; second++) {
+        const Slot& slot = slots[second % SLOT_COUNT];
+        if (slot.second.load(std::memory_order_acquire) != second) {
+            continue;   // No hashes that second, or being reclaimed
+        }
+        uint64_t count = slot.count.load(std::memory_order_acquire);
+        if (slot.second.load(std::memory_order_acquire) == second) {
+            total += count;
+        }
+    }
+    return static_cast<double>(total) / span;
+}
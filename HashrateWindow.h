@@ -0,0 +1,33 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// Per-thread ring of per-second hash counts covering the longest averaging
+// window. The mining thread is the only writer and never locks: a hash bumps the
+// current second's slot, and the first hash of a new second reclaims the oldest
+// slot. Any thread may read rates; a slot being reclaimed mid-read is skipped.
+class HashrateWindow {
+public:
+    HashrateWindow();
+
+    void add(uint64_t hashes = 1);          // Mining thread only
+
+    // Average H/s over the last 'seconds' complete seconds, or over the thread's
+    // lifetime if that is shorter
+    double rate(int seconds) const;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> second{UINT64_MAX};   // Which second the count belongs to
+        std::atomic<uint64_t> count{0};
+    };
+
+    static uint64_t nowSecond();
+
+    std::unique_ptr<Slot[]> slots;
+    uint64_t startSecond;
+    uint64_t currentSecond;                 // Writer only
+    Slot* current;                          // Writer only
+};
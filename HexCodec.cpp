@@ -0,0 +1,341 @@
+#include "HexCodec.h"
+#include <atomic>
+#include <stdexcept>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define HEXCODEC_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// MSVC allows intrinsics for any instruction set; GCC/Clang need a per-function target
+#if defined(HEXCODEC_X86) && !defined(_MSC_VER)
+#define HEXCODEC_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define HEXCODEC_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define HEXCODEC_TARGET_SSSE3
+#define HEXCODEC_TARGET_AVX2
+#endif
+
+namespace HexCodec {
+    namespace {
+        const char HEX_DIGITS[] = "0123456789abcdef";
+
+        // 256-entry lookup tables built once at startup
+        struct Tables {
+            char encode[256][2];
+            uint8_t decode[256];  // 0xFF marks an invalid character
+
+            Tables() {
+                for (int i = 0; i < 256; i++) {
+                    encode[i][0] = HEX_DIGITS[i >> 4];
+                    encode[i][1] = HEX_DIGITS[i & 0x0F];
+                    decode[i] = 0xFF;
+                }
+                for (int i = 0; i < 10; i++) {
+                    decode['0' + i] = static_cast<uint8_t>(i);
+                }
+                for (int i = 0; i < 6; i++) {
+                    decode['a' + i] = static_cast<uint8_t>(10 + i);
+                    decode['A' + i] = static_cast<uint8_t>(10 + i);
+                }
+            }
+        };
+
+        const Tables& tables() {
+            static const Tables t;
+            return t;
+        }
+
+        void encodeScalar(const uint8_t* data, size_t len, char* out) {
+            const Tables& t = tables();
+            for (size_t i = 0; i < len; i++) {
+                std::memcpy(out + 2 * i, t.encode[data[i]], 2);
+            }
+        }
+
+        bool decodeScalar(const char* hex, size_t byteLen, uint8_t* out) {
+            const Tables& t = tables();
+            for (size_t i = 0; i < byteLen; i++) {
+                uint8_t hi = t.decode[static_cast<uint8_t>(hex[2 * i])];
+                uint8_t lo = t.decode[static_cast<uint8_t>(hex[2 * i + 1])];
+                if ((hi | lo) & 0xF0) {
+                    return false;
+                }
+                out[i] = static_cast<uint8_t>((hi << 4) | lo);
+            }
+            return true;
+        }
+
+#ifdef HEXCODEC_X86
+        // Encodes 16 bytes into 32 chars
+        HEXCODEC_TARGET_SSSE3
+        inline void encodeBlock16(const uint8_t* data, char* out) {
+            const __m128i lut = _mm_loadu_si128(reinterpret_cast<const __m128i*>(HEX_DIGITS));
+            const __m128i mask = _mm_set1_epi8(0x0F);
+            __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+            __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(in, 4), mask));
+            __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(in, mask));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(hi, lo));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpackhi_epi8(hi, lo));
+        }
+
+        // Converts 16 hex chars to nibble values, clearing 'valid' if any char is not hex
+        HEXCODEC_TARGET_SSSE3
+        inline __m128i nibbles16(__m128i c, __m128i& valid) {
+            __m128i digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+            __m128i digitMask = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+            __m128i alpha = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+            __m128i alphaMask = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+            valid = _mm_and_si128(valid, _mm_or_si128(digitMask, alphaMask));
+            return _mm_or_si128(_mm_and_si128(digitMask, digit),
+                                _mm_and_si128(alphaMask, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+        }
+
+        // Decodes 32 chars into 16 bytes
+        HEXCODEC_TARGET_SSSE3
+        inline bool decodeBlock16(const char* hex, uint8_t* out) {
+            // Multiplying (hi, lo) nibble pairs by (16, 1) and summing yields one byte per pair
+            const __m128i weights = _mm_set1_epi16(0x0110);
+            __m128i valid = _mm_set1_epi8(-1);
+            __m128i a = nibbles16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex)), valid);
+            __m128i b = nibbles16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex + 16)), valid);
+            if (_mm_movemask_epi8(valid) != 0xFFFF) {
+                return false;
+            }
+            __m128i packed = _mm_packus_epi16(_mm_maddubs_epi16(a, weights), _mm_maddubs_epi16(b, weights));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), packed);
+            return true;
+        }
+
+        HEXCODEC_TARGET_SSSE3
+        void encodeSSSE3(const uint8_t* data, size_t len, char* out) {
+            size_t i = 0;
+            for (; i + 16 <= len; i += 16) {
+                encodeBlock16(data + i, out + 2 * i);
+            }
+            encodeScalar(data + i, len - i, out + 2 * i);
+        }
+
+        HEXCODEC_TARGET_SSSE3
+        bool decodeSSSE3(const char* hex, size_t byteLen, uint8_t* out) {
+            size_t i = 0;
+            for (; i + 16 <= byteLen; i += 16) {
+                if (!decodeBlock16(hex + 2 * i, out + i)) {
+                    return false;
+                }
+            }
+            return decodeScalar(hex + 2 * i, byteLen - i, out + i);
+        }
+
+        HEXCODEC_TARGET_AVX2
+        inline __m256i nibbles32(__m256i c, __m256i& valid) {
+            __m256i digit = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+            __m256i digitMask = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+            __m256i alpha = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+            __m256i alphaMask = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+            valid = _mm256_and_si256(valid, _mm256_or_si256(digitMask, alphaMask));
+            return _mm256_or_si256(_mm256_and_si256(digitMask, digit),
+                                   _mm256_and_si256(alphaMask, _mm256_add_epi8(alpha, _mm256_set1_epi8(10))));
+        }
+
+        HEXCODEC_TARGET_AVX2
+        void encodeAVX2(const uint8_t* data, size_t len, char* out) {
+            const __m256i lut = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(HEX_DIGITS)));
+            const __m256i mask = _mm256_set1_epi8(0x0F);
+            size_t i = 0;
+            for (; i + 32 <= len; i += 32) {
+                __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(in, 4), mask));
+                __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(in, mask));
+                // unpack works per 128-bit lane, so reorder lanes before storing
+                __m256i first = _mm256_unpacklo_epi8(hi, lo);
+                __m256i second = _mm256_unpackhi_epi8(hi, lo);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i),
+                                    _mm256_permute2x128_si256(first, second, 0x20));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i + 32),
+                                    _mm256_permute2x128_si256(first, second, 0x31));
+            }
+            encodeSSSE3(data + i, len - i, out + 2 * i);
+        }
+
+        HEXCODEC_TARGET_AVX2
+        bool decodeAVX2(const char* hex, size_t byteLen, uint8_t* out) {
+            const __m256i weights = _mm256_set1_epi16(0x0110);
+            size_t i = 0;
+            for (; i + 32 <= byteLen; i += 32) {
+                __m256i valid = _mm256_set1_epi8(-1);
+                __m256i a = nibbles32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(hex + 2 * i)), valid);
+                __m256i b = nibbles32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(hex + 2 * i + 32)), valid);
+                if (_mm256_movemask_epi8(valid) != -1) {
+                    return false;
+                }
+                __m256i packed = _mm256_packus_epi16(_mm256_maddubs_epi16(a, weights),
+                                                     _mm256_maddubs_epi16(b, weights));
+                // packus interleaves lanes as (a0, b0, a1, b1); restore (a0, a1, b0, b1)
+                packed = _mm256_permute4x64_epi64(packed, 0xD8);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+            }
+            return decodeSSSE3(hex + 2 * i, byteLen - i, out + i);
+        }
+
+        bool cpuSupports(Impl impl) {
+            if (impl == Impl::Scalar) {
+                return true;
+            }
+            int regs[4] = {0, 0, 0, 0};
+#if defined(_MSC_VER)
+            __cpuid(regs, 0);
+            int maxLeaf = regs[0];
+            __cpuid(regs, 1);
+#else
+            unsigned int eax, ebx, ecx, edx;
+            int maxLeaf = static_cast<int>(__get_cpuid_max(0, nullptr));
+            __cpuid(1, eax, ebx, ecx, edx);
+            regs[2] = static_cast<int>(ecx);
+#endif
+            const bool ssse3 = (regs[2] & (1 << 9)) != 0;
+            if (impl == Impl::SSSE3) {
+                return ssse3;
+            }
+
+            // AVX2 also needs the OS to save YMM state (OSXSAVE + XCR0 bits 1 and 2)
+            const bool osxsave = (regs[2] & (1 << 27)) != 0;
+            if (!ssse3 || !osxsave || maxLeaf < 7) {
+                return false;
+            }
+#if defined(_MSC_VER)
+            if ((_xgetbv(0) & 0x6) != 0x6) {
+                return false;
+            }
+            __cpuidex(regs, 7, 0);
+            return (regs[1] & (1 << 5)) != 0;
+#else
+            unsigned int xcr0Lo, xcr0Hi;
+            __asm__("xgetbv" : "=a"(xcr0Lo), "=d"(xcr0Hi) : "c"(0));
+            if ((xcr0Lo & 0x6) != 0x6) {
+                return false;
+            }
+            __cpuid_count(7, 0, eax, ebx, ecx, edx);
+            return (ebx & (1 << 5)) != 0;
+#endif
+        }
+#else
+        bool cpuSupports(Impl impl) {
+            return impl == Impl::Scalar;
+        }
+#endif
+
+        Impl detectBestImpl() {
+            if (cpuSupports(Impl::AVX2)) return Impl::AVX2;
+            if (cpuSupports(Impl::SSSE3)) return Impl::SSSE3;
+            return Impl::Scalar;
+        }
+
+        std::atomic<Impl>& currentImpl() {
+            static std::atomic<Impl> impl(detectBestImpl());
+            return impl;
+        }
+    }
+
+    Impl activeImpl() {
+        return currentImpl().load(std::memory_order_relaxed);
+    }
+
+    const char* implName(Impl impl) {
+        switch (impl) {
+            case Impl::AVX2: return "avx2";
+            case Impl::SSSE3: return "ssse3";
+            default: return "scalar";
+        }
+    }
+
+    bool isSupported(Impl impl) {
+        return cpuSupports(impl);
+    }
+
+    void setImpl(Impl impl) {
+        currentImpl().store(cpuSupports(impl) ? impl : Impl::Scalar, std::memory_order_relaxed);
+    }
+
+    void encode(const uint8_t* data, size_t len, char* out) {
+        switch (activeImpl()) {
+#ifdef HEXCODEC_X86
+            case Impl::AVX2: encodeAVX2(data, len, out); return;
+            case Impl::SSSE3: encodeSSSE3(data, len, out); return;
+#endif
+            default: encodeScalar(data, len, out); return;
+        }
+    }
+
+    bool decode(const char* hex, size_t hexLen, uint8_t* out) {
+        if (hexLen % 2 != 0) {
+            return false;
+        }
+        switch (activeImpl()) {
+#ifdef HEXCODEC_X86
+            case Impl::AVX2: return decodeAVX2(hex, hexLen / 2, out);
+            case Impl::SSSE3: return decodeSSSE3(hex, hexLen / 2, out);
+#endif
+            default: return decodeScalar(hex, hexLen / 2, out);
+        }
+    }
+
+    std::string encode(const uint8_t* data, size_t len) {
+        std::string hex(2 * len, '\0');
+        encode(data, len, &hex[0]);
+        return hex;
+    }
+
+    std::string encode(const std::vector<uint8_t>& bytes) {
+        return encode(bytes.data(), bytes.size());
+    }
+
+    std::string encode(const Hash& hash) {
+        return encode(hash.data(), hash.size());
+    }
+
+    std::string encode(const Blob& blob) {
+        return encode(blob.data, blob.size);
+    }
+
+    bool decode(const std::string& hex, std::vector<uint8_t>& out) {
+        if (hex.length() % 2 != 0) {
+            return false;
+        }
+        out.resize(hex.length() / 2);
+        return decode(hex.data(), hex.length(), out.data());
+    }
+
+    bool decode(const std::string& hex, Hash& out) {
+        if (hex.length() != 2 * out.size()) {
+            return false;
+        }
+        return decode(hex.data(), hex.length(), out.data());
+    }
+
+    bool decode(const std::string& hex, Blob& out) {
+        if (hex.length() > 2 * sizeof(out.data)) {
+            return false;
+        }
+        if (!decode(hex.data(), hex.length(), out.data)) {
+            return false;
+        }
+        out.size = hex.length() / 2;
+        return true;
+    }
+
+    std::vector<uint8_t> decode(const std::string& hex) {
+        std::vector<uint8_t> bytes;
+        if (!decode(hex, bytes)) {
+            throw std::invalid_argument("Invalid hex string of length " + std::to_string(hex.length()));
+        }
+        return bytes;
+    }
+}
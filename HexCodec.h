@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Constants.h"
+
+// Hex encoding/decoding for job blobs, hashes and seed hashes.
+// The best implementation for the host CPU (scalar table, SSSE3 or AVX2)
+// is selected once at startup. Decoding is strict: odd lengths and
+// non-hex characters are rejected instead of being silently truncated.
+namespace HexCodec {
+    enum class Impl {
+        Scalar,
+        SSSE3,
+        AVX2
+    };
+
+    // 32-byte hash / seed hash
+    using Hash = std::array<uint8_t, MiningConstants::HASH_SIZE>;
+
+    // Fixed-capacity blob, large enough for any stratum hashing blob
+    struct Blob {
+        uint8_t data[MiningConstants::MAX_BLOB_SIZE];
+        size_t size = 0;
+    };
+
+    // Implementation selection
+    Impl activeImpl();
+    const char* implName(Impl impl);
+    bool isSupported(Impl impl);
+    void setImpl(Impl impl);  // Falls back to Scalar if impl is not supported
+
+    // Raw buffer API. encode writes exactly 2 * len chars (no terminator).
+    // decode expects hexLen to be even and writes hexLen / 2 bytes.
+    void encode(const uint8_t* data, size_t len, char* out);
+    bool decode(const char* hex, size_t hexLen, uint8_t* out);
+
+    // Convenience API
+    std::string encode(const uint8_t* data, size_t len);
+    std::string encode(const std::vector<uint8_t>& bytes);
+    std::string encode(const Hash& hash);
+    std::string encode(const Blob& blob);
+    bool decode(const std::string& hex, std::vector<uint8_t>& out);
+    bool decode(const std::string& hex, Hash& out);  // Requires exactly 64 chars
+    bool decode(const std::string& hex, Blob& out);  // Requires at most 256 chars
+
+    // Throws std::invalid_argument on malformed input
+    std::vector<uint8_t> decode(const std::string& hex);
+}
@@ -0,0 +1,529 @@
+#include "HttpApi.h"
+#include "Metrics.h"
+#include "PoolClient.h"
+#include "SplitMining.h"
+#include "PerfCounters.h"
+#include "EnergyMeter.h"
+#include "RandomXManager.h"
+#include "MiningStats.h"
+#include "Globals.h"
+#include "Config.h"
+#include "Constants.h"
+#include "Utils.h"
+#include "picojson.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "Sockets.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <cerrno>
+#endif
+
+namespace HttpApi {
+#ifdef _WIN32
+    static constexpr int SEND_FLAGS = 0;
+#else
+    static constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#endif
+    static constexpr int SUMMARY_REFRESH_MS = 1000;
+
+    struct Connection {
+        SOCKET sock = INVALID_SOCKET;
+        std::string input;
+        std::string output;
+        size_t sent = 0;
+        bool responding = false;   // Response queued; the connection closes once it is sent
+        std::chrono::steady_clock::time_point openedAt;
+    };
+
+    static std::atomic<bool> running(false);
+    static std::thread apiThread;
+    static SOCKET listener = INVALID_SOCKET;
+
+    // Summary cache, API thread only
+    static std::string summaryCache;
+    static std::chrono::steady_clock::time_point summaryBuiltAt;
+
+    static bool setNonBlocking(SOCKET socket) {
+#ifdef _WIN32
+        u_long mode = 1;
+        return ioctlsocket(socket, FIONBIO, &mode) == 0;
+#else
+        int flags = fcntl(socket, F_GETFL, 0);
+        return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+    }
+
+    static bool wouldBlock() {
+#ifdef _WIN32
+        return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+    }
+
+    static std::string httpResponse(int status, const std::string& reason, const std::string& body,
+                                    const std::string& contentType = "application/json") {
+        return "HTTP/1.1 " + std::to_string(status) + " " + reason + "\r\n"
+               "Content-Type: " + contentType + "\r\n"
+               "Content-Length: " + std::to_string(body.size()) + "\r\n"
+               "Cache-Control: no-store\r\n"
+               "Connection: close\r\n\r\n" + body;
+    }
+
+    static std::string errorResponse(int status, const std::string& reason, const std::string& message) {
+        picojson::object body;
+        body["error"] = picojson::value(message);
+        return httpResponse(status, reason, picojson::value(body).serialize() + "\n");
+    }
+
+    static picojson::value number(double value) {
+        return picojson::value(value);
+    }
+
+    static picojson::value rates(double shortRate, double mediumRate, double longRate) {
+        picojson::object rate;
+        rate["10s"] = number(shortRate);
+        rate["60s"] = number(mediumRate);
+        rate["15m"] = number(longRate);
+        return picojson::value(rate);
+    }
+
+    static picojson::object controlState() {
+        picojson::object control;
+        control["paused"] = picojson::value(miningPaused.load());
+        control["active_threads"] = number(activeThreads.load());
+        control["threads"] = number(static_cast<double>(threadData.size()));
+        return control;
+    }
+
+    static std::string buildSummary() {
+        picojson::object summary;
+        summary["version"] = picojson::value(config.userAgent);
+        summary["uptime"] = number(std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - MiningStats::globalStats.startTime).count());
+        summary["control"] = picojson::value(controlState());
+
+        MiningStats::HashrateStats hashrate = MiningStats::getHashrateStats();
+        picojson::object total = rates(hashrate.shortRate, hashrate.mediumRate, hashrate.longRate).get<picojson::object>();
+        total["highest"] = number(hashrate.highest);
+        summary["hashrate"] = picojson::value(total);
+
+        // Per thread; plain counters written by the mining threads, read without locks
+        uint64_t hashes = 0, accepted = 0, rejected = 0;
+        picojson::array threads;
+        for (const auto* data : threadData) {
+            if (!data) continue;
+            MiningStats::StaleWorkStats stale = MiningStats::getStaleWork(data->getThreadId());
+            picojson::object thread;
+            thread["id"] = number(data->getThreadId());
+            thread["hashrate"] = rates(data->getHashrate(MiningConstants::HASHRATE_SHORT_WINDOW_SEC),
+                data->getHashrate(MiningConstants::HASHRATE_AVERAGING_WINDOW_SIZE),
+                data->getHashrate(MiningConstants::HASHRATE_LONG_WINDOW_SEC));
+            thread["hashes"] = number(static_cast<double>(data->getTotalHashCount()));
+            thread["accepted"] = number(static_cast<double>(data->getAcceptedShares()));
+            thread["rejected"] = number(static_cast<double>(data->getRejectedShares()));
+            thread["stale_percent"] = number(stale.stalePercent());
+            thread["endpoint"] = number(SplitMining::endpointFor(data->getThreadId()));
+            if (HashTiming::enabled) {
+                HashTiming::Percentiles latency = data->getHashLatency();
+                picojson::object hashLatency;
+                hashLatency["p50"] = number(latency.p50Ns);
+                hashLatency["p99"] = number(latency.p99Ns);
+                hashLatency["p999"] = number(latency.p999Ns);
+                hashLatency["max"] = number(latency.maxNs);
+                thread["hash_latency_ns"] = picojson::value(hashLatency);
+            }
+            PerfCounters::ThreadRates perf = PerfCounters::getRates(data->getThreadId());
+            if (perf.available) {
+                picojson::object counters;
+                if (perf.hasCycles) counters["ghz"] = number(perf.ghz);
+                if (perf.hasCycles && perf.hasInstructions) counters["ipc"] = number(perf.ipc);
+                if (perf.hasLlcMisses) counters["llc_misses_per_hash"] = number(perf.llcMissesPerHash);
+                if (perf.hasDtlbMisses) counters["dtlb_misses_per_hash"] = number(perf.dtlbMissesPerHash);
+                if (perf.hasPageFaults) counters["page_faults_per_sec"] = number(perf.pageFaultsPerSec);
+                thread["perf"] = picojson::value(counters);
+            }
+            threads.push_back(picojson::value(thread));
+            hashes += data->getTotalHashCount();
+            accepted += data->getAcceptedShares();
+            rejected += data->getRejectedShares();
+        }
+        summary["threads"] = picojson::value(threads);
+        summary["hashes"] = number(static_cast<double>(hashes));
+
+        MiningStats::StaleWorkStats stale = MiningStats::getStaleWork();
+        picojson::object shares;
+        shares["accepted"] = number(static_cast<double>(accepted));
+        shares["rejected"] = number(static_cast<double>(rejected));
+        shares["stale_rejected"] = number(static_cast<double>(stale.staleRejects));
+        shares["stale_found"] = number(static_cast<double>(stale.staleShares));
+        shares["pending"] = number(static_cast<double>(PoolClient::getPendingShareCount()));
+        shares["lost"] = number(static_cast<double>(PoolClient::getLostShareCount()));
+        summary["shares"] = picojson::value(shares);
+        picojson::object staleWork;
+        staleWork["hashes"] = number(static_cast<double>(stale.hashes));
+        staleWork["stale_hashes"] = number(static_cast<double>(stale.staleHashes));
+        staleWork["percent"] = number(stale.stalePercent());
+        summary["stale_work"] = picojson::value(staleWork);
+
+        // Over the stats monitor's last period, when RAPL can be read
+        EnergyMeter::Power power = EnergyMeter::getPower();
+        if (power.available) {
+            picojson::object energy;
+            energy["watts"] = number(power.watts());
+            energy["package_watts"] = number(power.packageWatts);
+            if (power.hasDram) energy["dram_watts"] = number(power.dramWatts);
+            energy["hashes_per_joule"] = number(power.hashesPerJoule);
+            summary["power"] = picojson::value(energy);
+        }
+
+        // Pools, from the network side
+        std::vector<PoolClient::PoolHealth> health = PoolClient::getPoolHealth();
+        std::vector<PoolClient::PoolLatency> latency = PoolClient::getPoolLatency();
+        int active = PoolClient::activePool.load();
+        picojson::array pools;
+        for (size_t i = 0; i < PoolClient::poolList.size() && i < health.size(); i++) {
+            const PoolClient::PoolHealth& pool = health[i];
+            picojson::object entry;
+            entry["address"] = picojson::value(PoolClient::poolList[i].address);
+            entry["port"] = number(PoolClient::poolList[i].port);
+            entry["priority"] = number(PoolClient::poolList[i].priority);
+            entry["active"] = picojson::value(static_cast<int>(i) == active);
+            entry["accepted"] = number(static_cast<double>(pool.acceptedShares));
+            entry["rejected"] = number(static_cast<double>(pool.rejectedShares));
+            entry["dead_connections"] = number(static_cast<double>(pool.deadConnections));
+            entry["last_job_age"] = number(pool.lastJobAgeSec());
+            entry["connect_ms"] = number(pool.connectTimeMs);
+            if (i < latency.size()) {
+                entry["submit_rtt_p50_ms"] = number(latency[i].submitRtt.percentileMs(50));
+                entry["submit_rtt_p99_ms"] = number(latency[i].submitRtt.percentileMs(99));
+                entry["job_interval_p50_ms"] = number(latency[i].jobInterval.percentileMs(50));
+                entry["job_switch_p50_ms"] = number(latency[i].jobSwitch.percentileMs(50));
+            }
+            pools.push_back(picojson::value(entry));
+        }
+        picojson::object pool;
+        pool["connected"] = picojson::value(PoolClient::isJobUsable());
+        pool["pools"] = picojson::value(pools);
+        if (!config.daemonAddress.empty()) {
+            pool["daemon"] = picojson::value(config.daemonAddress);
+        }
+        summary["pool"] = picojson::value(pool);
+
+        picojson::array splits;
+        for (const auto& endpoint : SplitMining::getStats()) {
+            picojson::object entry;
+            entry["name"] = picojson::value(endpoint.name);
+            entry["weight"] = number(endpoint.weight);
+            entry["threads"] = number(endpoint.threads);
+            entry["connected"] = picojson::value(endpoint.connected);
+            entry["ready"] = picojson::value(endpoint.ready);
+            entry["hashrate"] = number(endpoint.hashrate);
+            entry["hash_share"] = number(endpoint.hashShare);
+            entry["accepted"] = number(static_cast<double>(endpoint.acceptedShares));
+            entry["rejected"] = number(static_cast<double>(endpoint.rejectedShares));
+            splits.push_back(picojson::value(entry));
+        }
+        if (!splits.empty()) {
+            summary["splits"] = picojson::value(splits);
+        }
+
+        picojson::object dataset;
+        dataset["initialized"] = picojson::value(RandomXManager::isInitialized());
+        dataset["seed_hash"] = picojson::value(RandomXManager::getCurrentSeedHash());
+        summary["dataset"] = picojson::value(dataset);
+
+        picojson::object memory;
+        memory["resident_bytes"] = number(static_cast<double>(getResidentMemoryBytes()));
+        summary["memory"] = picojson::value(memory);
+
+        return picojson::value(summary).serialize(true);
+    }
+
+    static std::string controlResponse() {
+        summaryBuiltAt = std::chrono::steady_clock::time_point();   // The next summary shows the change
+        return httpResponse(200, "OK", picojson::value(controlState()).serialize() + "\n");
+    }
+
+    static std::string handleRequest(const std::string& method, const std::string& path,
+                                     const std::string& authorization, const std::string& body) {
+        if (!config.apiToken.empty() && authorization != "Bearer " + config.apiToken) {
+            return errorResponse(401, "Unauthorized", "missing or wrong access token");
+        }
+
+        if (path == "/api/summary" || path == "/") {
+            if (method != "GET") {
+                return errorResponse(405, "Method Not Allowed", "use GET");
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (summaryCache.empty() || now - summaryBuiltAt >= std::chrono::milliseconds(SUMMARY_REFRESH_MS)) {
+                summaryCache = buildSummary();
+                summaryBuiltAt = now;
+            }
+            return httpResponse(200, "OK", summaryCache);
+        }
+
+        // Prometheus scrapes; rendered fresh each time, it reads no more than the summary
+        if (path == "/metrics") {
+            if (method != "GET") {
+                return errorResponse(405, "Method Not Allowed", "use GET");
+            }
+            return httpResponse(200, "OK", Metrics::render(), "text/plain; version=0.0.4");
+        }
+
+        if (path != "/api/pause" && path != "/api/resume" && path != "/api/threads") {
+            return errorResponse(404, "Not Found", "unknown endpoint " + path);
+        }
+        if (method != "POST") {
+            return errorResponse(405, "Method Not Allowed", "use POST");
+        }
+        if (path == "/api/pause") {
+            if (!miningPaused.exchange(true)) {
+                threadSafePrint("API: mining paused", true);
+            }
+            return controlResponse();
+        }
+        if (path == "/api/resume") {
+            if (miningPaused.exchange(false)) {
+                threadSafePrint("API: mining resumed", true);
+            }
+            return controlResponse();
+        }
+
+        // {"threads": N}; threads are started at launch, so N can only go up to --threads
+        picojson::value v;
+        if (!picojson::parse(v, body).empty() || !v.is<picojson::object>() ||
+            !v.get<picojson::object>().count("threads") || !v.get<picojson::object>().at("threads").is<double>()) {
+            return errorResponse(400, "Bad Request", "expected {\"threads\": N}");
+        }
+        double requested = v.get<picojson::object>().at("threads").get<double>();
+        if (requested < 1 || requested > static_cast<double>(threadData.size())) {
+            return errorResponse(400, "Bad Request", "threads must be between 1 and " + std::to_string(threadData.size()));
+        }
+        int threads = static_cast<int>(requested);
+        if (activeThreads.exchange(threads) != threads) {
+            if (!SplitMining::isActive()) {
+                MiningStats::setJobSwitchThreads(threads);
+            }
+            threadSafePrint("API: mining on " + std::to_string(threads) + " of " +
+                std::to_string(threadData.size()) + " threads", true);
+        }
+        return controlResponse();
+    }
+
+    // Parses a complete request from the connection's input; false while more is needed
+    static bool parseRequest(Connection& connection) {
+        size_t headerEnd = connection.input.find("\r\n\r\n");
+        if (headerEnd == std::string::npos) {
+            if (connection.input.size() > NetworkConstants::API_MAX_REQUEST) {
+                connection.output = errorResponse(431, "Request Header Fields Too Large", "request too large");
+                return true;
+            }
+            return false;
+        }
+
+        std::string method, path, authorization;
+        size_t contentLength = 0;
+        size_t lineStart = 0;
+        bool firstLine = true;
+        while (lineStart < headerEnd) {
+            size_t lineEnd = connection.input.find("\r\n", lineStart);
+            std::string line = connection.input.substr(lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 2;
+            if (firstLine) {
+                // "GET /api/summary HTTP/1.1"
+                size_t space = line.find(' ');
+                size_t secondSpace = space == std::string::npos ? space : line.find(' ', space + 1);
+                if (secondSpace == std::string::npos) {
+                    connection.output = errorResponse(400, "Bad Request", "malformed request line");
+                    return true;
+                }
+                method = line.substr(0, space);
+                path = line.substr(space + 1, secondSpace - space - 1);
+                path = path.substr(0, path.find('?'));
+                firstLine = false;
+                continue;
+            }
+            size_t colon = line.find(':');
+            if (colon == std::string::npos) continue;
+            std::string name = line.substr(0, colon);
+            std::transform(name.begin(), name.end(), name.begin(),
+                           [](unsigned char c) { return static_cast<char>(tolower(c)); });
+            size_t valueStart = line.find_first_not_of(' ', colon + 1);
+            std::string value = valueStart == std::string::npos ? "" : line.substr(valueStart);
+            if (name == "content-length") {
+                try {
+                    contentLength = static_cast<size_t>(std::stoul(value));
+                } catch (const std::exception&) {
+                    contentLength = NetworkConstants::API_MAX_REQUEST + 1;
+                }
+            } else if (name == "authorization") {
+                authorization = value;
+            }
+        }
+
+        if (headerEnd + 4 + contentLength > NetworkConstants::API_MAX_REQUEST) {
+            connection.output = errorResponse(413, "Payload Too Large", "request too large");
+            return true;
+        }
+        if (connection.input.size() < headerEnd + 4 + contentLength) {
+            return false;
+        }
+        connection.output = handleRequest(method, path, authorization,
+                                          connection.input.substr(headerEnd + 4, contentLength));
+        return true;
+    }
+
+    static SOCKET openListener(const std::string& bindAddress, int port) {
+        struct addrinfo hints = {}, *result = nullptr;
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_protocol = IPPROTO_TCP;
+        hints.ai_flags = AI_PASSIVE;
+        int status = getaddrinfo(bindAddress.empty() ? nullptr : bindAddress.c_str(),
+                                 std::to_string(port).c_str(), &hints, &result);
+        if (status != 0) {
+            threadSafePrint("API: cannot resolve " + bindAddress + ": " + gai_strerrorA(status), true);
+            return INVALID_SOCKET;
+        }
+
+        SOCKET sock = INVALID_SOCKET;
+        for (struct addrinfo* ptr = result; ptr != nullptr; ptr = ptr->ai_next) {
+            sock = socket(ptr->ai_family, ptr->ai_socktype, ptr->ai_protocol);
+            if (sock == INVALID_SOCKET) continue;
+            int optval = 1;
+            setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char*>(&optval), sizeof(optval));
+            if (bind(sock, ptr->ai_addr, static_cast<int>(ptr->ai_addrlen)) != SOCKET_ERROR &&
+                listen(sock, SOMAXCONN) != SOCKET_ERROR && setNonBlocking(sock)) {
+                break;
+            }
+            closesocket(sock);
+            sock = INVALID_SOCKET;
+        }
+        freeaddrinfo(result);
+        if (sock == INVALID_SOCKET) {
+            threadSafePrint("API: cannot listen on " + bindAddress + ":" + std::to_string(port), true);
+        }
+        return sock;
+    }
+
+    static void acceptConnections(std::vector<std::unique_ptr<Connection>>& connections) {
+        while (connections.size() < NetworkConstants::API_MAX_CONNECTIONS) {
+            SOCKET sock = accept(listener, nullptr, nullptr);
+            if (sock == INVALID_SOCKET) {
+                return;
+            }
+            if (!setNonBlocking(sock)) {
+                closesocket(sock);
+                continue;
+            }
+            auto connection = std::make_unique<Connection>();
+            connection->sock = sock;
+            connection->openedAt = std::chrono::steady_clock::now();
+            connections.push_back(std::move(connection));
+        }
+    }
+
+    // Returns false once the connection is finished
+    static bool readConnection(Connection& connection) {
+        char data[NetworkConstants::MAX_RECEIVE_BUFFER];
+        int received = recv(connection.sock, data, sizeof(data), 0);
+        if (received == 0 || (received < 0 && !wouldBlock())) {
+            return false;
+        }
+        if (received > 0) {
+            connection.input.append(data, received);
+            connection.responding = parseRequest(connection);
+        }
+        return true;
+    }
+
+    static bool writeConnection(Connection& connection) {
+        while (connection.sent < connection.output.size()) {
+            int sent = send(connection.sock, connection.output.data() + connection.sent,
+                            static_cast<int>(connection.output.size() - connection.sent), SEND_FLAGS);
+            if (sent < 0) {
+                return wouldBlock();
+            }
+            connection.sent += sent;
+        }
+        return false;   // Response complete, close
+    }
+
+    // The event loop: one thread, select() over the listener and every connection
+    static void serve() {
+        std::vector<std::unique_ptr<Connection>> connections;
+        while (running && !shouldStop && !PoolClient::shouldStop) {
+            fd_set readSet, writeSet;
+            FD_ZERO(&readSet);
+            FD_ZERO(&writeSet);
+            SOCKET maxSocket = listener;
+            FD_SET(listener, &readSet);
+            for (const auto& connection : connections) {
+                FD_SET(connection->sock, connection->responding ? &writeSet : &readSet);
+                maxSocket = (std::max)(maxSocket, connection->sock);
+            }
+            struct timeval timeout = { 0, 200000 };
+            int ready = select(static_cast<int>(maxSocket) + 1, &readSet, &writeSet, nullptr, &timeout);
+            if (ready < 0) {
+                threadSafePrint("API: select failed", true);
+                break;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            for (auto it = connections.begin(); it != connections.end();) {
+                Connection& connection = **it;
+                bool keep = true;
+                if (connection.responding && FD_ISSET(connection.sock, &writeSet)) {
+                    keep = writeConnection(connection);
+                } else if (!connection.responding && FD_ISSET(connection.sock, &readSet)) {
+                    keep = readConnection(connection);
+                }
+                if (keep && now - connection.openedAt > std::chrono::seconds(NetworkConstants::API_IDLE_TIMEOUT_SEC)) {
+                    keep = false;
+                }
+                if (!keep) {
+                    closesocket(connection.sock);
+                    it = connections.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            if (FD_ISSET(listener, &readSet)) {
+                acceptConnections(connections);
+            }
+        }
+        for (auto& connection : connections) {
+            closesocket(connection->sock);
+        }
+    }
+
+    bool start(const std::string& bindAddress, int port) {
+        listener = openListener(bindAddress, port);
+        if (listener == INVALID_SOCKET) {
+            return false;
+        }
+        running = true;
+        apiThread = std::thread(serve);
+        threadSafePrint("HTTP API listening on " + bindAddress + ":" + std::to_string(port), true);
+        return true;
+    }
+
+    void stop() {
+        if (!running) {
+            return;
+        }
+        running = false;
+        if (apiThread.joinable()) {
+            apiThread.join();
+        }
+        closesocket(listener);
+        listener = INVALID_SOCKET;
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+
+// Embedded HTTP API for monitoring and control, served by one event-loop thread:
+//   GET  /api/summary   JSON stats: hashrate windows, threads, shares, pools, dataset, memory, uptime
+//   POST /api/pause     Idle every mining thread
+//   POST /api/resume
+//   POST /api/threads   {"threads": N} mines on the first N threads, the others idle
+//   GET  /metrics       Prometheus text format, see Metrics.h
+// Mining-thread figures are read from counters the threads publish without
+// locks. The pool figures need the network locks, so the summary is rebuilt at
+// most once a second however often it is scraped.
+namespace HttpApi {
+    bool start(const std::string& bindAddress, int port);
+    void stop();
+}
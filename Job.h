@@ -6,6 +6,10 @@
 #include <sstream>
 #include <iomanip>
 #include <cmath>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include "HexCodec.h"
 
 // Mining job structure
 class Job {
@@ -17,9 +21,11 @@ public:
     std::string seedHash;
     double difficulty;
     uint32_t nonce;
+    uint64_t sequence;                                  // Arrival order, from MiningStats::jobReceived
+    std::chrono::steady_clock::time_point receivedAt;   // When the pool's job line was read
 
     // Default constructor
-    Job() : height(0), difficulty(0.0), nonce(0) {}
+    Job() : height(0), difficulty(0.0), nonce(0), sequence(0) {}
 
     // Copy constructor
     Job(const Job& other) = default;
@@ -58,52 +64,66 @@ public:
     }
 
     Job(const std::string& id, const std::string& b, const std::string& t, uint32_t h, const std::string& sh)
-        : jobId(id), blob(b), target(t), height(h), seedHash(sh), difficulty(0.0), nonce(0) {
+        : jobId(id), blob(b), target(t), height(h), seedHash(sh), difficulty(0.0), nonce(0), sequence(0) {
         calculateDifficulty();
     }
 
     double calculateDifficulty() {
-        // Convert target from compact to expanded format
-        uint64_t compactTarget = std::stoull(target, nullptr, 16);
-        uint32_t exponent = (compactTarget >> 24) & 0xFF;
-        uint32_t mantissa = compactTarget & 0xFFFFFF;
-        
-        // Calculate expanded target (256-bit)
-        uint64_t expandedTarget[4] = {0, 0, 0, 0};
-        if (exponent <= 3) {
-            expandedTarget[3] = mantissa >> (8 * (3 - exponent));
-        } else {
-            uint32_t shift = 8 * (exponent - 3);
-            if (shift < 64) {
-                expandedTarget[3] = static_cast<uint64_t>(mantissa) << shift;
-            } else if (shift < 128) {
-                expandedTarget[2] = static_cast<uint64_t>(mantissa) << (shift - 64);
-            } else if (shift < 192) {
-                expandedTarget[1] = static_cast<uint64_t>(mantissa) << (shift - 128);
-            } else if (shift < 256) {
-                expandedTarget[0] = static_cast<uint64_t>(mantissa) << (shift - 192);
-            }
+        difficulty = targetDifficulty(target);
+        return difficulty;
+    }
+
+    // Stratum targets are little-endian hex, either 8 chars (32-bit compact form,
+    // difficulty = 0xFFFFFFFF / target) or 16 chars (64-bit). A hash meets the
+    // target if its most significant 64 bits, read little-endian, are below the
+    // 64-bit target. targetValue returns the 64-bit target, or 0 if invalid.
+    static uint64_t targetValue(const std::string& targetHex) {
+        uint8_t raw[8] = {};
+        if ((targetHex.size() != 8 && targetHex.size() != 16) ||
+            !HexCodec::decode(targetHex.c_str(), targetHex.size(), raw)) {
+            return 0;
         }
-        
-        // Calculate difficulty using 2^256 / target
-        double expandedTargetValue = 0.0;
-        double scale = 1.0;
-        for (int i = 3; i >= 0; i--) {
-            expandedTargetValue += static_cast<double>(expandedTarget[i]) * scale;
-            scale *= 18446744073709551616.0; // 2^64
+        uint64_t value = 0;
+        for (size_t i = 0; i < targetHex.size() / 2; i++) {
+            value |= static_cast<uint64_t>(raw[i]) << (8 * i);
         }
-        
-        difficulty = pow(2.0, 256) / expandedTargetValue;
-        return difficulty;
+        if (targetHex.size() == 8) {
+            if (value == 0) return 0;
+            value = 0xFFFFFFFFFFFFFFFFULL / (0xFFFFFFFFULL / value);
+        }
+        return value;
+    }
+
+    static double targetDifficulty(const std::string& targetHex) {
+        uint64_t value = targetValue(targetHex);
+        return value ? static_cast<double>(0xFFFFFFFFFFFFFFFFULL / value) : 0.0;
+    }
+
+    // Shortest target encoding for a difficulty, as pools send it
+    static std::string difficultyToTarget(uint64_t difficulty) {
+        difficulty = (std::max)(difficulty, static_cast<uint64_t>(1));
+        uint8_t raw[8];
+        size_t size = difficulty <= 0xFFFFFFFFULL ? 4 : 8;
+        uint64_t value = size == 4 ? 0xFFFFFFFFULL / difficulty : 0xFFFFFFFFFFFFFFFFULL / difficulty;
+        for (size_t i = 0; i < size; i++) {
+            raw[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+        return HexCodec::encode(raw, size);
+    }
+
+    static bool hashMeetsTarget(const uint8_t* hash, uint64_t target) {
+        uint64_t top = 0;
+        for (int i = 0; i < 8; i++) {
+            top |= static_cast<uint64_t>(hash[24 + i]) << (8 * i);
+        }
+        return top < target;
     }
 
     // Convert hex blob to bytes and handle nonce position correctly
     std::vector<uint8_t> getBlobBytes() const {
         std::vector<uint8_t> bytes;
-        for (size_t i = 0; i < blob.length(); i += 2) {
-            std::string byteString = blob.substr(i, 2);
-            uint8_t byte = static_cast<uint8_t>(std::stoul(byteString, nullptr, 16));
-            bytes.push_back(byte);
+        if (!HexCodec::decode(blob, bytes)) {
+            throw std::invalid_argument("Invalid job blob hex");
         }
         
         // Ensure the blob is at least 43 bytes (RandomX block header size)
@@ -0,0 +1,126 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+    constexpr int SUB_BUCKET_BITS = 7;
+    constexpr uint64_t SUB_BUCKETS = 1ULL << SUB_BUCKET_BITS;
+    constexpr uint64_t HALF_SUB_BUCKETS = SUB_BUCKETS / 2;
+    constexpr int MAX_MAGNITUDE = 40;                 // 2^40 us, about 12 days
+    constexpr uint64_t MAX_US = (1ULL << MAX_MAGNITUDE) - 1;
+    constexpr size_t BUCKET_COUNT = (MAX_MAGNITUDE - SUB_BUCKET_BITS + 2) * HALF_SUB_BUCKETS;
+
+    int magnitude(uint64_t value) {
+        int bits = 0;
+        while (value >>= 1) bits++;
+        return bits;
+    }
+}
+
+LatencyHistogram::LatencyHistogram() : counts(BUCKET_COUNT, 0) {}
+
+// Values below 128 us get their own bucket; above that each power of two is split
+// into 64 buckets, the same relative precision as the top half of the first range
+size_t LatencyHistogram::indexOf(uint64_t us) {
+    if (us < SUB_BUCKETS) {
+        return static_cast<size_t>(us);
+    }
+    int shift = magnitude(us) - (SUB_BUCKET_BITS - 1);
+    uint64_t subBucket = us >> shift;                  // 64 to 127
+    return static_cast<size_t>((shift + 1) * HALF_SUB_BUCKETS + (subBucket - HALF_SUB_BUCKETS));
+}
+
+uint64_t LatencyHistogram::highestEquivalent(size_t index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+    int shift = static_cast<int>(index / HALF_SUB_BUCKETS) - 1;
+    uint64_t subBucket = index % HALF_SUB_BUCKETS + HALF_SUB_BUCKETS;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(double ms) {
+    double us = std::round(ms * 1000.0);
+    uint64_t value = us <= 0.0 ? 0 : (us >= static_cast<double>(MAX_US) ? MAX_US : static_cast<uint64_t>(us));
+    counts[indexOf(value)]++;
+    total++;
+    minUs = (std::min)(minUs, value);
+    maxUs = (std::max)(maxUs, value);
+    sumUs += static_cast<double>(value);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < counts.size(); i++) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    minUs = (std::min)(minUs, other.minUs);
+    maxUs = (std::max)(maxUs, other.maxUs);
+    sumUs += other.sumUs;
+}
+
+void LatencyHistogram::reset() {
+    std::fill(counts.begin(), counts.end(), 0);
+    total = 0;
+    minUs = UINT64_MAX;
+    maxUs = 0;
+    sumUs = 0.0;
+}
+
+double LatencyHistogram::minMs() const {
+    return total == 0 ? 0.0 : minUs / 1000.0;
+}
+
+double LatencyHistogram::maxMs() const {
+    return maxUs / 1000.0;
+}
+
+double LatencyHistogram::meanMs() const {
+    return total == 0 ? 0.0 : sumUs / total / 1000.0;
+}
+
+double LatencyHistogram::percentileMs(double percentile) const {
+    if (total == 0) {
+        return 0.0;
+    }
+    double clamped = (std::min)((std::max)(percentile, 0.0), 100.0);
+    uint64_t rank = (std::max)(static_cast<uint64_t>(std::ceil(clamped / 100.0 * total)), uint64_t(1));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return (std::min)((std::max)(highestEquivalent(i), minUs), maxUs) / 1000.0;
+        }
+    }
+    return maxMs();
+}
+
+// Counts the buckets up to the one holding 'ms', so a value may be counted up to 1% above it
+uint64_t LatencyHistogram::countAtMost(double ms) const {
+    double us = std::round(ms * 1000.0);
+    if (us < 0.0) {
+        return 0;
+    }
+    if (us >= static_cast<double>(MAX_US)) {
+        return total;
+    }
+    size_t last = indexOf(static_cast<uint64_t>(us));
+    uint64_t count = 0;
+    for (size_t i = 0; i <= last; i++) {
+        count += counts[i];
+    }
+    return count;
+}
+
+std::string LatencyHistogram::summary() const {
+    if (total == 0) {
+        return "no samples";
+    }
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1)
+       << "p50 " << percentileMs(50) << " p90 " << percentileMs(90) << " p99 " << percentileMs(99)
+       << " max " << maxMs() << " ms (n=" << total << ")";
+    return ss.str();
+}
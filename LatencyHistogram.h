@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// HDR-style latency histogram: log-linear buckets of microseconds with 128
+// sub-buckets per power of two, so every recorded value is kept to within 1%
+// from a microsecond up to days, in fixed memory and O(1) per record. Not
+// thread safe; owners lock around it.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(double ms);
+    void merge(const LatencyHistogram& other);
+    void reset();
+
+    uint64_t count() const { return total; }
+    double minMs() const;
+    double maxMs() const;
+    double meanMs() const;
+    double percentileMs(double percentile) const;   // 0 to 100
+    double sumMs() const { return sumUs / 1000.0; }
+    uint64_t countAtMost(double ms) const;          // Cumulative, for exporting fixed buckets
+
+    // "p50 12.1 p90 15.0 p99 40.2 max 41.0 ms (n=120)", or "no samples"
+    std::string summary() const;
+
+private:
+    static size_t indexOf(uint64_t us);
+    static uint64_t highestEquivalent(size_t index);
+
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t minUs = UINT64_MAX;
+    uint64_t maxUs = 0;
+    double sumUs = 0.0;
+};
@@ -0,0 +1,199 @@
+#include "Logger.h"
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Logger {
+    static constexpr size_t RING_SIZE = 8192;        // Power of two
+    static constexpr int DRAIN_INTERVAL_MS = 10;
+
+    // A ring slot. 'sequence' says whose turn it is: equal to the claiming
+    // position when free, one past it once filled, a lap ahead once drained.
+    struct Record {
+        std::atomic<size_t> sequence{0};
+        Level level = Level::Info;
+        bool toLogFile = false;
+        time_t time = 0;
+        std::string message;
+    };
+
+    static std::unique_ptr<Record[]> ring;
+    static std::atomic<size_t> tail(0);              // Next position producers claim
+    static size_t head = 0;                          // Next position to drain, drain thread only
+    static std::atomic<uint64_t> dropped(0);
+    static std::atomic<bool> running(false);
+    static std::atomic<bool> stopping(false);
+    static std::thread drainThread;
+
+    // Console and file writes: the drain thread's batches and direct writes
+    static std::mutex outputMutex;
+    static std::ofstream file;
+
+    // Timestamp of the last second seen, guarded by outputMutex
+    static time_t stampTime = -1;
+    static std::string stamp;
+
+    static const char* levelName(Level level) {
+        switch (level) {
+            case Level::Debug: return "DEBUG";
+            case Level::Warning: return "WARN";
+            case Level::Error: return "ERROR";
+            default: return "INFO";
+        }
+    }
+
+    static std::string formatStamp(time_t time) {
+        struct tm local;
+#ifdef _WIN32
+        localtime_s(&local, &time);
+#else
+        localtime_r(&time, &local);
+#endif
+        char buffer[32];
+        strftime(buffer, sizeof(buffer), "[%Y-%m-%d %H:%M:%S] ", &local);
+        return buffer;
+    }
+
+    static void append(std::string& console, std::string& logText, Level level, bool toLogFile,
+                       time_t time, const std::string& message) {
+        if (level != Level::Info) {
+            console += '[';
+            console += levelName(level);
+            console += "] ";
+        }
+        console += message;
+        console += '\n';
+        if (toLogFile && file.is_open()) {
+            if (time != stampTime) {
+                stamp = formatStamp(time);
+                stampTime = time;
+            }
+            logText += stamp;
+            logText += levelName(level);
+            logText += ' ';
+            logText += message;
+            logText += '\n';
+        }
+    }
+
+    static void flush(const std::string& console, const std::string& logText) {
+        if (!console.empty()) {
+            std::cout << console;
+            std::cout.flush();
+        }
+        if (!logText.empty() && file.is_open()) {
+            file << logText;
+            file.flush();
+        }
+    }
+
+    // One console write and one file write per batch, whatever its size
+    static void drain() {
+        std::string console, logText;
+        for (;;) {
+            bool last = stopping.load();
+            {
+                std::lock_guard<std::mutex> lock(outputMutex);
+                console.clear();
+                logText.clear();
+                for (;;) {
+                    Record& record = ring[head & (RING_SIZE - 1)];
+                    if (record.sequence.load(std::memory_order_acquire) != head + 1) {
+                        break;
+                    }
+                    std::string message = std::move(record.message);
+                    append(console, logText, record.level, record.toLogFile, record.time, message);
+                    record.sequence.store(head + RING_SIZE, std::memory_order_release);
+                    head++;
+                }
+                uint64_t lost = dropped.exchange(0);
+                if (lost > 0) {
+                    append(console, logText, Level::Warning, true, time(nullptr),
+                           std::to_string(lost) + " log messages dropped, log ring full");
+                }
+                flush(console, logText);
+            }
+            if (last) {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(DRAIN_INTERVAL_MS));
+        }
+    }
+
+    void start() {
+        if (running) {
+            return;
+        }
+        ring.reset(new Record[RING_SIZE]);
+        for (size_t i = 0; i < RING_SIZE; i++) {
+            ring[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        tail = 0;
+        head = 0;
+        stopping = false;
+        drainThread = std::thread(drain);
+        running = true;
+    }
+
+    void stop() {
+        if (!running.exchange(false)) {
+            return;
+        }
+        stopping = true;
+        if (drainThread.joinable()) {
+            drainThread.join();
+        }
+    }
+
+    bool openFile(const std::string& fileName) {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        if (file.is_open()) {
+            file.close();
+        }
+        file.open(fileName, std::ios::app);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open log file: " << fileName << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void write(Level level, std::string message, bool toLogFile) {
+        time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        if (!running.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            std::string console, logText;
+            append(console, logText, level, toLogFile, now, message);
+            flush(console, logText);
+            return;
+        }
+
+        // Claim a slot; never wait for the drain thread
+        size_t position = tail.load(std::memory_order_relaxed);
+        Record* record;
+        for (;;) {
+            record = &ring[position & (RING_SIZE - 1)];
+            size_t sequence = record->sequence.load(std::memory_order_acquire);
+            if (sequence == position) {
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (sequence < position) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            } else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+        record->level = level;
+        record->toLogFile = toLogFile;
+        record->time = now;
+        record->message = std::move(message);
+        record->sequence.store(position + 1, std::memory_order_release);
+    }
+}
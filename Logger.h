@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+// Asynchronous logger behind threadSafePrint. Callers push a level-tagged record
+// into a lock-free ring and return; one background thread drains it in batches to
+// the console and the log file, adding the timestamp (formatted once a second).
+// A full ring drops the record and counts it, so logging never blocks a mining
+// thread. Records logged before start() or after stop() are written directly.
+namespace Logger {
+    enum class Level { Debug, Info, Warning, Error };
+
+    void start();
+    void stop();                                   // Drains what is queued, then joins
+    bool openFile(const std::string& fileName);    // Appends to fileName from now on
+
+    void write(Level level, std::string message, bool toLogFile = true);
+}
+
+// Debug records on the hash path; compiled out of release builds unless
+// MONEROMINER_DEBUG_LOG is defined, and gated by --debug where compiled in
+#if !defined(NDEBUG) || defined(MONEROMINER_DEBUG_LOG)
+#define LOG_DEBUG_ENABLED 1
+#endif
+
+#ifdef LOG_DEBUG_ENABLED
+#define LOG_DEBUG(message) \
+    do { if (config.debugMode) Logger::write(Logger::Level::Debug, (message)); } while (0)
+#else
+#define LOG_DEBUG(message) do { } while (0)
+#endif
@@ -0,0 +1,211 @@
+#include "Metrics.h"
+#include "PoolClient.h"
+#include "RandomXManager.h"
+#include "EnergyMeter.h"
+#include "MiningStats.h"
+#include "MiningThreadData.h"
+#include "Globals.h"
+#include "Config.h"
+#include "Utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace Metrics {
+    // Upper bounds of the exported latency buckets, in seconds. The histograms keep
+    // far finer buckets; these cover a LAN pool's submit round trip up to job intervals.
+    static const double LATENCY_BUCKETS[] = {
+        0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60, 120, 300
+    };
+
+    static void header(std::string& out, const char* name, const char* type, const char* help) {
+        out += "# HELP ";
+        out += name;
+        out += ' ';
+        out += help;
+        out += "\n# TYPE ";
+        out += name;
+        out += ' ';
+        out += type;
+        out += '\n';
+    }
+
+    static void sample(std::string& out, const char* name, const std::string& labels, double value) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.9g", value);
+        out += name;
+        if (!labels.empty()) {
+            out += '{';
+            out += labels;
+            out += '}';
+        }
+        out += ' ';
+        out += text;
+        out += '\n';
+    }
+
+    static void sample(std::string& out, const char* name, const std::string& labels, uint64_t value) {
+        out += name;
+        if (!labels.empty()) {
+            out += '{';
+            out += labels;
+            out += '}';
+        }
+        out += ' ';
+        out += std::to_string(value);
+        out += '\n';
+    }
+
+    static std::string label(const char* name, const std::string& value) {
+        std::string escaped;
+        for (char c : value) {
+            if (c == '\\' || c == '"') escaped += '\\';
+            escaped += c == '\n' ? 'n' : c;
+        }
+        return std::string(name) + "=\"" + escaped + "\"";
+    }
+
+    static void histogram(std::string& out, const char* name, const std::string& labels,
+                          const LatencyHistogram& histogram) {
+        std::string bucket = std::string(name) + "_bucket";
+        for (double bound : LATENCY_BUCKETS) {
+            char le[32];
+            snprintf(le, sizeof(le), "%g", bound);
+            sample(out, bucket.c_str(), labels + ",le=\"" + le + "\"", histogram.countAtMost(bound * 1000.0));
+        }
+        sample(out, bucket.c_str(), labels + ",le=\"+Inf\"", histogram.count());
+        sample(out, (std::string(name) + "_sum").c_str(), labels, histogram.sumMs() / 1000.0);
+        sample(out, (std::string(name) + "_count").c_str(), labels, histogram.count());
+    }
+
+    static void threadMetrics(std::string& out) {
+        header(out, "monerominer_thread_hashes_total", "counter", "Hashes computed by a mining thread.");
+        for (const auto* data : threadData) {
+            if (data) sample(out, "monerominer_thread_hashes_total", label("thread", std::to_string(data->getThreadId())), data->getTotalHashCount());
+        }
+        header(out, "monerominer_thread_stale_hashes_total", "counter", "Hashes computed on a job a newer job had already replaced.");
+        for (const auto* data : threadData) {
+            if (data) sample(out, "monerominer_thread_stale_hashes_total", label("thread", std::to_string(data->getThreadId())),
+                             MiningStats::getStaleWork(data->getThreadId()).staleHashes);
+        }
+        header(out, "monerominer_thread_shares_total", "counter", "Shares a mining thread submitted, by pool verdict.");
+        for (const auto* data : threadData) {
+            if (!data) continue;
+            std::string thread = label("thread", std::to_string(data->getThreadId()));
+            sample(out, "monerominer_thread_shares_total", thread + ",result=\"accepted\"", data->getAcceptedShares());
+            sample(out, "monerominer_thread_shares_total", thread + ",result=\"rejected\"", data->getRejectedShares());
+        }
+        header(out, "monerominer_threads", "gauge", "Mining threads started.");
+        sample(out, "monerominer_threads", "", static_cast<uint64_t>(threadData.size()));
+        header(out, "monerominer_threads_active", "gauge", "Mining threads currently hashing, 0 while paused.");
+        sample(out, "monerominer_threads_active", "", static_cast<uint64_t>(miningPaused ? 0 : activeThreads.load()));
+    }
+
+    static void shareMetrics(std::string& out) {
+        MiningStats::StaleWorkStats stale = MiningStats::getStaleWork();
+        header(out, "monerominer_stale_shares_total", "counter", "Shares found on a job a newer job had already replaced.");
+        sample(out, "monerominer_stale_shares_total", "", stale.staleShares);
+        header(out, "monerominer_stale_rejects_total", "counter", "Shares the pool rejected as stale.");
+        sample(out, "monerominer_stale_rejects_total", "", stale.staleRejects);
+        header(out, "monerominer_shares_pending", "gauge", "Shares queued while disconnected, waiting to be resubmitted.");
+        sample(out, "monerominer_shares_pending", "", static_cast<uint64_t>(PoolClient::getPendingShareCount()));
+        header(out, "monerominer_shares_lost_total", "counter", "Shares never delivered to a pool.");
+        sample(out, "monerominer_shares_lost_total", "", PoolClient::getLostShareCount());
+    }
+
+    static void poolMetrics(std::string& out) {
+        std::vector<PoolClient::PoolHealth> health = PoolClient::getPoolHealth();
+        std::vector<PoolClient::PoolLatency> latency = PoolClient::getPoolLatency();
+        size_t count = (std::min)(PoolClient::poolList.size(), (std::min)(health.size(), latency.size()));
+        std::vector<std::string> pools;
+        for (size_t i = 0; i < count; i++) {
+            pools.push_back(label("pool", PoolClient::poolList[i].address + ":" + std::to_string(PoolClient::poolList[i].port)));
+        }
+
+        int active = PoolClient::activePool.load();
+        header(out, "monerominer_pool_active", "gauge", "1 for the pool being mined on.");
+        for (size_t i = 0; i < count; i++) {
+            sample(out, "monerominer_pool_active", pools[i], static_cast<uint64_t>(static_cast<int>(i) == active ? 1 : 0));
+        }
+        header(out, "monerominer_pool_connected", "gauge", "1 while there is a job worth mining.");
+        sample(out, "monerominer_pool_connected", "", static_cast<uint64_t>(PoolClient::isJobUsable() ? 1 : 0));
+        header(out, "monerominer_pool_shares_total", "counter", "Shares answered by a pool, by verdict.");
+        for (size_t i = 0; i < count; i++) {
+            sample(out, "monerominer_pool_shares_total", pools[i] + ",result=\"accepted\"", health[i].acceptedShares);
+            sample(out, "monerominer_pool_shares_total", pools[i] + ",result=\"rejected\"", health[i].rejectedShares);
+        }
+        header(out, "monerominer_pool_logins_total", "counter", "Sessions logged in to a pool; increases after the first are reconnects.");
+        for (size_t i = 0; i < count; i++) {
+            sample(out, "monerominer_pool_logins_total", pools[i], health[i].logins);
+        }
+        header(out, "monerominer_pool_dead_connections_total", "counter", "Pool connections dropped as dead or failed.");
+        for (size_t i = 0; i < count; i++) {
+            sample(out, "monerominer_pool_dead_connections_total", pools[i], health[i].deadConnections);
+        }
+        header(out, "monerominer_pool_connect_seconds", "gauge", "TCP connect time of the last connection.");
+        for (size_t i = 0; i < count; i++) {
+            sample(out, "monerominer_pool_connect_seconds", pools[i], health[i].connectTimeMs / 1000.0);
+        }
+
+        header(out, "monerominer_pool_submit_latency_seconds", "histogram", "Share submit until the pool's response.");
+        for (size_t i = 0; i < count; i++) {
+            histogram(out, "monerominer_pool_submit_latency_seconds", pools[i], latency[i].submitRtt);
+        }
+        header(out, "monerominer_pool_job_interval_seconds", "histogram", "Time between consecutive jobs of one session.");
+        for (size_t i = 0; i < count; i++) {
+            histogram(out, "monerominer_pool_job_interval_seconds", pools[i], latency[i].jobInterval);
+        }
+        header(out, "monerominer_pool_job_switch_seconds", "histogram", "Job received until the last mining thread hashes it.");
+        for (size_t i = 0; i < count; i++) {
+            histogram(out, "monerominer_pool_job_switch_seconds", pools[i], latency[i].jobSwitch);
+        }
+    }
+
+    static void datasetMetrics(std::string& out) {
+        RandomXManager::DatasetStats dataset = RandomXManager::getDatasetStats();
+        header(out, "monerominer_dataset_build_seconds", "gauge", "Duration of the last RandomX dataset build.");
+        sample(out, "monerominer_dataset_build_seconds", "", dataset.buildSeconds);
+        header(out, "monerominer_dataset_load_seconds", "gauge", "Duration of the last RandomX dataset load from disk.");
+        sample(out, "monerominer_dataset_load_seconds", "", dataset.loadSeconds);
+        header(out, "monerominer_dataset_builds_total", "counter", "RandomX datasets built.");
+        sample(out, "monerominer_dataset_builds_total", "", dataset.builds);
+        header(out, "monerominer_dataset_loads_total", "counter", "RandomX datasets loaded from disk.");
+        sample(out, "monerominer_dataset_loads_total", "", dataset.loads);
+        header(out, "monerominer_dataset_huge_pages_ratio", "gauge", "Share of the RandomX dataset on huge pages.");
+        sample(out, "monerominer_dataset_huge_pages_ratio", "", static_cast<uint64_t>(dataset.largePages ? 1 : 0));
+    }
+
+    // Cumulative, so rate() gives watts and hashes over joules gives efficiency
+    static void energyMetrics(std::string& out) {
+        EnergyMeter::Reading energy = EnergyMeter::read();
+        if (!energy.available) {
+            return;
+        }
+        header(out, "monerominer_energy_joules_total", "counter", "Energy used by the CPU packages and DRAM, from RAPL.");
+        sample(out, "monerominer_energy_joules_total", label("domain", "package"), energy.packageJoules);
+        if (energy.hasDram) {
+            sample(out, "monerominer_energy_joules_total", label("domain", "dram"), energy.dramJoules);
+        }
+    }
+
+    std::string render() {
+        std::string out;
+        out.reserve(4096 + threadData.size() * 512);
+
+        header(out, "monerominer_info", "gauge", "Miner version.");
+        sample(out, "monerominer_info", label("version", config.userAgent), static_cast<uint64_t>(1));
+        header(out, "monerominer_uptime_seconds", "gauge", "Seconds since mining started.");
+        sample(out, "monerominer_uptime_seconds", "", std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - MiningStats::globalStats.startTime).count());
+        header(out, "monerominer_resident_memory_bytes", "gauge", "Resident memory of the process.");
+        sample(out, "monerominer_resident_memory_bytes", "", getResidentMemoryBytes());
+
+        threadMetrics(out);
+        shareMetrics(out);
+        poolMetrics(out);
+        datasetMetrics(out);
+        energyMetrics(out);
+        return out;
+    }
+}
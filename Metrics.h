@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string>
+
+// Prometheus text exposition of the miner's counters, served by the HTTP API at
+// GET /metrics. Mining-thread figures are read from the relaxed atomics the
+// threads publish; the mining threads never see a scrape. Pool figures are
+// copied under the network telemetry lock, which the hash path does not take.
+namespace Metrics {
+    std::string render();
+}
@@ -3,6 +3,10 @@
 #include "MiningThreadData.h"
 #include "Globals.h"
 #include "Utils.h"
+#include "PoolClient.h"
+#include "SplitMining.h"
+#include "PerfCounters.h"
+#include "EnergyMeter.h"
 #include <iostream>
 #include <iomanip>
 #include <sstream>
@@ -11,6 +15,7 @@
 #include <mutex>
 #include <atomic>
 #include <unordered_map>
+#include <algorithm>
 
 namespace MiningStats {
     std::atomic<bool> shouldStop(false);
@@ -22,6 +27,35 @@ namespace MiningStats {
     std::unordered_map<int, uint64_t> hashCounts;
     uint64_t totalHashes = 0;
 
+    // Job switch tracking; the hash path only touches the atomics
+    static std::atomic<uint64_t> latestJobSequence(0);
+    static std::atomic<int> switchedThreads(0);
+    static std::mutex switchMutex;
+    static std::chrono::steady_clock::time_point latestJobReceived;  // Guarded by switchMutex
+    static int latestJobPool = -1;                                   // Guarded by switchMutex
+    static JobSwitchStats switchStats;                               // Guarded by switchMutex
+    static double switchMsSum = 0.0;                                 // Guarded by switchMutex
+    static uint64_t completedSequence = 0;                           // Guarded by switchMutex
+    static std::atomic<int> switchThreads(0);                        // Threads mining the main session's jobs
+
+    // Stale work counters, one cache line per thread so the hash path never shares one
+    struct alignas(64) StaleCounters {
+        std::atomic<uint64_t> hashes{0};
+        std::atomic<uint64_t> staleHashes{0};
+        std::atomic<uint64_t> shares{0};
+        std::atomic<uint64_t> staleShares{0};
+        std::atomic<uint64_t> staleRejects{0};
+    };
+    static std::unique_ptr<StaleCounters[]> staleCounters;
+    static int staleThreads = 0;
+
+    static std::mutex hashrateMutex;
+    static double highestHashrate = 0.0;    // Guarded by hashrateMutex
+
+    double StaleWorkStats::stalePercent() const {
+        return hashes == 0 ? 0.0 : 100.0 * staleHashes / hashes;
+    }
+
     void initializeStats(const Config& config) {
         threadStats.clear();
         threadStats.resize(config.numThreads);
@@ -35,6 +69,9 @@ namespace MiningStats {
             threadStats[i]->runtime = 0;
         }
         globalStats.startTime = std::chrono::steady_clock::now();
+        staleCounters.reset(new StaleCounters[config.numThreads]);
+        staleThreads = config.numThreads;
+        switchThreads = config.numThreads;
     }
 
     void updateThreadStats(MiningThreadData* data, uint64_t hashCount, uint64_t totalHashCount,
@@ -50,43 +87,121 @@ namespace MiningStats {
         globalStats.currentNonce = currentNonce;
     }
 
+    // Sums the threads' per-second rings; no mining thread is stopped or locked
+    HashrateStats getHashrateStats() {
+        HashrateStats stats;
+        for (const auto* data : threadData) {
+            if (data) {
+                stats.shortRate += data->getHashrate(MiningConstants::HASHRATE_SHORT_WINDOW_SEC);
+                stats.mediumRate += data->getHashrate(MiningConstants::HASHRATE_AVERAGING_WINDOW_SIZE);
+                stats.longRate += data->getHashrate(MiningConstants::HASHRATE_LONG_WINDOW_SEC);
+            }
+        }
+        std::lock_guard<std::mutex> lock(hashrateMutex);
+        highestHashrate = (std::max)(highestHashrate, stats.shortRate);
+        stats.highest = highestHashrate;
+        return stats;
+    }
+
     void globalStatsMonitor() {
         while (!shouldStop) {
-            std::this_thread::sleep_for(std::chrono::seconds(5));
-            
+            for (int i = 0; i < 50 && !shouldStop; i++) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            if (shouldStop) break;
+
             std::lock_guard<std::mutex> lock(statsMutex);
+            PerfCounters::update(threadData);
             
             // Update global stats from all threads
             uint64_t totalHashes = 0;
             uint64_t totalAcceptedShares = 0;
             uint64_t totalRejectedShares = 0;
-            double totalHashrate = 0.0;
             
             for (const auto& data : threadData) {
                 if (data) {
                     totalHashes += data->getTotalHashCount();
                     totalAcceptedShares += data->getAcceptedShares();
                     totalRejectedShares += data->getRejectedShares();
-                    totalHashrate += data->getHashrate();
                 }
             }
+            HashrateStats hashrate = getHashrateStats();
+            EnergyMeter::update(totalHashes);
+            EnergyMeter::Power power = EnergyMeter::getPower();
             
             // Print global stats
             std::stringstream ss;
-            ss << "Global Hash Rate: " << std::fixed << std::setprecision(2) 
-               << (totalHashrate / 1000.0) << " kH/s | "
+            ss << "Global Hash Rate: " << std::fixed << std::setprecision(2)
+               << (hashrate.shortRate / 1000.0) << " / " << (hashrate.mediumRate / 1000.0) << " / "
+               << (hashrate.longRate / 1000.0) << " kH/s (10s/60s/15m), max " << (hashrate.highest / 1000.0) << " kH/s | "
                << "Shares: " << totalAcceptedShares << "/" << totalRejectedShares 
-               << " | Total Hashes: " << totalHashes << std::endl;
-            
+               << " | Pending: " << PoolClient::getPendingShareCount()
+               << " | Lost: " << PoolClient::getLostShareCount()
+               << " | Stale: " << std::setprecision(2) << getStaleWork().stalePercent() << "%"
+               << " | Total Hashes: " << totalHashes;
+            if (power.available) {
+                ss << " | Power: " << EnergyMeter::summary(power);
+            }
+            ss << std::endl;
+
+            // Active pool and dead-connection detection latency
+            int active = PoolClient::activePool.load();
+            std::vector<PoolClient::PoolHealth> health = PoolClient::getPoolHealth();
+            if (active >= 0 && active < static_cast<int>(health.size())) {
+                const PoolClient::PoolHealth& pool = health[active];
+                ss << "Pool: " << PoolClient::poolList[active].address << ":" << PoolClient::poolList[active].port
+                   << " | Last job: " << std::fixed << std::setprecision(0) << pool.lastJobAgeSec() << "s ago"
+                   << " | Dead connections: " << pool.deadConnections
+                   << " | Detection: last " << pool.lastDetectionMs << " ms, max " << pool.maxDetectionMs
+                   << " ms" << std::endl;
+            }
+
+            // Latency distributions of every pool that has any
+            std::vector<PoolClient::PoolLatency> latency = PoolClient::getPoolLatency();
+            for (size_t i = 0; i < latency.size() && i < PoolClient::poolList.size(); i++) {
+                const PoolClient::PoolLatency& pool = latency[i];
+                if (pool.submitRtt.count() + pool.jobInterval.count() + pool.jobSwitch.count() == 0) continue;
+                ss << "Latency " << PoolClient::poolList[i].address << ":" << PoolClient::poolList[i].port
+                   << " | Submit RTT: " << pool.submitRtt.summary()
+                   << " | Job interval: " << pool.jobInterval.summary()
+                   << " | Job switch: " << pool.jobSwitch.summary() << std::endl;
+            }
+
+            // Effective hashrate of each weighted endpoint
+            for (const auto& endpoint : SplitMining::getStats()) {
+                ss << "Split " << endpoint.name << " | Weight: " << endpoint.weight << "%"
+                   << " | Threads: " << endpoint.threads
+                   << " | Hash Rate: " << std::setprecision(2) << (endpoint.hashrate / 1000.0) << " kH/s ("
+                   << std::setprecision(1) << endpoint.hashShare << "% of hashes)"
+                   << " | Shares: " << endpoint.acceptedShares << "/" << endpoint.rejectedShares
+                   << " | Stale: " << std::setprecision(2)
+                   << (endpoint.hashes == 0 ? 0.0 : 100.0 * endpoint.staleHashes / endpoint.hashes) << "%"
+                   << (!endpoint.connected ? " | offline" : !endpoint.ready ? " | waiting for work on the dataset's seed" : "")
+                   << std::endl;
+            }
+
             // Print individual thread stats
             for (const auto& data : threadData) {
                 if (data) {
                     ss << "Thread " << data->getThreadId() 
                        << " Hash Rate: " << std::fixed << std::setprecision(2) 
-                       << (data->getHashrate() / 1000.0) << " kH/s | "
+                       << (data->getHashrate(MiningConstants::HASHRATE_SHORT_WINDOW_SEC) / 1000.0) << " / "
+                       << (data->getHashrate(MiningConstants::HASHRATE_AVERAGING_WINDOW_SIZE) / 1000.0) << " / "
+                       << (data->getHashrate(MiningConstants::HASHRATE_LONG_WINDOW_SEC) / 1000.0) << " kH/s | "
                        << "Hashes: " << data->getTotalHashCount() 
                        << " | Shares: " << data->getAcceptedShares() << "/" 
-                       << data->getRejectedShares() << std::endl;
+                       << data->getRejectedShares()
+                       << " | Stale: " << getStaleWork(data->getThreadId()).stalePercent() << "%";
+                    if (HashTiming::enabled) {
+                        HashTiming::Percentiles latency = data->getHashLatency();
+                        ss << " | Hash p50/p99/p99.9: " << std::setprecision(0) << (latency.p50Ns / 1000.0) << " / "
+                           << (latency.p99Ns / 1000.0) << " / " << (latency.p999Ns / 1000.0) << " us";
+                    }
+                    PerfCounters::ThreadRates perf = PerfCounters::getRates(data->getThreadId());
+                    if (perf.available) {
+                        ss << " | " << PerfCounters::summary(perf);
+                    }
+                    ss << std::endl;
                 }
             }
             
@@ -113,4 +228,99 @@ namespace MiningStats {
         std::lock_guard<std::mutex> lock(hashMutex);
         return totalHashes;
     }
-} 
\ No newline at end of file
+
+    uint64_t jobReceived(std::chrono::steady_clock::time_point receivedAt, int pool) {
+        std::lock_guard<std::mutex> lock(switchMutex);
+        latestJobReceived = receivedAt;
+        latestJobPool = pool;
+        switchedThreads = 0;
+        switchStats.jobs++;
+        return ++latestJobSequence;
+    }
+
+    // Called before each hash. The thread's previous hash, on job threadSequence, has
+    // just completed, so it was wasted if a newer job has arrived since.
+    void recordHash(int threadId, uint64_t& threadSequence, uint64_t jobSequence) {
+        uint64_t latest = latestJobSequence.load(std::memory_order_acquire);
+        if (threadSequence != 0 && threadId >= 0 && threadId < staleThreads) {
+            StaleCounters& counters = staleCounters[threadId];
+            counters.hashes.fetch_add(1, std::memory_order_relaxed);
+            if (threadSequence < latest) {
+                counters.staleHashes.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (jobSequence == threadSequence) {
+            return;
+        }
+
+        // First hash of this thread on a new job; the last thread to get there completes the switch
+        threadSequence = jobSequence;
+        if (jobSequence != latest || ++switchedThreads < switchThreads.load(std::memory_order_relaxed)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(switchMutex);
+        if (latestJobSequence.load() != jobSequence || completedSequence == jobSequence) {
+            return;
+        }
+        completedSequence = jobSequence;
+        double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - latestJobReceived).count();
+        switchStats.completedSwitches++;
+        switchStats.lastSwitchMs = ms;
+        switchStats.maxSwitchMs = (std::max)(switchStats.maxSwitchMs, ms);
+        switchMsSum += ms;
+        switchStats.avgSwitchMs = switchMsSum / switchStats.completedSwitches;
+        PoolClient::recordJobSwitch(latestJobPool, ms);
+    }
+
+    void setJobSwitchThreads(int threads) {
+        switchThreads = threads;
+    }
+
+    void recordShare(int threadId, uint64_t jobSequence) {
+        if (threadId < 0 || threadId >= staleThreads) return;
+        staleCounters[threadId].shares++;
+        if (jobSequence < latestJobSequence.load()) {
+            staleCounters[threadId].staleShares++;
+        }
+    }
+
+    void recordStaleReject(int threadId) {
+        if (threadId < 0 || threadId >= staleThreads) return;
+        staleCounters[threadId].staleRejects++;
+    }
+
+    JobSwitchStats getJobSwitchStats() {
+        StaleWorkStats stale = getStaleWork();
+        std::lock_guard<std::mutex> lock(switchMutex);
+        JobSwitchStats stats = switchStats;
+        stats.hashes = stale.hashes;
+        stats.wastedHashes = stale.staleHashes;
+        return stats;
+    }
+
+    StaleWorkStats getStaleWork(int threadId) {
+        StaleWorkStats stats;
+        if (threadId < 0 || threadId >= staleThreads) return stats;
+        const StaleCounters& counters = staleCounters[threadId];
+        stats.hashes = counters.hashes.load();
+        stats.staleHashes = counters.staleHashes.load();
+        stats.shares = counters.shares.load();
+        stats.staleShares = counters.staleShares.load();
+        stats.staleRejects = counters.staleRejects.load();
+        return stats;
+    }
+
+    StaleWorkStats getStaleWork() {
+        StaleWorkStats total;
+        for (int i = 0; i < staleThreads; i++) {
+            StaleWorkStats thread = getStaleWork(i);
+            total.hashes += thread.hashes;
+            total.staleHashes += thread.staleHashes;
+            total.shares += thread.shares;
+            total.staleShares += thread.staleShares;
+            total.staleRejects += thread.staleRejects;
+        }
+        return total;
+    }
+}
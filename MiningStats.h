@@ -27,6 +27,50 @@ namespace MiningStats {
     uint64_t getHashCount(int threadId);
     uint64_t getTotalHashes();
 
+    // Job switch latency (job received until every mining thread hashes it) and
+    // hashes spent on a job after a newer one had arrived
+    struct JobSwitchStats {
+        uint64_t jobs = 0;
+        uint64_t completedSwitches = 0;   // Jobs all threads reached before the next arrived
+        double lastSwitchMs = 0.0;
+        double avgSwitchMs = 0.0;
+        double maxSwitchMs = 0.0;
+        uint64_t hashes = 0;
+        uint64_t wastedHashes = 0;
+    };
+
+    // Stale work of one mining thread, or of all of them: hashes computed on a job
+    // that had already been superseded, shares found on such jobs and shares the
+    // pool rejected as stale
+    struct StaleWorkStats {
+        uint64_t hashes = 0;
+        uint64_t staleHashes = 0;
+        uint64_t shares = 0;
+        uint64_t staleShares = 0;
+        uint64_t staleRejects = 0;
+
+        double stalePercent() const;   // Stale hashes as a percentage of all hashes
+    };
+
+    // Hashrate of all mining threads over the short, 60 s and long windows, and the
+    // highest short-window rate seen by the stats monitor, in H/s
+    struct HashrateStats {
+        double shortRate = 0.0;
+        double mediumRate = 0.0;
+        double longRate = 0.0;
+        double highest = 0.0;
+    };
+
+    HashrateStats getHashrateStats();
+    uint64_t jobReceived(std::chrono::steady_clock::time_point receivedAt, int pool);  // Returns the job's sequence number
+    void recordHash(int threadId, uint64_t& threadSequence, uint64_t jobSequence);     // Before each hash, from the mining threads
+    void recordShare(int threadId, uint64_t jobSequence);                              // When a thread finds a share
+    void setJobSwitchThreads(int threads);                                             // Threads a job switch waits for, fewer when splitting
+    void recordStaleReject(int threadId);
+    JobSwitchStats getJobSwitchStats();
+    StaleWorkStats getStaleWork(int threadId);
+    StaleWorkStats getStaleWork();
+
     class MiningStats {
     public:
         static void updateHashCount(int threadId, uint64_t count) {
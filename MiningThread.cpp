@@ -4,6 +4,7 @@
 #include "MiningStats.h"
 #include "Globals.h"
 #include "Utils.h"
+#include "HexCodec.h"
 #include "Constants.h"
 #include "Types.h"
 #include <cstdint>
@@ -77,8 +78,8 @@ void miningThread(MiningThreadData* data) {
             uint32_t nonce = 0;
 
             // Prepare input for hashing
-            std::vector<uint8_t> input = hexToBytes(job.blob);
-            if (input.size() != 76) {
+            std::vector<uint8_t> input;
+            if (!HexCodec::decode(job.blob, input) || input.size() != 76) {
                 threadSafePrint("Error: Invalid blob size", true);
                 continue;
             }
@@ -92,7 +93,7 @@ void miningThread(MiningThreadData* data) {
             if (config.debugMode) {
                 std::stringstream ss;
                 ss << "[" << getCurrentTimestamp() << "] randomx  first hash:" << std::endl;
-                ss << "  Input: " << bytesToHex(input) << std::endl;
+                ss << "  Input: " << HexCodec::encode(input) << std::endl;
                 ss << "  Nonce: 0x" << std::hex << nonce << std::endl;
                 threadSafePrint(ss.str(), true);
             }
@@ -102,9 +103,9 @@ void miningThread(MiningThreadData* data) {
                 if (config.debugMode) {
                     std::stringstream ss;
                     ss << "[" << getCurrentTimestamp() << "] randomx  first hash:" << std::endl;
-                    ss << "  Input: " << bytesToHex(input) << std::endl;
+                    ss << "  Input: " << HexCodec::encode(input) << std::endl;
                     ss << "  Nonce: 0x" << std::hex << std::setw(8) << std::setfill('0') << nonce << std::endl;
-                    ss << "  Hash: " << bytesToHex(RandomXManager::getLastHash()) << std::endl;
+                    ss << "  Hash: " << HexCodec::encode(RandomXManager::getLastHash()) << std::endl;
                     ss << "  Target: 0x" << job.target << std::endl;
                     threadSafePrint(ss.str(), true);
                 }
@@ -132,7 +133,7 @@ void miningThread(MiningThreadData* data) {
                 if (RandomXManager::calculateHash(data->getVM(), input, nonce)) {
                     // Found a valid share - submit it
                     std::string nonceHex = Utils::formatHex(nonce, 8);
-                    std::string hashHex = bytesToHex(RandomXManager::getLastHash());
+                    std::string hashHex = HexCodec::encode(RandomXManager::getLastHash());
                     
                     if (config.debugMode) {
                         threadSafePrint("\nFound valid share!", true);
@@ -141,22 +142,13 @@ void miningThread(MiningThreadData* data) {
                         threadSafePrint("  Hash: " + hashHex, true);
                     }
                     
-                    // Submit share through PoolClient
-                    bool accepted = false;
-                    int retries = 3;
-                    while (retries > 0 && !accepted) {
-                        accepted = PoolClient::submitShare(job.jobId, nonceHex, hashHex, "rx/0");
-                        if (!accepted && retries > 1) {
-                            threadSafePrint("Share submission failed, retrying... (" + std::to_string(retries-1) + " attempts left)", true);
-                            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                        }
-                        retries--;
-                    }
-
-                    if (accepted) {
+                    // Submit share through PoolClient. Undeliverable shares are queued and
+                    // journaled by PoolClient, so there is no retry loop on the mining thread.
+                    PoolClient::ShareStatus status = PoolClient::submitShare(job.jobId, nonceHex, hashHex, "rx/0");
+                    if (status == PoolClient::ShareStatus::Accepted) {
                         threadSafePrint("Share accepted by pool!", true);
                         data->acceptedShares++;
-                    } else {
+                    } else if (status == PoolClient::ShareStatus::Rejected || status == PoolClient::ShareStatus::Stale) {
                         threadSafePrint("Share rejected by pool", true);
                         data->rejectedShares++;
                     }
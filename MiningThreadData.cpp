@@ -2,11 +2,14 @@
 #include "HashBuffers.h"
 #include "RandomXManager.h"
 #include "PoolClient.h"
+#include "SplitMining.h"
 #include "Utils.h"
+#include "HexCodec.h"
 #include "Constants.h"
 #include "RandomXFlags.h"
 #include "MiningStats.h"
 #include "Globals.h"
+#include "Logger.h"
 #include "randomx.h"
 #include <sstream>
 #include <thread>
@@ -36,11 +39,32 @@ bool MiningThreadData::initializeVM() {
     vm = RandomXManager::createVM(threadId);
     if (!vm) return false;
 
+#ifdef MONEROMINER_HASH_TIMING
+    // The VM is set up on the mining thread, so its hashes are timed from here on
+    HashTiming::bind(&hashTiming);
+#endif
     vmInitialized = true;
     return true;
 }
 
+HashTiming::Percentiles MiningThreadData::getHashLatency() const {
+#ifdef MONEROMINER_HASH_TIMING
+    return hashTiming.percentiles();
+#else
+    return HashTiming::Percentiles();
+#endif
+}
+
 bool MiningThreadData::calculateHash(const std::vector<uint8_t>& input, uint64_t nonce) {
+    return calculateHash(input, nonce, RandomXManager::currentTargetHex);
+}
+
+bool MiningThreadData::calculateHash(const std::vector<uint8_t>& input, uint64_t nonce, const std::string& targetHex) {
+    return calculateHash(vm, input, nonce, targetHex);
+}
+
+bool MiningThreadData::calculateHash(randomx_vm* vm, const std::vector<uint8_t>& input, uint64_t nonce,
+                                     const std::string& targetHex) {
     if (!vm || input.empty()) {
         return false;
     }
@@ -60,7 +84,7 @@ bool MiningThreadData::calculateHash(const std::vector<uint8_t>& input, uint64_t
     data[42] = nonce & 0xFF;
 
     // Calculate hash
-    return RandomXManager::calculateHash(vm, data, nonce);
+    return RandomXManager::calculateHash(vm, data, nonce, targetHex);
 }
 
 void MiningThreadData::updateJob(const Job& job) {
@@ -78,11 +102,9 @@ void MiningThreadData::updateJob(const Job& job) {
     // Initialize nonce based on thread ID
     currentNonce = static_cast<uint64_t>(threadId) * (0xFFFFFFFF / config.numThreads);
     
-    if (debugMode) {
-        threadSafePrint("Thread " + std::to_string(threadId) + 
-            " initialized with job: " + currentJob->getJobId() + 
-            " starting nonce: " + std::to_string(currentNonce), true);
-    }
+    LOG_DEBUG("Thread " + std::to_string(threadId) +
+        " initialized with job: " + currentJob->getJobId() +
+        " starting nonce: " + std::to_string(currentNonce));
 }
 
 void MiningThreadData::mine() {
@@ -118,6 +140,12 @@ void MiningThreadData::mine() {
                 }
             }
 
+            // Idle once the pool has been gone longer than the job grace period
+            if (!PoolClient::isJobUsable()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(THREAD_PAUSE_TIME));
+                continue;
+            }
+
             // Process current job
             std::vector<uint8_t> input;
             uint64_t currentNonce;
@@ -135,13 +163,9 @@ void MiningThreadData::mine() {
             
             // Calculate hash
             if (calculateHash(input, currentNonce)) {
-                // Check if we still have the same job before submitting
-                {
-                    std::lock_guard<std::mutex> lock(jobMutex);
-                    if (currentJob && currentJob->getJobId() == currentJobId) {
-                        submitShare(RandomXManager::getLastHash());
-                    }
-                }
+                // Submit outside the job lock; the share stays valid for its job
+                // even if a new job arrived meanwhile
+                submitShare(currentJobId, static_cast<uint32_t>(currentNonce), RandomXManager::getLastHash());
             }
             
             // Update nonce and stats
@@ -149,15 +173,15 @@ void MiningThreadData::mine() {
                 std::lock_guard<std::mutex> lock(jobMutex);
                 if (currentJob && currentJob->getJobId() == currentJobId) {
                     this->currentNonce++;
-                    hashCount++;
-                    totalHashCount++;
+                    bump(hashCount);
+                    bump(totalHashCount);
                 }
             }
             
-            // Print hash rate every 1000 hashes
-            if (hashCount % 1000 == 0) {
-                threadSafePrint("Thread " + std::to_string(threadId) + 
-                    " processed " + std::to_string(hashCount) + " hashes", true);
+            // Progress every 1000 hashes, debug builds only
+            if (getHashCount() % 1000 == 0) {
+                LOG_DEBUG("Thread " + std::to_string(threadId) +
+                    " processed " + std::to_string(getHashCount()) + " hashes");
             }
         }
         catch (const std::exception& e) {
@@ -168,45 +192,47 @@ void MiningThreadData::mine() {
     }
 }
 
-void MiningThreadData::submitShare(const std::vector<uint8_t>& hash) {
-    std::lock_guard<std::mutex> lock(jobMutex);
-    
-    if (!currentJob) {
-        if (debugMode) {
-            threadSafePrint("Thread " + std::to_string(threadId) + 
-                " attempted to submit share without current job", true);
-        }
-        return;
-    }
-
+void MiningThreadData::submitShare(const std::string& jobId, uint32_t nonce, const std::vector<uint8_t>& hash,
+                                   int endpoint) {
     // Convert hash to hex string
-    std::stringstream ss;
-    for (uint8_t byte : hash) {
-        ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(byte);
-    }
-    std::string hashHex = ss.str();
+    std::string hashHex = HexCodec::encode(hash);
 
-    // Convert height to string
-    std::string heightStr = std::to_string(currentJob->getHeight());
+    std::string nonceHex = MiningThreadData::nonceHex(nonce);
 
     if (debugMode) {
         threadSafePrint("Thread " + std::to_string(threadId) + 
-            " submitting share for job: " + currentJob->getJobId() + 
-            " nonce: " + std::to_string(currentNonce), true);
+            " submitting share for job: " + jobId + " nonce: " + nonceHex, true);
     }
 
-    // Submit share to pool
-    bool accepted = PoolClient::submitShare(hashHex, currentJob->getJobId(), heightStr, std::to_string(currentNonce));
+    // Submit share to the pool that sent the job
+    PoolClient::ShareStatus status = endpoint > 0 ?
+        SplitMining::submitShare(endpoint, jobId, nonceHex, hashHex) :
+        PoolClient::submitShare(jobId, nonceHex, hashHex, "rx/0");
     
-    if (accepted) {
-        acceptedShares++;
-        threadSafePrint("Share accepted! Hash: " + hashHex + " Nonce: " + std::to_string(currentNonce), true);
+    if (status == PoolClient::ShareStatus::Accepted) {
+        bump(acceptedShares);
+        threadSafePrint("Share accepted! Hash: " + hashHex + " Nonce: " + nonceHex, true);
+    } else if (status == PoolClient::ShareStatus::Rejected || status == PoolClient::ShareStatus::Stale) {
+        bump(rejectedShares);
+        if (status == PoolClient::ShareStatus::Stale) {
+            MiningStats::recordStaleReject(threadId);
+        }
+        threadSafePrint(std::string(status == PoolClient::ShareStatus::Stale ? "Stale share" : "Share") +
+            " rejected. Hash: " + hashHex + " Nonce: " + nonceHex, true);
     } else {
-        rejectedShares++;
-        threadSafePrint("Share rejected. Hash: " + hashHex + " Nonce: " + std::to_string(currentNonce), true);
+        threadSafePrint("Share queued for resubmission. Hash: " + hashHex + " Nonce: " + nonceHex, true);
     }
 }
 
+std::string MiningThreadData::nonceHex(uint32_t nonce) {
+    // Nonce is submitted as the 4 blob bytes at NONCE_OFFSET, in the order calculateHash wrote them
+    const uint8_t nonceBytes[MiningConstants::NONCE_SIZE] = {
+        static_cast<uint8_t>(nonce >> 24), static_cast<uint8_t>(nonce >> 16),
+        static_cast<uint8_t>(nonce >> 8), static_cast<uint8_t>(nonce)
+    };
+    return HexCodec::encode(nonceBytes, sizeof(nonceBytes));
+}
+
 bool MiningThreadData::needsVMReinit(const std::string& newSeedHash) const {
     return currentSeedHash != newSeedHash;
 }
@@ -215,7 +241,7 @@ double MiningThreadData::getHashrate() const {
     auto now = std::chrono::steady_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::seconds>(now - startTime).count();
     if (duration == 0) return 0.0;
-    return static_cast<double>(totalHashCount) / duration;
+    return static_cast<double>(getTotalHashCount()) / duration;
 }
 
 void MiningThreadData::start() {
@@ -10,6 +10,8 @@
 #include <thread>
 #include "Types.h"
 #include "HashBuffers.h"
+#include "HashrateWindow.h"
+#include "HashTiming.h"
 #include "Job.h"
 #include "RandomXManager.h"
 #include "randomx.h"
@@ -46,31 +48,49 @@ public:
 
     // Hash calculation
     bool calculateHash(const std::vector<uint8_t>& input, uint64_t nonce);
-    void submitShare(const std::vector<uint8_t>& hash);
+    bool calculateHash(const std::vector<uint8_t>& input, uint64_t nonce, const std::string& targetHex);
+    static bool calculateHash(randomx_vm* vm, const std::vector<uint8_t>& input, uint64_t nonce,
+                              const std::string& targetHex);  // Nonce inserted into a copy of input, then hashed
+    static std::string nonceHex(uint32_t nonce);  // Hex of the nonce as submitted
+    void submitShare(const std::string& jobId, uint32_t nonce, const std::vector<uint8_t>& hash,
+                     int endpoint = 0);  // Endpoint from SplitMining; 0 is the main pool
 
     // Stats
-    double getHashrate() const;
+    double getHashrate() const;                 // Average since the thread started
+    double getHashrate(int seconds) const { return hashrateWindow.rate(seconds); }
     int getThreadId() const { return threadId; }
-    uint64_t getHashCount() const { return hashCount; }
-    uint64_t getTotalHashCount() const { return totalHashCount; }
-    uint64_t getAcceptedShares() const { return acceptedShares; }
-    uint64_t getRejectedShares() const { return rejectedShares; }
-    void incrementHashCount() { hashCount++; totalHashCount++; }
+    uint64_t getHashCount() const { return hashCount.load(std::memory_order_relaxed); }
+    uint64_t getTotalHashCount() const { return totalHashCount.load(std::memory_order_relaxed); }
+    uint64_t getAcceptedShares() const { return acceptedShares.load(std::memory_order_relaxed); }
+    uint64_t getRejectedShares() const { return rejectedShares.load(std::memory_order_relaxed); }
+    void incrementHashCount() { bump(hashCount); bump(totalHashCount); hashrateWindow.add(); }
+    HashTiming::Percentiles getHashLatency() const;   // Empty unless built with MONEROMINER_HASH_TIMING
 
 private:
+    // The counters have one writer, the mining thread, and are read by the stats
+    // monitor and the HTTP API. A relaxed load and store is a plain add, with no
+    // locked instruction on the hash path.
+    static void bump(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
     int threadId;
     randomx_vm* vm;
     bool vmInitialized;
     std::mutex vmMutex;
     std::thread thread;
     bool running;
-    uint64_t hashCount;
-    uint64_t totalHashCount;
-    uint64_t acceptedShares;
-    uint64_t rejectedShares;
+    std::atomic<uint64_t> hashCount;
+    std::atomic<uint64_t> totalHashCount;
+    std::atomic<uint64_t> acceptedShares;
+    std::atomic<uint64_t> rejectedShares;
     uint64_t currentNonce;
     Job* currentJob;
     std::mutex jobMutex;
     std::string currentSeedHash;
     std::chrono::steady_clock::time_point startTime;
+    HashrateWindow hashrateWindow;
+#ifdef MONEROMINER_HASH_TIMING
+    HashTiming::Histogram hashTiming;
+#endif
 }; 
\ No newline at end of file
@@ -10,12 +10,25 @@
  
 #include "Config.h"
 #include "PoolClient.h"
+#include "ShareJournal.h"
+#include "StratumProxy.h"
+#include "StratumCapture.h"
+#include "StratumReplay.h"
+#include "DaemonClient.h"
+#include "SplitMining.h"
+#include "HttpApi.h"
+#include "Logger.h"
+#include "PerfCounters.h"
+#include "EnergyMeter.h"
+#include "Benchmark.h"
+#include "CpuTopology.h"
 #include "RandomXManager.h"
 #include "MiningStats.h"
 #include "Utils.h"
 #include "Job.h"
 #include "Globals.h"
 #include <iostream>
+#include <cstdlib>
 #include <thread>
 #include <vector>
 #include <mutex>
@@ -36,6 +49,9 @@ extern std::atomic<uint64_t> jsonRpcId;
 extern std::string sessionId;
 extern std::vector<MiningThreadData*> threadData;
 
+// CPU of each mining thread from --affinity; empty leaves placement to the OS
+static std::vector<int> miningThreadCpus;
+
 // Forward declarations
 void printHelp();
 bool validateConfig();
@@ -50,6 +66,7 @@ bool submitShare(const std::string& jobId, const std::string& nonce, const std::
 void handleLoginResponse(const std::string& response);
 void processNewJob(const picojson::object& jobObj);
 void miningThread(int threadId);
+void printReplayReport();
 bool loadConfig();
 
 void printHelp() {
@@ -61,6 +78,37 @@ void printHelp() {
               << "  --logfile            Enable logging to file\n"
               << "  --threads N          Number of mining threads (default: 1)\n"
               << "  --pool ADDRESS:PORT  Pool address and port (default: xmr-eu1.nanopool.org:14444)\n"
+              << "                       Repeat for failover pools, in order of preference\n"
+              << "  --job-timeout SEC    Fail over if a pool sends no job for SEC seconds (default: 1200, 0 = off)\n"
+              << "  --keepalive SEC      Send a keepalived request after SEC seconds of silence (default: 30, 0 = off)\n"
+              << "  --idle-timeout SEC   Treat the connection as dead after SEC seconds of silence (default: 60)\n"
+              << "  --job-grace SEC      Keep mining the last job for SEC seconds while disconnected (default: 120)\n"
+              << "  --share-journal FILE Record found shares and their outcome in FILE (default: shares.journal)\n"
+              << "  --no-share-journal   Disable the share journal\n"
+              << "  --dump-journal FILE  Print a share journal and exit\n"
+              << "  --proxy              Relay work to downstream miners instead of mining\n"
+              << "  --proxy-bind ADDRESS Address the proxy listens on (default: 0.0.0.0)\n"
+              << "  --proxy-port PORT    Port the proxy listens on (default: 3333)\n"
+              << "  --proxy-verify-threads N  Threads verifying downstream shares (default: 2, 0 = off)\n"
+              << "  --proxy-share-interval SEC  Vardiff share interval per miner (default: 30, 0 = pool target)\n"
+              << "  --capture FILE       Record the raw stratum session to FILE\n"
+              << "  --replay FILE        Mine against a recorded session instead of a pool, then report\n"
+              << "  --replay-speed X     Replay X times faster than recorded (default: 1)\n"
+              << "  --daemon HOST:PORT   Solo mine on block templates from a monerod RPC port\n"
+              << "  --daemon-zmq HOST:PORT  monerod --zmq-pub endpoint for instant new-block templates\n"
+              << "  --split HOST:PORT,WEIGHT[,WALLET[,WORKER]]  Give WEIGHT% of the hashpower to another\n"
+              << "                       pool or wallet; repeatable, the main pool gets the rest\n"
+              << "  --api-port PORT      Serve JSON stats and pause/resume/threads control over HTTP\n"
+              << "  --api-bind ADDRESS   Address the API listens on (default: 127.0.0.1)\n"
+              << "  --api-token TOKEN    Require 'Authorization: Bearer TOKEN' on API requests\n"
+              << "  --perf-counters      Show per-thread IPC, clock, LLC/dTLB misses per hash and page faults\n"
+              << "  --benchmark N        Hash N nonces (e.g. 1M) of a fixed job offline on --threads threads,\n"
+              << "                       verify the final hash and report, then exit\n"
+              << "  --benchmark-json FILE  Also write the benchmark report as JSON to FILE ('-' for stdout)\n"
+              << "  --bench-scaling N    Benchmark N hashes per thread at 1..all CPUs (or --threads) threads,\n"
+              << "                       per affinity policy, and recommend --threads and --affinity\n"
+              << "  --affinity POLICY    Pin mining threads: none (default), cores (one per physical core\n"
+              << "                       before SMT siblings) or compact (both siblings of a core first)\n"
               << "  --wallet ADDRESS      Your Monero wallet address\n"
               << "  --worker NAME        Worker name (default: worker1)\n"
               << "  --password X         Pool password (default: x)\n"
@@ -102,6 +150,33 @@ void printConfig() {
     std::cout << std::endl;
 }
 
+// Summary of a --replay run: what was replayed and how fast the miner followed it
+void printReplayReport() {
+    StratumReplay::Report replay = StratumReplay::getReport();
+    MiningStats::JobSwitchStats switches = MiningStats::getJobSwitchStats();
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    ss << "Replay report:\n"
+       << "  Jobs replayed: " << replay.jobsSent << "/" << replay.jobsTotal << " (" << replay.capturedSec
+       << "s recorded, " << replay.replaySec << "s replayed, " << replay.capturedLines << " captured lines)\n"
+       << "  Shares submitted: " << replay.sharesSubmitted << ", keepalives: " << replay.keepalives
+       << ", connections: " << replay.connections << "\n"
+       << "  Job switches: " << switches.completedSwitches << "/" << switches.jobs
+       << " completed, last " << switches.lastSwitchMs << " ms, avg " << switches.avgSwitchMs
+       << " ms, max " << switches.maxSwitchMs << " ms\n"
+       << "  Replayed shares for superseded jobs: " << replay.sharesStale << "/" << replay.sharesSubmitted << "\n";
+    MiningStats::StaleWorkStats stale = MiningStats::getStaleWork();
+    ss << "  Stale work: " << stale.stalePercent() << "% (" << stale.staleHashes << "/" << stale.hashes
+       << " hashes), stale shares " << stale.staleShares << "/" << stale.shares
+       << ", rejected as stale " << stale.staleRejects;
+    for (int i = 0; i < config.numThreads; i++) {
+        MiningStats::StaleWorkStats thread = MiningStats::getStaleWork(i);
+        ss << "\n    Thread " << i << ": " << thread.stalePercent() << "% (" << thread.staleHashes << "/"
+           << thread.hashes << " hashes), stale shares " << thread.staleShares << "/" << thread.shares;
+    }
+    threadSafePrint(ss.str(), true);
+}
+
 void miningThread(int threadId) {
     try {
         threadSafePrint("Starting mining thread " + std::to_string(threadId), true);
@@ -113,40 +188,84 @@ void miningThread(int threadId) {
             return;
         }
 
+        // Pin before the VM is created, so its memory is allocated on the thread's node
+        if (threadId < static_cast<int>(miningThreadCpus.size()) &&
+            !CpuTopology::pinCurrentThread(miningThreadCpus[threadId])) {
+            threadSafePrint("Could not pin thread " + std::to_string(threadId) + " to CPU " +
+                std::to_string(miningThreadCpus[threadId]), true);
+        }
+
         // Initialize VM
         if (!data->initializeVM()) {
             threadSafePrint("Failed to initialize VM for thread " + std::to_string(threadId), true);
             return;
         }
+        PerfCounters::openThread(threadId);
 
         // Main mining loop
+        uint64_t jobSequence = 0;  // Sequence of the job this thread last hashed
         while (!shouldStop) {
             try {
-                // Get current job
-                Job* currentJob = nullptr;
+                // Paused, or beyond the thread count set through the HTTP API
+                if (miningPaused.load(std::memory_order_relaxed) ||
+                    threadId >= activeThreads.load(std::memory_order_relaxed)) {
+                    jobSequence = 0;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                    continue;
+                }
+
+                // Hash for a split endpoint during the slices the scheduler gives it this thread
+                int endpoint = SplitMining::endpointFor(threadId);
+                if (endpoint != 0) {
+                    SplitMining::Work work;
+                    if (!SplitMining::getWork(endpoint, work)) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                        continue;
+                    }
+                    jobSequence = 0;  // The next main pool hash follows no main pool work, so it cannot be stale
+                    bool found = data->calculateHash(work.job->getBlobBytes(), work.nonce, work.job->getTarget());
+                    data->incrementHashCount();
+                    SplitMining::recordHash(threadId, endpoint, work.job->sequence);
+                    if (found) {
+                        data->submitShare(work.job->getJobId(), work.nonce, RandomXManager::getLastHash(), endpoint);
+                    }
+                    continue;
+                }
+
+                // Copy the current job and claim its next nonce under the lock;
+                // processNewJob replaces the queued job while threads hash
+                Job job;
+                bool haveJob = false;
                 {
                     std::lock_guard<std::mutex> lock(PoolClient::jobMutex);
                     if (!PoolClient::jobQueue.empty()) {
-                        currentJob = &PoolClient::jobQueue.front();
+                        Job& current = PoolClient::jobQueue.front();
+                        job = current;
+                        current.incrementNonce();
+                        haveJob = true;
                     }
                 }
 
-                if (!currentJob) {
+                // Idle once the pool has been gone longer than the job grace period
+                if (!haveJob || !PoolClient::isJobUsable()) {
                     std::this_thread::sleep_for(std::chrono::milliseconds(100));
                     continue;
                 }
 
+                MiningStats::recordHash(threadId, jobSequence, job.sequence);
+
                 // Convert hex blob to bytes
-                std::vector<uint8_t> input = currentJob->getBlobBytes();
+                std::vector<uint8_t> input = job.getBlobBytes();
 
                 // Calculate hash
-                if (data->calculateHash(input, currentJob->getNonce())) {
-                    // Share was found and submitted
-                    data->submitShare(RandomXManager::getLastHash());
+                bool found = data->calculateHash(input, job.getNonce());
+                data->incrementHashCount();
+                SplitMining::recordHash(threadId, 0, jobSequence);
+                if (found) {
+                    // Share was found, submit it
+                    MiningStats::recordShare(threadId, jobSequence);
+                    data->submitShare(job.getJobId(), job.getNonce(), RandomXManager::getLastHash());
                 }
-
-                // Increment nonce
-                currentJob->incrementNonce();
             }
             catch (const std::exception& e) {
                 threadSafePrint("Error in mining thread " + std::to_string(threadId) + 
@@ -343,7 +462,7 @@ std::string sendAndReceive(SOCKET sock, const std::string& payload) {
     timeout.tv_usec = 0;
 
     // Wait for data with timeout
-    int result = select(0, &readSet, nullptr, nullptr, &timeout);
+    int result = select(static_cast<int>(sock) + 1, &readSet, nullptr, nullptr, &timeout);
     if (result == 0) {
         threadSafePrint("Timeout waiting for response", true);
         return "";
@@ -502,6 +621,89 @@ bool loadConfig() {
                 if (obj.find("logFileName") != obj.end()) {
                     config.logFileName = obj.at("logFileName").get<std::string>();
                 }
+                if (obj.find("jobTimeoutSec") != obj.end()) {
+                    config.jobTimeoutSec = static_cast<int>(obj.at("jobTimeoutSec").get<double>());
+                }
+                if (obj.find("keepaliveSec") != obj.end()) {
+                    config.keepaliveSec = static_cast<int>(obj.at("keepaliveSec").get<double>());
+                }
+                if (obj.find("idleTimeoutSec") != obj.end()) {
+                    config.idleTimeoutSec = static_cast<int>(obj.at("idleTimeoutSec").get<double>());
+                }
+                if (obj.find("jobGraceSec") != obj.end()) {
+                    config.jobGraceSec = static_cast<int>(obj.at("jobGraceSec").get<double>());
+                }
+                if (obj.find("shareJournal") != obj.end()) {
+                    config.shareJournalFile = obj.at("shareJournal").get<std::string>();
+                }
+                if (obj.find("proxy") != obj.end()) {
+                    config.proxyMode = obj.at("proxy").get<bool>();
+                }
+                if (obj.find("proxyBind") != obj.end()) {
+                    config.proxyBindAddress = obj.at("proxyBind").get<std::string>();
+                }
+                if (obj.find("proxyPort") != obj.end()) {
+                    config.proxyPort = static_cast<int>(obj.at("proxyPort").get<double>());
+                }
+                if (obj.find("proxyVerifyThreads") != obj.end()) {
+                    config.proxyVerifyThreads = static_cast<int>(obj.at("proxyVerifyThreads").get<double>());
+                }
+                if (obj.find("proxyShareInterval") != obj.end()) {
+                    config.proxyShareInterval = static_cast<int>(obj.at("proxyShareInterval").get<double>());
+                }
+                if (obj.find("capture") != obj.end()) {
+                    config.captureFile = obj.at("capture").get<std::string>();
+                }
+                if (obj.find("daemon") != obj.end()) {
+                    config.daemonAddress = obj.at("daemon").get<std::string>();
+                }
+                if (obj.find("daemonZmq") != obj.end()) {
+                    config.daemonZmqAddress = obj.at("daemonZmq").get<std::string>();
+                }
+                if (obj.find("apiPort") != obj.end()) {
+                    config.apiPort = static_cast<int>(obj.at("apiPort").get<double>());
+                }
+                if (obj.find("apiBind") != obj.end()) {
+                    config.apiBindAddress = obj.at("apiBind").get<std::string>();
+                }
+                if (obj.find("apiToken") != obj.end()) {
+                    config.apiToken = obj.at("apiToken").get<std::string>();
+                }
+                if (obj.find("perfCounters") != obj.end()) {
+                    config.perfCounters = obj.at("perfCounters").get<bool>();
+                }
+                if (obj.find("affinity") != obj.end()) {
+                    config.affinity = obj.at("affinity").get<std::string>();
+                }
+                // Weighted endpoints: [{"address": "host", "port": 3333, "weight": 30, "wallet": "..."}, ...]
+                if (obj.find("splits") != obj.end() && obj.at("splits").is<picojson::array>()) {
+                    for (const auto& item : obj.at("splits").get<picojson::array>()) {
+                        const picojson::object& splitObj = item.get<picojson::object>();
+                        std::string spec = splitObj.at("address").get<std::string>() + ":" +
+                            std::to_string(static_cast<int>(splitObj.at("port").get<double>())) + "," +
+                            std::to_string(static_cast<int>(splitObj.at("weight").get<double>()));
+                        if (splitObj.find("wallet") != splitObj.end()) {
+                            spec += "," + splitObj.at("wallet").get<std::string>();
+                            if (splitObj.find("worker") != splitObj.end()) {
+                                spec += "," + splitObj.at("worker").get<std::string>();
+                            }
+                        }
+                        config.addSplit(spec);
+                    }
+                }
+                // Failover list: [{"address": "host", "port": 3333, "priority": 0}, ...]
+                if (obj.find("pools") != obj.end() && obj.at("pools").is<picojson::array>()) {
+                    const picojson::array& pools = obj.at("pools").get<picojson::array>();
+                    for (size_t i = 0; i < pools.size(); i++) {
+                        const picojson::object& poolObj = pools[i].get<picojson::object>();
+                        int priority = static_cast<int>(i);
+                        if (poolObj.find("priority") != poolObj.end()) {
+                            priority = static_cast<int>(poolObj.at("priority").get<double>());
+                        }
+                        config.addPool(poolObj.at("address").get<std::string>() + ":" +
+                            std::to_string(static_cast<int>(poolObj.at("port").get<double>())), priority);
+                    }
+                }
                 
                 file.close();
                 return true;
@@ -525,11 +727,17 @@ int main(int argc, char* argv[]) {
             printHelp();
             return 0;
         }
+        if (strcmp(argv[i], "--dump-journal") == 0 && i + 1 < argc) {
+            return ShareJournal::dump(argv[i + 1], std::cout) ? 0 : 1;
+        }
     }
 
+    // Console output goes through the async logger from here on
+    Logger::start();
+    std::atexit(Logger::stop);
+
     // Initialize Winsock
-    WSADATA wsaData;
-    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+    if (!startSockets()) {
         std::cerr << "Failed to initialize Winsock" << std::endl;
         return 1;
     }
@@ -537,11 +745,13 @@ int main(int argc, char* argv[]) {
     // Load configuration
     if (!loadConfig()) {
         std::cerr << "Failed to load configuration" << std::endl;
-        WSACleanup();
+        stopSockets();
         return 1;
     }
 
     // Parse command line arguments
+    bool cliPools = false;
+    bool cliSplits = false;
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
         if (arg == "--debug") {
@@ -551,7 +761,106 @@ int main(int argc, char* argv[]) {
             config.numThreads = std::stoi(argv[++i]);
         }
         else if (arg == "--pool" && i + 1 < argc) {
-            config.poolAddress = argv[++i];
+            // Pools given on the command line replace the config.json list
+            if (!cliPools) {
+                config.pools.clear();
+                cliPools = true;
+            }
+            if (!config.addPool(argv[++i], static_cast<int>(config.pools.size()))) {
+                stopSockets();
+                return 1;
+            }
+        }
+        else if (arg == "--job-timeout" && i + 1 < argc) {
+            config.jobTimeoutSec = std::stoi(argv[++i]);
+        }
+        else if (arg == "--keepalive" && i + 1 < argc) {
+            config.keepaliveSec = std::stoi(argv[++i]);
+        }
+        else if (arg == "--idle-timeout" && i + 1 < argc) {
+            config.idleTimeoutSec = std::stoi(argv[++i]);
+        }
+        else if (arg == "--job-grace" && i + 1 < argc) {
+            config.jobGraceSec = std::stoi(argv[++i]);
+        }
+        else if (arg == "--share-journal" && i + 1 < argc) {
+            config.shareJournalFile = argv[++i];
+        }
+        else if (arg == "--no-share-journal") {
+            config.shareJournalFile.clear();
+        }
+        else if (arg == "--proxy") {
+            config.proxyMode = true;
+        }
+        else if (arg == "--proxy-bind" && i + 1 < argc) {
+            config.proxyBindAddress = argv[++i];
+        }
+        else if (arg == "--proxy-port" && i + 1 < argc) {
+            config.proxyPort = std::stoi(argv[++i]);
+        }
+        else if (arg == "--proxy-verify-threads" && i + 1 < argc) {
+            config.proxyVerifyThreads = std::stoi(argv[++i]);
+        }
+        else if (arg == "--proxy-share-interval" && i + 1 < argc) {
+            config.proxyShareInterval = std::stoi(argv[++i]);
+        }
+        else if (arg == "--capture" && i + 1 < argc) {
+            config.captureFile = argv[++i];
+        }
+        else if (arg == "--replay" && i + 1 < argc) {
+            config.replayFile = argv[++i];
+        }
+        else if (arg == "--replay-speed" && i + 1 < argc) {
+            config.replaySpeed = std::stod(argv[++i]);
+        }
+        else if (arg == "--daemon" && i + 1 < argc) {
+            config.daemonAddress = argv[++i];
+        }
+        else if (arg == "--daemon-zmq" && i + 1 < argc) {
+            config.daemonZmqAddress = argv[++i];
+        }
+        else if (arg == "--split" && i + 1 < argc) {
+            // Splits given on the command line replace the config.json list
+            if (!cliSplits) {
+                config.splits.clear();
+                cliSplits = true;
+            }
+            if (!config.addSplit(argv[++i])) {
+                stopSockets();
+                return 1;
+            }
+        }
+        else if (arg == "--api-port" && i + 1 < argc) {
+            config.apiPort = std::stoi(argv[++i]);
+        }
+        else if (arg == "--api-bind" && i + 1 < argc) {
+            config.apiBindAddress = argv[++i];
+        }
+        else if (arg == "--api-token" && i + 1 < argc) {
+            config.apiToken = argv[++i];
+        }
+        else if (arg == "--perf-counters") {
+            config.perfCounters = true;
+        }
+        else if (arg == "--benchmark" && i + 1 < argc) {
+            if (!Benchmark::parseCount(argv[++i], config.benchmarkHashes)) {
+                std::cerr << "Invalid benchmark hash count: " << argv[i] << std::endl;
+                stopSockets();
+                return 1;
+            }
+        }
+        else if (arg == "--benchmark-json" && i + 1 < argc) {
+            config.benchmarkJsonFile = argv[++i];
+        }
+        else if (arg == "--bench-scaling" && i + 1 < argc) {
+            if (!Benchmark::parseCount(argv[++i], config.benchScalingHashes)) {
+                std::cerr << "Invalid hashes per thread: " << argv[i] << std::endl;
+                stopSockets();
+                return 1;
+            }
+        }
+        else if (arg == "--affinity" && i + 1 < argc) {
+            config.affinity = argv[++i];
         }
         else if (arg == "--wallet" && i + 1 < argc) {
             config.walletAddress = argv[++i];
@@ -569,26 +878,96 @@ int main(int argc, char* argv[]) {
         else if (arg != "--help" && arg != "-h") {
             std::cerr << "Unknown argument: " << arg << std::endl;
             printHelp();
-            WSACleanup();
+            stopSockets();
+            return 1;
+        }
+    }
+
+    // Replay mode: a recorded session stands in for the pool on a loopback port.
+    // Its shares are not real, so they are not journaled.
+    if (!config.replayFile.empty()) {
+        int replayPort = 0;
+        if (config.replaySpeed <= 0.0) {
+            std::cerr << "Replay speed must be positive" << std::endl;
+            stopSockets();
+            return 1;
+        }
+        if (!StratumReplay::start(config.replayFile, config.replaySpeed, replayPort)) {
+            stopSockets();
             return 1;
         }
+        config.pools.clear();
+        config.addPool("127.0.0.1:" + std::to_string(replayPort), 0);
+        config.shareJournalFile.clear();
+        config.daemonAddress.clear();
+        config.splits.clear();
+    }
+
+    if (config.useLogFile) {
+        Logger::openFile(config.logFileName);
+    }
+
+    CpuTopology::Policy affinity;
+    if (!CpuTopology::parsePolicy(config.affinity, affinity)) {
+        std::cerr << "Unknown affinity policy: " << config.affinity << " (none, cores or compact)" << std::endl;
+        stopSockets();
+        return 1;
+    }
+
+    // Package and DRAM power next to the hashrate, where RAPL is readable
+    EnergyMeter::start();
+
+    // Benchmark modes: a fixed job hashed offline, no pool involved
+    if (config.benchScalingHashes > 0) {
+        bool scalingOk = Benchmark::runScaling(config.benchScalingHashes, config.numThreads > 1 ? config.numThreads : 0,
+                                               config.benchmarkJsonFile);
+        stopSockets();
+        return scalingOk ? 0 : 1;
+    }
+    if (config.benchmarkHashes > 0) {
+        bool benchmarkOk = Benchmark::run(config.benchmarkHashes, config.numThreads, affinity, config.benchmarkJsonFile);
+        stopSockets();
+        return benchmarkOk ? 0 : 1;
     }
 
     // Print current configuration
     config.printConfig();
 
-    // Connect to pool
-    if (!PoolClient::connect(config.poolAddress, std::to_string(config.poolPort))) {
-        std::cerr << "Failed to connect to pool" << std::endl;
+    // Journal failures are not fatal; shares are still submitted without it
+    if (!config.shareJournalFile.empty()) {
+        ShareJournal::open(config.shareJournalFile);
+    }
+    if (!config.captureFile.empty()) {
+        StratumCapture::open(config.captureFile);
+    }
+
+    if (config.proxyMode) {
+        PoolClient::setJobHandler(StratumProxy::onUpstreamJob);
+    }
+
+    // Connect and login to the best reachable pool, or get work from the daemon when solo mining
+    bool daemonMode = !config.daemonAddress.empty();
+    void (*jobListener)() = daemonMode ? DaemonClient::jobListener : PoolClient::jobListener;
+    if (daemonMode ? !DaemonClient::start() : !PoolClient::connectToPools(config.getPoolList())) {
+        std::cerr << (daemonMode ? "Failed to get work from the daemon" : "Failed to connect to any pool") << std::endl;
         PoolClient::cleanup();
+        ShareJournal::close();
+        StratumCapture::close();
+        StratumReplay::stop();
         return 1;
     }
 
-    // Login to pool
-    if (!PoolClient::login(config.walletAddress, config.password, config.workerName, config.userAgent)) {
-        std::cerr << "Failed to login to pool" << std::endl;
+    // Proxy mode: relay the upstream session to downstream miners, no local mining
+    if (config.proxyMode) {
+        std::thread jobListenerThread(jobListener);
+        bool proxyOk = StratumProxy::run(config.proxyBindAddress, config.proxyPort);
+        PoolClient::shouldStop = true;
+        jobListenerThread.join();
         PoolClient::cleanup();
-        return 1;
+        ShareJournal::close();
+        StratumCapture::close();
+        StratumReplay::stop();
+        return proxyOk ? 0 : 1;
     }
 
     // Initialize thread data
@@ -603,26 +982,68 @@ int main(int argc, char* argv[]) {
             }
             threadData.clear();
             PoolClient::cleanup();
+            ShareJournal::close();
+            StratumCapture::close();
+            StratumReplay::stop();
             return 1;
         }
     }
 
+    MiningStats::initializeStats(config);
+    MiningStats::threadData = threadData;
+    activeThreads = config.numThreads;
+    if (config.perfCounters) {
+        PerfCounters::start(config.numThreads);
+    }
+
+    // Weighted split endpoints get their own sessions and a share of the threads
+    SplitMining::start();
+
     // Start job listener thread
-    std::thread jobListenerThread(PoolClient::jobListener);
+    std::thread jobListenerThread(jobListener);
+    std::thread statsThread(MiningStats::globalStatsMonitor);
+
+    // The stats and control API is optional; mining goes on without it
+    if (config.apiPort > 0 && !HttpApi::start(config.apiBindAddress, config.apiPort)) {
+        threadSafePrint("HTTP API disabled", true);
+    }
 
     // Start mining threads
+    miningThreadCpus = CpuTopology::plan(affinity, config.numThreads);
     std::vector<std::thread> miningThreads;
     for (int i = 0; i < config.numThreads; i++) {
         miningThreads.emplace_back(miningThread, i);
     }
 
+    // A replay ends the run once the recorded session has been played out
+    std::thread replayWatcher;
+    if (!config.replayFile.empty()) {
+        replayWatcher = std::thread([]() {
+            while (!shouldStop && !StratumReplay::isFinished()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            shouldStop = true;
+            PoolClient::shouldStop = true;
+        });
+    }
+
     // Wait for mining threads to complete
     for (auto& thread : miningThreads) {
         thread.join();
     }
     
+    HttpApi::stop();
+
     // Wait for job listener thread
     jobListenerThread.join();
+    SplitMining::stop();
+    MiningStats::stopStatsMonitor();
+    statsThread.join();
+    PerfCounters::stop();
+    if (replayWatcher.joinable()) {
+        replayWatcher.join();
+        printReplayReport();
+    }
 
     // Cleanup
     for (auto* data : threadData) {
@@ -630,5 +1051,8 @@ int main(int argc, char* argv[]) {
     }
     threadData.clear();
     PoolClient::cleanup();
+    ShareJournal::close();
+    StratumCapture::close();
+    StratumReplay::stop();
     return 0;
 } 
\ No newline at end of file
@@ -6,8 +6,7 @@
 #include "MiningThreadData.h"
 #include "Job.h"
 #include "Config.h"
-#include <WinSock2.h>
-#include <WS2tcpip.h>
+#include "Sockets.h"
 #include <queue>
 #include <atomic>
 #include <mutex>
@@ -0,0 +1,257 @@
+#include "PerfCounters.h"
+#include "MiningThreadData.h"
+#include "Utils.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <fstream>
+#endif
+
+namespace PerfCounters {
+    enum Event { CYCLES, INSTRUCTIONS, LLC_MISSES, DTLB_MISSES, PAGE_FAULTS, EVENT_COUNT };
+
+    struct Reading {
+        double counts[EVENT_COUNT] = {};
+        uint64_t hashes = 0;
+        std::chrono::steady_clock::time_point time;
+    };
+
+    struct ThreadCounters {
+        int fds[EVENT_COUNT] = { -1, -1, -1, -1, -1 };
+        std::atomic<bool> opened{false};   // fds are set; published by the mining thread
+        Reading last;                      // Previous update, guarded by ratesMutex
+        ThreadRates rates;                 // Guarded by ratesMutex
+    };
+
+    static std::unique_ptr<ThreadCounters[]> counters;
+    static int threadCount = 0;
+    static std::atomic<bool> active(false);
+    static std::atomic<bool> missingLogged(false);
+    static std::mutex ratesMutex;
+
+#ifdef __linux__
+    static const char* EVENT_NAMES[EVENT_COUNT] = { "cycles", "instructions", "LLC misses", "dTLB misses", "page faults" };
+
+    static void describe(Event event, perf_event_attr& attr) {
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.exclude_kernel = 1;   // Allowed up to perf_event_paranoid 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        switch (event) {
+            case CYCLES:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case INSTRUCTIONS:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case LLC_MISSES:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                              (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                break;
+            case DTLB_MISSES:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                              (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                break;
+            default:
+                attr.type = PERF_TYPE_SOFTWARE;
+                attr.config = PERF_COUNT_SW_PAGE_FAULTS;
+                break;
+        }
+    }
+
+    static int paranoidLevel() {
+        std::ifstream file("/proc/sys/kernel/perf_event_paranoid");
+        int level = -1;
+        file >> level;
+        return level;
+    }
+
+    // Value scaled up for the time the kernel multiplexed the counter off the PMU
+    static bool readCounter(int fd, double& value) {
+        uint64_t data[3];
+        if (read(fd, data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0) {
+            return false;
+        }
+        value = static_cast<double>(data[0]) * (static_cast<double>(data[1]) / static_cast<double>(data[2]));
+        return true;
+    }
+#endif
+
+    bool start(int threads) {
+#ifdef __linux__
+        counters.reset(new ThreadCounters[threads]);
+        threadCount = threads;
+        active = true;
+        return true;
+#else
+        (void)threads;
+        threadSafePrint("Performance counters need Linux perf_event_open, continuing without them", true);
+        return false;
+#endif
+    }
+
+    void stop() {
+        if (!active.exchange(false)) {
+            return;
+        }
+#ifdef __linux__
+        std::lock_guard<std::mutex> lock(ratesMutex);
+        for (int t = 0; t < threadCount; t++) {
+            for (int& fd : counters[t].fds) {
+                if (fd >= 0) {
+                    close(fd);
+                    fd = -1;
+                }
+            }
+        }
+#endif
+    }
+
+    bool isActive() {
+        return active;
+    }
+
+    void openThread(int threadId) {
+#ifdef __linux__
+        if (!active || threadId < 0 || threadId >= threadCount) {
+            return;
+        }
+        ThreadCounters& thread = counters[threadId];
+        std::string missing, reason;
+        bool refused = false;
+        bool any = false;
+        for (int e = 0; e < EVENT_COUNT; e++) {
+            perf_event_attr attr;
+            describe(static_cast<Event>(e), attr);
+            // pid 0, cpu -1: this thread, wherever it runs
+            thread.fds[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (thread.fds[e] >= 0) {
+                any = true;
+                continue;
+            }
+            refused = refused || errno == EACCES || errno == EPERM;
+            // ENOENT is the kernel's "no such event": no PMU, as in most virtual machines
+            reason = errno == ENOENT || errno == EOPNOTSUPP || errno == ENODEV ?
+                "not supported by this CPU or hypervisor" : strerror(errno);
+            missing += (missing.empty() ? "" : ", ") + std::string(EVENT_NAMES[e]);
+        }
+        thread.opened.store(true, std::memory_order_release);
+
+        // Every thread gets the same answer from the kernel; say it once
+        if (missing.empty() || missingLogged.exchange(true)) {
+            return;
+        }
+        if (refused) {
+            reason = "perf_event_paranoid is " + std::to_string(paranoidLevel()) +
+                "; set kernel.perf_event_paranoid to 2 or lower, or grant CAP_PERFMON";
+        }
+        threadSafePrint("Performance counters " + std::string(any ? "without " + missing : "unavailable") +
+            " (" + reason + ")" + (any ? "" : ", continuing without them"), true);
+#else
+        (void)threadId;
+#endif
+    }
+
+    void update(const std::vector<MiningThreadData*>& threads) {
+#ifdef __linux__
+        if (!active) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(ratesMutex);
+        auto now = std::chrono::steady_clock::now();
+        for (const auto* data : threads) {
+            if (!data || data->getThreadId() >= threadCount) continue;
+            ThreadCounters& thread = counters[data->getThreadId()];
+            if (!thread.opened.load(std::memory_order_acquire)) continue;
+
+            Reading reading;
+            reading.time = now;
+            reading.hashes = data->getTotalHashCount();
+            bool has[EVENT_COUNT] = {};
+            for (int e = 0; e < EVENT_COUNT; e++) {
+                has[e] = thread.fds[e] >= 0 && readCounter(thread.fds[e], reading.counts[e]);
+            }
+
+            // Rates need a previous reading; the first update only records one
+            if (thread.last.time != std::chrono::steady_clock::time_point()) {
+                double seconds = std::chrono::duration<double>(now - thread.last.time).count();
+                double hashes = static_cast<double>(reading.hashes - thread.last.hashes);
+                double delta[EVENT_COUNT];
+                for (int e = 0; e < EVENT_COUNT; e++) {
+                    delta[e] = reading.counts[e] - thread.last.counts[e];
+                }
+                ThreadRates rates;
+                rates.hasCycles = has[CYCLES];
+                rates.hasInstructions = has[INSTRUCTIONS];
+                rates.hasLlcMisses = has[LLC_MISSES];
+                rates.hasDtlbMisses = has[DTLB_MISSES];
+                rates.hasPageFaults = has[PAGE_FAULTS];
+                rates.available = has[CYCLES] || has[INSTRUCTIONS] || has[LLC_MISSES] || has[DTLB_MISSES] || has[PAGE_FAULTS];
+                if (seconds > 0.0) {
+                    rates.ghz = delta[CYCLES] / seconds / 1e9;
+                    rates.pageFaultsPerSec = delta[PAGE_FAULTS] / seconds;
+                }
+                if (delta[CYCLES] > 0.0) {
+                    rates.ipc = delta[INSTRUCTIONS] / delta[CYCLES];
+                }
+                if (hashes > 0.0) {
+                    rates.llcMissesPerHash = delta[LLC_MISSES] / hashes;
+                    rates.dtlbMissesPerHash = delta[DTLB_MISSES] / hashes;
+                }
+                thread.rates = rates;
+            }
+            thread.last = reading;
+        }
+#else
+        (void)threads;
+#endif
+    }
+
+    ThreadRates getRates(int threadId) {
+        std::lock_guard<std::mutex> lock(ratesMutex);
+        if (!active || threadId < 0 || threadId >= threadCount) {
+            return ThreadRates();
+        }
+        return counters[threadId].rates;
+    }
+
+    std::string summary(const ThreadRates& rates) {
+        std::stringstream ss;
+        ss << std::fixed;
+        const char* separator = "";
+        if (rates.hasCycles && rates.hasInstructions) {
+            ss << "IPC " << std::setprecision(2) << rates.ipc;
+            separator = " | ";
+        }
+        if (rates.hasCycles) {
+            ss << separator << std::setprecision(2) << rates.ghz << " GHz";
+            separator = " | ";
+        }
+        if (rates.hasLlcMisses) {
+            ss << separator << "LLC miss/hash " << std::setprecision(0) << rates.llcMissesPerHash;
+            separator = " | ";
+        }
+        if (rates.hasDtlbMisses) {
+            ss << separator << "dTLB miss/hash " << std::setprecision(0) << rates.dtlbMissesPerHash;
+            separator = " | ";
+        }
+        if (rates.hasPageFaults) {
+            ss << separator << "faults/s " << std::setprecision(1) << rates.pageFaultsPerSec;
+        }
+        return ss.str();
+    }
+}
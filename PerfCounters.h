@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+class MiningThreadData;
+
+// Hardware performance counters per mining thread (--perf-counters), from
+// perf_event_open on Linux: cycles, instructions, LLC and dTLB load misses and
+// page faults, user space only. They show whether huge pages, affinity and NUMA
+// placement work on a box without an external perf session. Each mining thread
+// opens its own counters; events the CPU, hypervisor or perf_event_paranoid
+// refuse are left out, and with none left the feature switches itself off.
+namespace PerfCounters {
+    struct ThreadRates {
+        bool available = false;
+        bool hasCycles = false, hasInstructions = false, hasLlcMisses = false,
+             hasDtlbMisses = false, hasPageFaults = false;
+        double ghz = 0.0;                // Cycles per second while the thread ran, in GHz
+        double ipc = 0.0;                // Instructions per cycle
+        double llcMissesPerHash = 0.0;
+        double dtlbMissesPerHash = 0.0;
+        double pageFaultsPerSec = 0.0;
+    };
+
+    bool start(int threads);         // Before the mining threads start; false if unsupported here
+    void stop();                     // After the mining threads have joined
+    bool isActive();
+
+    void openThread(int threadId);   // From the mining thread itself
+
+    // Reads every thread's counters and works out rates over the interval since
+    // the previous update; called by the stats monitor each period
+    void update(const std::vector<MiningThreadData*>& threads);
+    ThreadRates getRates(int threadId);
+
+    // "IPC 1.23 | 3.1 GHz | LLC miss/hash 412 | dTLB miss/hash 35 | faults/s 0"
+    std::string summary(const ThreadRates& rates);
+}
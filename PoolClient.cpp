@@ -6,15 +6,27 @@
 #include "RandomXManager.h"
 #include "MiningThreadData.h"
 #include "Job.h"
+#include "HexCodec.h"
+#include "ShareJournal.h"
+#include "StratumCapture.h"
+#include "MiningStats.h"
+#include "Connector.h"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <chrono>
 #include <thread>
 #include <cstring>
-#include <ws2tcpip.h>
+#include <future>
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <unordered_map>
+#include "Sockets.h"
+#ifdef _WIN32
+#include <mstcpip.h>
+#endif
 #include "picojson.h"
-#pragma comment(lib, "ws2_32.lib")
 
 using namespace picojson;
 
@@ -33,77 +45,218 @@ namespace PoolClient {
     std::mutex socketMutex;
     std::mutex submitMutex;
     std::string poolId;
+    std::vector<PoolEndpoint> poolList;
+    std::vector<PoolHealth> poolHealth;
+    std::atomic<int> activePool(-1);
+    std::mutex healthMutex;
+    static std::vector<PoolLatency> poolLatency;                              // Guarded by healthMutex
+    static std::vector<std::chrono::steady_clock::time_point> lastJobArrival;  // Per pool, this session; guarded by healthMutex
 
     // Forward declarations
     bool sendRequest(const std::string& request);
-    void processNewJob(const picojson::object& jobObj);
 
-    std::string receiveData(SOCKET socket) {
-        if (socket == INVALID_SOCKET) {
-            threadSafePrint("Invalid socket");
-            return "";
+    // A logged-in connection to the next best pool, kept warm for failover
+    struct StandbyConnection {
+        int pool = -1;
+        SOCKET socket = INVALID_SOCKET;
+        std::string poolId;
+        std::string recvBuffer;
+        picojson::object lastJob;
+        bool hasJob = false;
+        std::chrono::steady_clock::time_point lastReceiveTime;
+        std::chrono::steady_clock::time_point keepaliveSentTime;
+    };
+
+    static StandbyConnection standby;
+    static std::future<StandbyConnection> standbyPending;
+    static std::chrono::steady_clock::time_point lastStandbyAttempt;
+    static std::string recvBuffer;  // Partial line data from the active connection
+    static std::chrono::steady_clock::time_point lastReceiveTime;   // Last data from the active pool
+    static std::chrono::steady_clock::time_point keepaliveSentTime;
+
+    // Connection state for the job grace period; disconnectedSince is a steady_clock tick count
+    static std::atomic<bool> connected(false);
+    static std::atomic<std::chrono::steady_clock::rep> disconnectedSince(0);
+    static int reconnectAttempts = 0;
+    static std::mt19937 backoffRng(std::random_device{}());
+
+    // Shares that could not be delivered, replayed after reconnecting if their
+    // job is still current
+    struct PendingShare {
+        uint32_t shareId = 0;  // Share journal id
+        int pool = -1;
+        std::string jobId;
+        std::string nonce;
+        std::string result;
+        std::string algo;
+        std::chrono::steady_clock::time_point foundTime;
+    };
+    static std::deque<PendingShare> pendingShares;  // Guarded by submitMutex
+    static std::future<void> resubmitPending;
+    static std::atomic<uint64_t> lostShares(0);
+
+    // Job id of the job being mined and the pool that sent it, guarded by jobMutex
+    static std::string currentJobId;
+    static int currentJobPool = -1;
+    static std::function<void(const Job&)> jobHandler;
+    static SubmitHandler submitHandler;  // Set when a non-pool work source is used
+
+    // Submit responses are read by the job listener and handed to the waiting
+    // submitter by request id
+    struct SubmitWaiter {
+        bool done = false;
+        std::string response;
+        std::chrono::steady_clock::time_point receivedAt;
+    };
+    static std::unordered_map<uint64_t, std::shared_ptr<SubmitWaiter>> submitWaiters;
+    static std::mutex submitWaitersMutex;
+    static std::condition_variable submitResponseCV;
+
+    static void resubmitQueuedShares();
+    static void journalShare(ShareJournal::RecordType type, const PendingShare& share,
+                             ShareJournal::LostReason reason);
+    static bool deliverResponse(uint64_t id, const std::string& response,
+                                std::chrono::steady_clock::time_point receivedAt);
+
+    static void setConnected(bool isConnected) {
+        if (connected.exchange(isConnected) && !isConnected) {
+            disconnectedSince = std::chrono::steady_clock::now().time_since_epoch().count();
+            threadSafePrint("Disconnected from pool, mining on last job for up to " +
+                std::to_string(config.jobGraceSec) + " seconds", true);
         }
+    }
 
-        char buffer[4096];
-        std::string messageBuffer;
-        
-        // Wait for data with timeout
-        fd_set readfds;
-        FD_ZERO(&readfds);
-        FD_SET(socket, &readfds);
-        struct timeval tv = { 1, 0 }; // 1 second timeout
-        
-        int status = select(0, &readfds, nullptr, nullptr, &tv);
-        if (status <= 0) {
-            if (status == 0) {
-                // Timeout - no data available
-                return "";
-            }
-            if (WSAGetLastError() == WSAEWOULDBLOCK) {
-                // No data available in non-blocking mode
-                return "";
-            }
-            threadSafePrint("select failed: " + std::to_string(WSAGetLastError()));
-            return "";
+    // Jittered exponential backoff: a random delay in [d/2, d] with d doubling per attempt
+    static std::chrono::milliseconds nextReconnectDelay() {
+        int64_t delay = NetworkConstants::RECONNECT_BACKOFF_BASE_MS;
+        for (int i = 0; i < reconnectAttempts && delay < NetworkConstants::RECONNECT_BACKOFF_MAX_MS; i++) {
+            delay *= 2;
         }
+        delay = (std::min)(delay, static_cast<int64_t>(NetworkConstants::RECONNECT_BACKOFF_MAX_MS));
+        reconnectAttempts++;
+        std::uniform_int_distribution<int64_t> jitter(delay / 2, delay);
+        return std::chrono::milliseconds(jitter(backoffRng));
+    }
 
-        int bytesReceived = recv(socket, buffer, sizeof(buffer) - 1, 0);
-        if (bytesReceived <= 0) {
-            if (bytesReceived == 0) {
-                threadSafePrint("Connection closed by pool");
-            } else if (WSAGetLastError() == WSAEWOULDBLOCK) {
-                // No data available in non-blocking mode
-                return "";
-            } else {
-                threadSafePrint("Error receiving data from pool: " + std::to_string(WSAGetLastError()));
-            }
-            return "";
+    // Sleeps in short steps so shutdown is not delayed by a long backoff
+    static void interruptibleSleep(std::chrono::milliseconds duration) {
+        auto end = std::chrono::steady_clock::now() + duration;
+        while (!shouldStop && std::chrono::steady_clock::now() < end) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
-        buffer[bytesReceived] = '\0';
-        
-        // Add received data to message buffer
-        messageBuffer += buffer;
+    }
+
+    static double msSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
 
-        // Process complete messages (separated by newlines)
-        size_t pos = 0;
-        while ((pos = messageBuffer.find('\n')) != std::string::npos) {
-            std::string message = messageBuffer.substr(0, pos);
-            messageBuffer = messageBuffer.substr(pos + 1);
+    double PoolHealth::rejectRate() const {
+        uint64_t total = acceptedShares + rejectedShares;
+        return total == 0 ? 0.0 : static_cast<double>(rejectedShares) / total;
+    }
 
-            // Skip empty messages
-            if (message.empty()) {
-                continue;
-            }
+    double PoolHealth::lastJobAgeSec() const {
+        if (lastJobTime.time_since_epoch().count() == 0) return -1.0;
+        return msSince(lastJobTime) / 1000.0;
+    }
+
+    double PoolHealth::waitingForWorkSec() const {
+        std::chrono::steady_clock::time_point since = (std::max)(lastJobTime, loginTime);
+        if (since.time_since_epoch().count() == 0) return -1.0;
+        return msSince(since) / 1000.0;
+    }
+
+    // Lower is better. Priority dominates; health only reorders pools of equal priority
+    // unless a pool keeps failing.
+    double PoolHealth::score(int priority) const {
+        return priority * 100.0
+            + rejectRate() * 50.0
+            + (std::min)(connectTimeMs, 5000.0) / 100.0
+            + (std::min)(jobLatencyMs, 5000.0) / 100.0
+            + consecutiveFailures * 150.0;
+    }
+
+    static bool inCooldown(const PoolHealth& health) {
+        if (health.consecutiveFailures == 0) return false;
+        auto elapsed = std::chrono::steady_clock::now() - health.lastFailureTime;
+        return elapsed < std::chrono::seconds(NetworkConstants::POOL_FAILURE_COOLDOWN_SEC);
+    }
+
+    static std::string poolName(int index) {
+        if (index < 0 || index >= static_cast<int>(poolList.size())) return "none";
+        return poolList[index].address + ":" + std::to_string(poolList[index].port);
+    }
 
-            // Remove any trailing carriage return
-            if (!message.empty() && message.back() == '\r') {
-                message.pop_back();
+    // Picks the best pool by health score, skipping 'exclude' and pools in cooldown.
+    // Falls back to pools in cooldown when nothing else is available.
+    static int selectPool(int exclude) {
+        std::lock_guard<std::mutex> lock(healthMutex);
+        int best = -1;
+        int bestCooling = -1;
+        for (int i = 0; i < static_cast<int>(poolList.size()); i++) {
+            if (i == exclude) continue;
+            double score = poolHealth[i].score(poolList[i].priority);
+            if (inCooldown(poolHealth[i])) {
+                if (bestCooling < 0 || score < poolHealth[bestCooling].score(poolList[bestCooling].priority)) {
+                    bestCooling = i;
+                }
+            } else if (best < 0 || score < poolHealth[best].score(poolList[best].priority)) {
+                best = i;
             }
+        }
+        return best >= 0 ? best : bestCooling;
+    }
+
+    static void recordFailure(int index) {
+        if (index < 0) return;
+        std::lock_guard<std::mutex> lock(healthMutex);
+        poolHealth[index].consecutiveFailures++;
+        poolHealth[index].lastFailureTime = std::chrono::steady_clock::now();
+    }
 
-            return message;
+    static void closeSocket(SOCKET& sock) {
+        if (sock != INVALID_SOCKET) {
+            closesocket(sock);
+            sock = INVALID_SOCKET;
         }
-        
-        return "";
+    }
+
+    // Appends received data to 'buffer' and moves every complete line into 'lines'.
+    // Returns false if the connection was closed or failed.
+    bool readLines(SOCKET sock, std::string& buffer, std::vector<std::string>& lines) {
+        char data[NetworkConstants::MAX_RECEIVE_BUFFER];
+        int bytesReceived = recv(sock, data, sizeof(data), 0);
+        if (bytesReceived == 0) {
+            threadSafePrint("Connection closed by pool");
+            return false;
+        }
+        if (bytesReceived < 0) {
+#ifdef _WIN32
+            if (WSAGetLastError() == WSAEWOULDBLOCK) {
+#else
+            if (errno == EWOULDBLOCK || errno == EAGAIN) {
+#endif
+                return true;
+            }
+            threadSafePrint("Error receiving data from pool: " + std::to_string(WSAGetLastError()));
+            return false;
+        }
+        buffer.append(data, bytesReceived);
+
+        size_t start = 0;
+        size_t pos;
+        while ((pos = buffer.find('\n', start)) != std::string::npos) {
+            std::string line = buffer.substr(start, pos - start);
+            start = pos + 1;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (!line.empty()) {
+                lines.push_back(line);
+            }
+        }
+        buffer.erase(0, start);
+        return true;
     }
 
     bool initialize() {
@@ -113,10 +266,9 @@ namespace PoolClient {
         currentSeedHash.clear();
         sessionId.clear();
         currentTargetHex.clear();
-        
+
         // Initialize Winsock
-        WSADATA wsaData;
-        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        if (!startSockets()) {
             threadSafePrint("Failed to initialize Winsock");
             return false;
         }
@@ -124,88 +276,203 @@ namespace PoolClient {
         return true;
     }
 
+    // Shortens OS keepalive timers from the default of hours to seconds so a dead
+    // NAT mapping or peer surfaces as a socket error on the next recv
+    static void configureKeepalive(SOCKET sock) {
+#ifdef _WIN32
+        struct tcp_keepalive keepalive;
+        keepalive.onoff = 1;
+        keepalive.keepalivetime = NetworkConstants::TCP_KEEPALIVE_IDLE_SEC * 1000;
+        keepalive.keepaliveinterval = NetworkConstants::TCP_KEEPALIVE_INTERVAL_SEC * 1000;
+        DWORD bytesReturned = 0;
+        if (WSAIoctl(sock, SIO_KEEPALIVE_VALS, &keepalive, sizeof(keepalive), nullptr, 0,
+                     &bytesReturned, nullptr, nullptr) == SOCKET_ERROR) {
+            threadSafePrint("SIO_KEEPALIVE_VALS failed: " + std::to_string(WSAGetLastError()));
+        }
+#else
+        int idle = NetworkConstants::TCP_KEEPALIVE_IDLE_SEC;
+        int interval = NetworkConstants::TCP_KEEPALIVE_INTERVAL_SEC;
+        int count = NetworkConstants::TCP_KEEPALIVE_COUNT;
+        setsockopt(sock, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle));
+        setsockopt(sock, IPPROTO_TCP, TCP_KEEPINTVL, &interval, sizeof(interval));
+        setsockopt(sock, IPPROTO_TCP, TCP_KEEPCNT, &count, sizeof(count));
+#ifdef TCP_USER_TIMEOUT
+        unsigned int userTimeout = NetworkConstants::TCP_USER_TIMEOUT_MS;
+        setsockopt(sock, IPPROTO_TCP, TCP_USER_TIMEOUT, &userTimeout, sizeof(userTimeout));
+#endif
+#endif
+    }
+
+    // Connects a new socket without touching the active connection
+    static SOCKET openSocket(const std::string& address, const std::string& port, double& connectTimeMs) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<Connector::Attempt> attempts;
+        SOCKET sock = Connector::connect(address, port, attempts);
+        connectTimeMs = msSince(start);
+        if (attempts.size() > 1 || sock == INVALID_SOCKET || config.debugMode) {
+            threadSafePrint("Connect to " + address + ":" + port + ": " +
+                (attempts.empty() ? std::string("no addresses") : Connector::describe(attempts)), true);
+        }
+        if (sock == INVALID_SOCKET) {
+            return INVALID_SOCKET;
+        }
+
+        int optval = 1;
+        if (setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, (char*)&optval, sizeof(optval)) == SOCKET_ERROR) {
+            threadSafePrint("setsockopt SO_KEEPALIVE failed: " + std::to_string(WSAGetLastError()));
+            closeSocket(sock);
+            return INVALID_SOCKET;
+        }
+        configureKeepalive(sock);
+
+        // Set TCP_NODELAY to disable Nagle's algorithm
+        if (setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (char*)&optval, sizeof(optval)) == SOCKET_ERROR) {
+            threadSafePrint("setsockopt TCP_NODELAY failed: " + std::to_string(WSAGetLastError()));
+            closeSocket(sock);
+            return INVALID_SOCKET;
+        }
+        return sock;
+    }
+
     bool connect(const std::string& address, const std::string& port) {
         threadSafePrint("Attempting to connect to " + address + ":" + port, true);
-        
-        // Close existing socket if any
-        if (poolSocket != INVALID_SOCKET) {
-            closesocket(poolSocket);
-            poolSocket = INVALID_SOCKET;
-        }
-
-        struct addrinfo hints = {}, *result = nullptr;
-        hints.ai_family = AF_UNSPEC;
-        hints.ai_socktype = SOCK_STREAM;
-        hints.ai_protocol = IPPROTO_TCP;
-
-        int status = getaddrinfo(address.c_str(), port.c_str(), &hints, &result);
-        if (status != 0) {
-            char errorMsg[256];
-            strcpy_s(errorMsg, gai_strerrorA(status));
-            threadSafePrint("getaddrinfo failed: " + std::string(errorMsg));
+
+        double connectTimeMs = 0.0;
+        SOCKET sock = openSocket(address, port, connectTimeMs);
+        if (sock == INVALID_SOCKET) {
+            threadSafePrint("Failed to connect to any pool address", true);
             return false;
         }
 
-        bool connected = false;
-        // Try each address until we connect
-        for (struct addrinfo* ptr = result; ptr != nullptr; ptr = ptr->ai_next) {
-            // Create socket
-            poolSocket = socket(ptr->ai_family, ptr->ai_socktype, ptr->ai_protocol);
-            if (poolSocket == INVALID_SOCKET) {
-                threadSafePrint("socket failed: " + std::to_string(WSAGetLastError()));
-                continue;
-            }
+        // Replace existing socket if any
+        {
+            std::lock_guard<std::mutex> lock(socketMutex);
+            closeSocket(poolSocket);
+            poolSocket = sock;
+            recvBuffer.clear();
+            lastReceiveTime = std::chrono::steady_clock::now();
+        }
 
-            // Set socket options
-            int optval = 1;
-            if (setsockopt(poolSocket, SOL_SOCKET, SO_KEEPALIVE, (char*)&optval, sizeof(optval)) == SOCKET_ERROR) {
-                threadSafePrint("setsockopt SO_KEEPALIVE failed: " + std::to_string(WSAGetLastError()));
-                closesocket(poolSocket);
-                poolSocket = INVALID_SOCKET;
-                continue;
-            }
+        threadSafePrint("Successfully connected to pool in " + std::to_string(static_cast<int>(connectTimeMs)) + " ms", true);
+        return true;
+    }
 
-            // Set TCP_NODELAY to disable Nagle's algorithm
-            if (setsockopt(poolSocket, IPPROTO_TCP, TCP_NODELAY, (char*)&optval, sizeof(optval)) == SOCKET_ERROR) {
-                threadSafePrint("setsockopt TCP_NODELAY failed: " + std::to_string(WSAGetLastError()));
-                closesocket(poolSocket);
-                poolSocket = INVALID_SOCKET;
-                continue;
-            }
+    // Extracts the session ID and optional job from a login response
+    static bool parseLoginResponse(const std::string& response, std::string& outPoolId,
+                                   picojson::object& outJob, bool& hasJob) {
+        picojson::value v;
+        std::string err = picojson::parse(v, response);
+        if (!err.empty()) {
+            threadSafePrint("JSON parse error: " + err, true);
+            return false;
+        }
 
-            // Connect to server
-            status = ::connect(poolSocket, ptr->ai_addr, static_cast<int>(ptr->ai_addrlen));
-            if (status == SOCKET_ERROR) {
-                int error = WSAGetLastError();
-                threadSafePrint("connect failed: " + std::to_string(error));
-                closesocket(poolSocket);
-                poolSocket = INVALID_SOCKET;
-                continue;
-            }
+        if (!v.is<picojson::object>()) {
+            threadSafePrint("Invalid response format", true);
+            return false;
+        }
 
-            // Verify socket is valid after connection
-            if (poolSocket == INVALID_SOCKET) {
-                threadSafePrint("Socket became invalid after connection");
-                continue;
-            }
+        const picojson::object& responseObj = v.get<picojson::object>();
+        if (responseObj.find("result") == responseObj.end() ||
+            !responseObj.at("result").is<picojson::object>()) {
+            threadSafePrint("Invalid result format", true);
+            return false;
+        }
 
-            // Connection successful
-            connected = true;
-            threadSafePrint("Successfully connected to pool", true);
-            break;
+        const picojson::object& result = responseObj.at("result").get<picojson::object>();
+
+        // Get pool ID
+        if (result.find("id") != result.end() && result.at("id").is<std::string>()) {
+            outPoolId = result.at("id").get<std::string>();
+        } else {
+            threadSafePrint("Warning: No pool ID in login response", true);
+            outPoolId = "1"; // Fallback ID
         }
 
-        freeaddrinfo(result);
-        
-        if (!connected) {
-            threadSafePrint("Failed to connect to any pool address", true);
-            return false;
+        // Get job
+        hasJob = result.find("job") != result.end() && result.at("job").is<picojson::object>();
+        if (hasJob) {
+            outJob = result.at("job").get<picojson::object>();
         }
-        
         return true;
     }
 
-    bool login(const std::string& wallet, const std::string& password, 
+    // Sends a login request on 'sock' and waits for the response line.
+    // Leftover data after the response is kept in 'buffer'. 'capture' records the
+    // exchange in the stratum capture (the active session, not a standby).
+    static bool loginOnSocket(SOCKET sock, std::string& buffer, const std::string& wallet,
+                              const std::string& password, const std::string& worker,
+                              const std::string& userAgent, std::string& outPoolId,
+                              picojson::object& outJob, bool& hasJob, double& latencyMs,
+                              bool capture) {
+        // Create login request
+        picojson::object loginObj;
+        loginObj["id"] = picojson::value(1.0);
+        loginObj["jsonrpc"] = picojson::value("2.0");
+        loginObj["method"] = picojson::value("login");
+
+        picojson::object params;
+        params["agent"] = picojson::value(userAgent);
+        params["login"] = picojson::value(wallet);
+        params["pass"] = picojson::value(password);
+        params["worker"] = picojson::value(worker);
+
+        loginObj["params"] = picojson::value(params);
+
+        std::string request = picojson::value(loginObj).serialize();
+        if (config.debugMode) {
+            threadSafePrint("Sending login request: " + request, true);
+        }
+
+        // Send request
+        if (capture) {
+            StratumCapture::record(StratumCapture::Direction::Sent, request);
+        }
+        auto start = std::chrono::steady_clock::now();
+        std::string fullRequest = request + "\n";
+        int result = send(sock, fullRequest.c_str(), static_cast<int>(fullRequest.length()), 0);
+        if (result == SOCKET_ERROR) {
+            int error = WSAGetLastError();
+            threadSafePrint("Failed to send login request: " + std::to_string(error), true);
+            return false;
+        }
+
+        // Receive response
+        std::vector<std::string> lines;
+        while (lines.empty()) {
+            fd_set readSet;
+            FD_ZERO(&readSet);
+            FD_SET(sock, &readSet);
+            struct timeval timeout = { NetworkConstants::SOCKET_TIMEOUT_SEC, 0 };
+            int status = select(static_cast<int>(sock) + 1, &readSet, nullptr, nullptr, &timeout);
+            if (status <= 0) {
+                threadSafePrint("Timeout waiting for login response", true);
+                return false;
+            }
+            if (!readLines(sock, buffer, lines)) {
+                threadSafePrint("Connection closed by server during login", true);
+                return false;
+            }
+        }
+        latencyMs = msSince(start);
+        if (capture) {
+            StratumCapture::record(StratumCapture::Direction::Received, lines[0]);
+        }
+
+        // Anything after the login response is handled by the job listener
+        std::string pending;
+        for (size_t i = 1; i < lines.size(); i++) {
+            pending += lines[i] + "\n";
+        }
+        buffer = pending + buffer;
+
+        if (config.debugMode) {
+            threadSafePrint("Received login response: " + lines[0], true);
+        }
+        return parseLoginResponse(lines[0], outPoolId, outJob, hasJob);
+    }
+
+    bool login(const std::string& wallet, const std::string& password,
                const std::string& worker, const std::string& userAgent) {
         // Verify socket is valid
         if (poolSocket == INVALID_SOCKET) {
@@ -214,109 +481,399 @@ namespace PoolClient {
         }
 
         try {
-            // Create login request
-            picojson::object loginObj;
-            loginObj["id"] = picojson::value(1.0);
-            loginObj["jsonrpc"] = picojson::value("2.0");
-            loginObj["method"] = picojson::value("login");
-            
-            picojson::object params;
-            params["agent"] = picojson::value(userAgent);
-            params["login"] = picojson::value(wallet);
-            params["pass"] = picojson::value(password);
-            params["worker"] = picojson::value(worker);
-            
-            loginObj["params"] = picojson::value(params);
-            
-            std::string request = picojson::value(loginObj).serialize();
-            threadSafePrint("Sending login request: " + request, true);
-            
-            // Send request
-            std::string fullRequest = request + "\n";
-            int result = send(poolSocket, fullRequest.c_str(), static_cast<int>(fullRequest.length()), 0);
-            if (result == SOCKET_ERROR) {
-                int error = WSAGetLastError();
-                threadSafePrint("Failed to send login request: " + std::to_string(error), true);
+            std::string newPoolId;
+            picojson::object jobObj;
+            bool hasJob = false;
+            double latencyMs = 0.0;
+            if (!loginOnSocket(poolSocket, recvBuffer, wallet, password, worker, userAgent,
+                               newPoolId, jobObj, hasJob, latencyMs, true)) {
                 return false;
             }
 
-            // Receive response
-            char buffer[4096];
-            std::string response;
-            bool complete = false;
-            
-            while (!complete) {
-                int bytesReceived = recv(poolSocket, buffer, sizeof(buffer) - 1, 0);
-                if (bytesReceived == SOCKET_ERROR) {
-                    int error = WSAGetLastError();
-                    threadSafePrint("Failed to receive login response: " + std::to_string(error), true);
-                    return false;
-                }
-                if (bytesReceived == 0) {
-                    threadSafePrint("Connection closed by server during login", true);
-                    return false;
-                }
+            poolId = newPoolId;
+            threadSafePrint("Pool session ID: " + poolId, true);
+            int index = activePool.load();
+            if (index >= 0) {
+                std::lock_guard<std::mutex> lock(healthMutex);
+                poolHealth[index].jobLatencyMs = latencyMs;
+                poolHealth[index].loginTime = std::chrono::steady_clock::now();
+            }
 
-                buffer[bytesReceived] = '\0';
-                response += buffer;
+            // Some pools send the first job as a separate notification
+            if (!hasJob) {
+                threadSafePrint("No job in login response, waiting for job notification", true);
+                return true;
+            }
+            processNewJob(jobObj);
+            if (index >= 0) {
+                std::lock_guard<std::mutex> lock(healthMutex);
+                poolHealth[index].lastJobTime = std::chrono::steady_clock::now();
+            }
+            return true;
+        }
+        catch (const std::exception& e) {
+            threadSafePrint("Login error: " + std::string(e.what()), true);
+            return false;
+        }
+        catch (...) {
+            threadSafePrint("Unknown error during login", true);
+            return false;
+        }
+    }
 
-                // Check if we have a complete JSON response
-                try {
-                    picojson::value v;
-                    std::string err = picojson::parse(v, response);
-                    if (err.empty()) {
-                        complete = true;
-                    }
-                } catch (...) {
-                    // Continue receiving if JSON is incomplete
-                    continue;
-                }
+    // Connects and logs in to pool 'index', making it the active pool
+    static bool activatePool(int index) {
+        const PoolEndpoint& pool = poolList[index];
+        activePool = index;
+        StratumCapture::record(StratumCapture::Direction::Event, "connect " + poolName(index));
+        {
+            std::lock_guard<std::mutex> lock(healthMutex);
+            lastJobArrival[index] = std::chrono::steady_clock::time_point();
+        }
+        if (!connect(pool.address, std::to_string(pool.port))) {
+            recordFailure(index);
+            return false;
+        }
+        if (!login(config.walletAddress, config.password, config.workerName, config.userAgent)) {
+            recordFailure(index);
+            std::lock_guard<std::mutex> lock(socketMutex);
+            closeSocket(poolSocket);
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(healthMutex);
+            poolHealth[index].consecutiveFailures = 0;
+            poolHealth[index].logins++;
+        }
+        setConnected(true);
+        return true;
+    }
+
+    bool connectToPools(const std::vector<PoolEndpoint>& pools) {
+        poolList = pools;
+        poolHealth.assign(pools.size(), PoolHealth());
+        poolLatency.assign(pools.size(), PoolLatency());
+        lastJobArrival.assign(pools.size(), std::chrono::steady_clock::time_point());
+        for (size_t i = 0; i < poolList.size(); i++) {
+            ShareJournal::appendPool(static_cast<uint16_t>(i), poolName(static_cast<int>(i)));
+        }
+
+        // Try every pool once, best first
+        for (size_t attempt = 0; attempt < poolList.size(); attempt++) {
+            int index = selectPool(-1);
+            if (index < 0) break;
+            if (activatePool(index)) {
+                threadSafePrint("Mining on pool " + poolName(index), true);
+                return true;
             }
+        }
+        activePool = -1;
+        return false;
+    }
+
+    // Runs on a worker thread so a slow standby connect never stalls the job listener
+    static StandbyConnection prepareStandby(int index, PoolEndpoint pool) {
+        StandbyConnection conn;
+        conn.pool = index;
+        double connectTimeMs = 0.0;
+        conn.socket = openSocket(pool.address, std::to_string(pool.port), connectTimeMs);
+        if (conn.socket == INVALID_SOCKET) {
+            return conn;
+        }
+
+        conn.lastReceiveTime = std::chrono::steady_clock::now();
+        double latencyMs = 0.0;
+        if (!loginOnSocket(conn.socket, conn.recvBuffer, config.walletAddress, config.password,
+                           config.workerName, config.userAgent, conn.poolId, conn.lastJob,
+                           conn.hasJob, latencyMs, false)) {
+            closeSocket(conn.socket);
+            return conn;
+        }
+
+        std::lock_guard<std::mutex> lock(healthMutex);
+        poolHealth[index].connectTimeMs = connectTimeMs;
+        poolHealth[index].jobLatencyMs = latencyMs;
+        poolHealth[index].loginTime = std::chrono::steady_clock::now();
+        poolHealth[index].logins++;
+        if (conn.hasJob) {
+            poolHealth[index].lastJobTime = std::chrono::steady_clock::now();
+        }
+        return conn;
+    }
+
+    // Switches mining to the standby connection. Returns false if no standby is ready.
+    static bool promoteStandby(const std::string& reason) {
+        if (standby.socket == INVALID_SOCKET || !standby.hasJob) {
+            return false;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        int previous = activePool.load();
+        {
+            std::lock_guard<std::mutex> lock(socketMutex);
+            closeSocket(poolSocket);
+            poolSocket = standby.socket;
+            poolId = standby.poolId;
+            recvBuffer = standby.recvBuffer;
+            activePool = standby.pool;
+            lastReceiveTime = standby.lastReceiveTime;
+            keepaliveSentTime = standby.keepaliveSentTime;
+        }
+        picojson::object job = standby.lastJob;
+        standby = StandbyConnection();
+        {
+            std::lock_guard<std::mutex> lock(healthMutex);
+            lastJobArrival[activePool] = std::chrono::steady_clock::time_point();
+        }
+
+        // The standby's login and jobs were not captured; record its job as if the
+        // pool had just sent it so a replay switches at the same point
+        if (StratumCapture::isOpen()) {
+            StratumCapture::record(StratumCapture::Direction::Event, "switch " + poolName(activePool) + ": " + reason);
+            picojson::object notify;
+            notify["jsonrpc"] = picojson::value("2.0");
+            notify["method"] = picojson::value("job");
+            notify["params"] = picojson::value(job);
+            StratumCapture::record(StratumCapture::Direction::Received, picojson::value(notify).serialize());
+        }
 
-            // Clean up response
-            while (!response.empty() && (response.back() == '\n' || response.back() == '\r')) {
-                response.pop_back();
+        setConnected(true);
+        processNewJob(job);
+        threadSafePrint("Switched from pool " + poolName(previous) + " to " + poolName(activePool) +
+            " (" + reason + ") in " + std::to_string(static_cast<int>(msSince(start))) + " ms", true);
+        return true;
+    }
+
+    // Drops the active connection and moves to the standby or next best pool
+    static void failover(const std::string& reason) {
+        int failed = activePool.load();
+
+        // Detection latency: how long the connection had been silent when we gave up on it
+        double detectionMs = msSince(lastReceiveTime);
+        if (failed >= 0) {
+            std::lock_guard<std::mutex> lock(healthMutex);
+            PoolHealth& health = poolHealth[failed];
+            health.deadConnections++;
+            health.lastDetectionMs = detectionMs;
+            health.maxDetectionMs = (std::max)(health.maxDetectionMs, detectionMs);
+        }
+        threadSafePrint("Pool " + poolName(failed) + " failed: " + reason + " (detected after " +
+            std::to_string(static_cast<int>(detectionMs)) + " ms of silence)", true);
+        recordFailure(failed);
+        StratumCapture::record(StratumCapture::Direction::Event, "failover " + poolName(failed) + ": " + reason);
+
+        if (promoteStandby(reason)) {
+            return;
+        }
+
+        setConnected(false);
+        {
+            std::lock_guard<std::mutex> lock(socketMutex);
+            closeSocket(poolSocket);
+        }
+        int next = selectPool(failed);
+        if (next >= 0 && activatePool(next)) {
+            threadSafePrint("Failed over to pool " + poolName(next), true);
+        }
+    }
+
+    // Keeps a standby connection to the best non-active pool and fails back
+    // to a preferred pool once it is reachable again
+    static void maintainStandby() {
+        if (poolList.size() < 2) return;
+
+        if (standbyPending.valid()) {
+            if (standbyPending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                return;
+            }
+            StandbyConnection conn = standbyPending.get();
+            if (conn.socket == INVALID_SOCKET) {
+                recordFailure(conn.pool);
+                return;
+            }
+            if (conn.pool == activePool.load()) {
+                closeSocket(conn.socket);
+                return;
             }
+            closeSocket(standby.socket);
+            standby = conn;
+            threadSafePrint("Standby pool " + poolName(standby.pool) + " ready", true);
+        }
 
-            if (response.empty()) {
-                threadSafePrint("Empty login response received", true);
-                return false;
+        int active = activePool.load();
+        if (standby.socket != INVALID_SOCKET && standby.hasJob && active >= 0 &&
+            poolList[standby.pool].priority < poolList[active].priority) {
+            promoteStandby("preferred pool available");
+            return;
+        }
+
+        if (standby.socket == INVALID_SOCKET) {
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastStandbyAttempt < std::chrono::seconds(NetworkConstants::STANDBY_RETRY_SEC)) {
+                return;
             }
+            int index = selectPool(active);
+            if (index < 0) return;
+            lastStandbyAttempt = now;
+            standbyPending = std::async(std::launch::async, prepareStandby, index, poolList[index]);
+        }
+    }
+
+    // Sends a stratum keepalived request; pools answer with {"status":"KEEPALIVED"}
+    static bool sendKeepalive(SOCKET sock, const std::string& sessionPoolId) {
+        picojson::object params;
+        params["id"] = picojson::value(sessionPoolId);
 
-            threadSafePrint("Received login response: " + response, true);
-            
-            // Process login response
-            if (!handleLoginResponse(response)) {
+        picojson::object request;
+        request["id"] = picojson::value(static_cast<double>(++jsonRpcId));
+        request["jsonrpc"] = picojson::value("2.0");
+        request["method"] = picojson::value("keepalived");
+        request["params"] = picojson::value(params);
+
+        std::string line = picojson::value(request).serialize();
+        if (sock == poolSocket) {
+            StratumCapture::record(StratumCapture::Direction::Sent, line);
+        }
+        line += "\n";
+        return send(sock, line.c_str(), static_cast<int>(line.length()), 0) != SOCKET_ERROR;
+    }
+
+    // Returns false once a connection has been silent for longer than the idle timeout.
+    // A keepalived request is sent first so a healthy but quiet pool gets a chance to answer.
+    static bool checkConnectionAlive(SOCKET sock, const std::string& sessionPoolId,
+                                     std::chrono::steady_clock::time_point lastReceive,
+                                     std::chrono::steady_clock::time_point& keepaliveSent,
+                                     std::mutex* sendMutex) {
+        auto now = std::chrono::steady_clock::now();
+        auto silence = now - lastReceive;
+        if (config.idleTimeoutSec > 0 && silence > std::chrono::seconds(config.idleTimeoutSec)) {
+            return false;
+        }
+
+        // One outstanding keepalive at a time: only send if nothing was sent since the last data
+        if (config.keepaliveSec > 0 && silence > std::chrono::seconds(config.keepaliveSec) &&
+            keepaliveSent <= lastReceive) {
+            // A share submission in flight holds the socket and counts as traffic; try again later
+            std::unique_lock<std::mutex> lock;
+            if (sendMutex) {
+                lock = std::unique_lock<std::mutex>(*sendMutex, std::try_to_lock);
+                if (!lock.owns_lock()) return true;
+            }
+            if (!sendKeepalive(sock, sessionPoolId)) {
                 return false;
             }
-            
-            // Verify we received a job
-            {
-                std::lock_guard<std::mutex> lock(jobMutex);
-                if (jobQueue.empty()) {
-                    threadSafePrint("No job received from login response", true);
-                    return false;
+            keepaliveSent = now;
+            if (config.debugMode) {
+                threadSafePrint("Sent keepalived to pool", true);
+            }
+        }
+        return true;
+    }
+
+    static void handleStandbyData() {
+        std::vector<std::string> lines;
+        if (!readLines(standby.socket, standby.recvBuffer, lines)) {
+            threadSafePrint("Standby pool " + poolName(standby.pool) + " disconnected", true);
+            recordFailure(standby.pool);
+            closeSocket(standby.socket);
+            standby = StandbyConnection();
+            return;
+        }
+        standby.lastReceiveTime = std::chrono::steady_clock::now();
+        for (const auto& line : lines) {
+            picojson::value v;
+            if (!picojson::parse(v, line).empty() || !v.is<picojson::object>()) continue;
+            const picojson::object& obj = v.get<picojson::object>();
+            auto method = obj.find("method");
+            auto params = obj.find("params");
+            if (method != obj.end() && method->second.is<std::string>() &&
+                method->second.get<std::string>() == "job" &&
+                params != obj.end() && params->second.is<picojson::object>()) {
+                standby.lastJob = params->second.get<picojson::object>();
+                standby.hasJob = true;
+                std::lock_guard<std::mutex> lock(healthMutex);
+                poolHealth[standby.pool].lastJobTime = std::chrono::steady_clock::now();
+            }
+        }
+    }
+
+    static void handlePoolMessage(const std::string& response, std::chrono::steady_clock::time_point receivedAt) {
+        try {
+            picojson::value v;
+            std::string err = picojson::parse(v, response);
+            if (!err.empty()) {
+                threadSafePrint("JSON parse error: " + err, true);
+                return;
+            }
+
+            if (!v.is<picojson::object>()) {
+                threadSafePrint("Invalid JSON response format", true);
+                return;
+            }
+
+            const picojson::object& obj = v.get<picojson::object>();
+
+            // Responses to share submissions go to the waiting submitter
+            auto id = obj.find("id");
+            if (obj.find("method") == obj.end() && id != obj.end() && id->second.is<double>()) {
+                deliverResponse(static_cast<uint64_t>(id->second.get<double>()), response, receivedAt);
+                return;
+            }
+
+            if (obj.find("method") != obj.end()) {
+                const std::string& method = obj.at("method").get<std::string>();
+                if (method == "job") {
+                    const picojson::object& jobObj = obj.at("params").get<picojson::object>();
+                    processNewJob(jobObj, receivedAt);
+                    int index = activePool.load();
+                    if (index >= 0) {
+                        std::lock_guard<std::mutex> lock(healthMutex);
+                        poolHealth[index].lastJobTime = std::chrono::steady_clock::now();
+                    }
                 }
             }
-            
-            return true;
         }
         catch (const std::exception& e) {
-            threadSafePrint("Login error: " + std::string(e.what()), true);
-            return false;
+            threadSafePrint("Error processing response: " + std::string(e.what()), true);
         }
-        catch (...) {
-            threadSafePrint("Unknown error during login", true);
-            return false;
+    }
+
+    std::vector<PoolHealth> getPoolHealth() {
+        std::lock_guard<std::mutex> lock(healthMutex);
+        return poolHealth;
+    }
+
+    std::vector<PoolLatency> getPoolLatency() {
+        std::lock_guard<std::mutex> lock(healthMutex);
+        return poolLatency;
+    }
+
+    void recordJobSwitch(int pool, double ms) {
+        std::lock_guard<std::mutex> lock(healthMutex);
+        if (pool >= 0 && pool < static_cast<int>(poolLatency.size())) {
+            poolLatency[pool].jobSwitch.record(ms);
         }
     }
 
     void cleanup() {
-        if (poolSocket != INVALID_SOCKET) {
-            closesocket(poolSocket);
-            poolSocket = INVALID_SOCKET;
+        if (resubmitPending.valid()) {
+            resubmitPending.wait();
         }
-        WSACleanup();
+        {
+            std::lock_guard<std::mutex> lock(submitMutex);
+            for (const auto& share : pendingShares) {
+                journalShare(ShareJournal::RecordType::Lost, share, ShareJournal::LostReason::Shutdown);
+            }
+            lostShares += pendingShares.size();
+            pendingShares.clear();
+        }
+        if (standbyPending.valid()) {
+            StandbyConnection conn = standbyPending.get();
+            closeSocket(conn.socket);
+        }
+        closeSocket(standby.socket);
+        closeSocket(poolSocket);
+        stopSockets();
     }
 
     bool sendRequest(const std::string& request) {
@@ -327,88 +884,171 @@ namespace PoolClient {
 
         // Add newline character to the request
         std::string requestWithNewline = request + "\n";
-        
+
         int result = send(poolSocket, requestWithNewline.c_str(), static_cast<int>(requestWithNewline.length()), 0);
         if (result == SOCKET_ERROR) {
             threadSafePrint("send failed: " + std::to_string(WSAGetLastError()));
             return false;
         }
-        
+
         return true;
     }
 
     void jobListener() {
+        if (poolList.empty()) {
+            connectToPools(config.getPoolList());
+        }
+
         while (!shouldStop) {
-            // Verify socket is valid
+            // Make sure we have an active pool
             if (poolSocket == INVALID_SOCKET) {
+                setConnected(false);
                 threadSafePrint("Pool connection lost, attempting to reconnect...", true);
-                if (!connect(config.poolAddress, std::to_string(config.poolPort))) {
-                    threadSafePrint("Failed to reconnect to pool", true);
-                    std::this_thread::sleep_for(std::chrono::seconds(5));
-                    continue;
-                }
-                // Re-login after reconnection
-                if (!login(config.walletAddress, config.password, config.workerName, config.userAgent)) {
-                    threadSafePrint("Failed to re-login to pool", true);
-                    std::this_thread::sleep_for(std::chrono::seconds(5));
-                    continue;
+                if (!promoteStandby("active connection lost")) {
+                    int index = selectPool(-1);
+                    if (index < 0 || !activatePool(index)) {
+                        auto delay = nextReconnectDelay();
+                        threadSafePrint("Failed to reconnect to pool, retrying in " +
+                            std::to_string(delay.count()) + " ms", true);
+                        interruptibleSleep(delay);
+                        continue;
+                    }
                 }
             }
+            if (connected) {
+                reconnectAttempts = 0;
+            }
+
+            // Resubmit shares found while disconnected, off the listener thread since
+            // their responses arrive through it
+            if (connected && getPendingShareCount() > 0 &&
+                (!resubmitPending.valid() ||
+                 resubmitPending.wait_for(std::chrono::seconds(0)) == std::future_status::ready)) {
+                resubmitPending = std::async(std::launch::async, resubmitQueuedShares);
+            }
+
+            maintainStandby();
 
-            std::string response = receiveData(poolSocket);
-            if (response.empty()) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            // Wait for data on the active and standby connections
+            fd_set readSet;
+            FD_ZERO(&readSet);
+            FD_SET(poolSocket, &readSet);
+            SOCKET maxSocket = poolSocket;
+            if (standby.socket != INVALID_SOCKET) {
+                FD_SET(standby.socket, &readSet);
+                maxSocket = (std::max)(maxSocket, standby.socket);
+            }
+            struct timeval tv = { 1, 0 };
+            int status = select(static_cast<int>(maxSocket) + 1, &readSet, nullptr, nullptr, &tv);
+            if (status < 0) {
+                failover("select failed: " + std::to_string(WSAGetLastError()));
                 continue;
             }
 
-            try {
-                picojson::value v;
-                std::string err = picojson::parse(v, response);
-                if (!err.empty()) {
-                    threadSafePrint("JSON parse error: " + err, true);
-                    continue;
-                }
+            if (standby.socket != INVALID_SOCKET && FD_ISSET(standby.socket, &readSet)) {
+                handleStandbyData();
+            }
 
-                if (!v.is<picojson::object>()) {
-                    threadSafePrint("Invalid JSON response format", true);
+            if (FD_ISSET(poolSocket, &readSet)) {
+                std::vector<std::string> lines;
+                if (!readLines(poolSocket, recvBuffer, lines)) {
+                    failover("connection lost");
                     continue;
                 }
-
-                const picojson::object& obj = v.get<picojson::object>();
-                if (obj.find("method") != obj.end()) {
-                    const std::string& method = obj.at("method").get<std::string>();
-                    if (method == "job") {
-                        const picojson::object& jobObj = obj.at("params").get<picojson::object>();
-                        processNewJob(jobObj);
-                    }
+                lastReceiveTime = std::chrono::steady_clock::now();
+                for (const auto& line : lines) {
+                    StratumCapture::record(StratumCapture::Direction::Received, line);
+                    handlePoolMessage(line, lastReceiveTime);
                 }
             }
-            catch (const std::exception& e) {
-                threadSafePrint("Error processing response: " + std::string(e.what()), true);
+
+            // Application-level liveness: keepalives on quiet connections, drop dead ones
+            if (!checkConnectionAlive(poolSocket, poolId, lastReceiveTime, keepaliveSentTime, &socketMutex)) {
+                failover("no response for " + std::to_string(config.idleTimeoutSec) + " seconds");
+                continue;
+            }
+            if (standby.socket != INVALID_SOCKET &&
+                !checkConnectionAlive(standby.socket, standby.poolId, standby.lastReceiveTime,
+                                      standby.keepaliveSentTime, nullptr)) {
+                threadSafePrint("Standby pool " + poolName(standby.pool) + " stopped responding", true);
+                recordFailure(standby.pool);
+                closeSocket(standby.socket);
+                standby = StandbyConnection();
+            }
+
+            // Job deadline: a pool that stops sending work is as bad as a dead one.
+            // Counted from login until the session's first job arrives.
+            int active = activePool.load();
+            if (config.jobTimeoutSec > 0 && active >= 0) {
+                double waiting;
+                {
+                    std::lock_guard<std::mutex> lock(healthMutex);
+                    waiting = poolHealth[active].waitingForWorkSec();
+                }
+                if (waiting > config.jobTimeoutSec) {
+                    failover("no job for " + std::to_string(static_cast<int>(waiting)) + " seconds");
+                }
             }
         }
     }
 
-    void processNewJob(const picojson::object& jobObj) {
+    bool parseJob(const picojson::object& jobObj, Job& job) {
+        std::string jobId = jobObj.at("job_id").get<std::string>();
+        std::string blob = jobObj.at("blob").get<std::string>();
+        std::string target = jobObj.at("target").get<std::string>();
+        uint64_t height = static_cast<uint64_t>(jobObj.at("height").get<double>());
+        std::string seedHash = jobObj.at("seed_hash").get<std::string>();
+
+        // Reject malformed jobs before they reach the mining threads
+        HexCodec::Blob blobBytes;
+        HexCodec::Hash seedBytes;
+        if (!HexCodec::decode(blob, blobBytes) ||
+            blobBytes.size < MiningConstants::NONCE_OFFSET + MiningConstants::NONCE_SIZE) {
+            threadSafePrint("Invalid blob in job " + jobId, true);
+            return false;
+        }
+        if (!HexCodec::decode(seedHash, seedBytes)) {
+            threadSafePrint("Invalid seed hash in job " + jobId, true);
+            return false;
+        }
+
+        job = Job(jobId, blob, target, static_cast<uint32_t>(height), seedHash);
+        return true;
+    }
+
+    void processNewJob(const picojson::object& jobObj, std::chrono::steady_clock::time_point receivedAt) {
         try {
-            // Extract job details
-            std::string jobId = jobObj.at("job_id").get<std::string>();
-            std::string blob = jobObj.at("blob").get<std::string>();
-            std::string target = jobObj.at("target").get<std::string>();
-            uint64_t height = static_cast<uint64_t>(jobObj.at("height").get<double>());
-            std::string seedHash = jobObj.at("seed_hash").get<std::string>();
-
-            // Create new job
-            Job newJob(jobId, blob, target, static_cast<uint32_t>(height), seedHash);
-
-            // Update active job ID atomically
-            uint32_t jobIdNum = static_cast<uint32_t>(std::stoul(jobId));
-            if (jobIdNum != activeJobId.load()) {
-                activeJobId.store(jobIdNum);
-                notifiedJobId.store(jobIdNum);
-
-                // Initialize RandomX with new seed hash if needed
-                if (!RandomXManager::initialize(seedHash)) {
+            Job newJob;
+            if (!parseJob(jobObj, newJob)) {
+                return;
+            }
+            std::string jobId = newJob.getJobId();
+            std::string blob = newJob.getBlob();
+            std::string target = newJob.getTarget();
+            uint64_t height = newJob.getHeight();
+            std::string seedHash = newJob.getSeedHash();
+
+            // Job ids are opaque strings, so a new job is one with a different id or pool
+            bool isNew;
+            {
+                std::lock_guard<std::mutex> lock(jobMutex);
+                isNew = jobId != currentJobId || activePool.load() != currentJobPool;
+            }
+            if (isNew) {
+                int pool = activePool.load();
+                newJob.receivedAt = receivedAt;
+                newJob.sequence = MiningStats::jobReceived(receivedAt, pool);
+                if (pool >= 0) {
+                    std::lock_guard<std::mutex> lock(healthMutex);
+                    if (lastJobArrival[pool].time_since_epoch().count() != 0) {
+                        poolLatency[pool].jobInterval.record(
+                            std::chrono::duration<double, std::milli>(receivedAt - lastJobArrival[pool]).count());
+                    }
+                    lastJobArrival[pool] = receivedAt;
+                }
+
+                // Initialize RandomX with new seed hash if needed; a proxy does not hash
+                if (!config.proxyMode && !RandomXManager::initialize(seedHash)) {
                     threadSafePrint("Failed to initialize RandomX with seed hash: " + seedHash, true);
                     return;
                 }
@@ -421,6 +1061,8 @@ namespace PoolClient {
                     std::swap(jobQueue, empty);
                     // Add the new job
                     jobQueue.push(newJob);
+                    currentJobId = jobId;
+                    currentJobPool = activePool.load();
                     
                     if (debugMode) {
                         threadSafePrint("Job queue updated with new job: " + jobId, true);
@@ -457,6 +1099,10 @@ namespace PoolClient {
                     }
                 }
 
+                if (jobHandler) {
+                    jobHandler(newJob);
+                }
+
                 // Notify all mining threads about the new job
                 jobQueueCondition.notify_all();
                 if (debugMode) {
@@ -478,101 +1124,289 @@ namespace PoolClient {
         }
     }
 
-    bool submitShare(const std::string& jobId, const std::string& nonce, 
-                    const std::string& result, const std::string& algorithm) {
+    static void journalShare(ShareJournal::RecordType type, const PendingShare& share,
+                             ShareJournal::LostReason reason) {
+        if (!ShareJournal::isOpen()) {
+            return;
+        }
+        ShareJournal::Record record;
+        record.type = type;
+        record.reason = reason;
+        record.pool = static_cast<uint16_t>(share.pool < 0 ? 0 : share.pool);
+        record.shareId = share.shareId;
+        record.text = share.jobId;
+        if (type == ShareJournal::RecordType::Found) {
+            if (share.nonce.size() == 2 * sizeof(record.nonce)) {
+                HexCodec::decode(share.nonce.c_str(), share.nonce.size(), record.nonce);
+            }
+            if (share.result.size() == 2 * sizeof(record.result)) {
+                HexCodec::decode(share.result.c_str(), share.result.size(), record.result);
+            }
+        }
+        ShareJournal::append(std::move(record));
+    }
+
+    static void queueShare(const PendingShare& share) {
         std::lock_guard<std::mutex> lock(submitMutex);
-        std::lock_guard<std::mutex> sockLock(socketMutex);
+        if (pendingShares.size() >= MiningConstants::MAX_PENDING_SHARES) {
+            journalShare(ShareJournal::RecordType::Lost, pendingShares.front(), ShareJournal::LostReason::QueueFull);
+            lostShares++;
+            pendingShares.pop_front();
+            threadSafePrint("Pending share queue full, dropping oldest share", true);
+        }
+        pendingShares.push_back(share);
+        journalShare(ShareJournal::RecordType::Queued, share, ShareJournal::LostReason::None);
+    }
 
-        if (poolSocket == INVALID_SOCKET) {
-            threadSafePrint("Cannot submit share: Not connected to pool", true);
+    // Called by the job listener for every message carrying an id; returns true
+    // if a submitter was waiting for it
+    static bool deliverResponse(uint64_t id, const std::string& response,
+                                std::chrono::steady_clock::time_point receivedAt) {
+        std::lock_guard<std::mutex> lock(submitWaitersMutex);
+        auto it = submitWaiters.find(id);
+        if (it == submitWaiters.end()) {
             return false;
         }
+        it->second->response = response;
+        it->second->receivedAt = receivedAt;
+        it->second->done = true;
+        submitResponseCV.notify_all();
+        return true;
+    }
 
-        // Construct JSON request
-        std::stringstream ss;
-        ss << "{\"id\":1,\"jsonrpc\":\"2.0\",\"method\":\"submit\",\"params\":{"
-           << "\"id\":\"" << poolId << "\","
-           << "\"job_id\":\"" << jobId << "\","
-           << "\"nonce\":\"" << nonce << "\","
-           << "\"result\":\"" << result << "\","
-           << "\"algo\":\"" << algorithm << "\"}}";
-        
-        std::string request = ss.str();
+    std::string createSubmitRequest(uint64_t id, const std::string& sessionPoolId, const std::string& jobId,
+                                    const std::string& nonce, const std::string& result, const std::string& algo) {
+        picojson::object params;
+        params["id"] = picojson::value(sessionPoolId);
+        params["job_id"] = picojson::value(jobId);
+        params["nonce"] = picojson::value(nonce);
+        params["result"] = picojson::value(result);
+        params["algo"] = picojson::value(algo);
+
+        picojson::object request;
+        request["id"] = picojson::value(static_cast<double>(id));
+        request["jsonrpc"] = picojson::value("2.0");
+        request["method"] = picojson::value("submit");
+        request["params"] = picojson::value(params);
+        return picojson::value(request).serialize();
+    }
 
-        if (config.debugMode) {
-            threadSafePrint("\nSubmitting share to pool:", true);
-            threadSafePrint("  Pool ID: " + poolId, true);
-            threadSafePrint("  Job ID: " + jobId, true);
-            threadSafePrint("  Nonce: " + nonce, true);
-            threadSafePrint("  Result: " + result, true);
-            threadSafePrint("  Request: " + request, true);
+    // Pools word it differently: "Block expired", "Job not found", "Stale share", ...
+    bool isStaleReject(std::string message) {
+        std::transform(message.begin(), message.end(), message.begin(),
+                       [](unsigned char c) { return static_cast<char>(tolower(c)); });
+        for (const char* reason : { "stale", "expired", "job not found", "invalid job id", "unknown job" }) {
+            if (message.find(reason) != std::string::npos) return true;
         }
+        return false;
+    }
 
-        // Send request with newline
-        request += "\n";
-        int bytesSent = send(poolSocket, request.c_str(), static_cast<int>(request.length()), 0);
-        if (bytesSent == SOCKET_ERROR) {
-            threadSafePrint("Failed to send share: " + std::to_string(WSAGetLastError()), true);
-            return false;
+    static ShareStatus sendShare(const PendingShare& share) {
+        if (!connected || poolSocket == INVALID_SOCKET) {
+            queueShare(share);
+            threadSafePrint("Not connected to pool, share queued for resubmission", true);
+            return ShareStatus::Queued;
         }
 
-        // Receive response with timeout
-        fd_set readSet;
-        struct timeval timeout;
-        FD_ZERO(&readSet);
-        FD_SET(poolSocket, &readSet);
-        timeout.tv_sec = 10;
-        timeout.tv_usec = 0;
-
-        int selectResult = select(0, &readSet, nullptr, nullptr, &timeout);
-        if (selectResult <= 0) {
-            threadSafePrint("Timeout or error waiting for pool response", true);
-            return false;
+        uint64_t id = ++jsonRpcId;
+        auto waiter = std::make_shared<SubmitWaiter>();
+        {
+            std::lock_guard<std::mutex> lock(submitWaitersMutex);
+            submitWaiters[id] = waiter;
         }
 
-        char buffer[4096];
-        int bytesReceived = recv(poolSocket, buffer, sizeof(buffer) - 1, 0);
-        if (bytesReceived <= 0) {
-            threadSafePrint("Failed to receive pool response", true);
-            return false;
+        // Send the request; the response is read by the job listener
+        bool sent = false;
+        int pool = activePool.load();
+        std::chrono::steady_clock::time_point sentAt;
+        {
+            std::lock_guard<std::mutex> sockLock(socketMutex);
+            if (poolSocket != INVALID_SOCKET) {
+                std::string request = createSubmitRequest(id, poolId, share.jobId, share.nonce,
+                                                          share.result, share.algo);
+                if (config.debugMode) {
+                    threadSafePrint("Submitting share to pool: " + request, true);
+                }
+                StratumCapture::record(StratumCapture::Direction::Sent, request);
+                request += "\n";
+                sentAt = std::chrono::steady_clock::now();
+                sent = send(poolSocket, request.c_str(), static_cast<int>(request.length()), 0) != SOCKET_ERROR;
+                if (!sent) {
+                    threadSafePrint("Failed to send share: " + std::to_string(WSAGetLastError()), true);
+                }
+            }
         }
 
-        buffer[bytesReceived] = '\0';
-        std::string response(buffer);
+        std::string response;
+        std::chrono::steady_clock::time_point respondedAt;
+        bool answered = false;
+        {
+            std::unique_lock<std::mutex> lock(submitWaitersMutex);
+            if (sent) {
+                answered = submitResponseCV.wait_for(lock,
+                    std::chrono::seconds(NetworkConstants::SUBMIT_TIMEOUT_SEC),
+                    [&]() { return waiter->done; });
+            }
+            response = waiter->response;
+            respondedAt = waiter->receivedAt;
+            submitWaiters.erase(id);
+        }
+
+        if (!answered) {
+            // The connection is likely dying; keep the share for the next session
+            threadSafePrint("No response to share submission, share queued for resubmission", true);
+            queueShare(share);
+            return ShareStatus::Queued;
+        }
 
         if (config.debugMode) {
             threadSafePrint("Pool response: " + response, true);
         }
+        if (pool >= 0) {
+            std::lock_guard<std::mutex> lock(healthMutex);
+            poolLatency[pool].submitRtt.record(std::chrono::duration<double, std::milli>(respondedAt - sentAt).count());
+        }
 
         // Parse response
+        bool accepted = false;
+        std::string status = "invalid response";
         try {
             picojson::value v;
             std::string err = picojson::parse(v, response);
             if (err.empty() && v.is<picojson::object>()) {
                 const picojson::object& obj = v.get<picojson::object>();
-                if (obj.find("result") != obj.end() && 
+                if (obj.find("result") != obj.end() &&
                     obj.at("result").is<picojson::object>()) {
                     const picojson::object& result = obj.at("result").get<picojson::object>();
                     if (result.find("status") != result.end()) {
-                        std::string status = result.at("status").get<std::string>();
-                        bool accepted = (status == "OK");
-                        
-                        if (config.debugMode) {
-                            threadSafePrint("Share " + std::string(accepted ? "accepted" : "rejected") + 
-                                          " by pool (status: " + status + ")", true);
-                        }
-                        
-                        return accepted;
+                        status = result.at("status").get<std::string>();
+                        accepted = (status == "OK");
+                    }
+                } else if (obj.find("error") != obj.end() && obj.at("error").is<picojson::object>()) {
+                    const picojson::object& error = obj.at("error").get<picojson::object>();
+                    if (error.find("message") != error.end()) {
+                        status = error.at("message").to_str();
                     }
                 }
             }
-            threadSafePrint("Invalid response format from pool", true);
         }
         catch (const std::exception& e) {
             threadSafePrint("Error parsing share response: " + std::string(e.what()), true);
         }
 
-        return false;
+        // Credit the pool the share went to; a failover may have happened since
+        if (pool >= 0) {
+            std::lock_guard<std::mutex> lock(healthMutex);
+            if (accepted) {
+                poolHealth[pool].acceptedShares++;
+            } else {
+                poolHealth[pool].rejectedShares++;
+            }
+        }
+
+        journalShare(accepted ? ShareJournal::RecordType::Accepted : ShareJournal::RecordType::Rejected,
+                     share, ShareJournal::LostReason::None);
+
+        if (config.debugMode || !accepted) {
+            threadSafePrint("Share " + std::string(accepted ? "accepted" : "rejected") +
+                          " by pool (status: " + status + ")", true);
+        }
+        if (accepted) {
+            return ShareStatus::Accepted;
+        }
+        return isStaleReject(status) ? ShareStatus::Stale : ShareStatus::Rejected;
+    }
+
+    ShareStatus submitShare(const std::string& jobId, const std::string& nonce,
+                            const std::string& result, const std::string& algorithm) {
+        if (submitHandler) {
+            return submitHandler(jobId, nonce, result);
+        }
+
+        PendingShare share;
+        share.shareId = ShareJournal::nextShareId();
+        share.pool = activePool.load();
+        share.jobId = jobId;
+        share.nonce = nonce;
+        share.result = result;
+        share.algo = algorithm;
+        share.foundTime = std::chrono::steady_clock::now();
+        journalShare(ShareJournal::RecordType::Found, share, ShareJournal::LostReason::None);
+        return sendShare(share);
+    }
+
+    // Replays shares queued while disconnected. Only shares for the job the pool
+    // is currently running are sent; the rest are journaled as lost, since a
+    // new session or a newer job makes them stale.
+    static void resubmitQueuedShares() {
+        std::deque<PendingShare> shares;
+        {
+            std::lock_guard<std::mutex> lock(submitMutex);
+            shares.swap(pendingShares);
+        }
+
+        std::string jobId;
+        int jobPool;
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            jobId = currentJobId;
+            jobPool = currentJobPool;
+        }
+
+        int accepted = 0, rejected = 0, expired = 0, superseded = 0;
+        for (const auto& share : shares) {
+            if (std::chrono::steady_clock::now() - share.foundTime > std::chrono::seconds(config.jobGraceSec)) {
+                journalShare(ShareJournal::RecordType::Lost, share, ShareJournal::LostReason::Expired);
+                expired++;
+                continue;
+            }
+            if (share.jobId != jobId || share.pool != jobPool) {
+                journalShare(ShareJournal::RecordType::Lost, share, ShareJournal::LostReason::JobSuperseded);
+                superseded++;
+                continue;
+            }
+            journalShare(ShareJournal::RecordType::Replayed, share, ShareJournal::LostReason::None);
+            ShareStatus status = sendShare(share);
+            if (status == ShareStatus::Accepted) {
+                accepted++;
+                acceptedShares++;
+            } else if (status == ShareStatus::Rejected || status == ShareStatus::Stale) {
+                rejected++;
+                rejectedShares++;
+            }
+        }
+        lostShares += expired + superseded;
+        threadSafePrint("Replayed queued shares: " + std::to_string(accepted) + " accepted, " +
+            std::to_string(rejected) + " rejected; lost " + std::to_string(expired) + " expired, " +
+            std::to_string(superseded) + " for superseded jobs", true);
+    }
+
+    void setJobHandler(std::function<void(const Job&)> handler) {
+        jobHandler = std::move(handler);
+    }
+
+    void setWorkSource(SubmitHandler handler) {
+        submitHandler = std::move(handler);
+    }
+
+    void setWorkSourceConnected(bool isConnected) {
+        setConnected(isConnected);
+    }
+
+    size_t getPendingShareCount() {
+        std::lock_guard<std::mutex> lock(submitMutex);
+        return pendingShares.size();
+    }
+
+    uint64_t getLostShareCount() {
+        return lostShares.load();
+    }
+
+    bool isJobUsable() {
+        if (connected) return true;
+        auto disconnectedFor = std::chrono::steady_clock::now().time_since_epoch() -
+            std::chrono::steady_clock::duration(disconnectedSince.load());
+        return disconnectedFor < std::chrono::seconds(config.jobGraceSec);
     }
 
     void handleSeedHashChange(const std::string& newSeedHash) {
@@ -590,46 +1424,19 @@ namespace PoolClient {
 
     bool handleLoginResponse(const std::string& response) {
         try {
-            picojson::value v;
-            std::string err = picojson::parse(v, response);
-            if (!err.empty()) {
-                threadSafePrint("JSON parse error: " + err, true);
+            picojson::object jobObj;
+            bool hasJob = false;
+            if (!parseLoginResponse(response, poolId, jobObj, hasJob)) {
                 return false;
             }
+            threadSafePrint("Pool session ID: " + poolId, true);
 
-            if (!v.is<picojson::object>()) {
-                threadSafePrint("Invalid response format", true);
-                return false;
-            }
-
-            const picojson::object& responseObj = v.get<picojson::object>();
-            if (responseObj.find("result") == responseObj.end() || 
-                !responseObj.at("result").is<picojson::object>()) {
-                threadSafePrint("Invalid result format", true);
-                return false;
-            }
-
-            const picojson::object& result = responseObj.at("result").get<picojson::object>();
-            
-            // Get and store pool ID
-            if (result.find("id") != result.end() && result.at("id").is<std::string>()) {
-                poolId = result.at("id").get<std::string>();
-                threadSafePrint("Pool session ID: " + poolId, true);
-            } else {
-                threadSafePrint("Warning: No pool ID in login response", true);
-                poolId = "1"; // Fallback ID
-            }
-
-            // Get job
-            if (result.find("job") != result.end() && 
-                result.at("job").is<picojson::object>()) {
-                const picojson::object& jobObj = result.at("job").get<picojson::object>();
-                processNewJob(jobObj);
-                return true;
-            } else {
+            if (!hasJob) {
                 threadSafePrint("No job in login response", true);
                 return false;
             }
+            processNewJob(jobObj);
+            return true;
         }
         catch (const std::exception& e) {
             threadSafePrint("Error processing login response: " + std::string(e.what()), true);
@@ -672,7 +1479,7 @@ namespace PoolClient {
             timeout.tv_sec = 10;  // 10 second timeout
             timeout.tv_usec = 0;
 
-            int result = select(0, &readSet, nullptr, nullptr, &timeout);
+            int result = select(static_cast<int>(poolSocket) + 1, &readSet, nullptr, nullptr, &timeout);
             if (result == 0) {
                 threadSafePrint("Timeout waiting for response", true);
                 break;
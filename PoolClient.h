@@ -1,7 +1,6 @@
 #pragma once
 
-#include <WinSock2.h>
-#include <WS2tcpip.h>
+#include "Sockets.h"
 #include "picojson.h"
 #include "Job.h"
 #include <string>
@@ -11,9 +10,43 @@
 #include <atomic>
 #include <thread>
 #include <memory>
+#include <chrono>
+#include <vector>
+#include <functional>
 #include "MiningThreadData.h"
+#include "Config.h"
+#include "LatencyHistogram.h"
 
 namespace PoolClient {
+    // Per-pool health used to rank pools for failover
+    struct PoolHealth {
+        double connectTimeMs = 0.0;     // TCP connect time of the last connection
+        double jobLatencyMs = 0.0;      // Login request to first job round trip
+        uint64_t acceptedShares = 0;
+        uint64_t rejectedShares = 0;
+        int consecutiveFailures = 0;
+        uint64_t deadConnections = 0;   // Connections dropped as dead or failed
+        uint64_t logins = 0;            // Sessions logged in, active or standby; more than one means reconnects
+        double lastDetectionMs = 0.0;   // Silence before the last dead connection was detected
+        double maxDetectionMs = 0.0;
+        std::chrono::steady_clock::time_point lastJobTime;
+        std::chrono::steady_clock::time_point loginTime;       // Of the pool's latest session
+        std::chrono::steady_clock::time_point lastFailureTime;
+
+        double rejectRate() const;
+        double lastJobAgeSec() const;   // -1 if no job received yet
+        double waitingForWorkSec() const;   // Since the last job or, if later, the last login; -1 if neither
+        double score(int priority) const;
+    };
+
+    // Per-pool latency distributions, for picking pools and spotting network trouble.
+    // Times are taken when a message comes off the socket.
+    struct PoolLatency {
+        LatencyHistogram submitRtt;     // Share submit until the pool's response
+        LatencyHistogram jobInterval;   // Between consecutive jobs of one session
+        LatencyHistogram jobSwitch;     // Job received until the last mining thread hashes it
+    };
+
     extern SOCKET poolSocket;
     extern std::mutex jobMutex;
     extern std::mutex socketMutex;
@@ -26,21 +59,53 @@ namespace PoolClient {
     extern std::string sessionId;
     extern std::string currentTargetHex;
     extern std::string poolId;
+    enum class ShareStatus {
+        Accepted,
+        Rejected,
+        Stale,     // Rejected because its job was no longer current
+        Queued     // Not delivered; will be resubmitted after reconnecting
+    };
+
     extern std::vector<std::shared_ptr<MiningThreadData>> threadData;
+    extern std::vector<PoolEndpoint> poolList;
+    extern std::atomic<int> activePool;
 
     bool initialize();
     bool connect(const std::string& address, const std::string& port);
+    bool connectToPools(const std::vector<PoolEndpoint>& pools);
+    std::vector<PoolHealth> getPoolHealth();
+    std::vector<PoolLatency> getPoolLatency();
+    void recordJobSwitch(int pool, double ms);  // From MiningStats once every thread is on the pool's new job
     bool login(const std::string& wallet, const std::string& password, 
                const std::string& worker, const std::string& userAgent);
     void jobListener();
-    bool submitShare(const std::string& jobId, const std::string& nonce, 
-                    const std::string& hash, const std::string& algo);
+    ShareStatus submitShare(const std::string& jobId, const std::string& nonce,
+                            const std::string& hash, const std::string& algo);
+    size_t getPendingShareCount();
+    uint64_t getLostShareCount();  // Shares never delivered, see the share journal for reasons
+    bool isJobUsable();  // False once disconnected for longer than the job grace period
+    void setJobHandler(std::function<void(const Job&)> handler);  // Called for every new job
+
+    // Another work source (e.g. a daemon) feeding jobs through processNewJob
+    // instead of a pool; its handler receives the shares
+    using SubmitHandler = std::function<ShareStatus(const std::string& jobId, const std::string& nonce,
+                                                    const std::string& result)>;
+    void setWorkSource(SubmitHandler handler);
+    void setWorkSourceConnected(bool isConnected);  // Drives isJobUsable and the job grace period
     void cleanup();
+
+    // Stratum helpers shared with the split endpoint sessions
+    bool readLines(SOCKET sock, std::string& buffer, std::vector<std::string>& lines);  // False once closed
+    bool isStaleReject(std::string message);  // Reject reason means the share's job was no longer current
     
     void handleSeedHashChange(const std::string& newSeedHash);
-    void processNewJob(const picojson::object& jobObj);
+    // A job notify's params; false, logged, on a bad blob or seed hash, throws on a missing field
+    bool parseJob(const picojson::object& jobObj, Job& job);
+    void processNewJob(const picojson::object& jobObj,
+                       std::chrono::steady_clock::time_point receivedAt = std::chrono::steady_clock::now());
     bool handleLoginResponse(const std::string& response);
+    std::string createSubmitRequest(uint64_t id, const std::string& sessionPoolId, const std::string& jobId,
+                                    const std::string& nonce, const std::string& result, const std::string& algo);
     std::string sendAndReceive(const std::string& payload);
-    std::string receiveData(SOCKET sock);
     bool sendData(const std::string& data);
 } 
\ No newline at end of file
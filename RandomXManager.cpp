@@ -1,13 +1,18 @@
 #include "RandomXManager.h"
 #include "Globals.h"
 #include "Utils.h"
+#include "HexCodec.h"
+#include "HashTiming.h"
+#include "Logger.h"
 #include "Types.h"
 #include "Constants.h"
 #include "MiningStats.h"
 #include "MiningThreadData.h"
+#include "Job.h"
 #include "randomx.h"
 #include <fstream>
 #include <thread>
+#include <chrono>
 #include <vector>
 #include <mutex>
 #include <sstream>
@@ -54,6 +59,34 @@ uint256_t RandomXManager::expandedTarget;
 uint256_t RandomXManager::hashValue;
 uint32_t RandomXManager::currentTarget;
 std::string RandomXManager::lastHashHex;
+std::atomic<double> RandomXManager::buildSeconds(0.0);
+std::atomic<double> RandomXManager::loadSeconds(0.0);
+std::atomic<uint64_t> RandomXManager::builds(0);
+std::atomic<uint64_t> RandomXManager::loads(0);
+std::atomic<bool> RandomXManager::datasetLargePages(false);
+std::mutex RandomXManager::lightMutex;
+std::vector<std::shared_ptr<RandomXManager::LightCache>> RandomXManager::lightCaches;
+
+// A light-mode cache and the VMs created on it. Released once evicted and no
+// verifier still holds it.
+struct RandomXManager::LightCache {
+    std::string seedHash;
+    randomx_cache* cache = nullptr;
+    std::mutex initMutex;
+    bool ready = false;
+    bool failed = false;
+    std::mutex vmPoolMutex;
+    std::vector<randomx_vm*> freeVMs;
+
+    ~LightCache() {
+        for (randomx_vm* vm : freeVMs) {
+            randomx_destroy_vm(vm);
+        }
+        if (cache) {
+            randomx_release_cache(cache);
+        }
+    }
+};
 
 bool RandomXManager::initialize(const std::string& seedHash) {
     std::lock_guard<std::mutex> lock(initMutex);
@@ -82,14 +115,17 @@ bool RandomXManager::initialize(const std::string& seedHash) {
     uint32_t flags = RANDOMX_FLAG_JIT | RANDOMX_FLAG_HARD_AES | RANDOMX_FLAG_FULL_MEM;
     
     // Try to load existing dataset
-    dataset = randomx_alloc_dataset(flags);
+    dataset = allocateDataset(flags);
     if (!dataset) {
         threadSafePrint("Failed to allocate dataset memory", true);
         return false;
     }
 
     if (std::filesystem::exists(datasetPath)) {
+        auto loadStart = std::chrono::steady_clock::now();
         if (loadDataset(seedHash)) {
+            loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+            loads++;
             currentSeedHash = seedHash;
             threadSafePrint("Dataset loaded successfully", true);
             return true;
@@ -99,6 +135,7 @@ bool RandomXManager::initialize(const std::string& seedHash) {
 
     // Create new dataset
     threadSafePrint("Creating new RandomX dataset...", true);
+    auto buildStart = std::chrono::steady_clock::now();
     
     // Initialize cache first
     cache = randomx_alloc_cache(flags);
@@ -109,9 +146,18 @@ bool RandomXManager::initialize(const std::string& seedHash) {
         return false;
     }
 
-    // Initialize cache
+    // Initialize cache with the raw 32-byte seed, not its hex representation
     threadSafePrint("Initializing RandomX cache...", true);
-    randomx_init_cache(cache, seedHash.c_str(), seedHash.length());
+    HexCodec::Hash seedBytes;
+    if (!HexCodec::decode(seedHash, seedBytes)) {
+        threadSafePrint("Invalid seed hash: " + seedHash, true);
+        randomx_release_cache(cache);
+        randomx_release_dataset(dataset);
+        cache = nullptr;
+        dataset = nullptr;
+        return false;
+    }
+    randomx_init_cache(cache, seedBytes.data(), seedBytes.size());
 
     // Initialize dataset in parallel
     threadSafePrint("Initializing RandomX dataset...", true);
@@ -154,6 +200,9 @@ bool RandomXManager::initialize(const std::string& seedHash) {
         return false;
     }
 
+    buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - buildStart).count();
+    builds++;
+
     // Save dataset for future use
     if (!saveDataset(seedHash)) {
         threadSafePrint("Warning: Failed to save dataset", true);
@@ -173,7 +222,7 @@ bool RandomXManager::initialize(const std::string& seedHash) {
 bool RandomXManager::loadDataset(const std::string& seedHash) {
     // Allocate dataset if not already allocated
     if (!dataset) {
-        dataset = randomx_alloc_dataset(static_cast<randomx_flags>(RANDOMX_FLAG_DEFAULT));
+        dataset = allocateDataset(static_cast<randomx_flags>(RANDOMX_FLAG_DEFAULT));
         if (!dataset) {
             threadSafePrint("Failed to allocate dataset for loading", true);
             return false;
@@ -329,6 +378,11 @@ void RandomXManager::destroyVM(randomx_vm* vm) {
 }
 
 bool RandomXManager::calculateHash(randomx_vm* vm, const std::vector<uint8_t>& input, uint64_t nonce) {
+    return calculateHash(vm, input, nonce, currentTargetHex);
+}
+
+bool RandomXManager::calculateHash(randomx_vm* vm, const std::vector<uint8_t>& input, uint64_t nonce,
+                                   const std::string& targetHex) {
     if (!vm || input.empty()) {
         return false;
     }
@@ -338,40 +392,113 @@ bool RandomXManager::calculateHash(randomx_vm* vm, const std::vector<uint8_t>& i
         lastHash.resize(32);
     }
 
-    // Calculate hash
-    randomx_calculate_hash(vm, input.data(), input.size(), lastHash.data());
+    // Calculate hash, timed per thread in MONEROMINER_HASH_TIMING builds
+    {
+        HASH_TIMING_SCOPE();
+        randomx_calculate_hash(vm, input.data(), input.size(), lastHash.data());
+    }
 
     // Check if hash meets target
-    bool meetsTarget = checkHash(lastHash.data(), currentTargetHex);
+    bool meetsTarget = checkHash(lastHash.data(), targetHex);
 
-    // Show debug output if debug mode is enabled
-    static uint64_t hashCount = 0;
+#ifdef LOG_DEBUG_ENABLED
+    // Sample hash dump, debug builds only; counted per mining thread
+    static thread_local uint64_t hashCount = 0;
     hashCount++;
-    
-    if (config.debugMode && (hashCount == 1 || hashCount % 10000 == 0)) {
-        std::stringstream ss;
-        ss << "\nRandomX Hash Calculation:" << std::endl;
-        ss << "  Input data: " << bytesToHex(input) << std::endl;
-        ss << "  Nonce: 0x" << std::hex << std::setw(8) << std::setfill('0') << nonce << std::endl;
-        ss << "  Hash output: " << bytesToHex(lastHash) << std::endl;
-        ss << "  Target: 0x" << currentTargetHex << std::endl;
-        threadSafePrint(ss.str(), true);
-    }
+    if (hashCount == 1 || hashCount % 10000 == 0) {
+        LOG_DEBUG([&]() {
+            std::stringstream ss;
+            ss << "\nRandomX Hash Calculation:" << std::endl;
+            ss << "  Input data: " << HexCodec::encode(input) << std::endl;
+            ss << "  Nonce: 0x" << std::hex << std::setw(8) << std::setfill('0') << nonce << std::endl;
+            ss << "  Hash output: " << HexCodec::encode(lastHash) << std::endl;
+            ss << "  Target: 0x" << targetHex;
+            return ss.str();
+        }());
+    }
+#else
+    (void)nonce;
+#endif
 
     if (meetsTarget) {
         std::stringstream ss;
         ss << "\nFound valid share!" << std::endl;
-        ss << "  Hash: " << bytesToHex(lastHash) << std::endl;
-        ss << "  Target: 0x" << currentTargetHex << std::endl;
+        ss << "  Hash: " << HexCodec::encode(lastHash) << std::endl;
+        ss << "  Target: 0x" << targetHex << std::endl;
         threadSafePrint(ss.str(), true);
     }
 
     return meetsTarget;
 }
 
+std::shared_ptr<RandomXManager::LightCache> RandomXManager::getLightCache(const std::string& seedHash) {
+    std::shared_ptr<LightCache> light;
+    {
+        std::lock_guard<std::mutex> lock(lightMutex);
+        auto it = std::find_if(lightCaches.begin(), lightCaches.end(),
+            [&](const std::shared_ptr<LightCache>& entry) { return entry->seedHash == seedHash; });
+        if (it != lightCaches.end()) {
+            light = *it;
+        } else {
+            light = std::make_shared<LightCache>();
+            light->seedHash = seedHash;
+            lightCaches.insert(lightCaches.begin(), light);
+            // Keep the previous seed too, shares for the last epoch's jobs may still arrive
+            if (lightCaches.size() > 2) {
+                lightCaches.pop_back();
+            }
+        }
+    }
+
+    // Built outside lightMutex; other seeds stay usable while this one initializes
+    std::lock_guard<std::mutex> initLock(light->initMutex);
+    if (!light->ready && !light->failed) {
+        HexCodec::Hash seedBytes;
+        randomx_flags flags = randomx_get_flags();
+        if (HexCodec::decode(seedHash, seedBytes) && (light->cache = randomx_alloc_cache(flags)) != nullptr) {
+            threadSafePrint("Initializing light RandomX cache for seed hash: " + seedHash, true);
+            randomx_init_cache(light->cache, seedBytes.data(), seedBytes.size());
+            light->ready = true;
+        } else {
+            threadSafePrint("Failed to create light RandomX cache for seed hash: " + seedHash, true);
+            light->failed = true;
+        }
+    }
+    return light->ready ? light : nullptr;
+}
+
+bool RandomXManager::lightHash(const std::string& seedHash, const uint8_t* input, size_t size, uint8_t* output) {
+    std::shared_ptr<LightCache> light = getLightCache(seedHash);
+    if (!light) {
+        return false;
+    }
+
+    randomx_vm* vm = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(light->vmPoolMutex);
+        if (!light->freeVMs.empty()) {
+            vm = light->freeVMs.back();
+            light->freeVMs.pop_back();
+        }
+    }
+    if (!vm) {
+        vm = randomx_create_vm(randomx_get_flags(), light->cache, nullptr);
+        if (!vm) {
+            threadSafePrint("Failed to create light RandomX VM", true);
+            return false;
+        }
+    }
+
+    randomx_calculate_hash(vm, input, size, output);
+
+    std::lock_guard<std::mutex> lock(light->vmPoolMutex);
+    light->freeVMs.push_back(vm);
+    return true;
+}
+
 std::string RandomXManager::getLastHashHex() {
     std::lock_guard<std::mutex> lock(hashMutex);
-    return bytesToHex(lastHash);
+    return HexCodec::encode(lastHash);
 }
 
 bool RandomXManager::checkHash(const uint8_t* hash, const std::string& targetHex) {
@@ -380,56 +507,22 @@ bool RandomXManager::checkHash(const uint8_t* hash, const std::string& targetHex
         return false;
     }
 
-    // Extract exponent and mantissa from target
-    uint32_t target = std::stoul(targetHex, nullptr, 16);
-    uint8_t exponent = (target >> 24) & 0xFF;
-    uint32_t mantissa = target & 0x00FFFFFF;
-
-    // Create 256-bit target
-    uint256_t targetValue;
-    targetValue.words[0] = static_cast<uint64_t>(mantissa) << 40;  // Shift left by 40 bits
-    targetValue.words[1] = 0;
-    targetValue.words[2] = 0;
-    targetValue.words[3] = 0;
-
-    // Create 256-bit hash value
-    uint256_t hashValue;
-    for (int i = 0; i < 32; i++) {
-        int word_idx = i / 8;
-        int byte_idx = 7 - (i % 8);
-        hashValue.words[word_idx] |= (static_cast<uint64_t>(hash[i]) << (byte_idx * 8));
-    }
+    // 32-bit pool targets and 64-bit (e.g. network difficulty) targets alike
+    uint64_t target = Job::targetValue(targetHex);
+    bool meetsTarget = target != 0 && Job::hashMeetsTarget(hash, target);
 
-    // Show debug output if debug mode is enabled
-    if (config.debugMode) {
+    // Every hash; compiled out of release builds
+    LOG_DEBUG([&]() {
         std::stringstream ss;
-        ss << "\nTarget Expansion:" << std::endl;
-        ss << "  Compact target: 0x" << targetHex << std::endl;
-        ss << "  Exponent: 0x" << std::hex << std::setw(2) << std::setfill('0') 
-           << static_cast<int>(exponent) << std::endl;
-        ss << "  Mantissa: 0x" << std::hex << std::setw(6) << std::setfill('0') 
-           << mantissa << std::endl;
-        
-        ss << "\nExpanded Target (256-bit):" << std::endl;
-        for (int i = 0; i < 4; i++) {
-            ss << "  Word " << i << ": 0x" << std::hex << std::setw(16) << std::setfill('0') 
-               << targetValue.words[i] << std::endl;
-        }
-        
-        ss << "\nHash Value (256-bit):" << std::endl;
-        for (int i = 0; i < 4; i++) {
-            ss << "  Word " << i << ": 0x" << std::hex << std::setw(16) << std::setfill('0') 
-               << hashValue.words[i] << std::endl;
-        }
-        
         ss << "\nShare Validation:" << std::endl;
-        bool meetsTarget = hashValue < targetValue;
-        ss << "  Hash " << (meetsTarget ? "meets" : "does not meet") << " target" << std::endl;
-        
-        threadSafePrint(ss.str(), true);
-    }
+        ss << "  Target: 0x" << targetHex << " (64-bit 0x" << std::hex << std::setw(16) << std::setfill('0')
+           << target << ")" << std::endl;
+        ss << "  Hash bytes 24..31: " << HexCodec::encode(hash + 24, 8) << std::endl;
+        ss << "  Hash " << (meetsTarget ? "meets" : "does not meet") << " target";
+        return ss.str();
+    }());
 
-    return hashValue < targetValue;
+    return meetsTarget;
 }
 
 void RandomXManager::initializeDataset(const std::string& seedHash) {
@@ -450,8 +543,31 @@ void RandomXManager::initializeDataset(const std::string& seedHash) {
     }
 }
 
+// Huge pages cut TLB misses on the 2 GB dataset; without them (no privilege on
+// Windows, none reserved on Linux) the dataset goes on normal pages
+randomx_dataset* RandomXManager::allocateDataset(randomx_flags flags) {
+    randomx_dataset* allocated = randomx_alloc_dataset(flags | RANDOMX_FLAG_LARGE_PAGES);
+    datasetLargePages = allocated != nullptr;
+    if (!allocated) {
+        threadSafePrint("Huge pages unavailable, dataset uses normal pages", true);
+        allocated = randomx_alloc_dataset(flags & ~RANDOMX_FLAG_LARGE_PAGES);
+    }
+    return allocated;
+}
+
+RandomXManager::DatasetStats RandomXManager::getDatasetStats() {
+    DatasetStats stats;
+    stats.buildSeconds = buildSeconds.load();
+    stats.loadSeconds = loadSeconds.load();
+    stats.builds = builds.load();
+    stats.loads = loads.load();
+    stats.largePages = dataset != nullptr && datasetLargePages.load();
+    return stats;
+}
+
 std::string RandomXManager::getDatasetPath(const std::string& seedHash) {
-    return "randomx_dataset_" + seedHash + ".bin";
+    // "v2" datasets are built from the decoded seed; older files used the hex string as key
+    return "randomx_dataset_v2_" + seedHash + ".bin";
 }
 
 void RandomXManager::handleSeedHashChange(const std::string& newSeedHash) {
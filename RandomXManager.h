@@ -4,6 +4,7 @@
 #include <string>
 #include <mutex>
 #include <memory>
+#include <atomic>
 #include <unordered_map>
 #include <algorithm>
 #include "randomx.h"
@@ -54,13 +55,25 @@ struct uint256_t {
 
 class RandomXManager {
 public:
+    // Dataset preparation figures for the metrics endpoint, readable while a build runs
+    struct DatasetStats {
+        double buildSeconds = 0.0;   // Last build from the cache
+        double loadSeconds = 0.0;    // Last load from disk
+        uint64_t builds = 0;
+        uint64_t loads = 0;
+        bool largePages = false;     // Dataset memory is on huge (large) pages
+    };
+
     static bool initialize(const std::string& seedHash);
     static void cleanup();
     static randomx_vm* createVM(int threadId);
     static void destroyVM(randomx_vm* vm);
     static bool calculateHash(randomx_vm* vm, const std::vector<uint8_t>& input, uint64_t nonce);
+    static bool calculateHash(randomx_vm* vm, const std::vector<uint8_t>& input, uint64_t nonce,
+                              const std::string& targetHex);  // Against a job's own target
     static bool isInitialized() { return dataset != nullptr; }
     static std::string getCurrentSeedHash() { return currentSeedHash; }
+    static DatasetStats getDatasetStats();
     static void initializeDataset(const std::string& seedHash);
     static bool loadDataset(const std::string& seedHash);
     static bool saveDataset(const std::string& seedHash);
@@ -68,13 +81,20 @@ public:
     static std::string currentTargetHex;
     static const std::vector<uint8_t>& getLastHash() { return lastHash; }
     static std::string getLastHashHex();
+    static bool checkHash(const uint8_t* hash, const std::string& targetHex);  // Hash meets a 32- or 64-bit target
     static void setTarget(const std::string& targetHex);
     static void setJobInfo(uint64_t height, const std::string& jobId) {
         currentHeight = height;
         currentJobId = jobId;
     }
 
+    // Light mode (cache only, no dataset) hashing used to verify shares from
+    // other miners. Thread-safe; VMs are pooled per seed hash.
+    static bool lightHash(const std::string& seedHash, const uint8_t* input, size_t size, uint8_t* output);
+
 private:
+    struct LightCache;
+
     static std::mutex vmMutex;
     static std::mutex datasetMutex;
     static std::mutex seedHashMutex;
@@ -95,6 +115,16 @@ private:
     static uint256_t hashValue;
     static uint32_t currentTarget;
 
-    static bool checkHash(const uint8_t* hash, const std::string& targetHex);
+    static std::atomic<double> buildSeconds;
+    static std::atomic<double> loadSeconds;
+    static std::atomic<uint64_t> builds;
+    static std::atomic<uint64_t> loads;
+    static std::atomic<bool> datasetLargePages;
+
+    static std::mutex lightMutex;
+    static std::vector<std::shared_ptr<LightCache>> lightCaches;  // Most recent seed first
+
+    static std::shared_ptr<LightCache> getLightCache(const std::string& seedHash);
     static std::string getDatasetPath(const std::string& seedHash);
+    static randomx_dataset* allocateDataset(randomx_flags flags);
 }; 
\ No newline at end of file
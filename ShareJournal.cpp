@@ -0,0 +1,369 @@
+#include "ShareJournal.h"
+#include "Globals.h"
+#include "HexCodec.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace ShareJournal {
+    static const char FILE_MAGIC[4] = {'M', 'M', 'S', 'J'};
+    static const uint16_t FILE_VERSION = 1;
+    static const size_t FILE_HEADER_SIZE = 8;
+    static const size_t RECORD_FIXED_SIZE = 1 + 1 + 2 + 4 + 8 +
+        MiningConstants::NONCE_SIZE + MiningConstants::HASH_SIZE + 1;
+
+    static std::ofstream journalFile;
+    static std::string journalPath;
+    static std::deque<Record> queue;  // Guarded by queueMutex
+    static std::mutex queueMutex;
+    static std::condition_variable queueCV;
+    static std::thread writerThread;
+    static bool stopWriter = false;
+    static std::atomic<bool> opened(false);
+    static std::atomic<uint32_t> shareCounter(0);
+
+    static void putLE(std::string& out, uint64_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; i++) {
+            out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    static uint64_t getLE(const uint8_t* in, size_t bytes) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; i++) {
+            value |= static_cast<uint64_t>(in[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    static void serialize(const Record& record, std::string& out) {
+        size_t textLength = (std::min)(record.text.size(), static_cast<size_t>(255));
+        out.push_back(static_cast<char>(record.type));
+        out.push_back(static_cast<char>(record.reason));
+        putLE(out, record.pool, 2);
+        putLE(out, record.shareId, 4);
+        putLE(out, record.timeMs, 8);
+        out.append(reinterpret_cast<const char*>(record.nonce), sizeof(record.nonce));
+        out.append(reinterpret_cast<const char*>(record.result), sizeof(record.result));
+        out.push_back(static_cast<char>(textLength));
+        out.append(record.text, 0, textLength);
+    }
+
+    static bool readRecord(std::istream& in, Record& record) {
+        uint8_t fixed[RECORD_FIXED_SIZE];
+        if (!in.read(reinterpret_cast<char*>(fixed), sizeof(fixed))) {
+            return false;
+        }
+        const uint8_t* p = fixed;
+        record.type = static_cast<RecordType>(p[0]);
+        record.reason = static_cast<LostReason>(p[1]);
+        record.pool = static_cast<uint16_t>(getLE(p + 2, 2));
+        record.shareId = static_cast<uint32_t>(getLE(p + 4, 4));
+        record.timeMs = getLE(p + 8, 8);
+        p += 16;
+        std::memcpy(record.nonce, p, sizeof(record.nonce));
+        p += sizeof(record.nonce);
+        std::memcpy(record.result, p, sizeof(record.result));
+        p += sizeof(record.result);
+        record.text.assign(*p, '\0');
+        return record.text.empty() || static_cast<bool>(in.read(&record.text[0], record.text.size()));
+    }
+
+    static bool atEnd(std::istream& in) {
+        return in.peek() == std::char_traits<char>::eof();
+    }
+
+    static bool readHeader(std::istream& in) {
+        uint8_t header[FILE_HEADER_SIZE];
+        if (!in.read(reinterpret_cast<char*>(header), sizeof(header))) {
+            return false;
+        }
+        return std::memcmp(header, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0 &&
+               getLE(header + 4, 2) == FILE_VERSION;
+    }
+
+    static uint64_t unixTimeMs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    static bool isFinal(RecordType type) {
+        return type == RecordType::Accepted || type == RecordType::Rejected || type == RecordType::Lost;
+    }
+
+    // Batches queued records into a single write and flush
+    static void writerLoop() {
+        std::string buffer;
+        std::unique_lock<std::mutex> lock(queueMutex);
+        while (true) {
+            queueCV.wait(lock, []() { return stopWriter || !queue.empty(); });
+            if (queue.empty() && stopWriter) {
+                break;
+            }
+            std::deque<Record> batch;
+            batch.swap(queue);
+            lock.unlock();
+
+            buffer.clear();
+            for (const auto& record : batch) {
+                serialize(record, buffer);
+            }
+            journalFile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            journalFile.flush();
+            if (!journalFile) {
+                threadSafePrint("Failed to write share journal " + journalPath, true);
+                journalFile.clear();
+            }
+
+            lock.lock();
+        }
+    }
+
+    // Scans the existing journal so share ids keep increasing across runs, and
+    // marks shares left unresolved by a previous run as lost
+    static bool recoverExisting(const std::string& path, std::vector<Record>& unresolved) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            return true;  // New journal
+        }
+        in.seekg(0, std::ios::end);
+        if (in.tellg() == 0) {
+            return true;
+        }
+        in.seekg(0, std::ios::beg);
+        if (!readHeader(in)) {
+            threadSafePrint("Share journal " + path + " has an unknown format", true);
+            return false;
+        }
+
+        std::map<uint32_t, Record> pending;
+        uint32_t maxId = 0;
+        Record record;
+        std::streamoff validLength = static_cast<std::streamoff>(FILE_HEADER_SIZE);
+        bool truncated = false;
+        while (!atEnd(in)) {
+            if (!readRecord(in, record)) {
+                truncated = true;
+                break;
+            }
+            validLength = in.tellg();
+            if (record.type == RecordType::Pool) continue;
+            maxId = (std::max)(maxId, record.shareId);
+            if (record.type == RecordType::Found) {
+                pending[record.shareId] = record;
+            } else if (isFinal(record.type)) {
+                pending.erase(record.shareId);
+            }
+        }
+        in.close();
+
+        // A crash mid-write leaves a partial record; drop it so appends stay aligned
+        if (truncated) {
+            std::error_code ec;
+            std::filesystem::resize_file(path, static_cast<uintmax_t>(validLength), ec);
+            if (ec) {
+                threadSafePrint("Failed to repair share journal " + path + ": " + ec.message(), true);
+                return false;
+            }
+            threadSafePrint("Share journal " + path + " had a partial record, truncated", true);
+        }
+
+        shareCounter = maxId;
+        for (auto& entry : pending) {
+            unresolved.push_back(entry.second);
+        }
+        return true;
+    }
+
+    bool open(const std::string& path) {
+        if (opened) {
+            return true;
+        }
+
+        std::vector<Record> unresolved;
+        if (!recoverExisting(path, unresolved)) {
+            return false;
+        }
+
+        bool writeHeader = true;
+        {
+            std::ifstream existing(path, std::ios::binary | std::ios::ate);
+            writeHeader = !existing || existing.tellg() == 0;
+        }
+        journalFile.open(path, std::ios::binary | std::ios::app);
+        if (!journalFile) {
+            threadSafePrint("Failed to open share journal " + path, true);
+            return false;
+        }
+        if (writeHeader) {
+            uint8_t header[FILE_HEADER_SIZE] = {};
+            std::memcpy(header, FILE_MAGIC, sizeof(FILE_MAGIC));
+            header[4] = static_cast<uint8_t>(FILE_VERSION & 0xFF);
+            header[5] = static_cast<uint8_t>(FILE_VERSION >> 8);
+            journalFile.write(reinterpret_cast<const char*>(header), sizeof(header));
+            journalFile.flush();
+        }
+
+        journalPath = path;
+        stopWriter = false;
+        writerThread = std::thread(writerLoop);
+        opened = true;
+
+        for (auto& record : unresolved) {
+            record.type = RecordType::Lost;
+            record.reason = LostReason::Shutdown;
+            record.timeMs = 0;
+            append(record);
+        }
+        if (!unresolved.empty()) {
+            threadSafePrint("Share journal: " + std::to_string(unresolved.size()) +
+                " shares from a previous run were never delivered", true);
+        }
+        threadSafePrint("Share journal: " + path, true);
+        return true;
+    }
+
+    void close() {
+        if (!opened.exchange(false)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopWriter = true;
+        }
+        queueCV.notify_one();
+        if (writerThread.joinable()) {
+            writerThread.join();
+        }
+        journalFile.close();
+    }
+
+    bool isOpen() {
+        return opened;
+    }
+
+    uint32_t nextShareId() {
+        return ++shareCounter;
+    }
+
+    void append(Record record) {
+        if (!opened) {
+            return;
+        }
+        if (record.timeMs == 0) {
+            record.timeMs = unixTimeMs();
+        }
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queue.push_back(std::move(record));
+        }
+        queueCV.notify_one();
+    }
+
+    void appendPool(uint16_t index, const std::string& name) {
+        Record record;
+        record.type = RecordType::Pool;
+        record.pool = index;
+        record.text = name;
+        append(std::move(record));
+    }
+
+    const char* typeName(RecordType type) {
+        switch (type) {
+            case RecordType::Pool: return "POOL";
+            case RecordType::Found: return "FOUND";
+            case RecordType::Accepted: return "ACCEPTED";
+            case RecordType::Rejected: return "REJECTED";
+            case RecordType::Queued: return "QUEUED";
+            case RecordType::Replayed: return "REPLAYED";
+            case RecordType::Lost: return "LOST";
+        }
+        return "UNKNOWN";
+    }
+
+    const char* reasonName(LostReason reason) {
+        switch (reason) {
+            case LostReason::None: return "none";
+            case LostReason::Expired: return "expired";
+            case LostReason::JobSuperseded: return "job superseded";
+            case LostReason::QueueFull: return "queue full";
+            case LostReason::Shutdown: return "shutdown";
+        }
+        return "unknown";
+    }
+
+    static std::string formatTime(uint64_t timeMs) {
+        std::time_t seconds = static_cast<std::time_t>(timeMs / 1000);
+        std::tm tm = {};
+#ifdef _WIN32
+        gmtime_s(&tm, &seconds);
+#else
+        gmtime_r(&seconds, &tm);
+#endif
+        std::stringstream ss;
+        ss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S") << "."
+           << std::setw(3) << std::setfill('0') << (timeMs % 1000) << "Z";
+        return ss.str();
+    }
+
+    bool dump(const std::string& path, std::ostream& out) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            out << "Cannot open share journal " << path << std::endl;
+            return false;
+        }
+        if (!readHeader(in)) {
+            out << path << " is not a share journal" << std::endl;
+            return false;
+        }
+
+        std::map<RecordType, uint64_t> counts;
+        std::map<LostReason, uint64_t> lost;
+        Record record;
+        while (!atEnd(in)) {
+            if (!readRecord(in, record)) {
+                out << "Journal is truncated after this point" << std::endl;
+                break;
+            }
+            counts[record.type]++;
+            out << formatTime(record.timeMs) << " " << std::left << std::setw(8) << typeName(record.type)
+                << std::right << " pool=" << record.pool;
+            if (record.type == RecordType::Pool) {
+                out << " " << record.text << std::endl;
+                continue;
+            }
+            out << " share=" << record.shareId << " job=" << record.text;
+            if (record.type == RecordType::Found) {
+                out << " nonce=" << HexCodec::encode(record.nonce, sizeof(record.nonce))
+                    << " result=" << HexCodec::encode(record.result, sizeof(record.result));
+            }
+            if (record.type == RecordType::Lost) {
+                lost[record.reason]++;
+                out << " reason=" << reasonName(record.reason);
+            }
+            out << std::endl;
+        }
+
+        out << "Summary: " << counts[RecordType::Found] << " found, "
+            << counts[RecordType::Accepted] << " accepted, "
+            << counts[RecordType::Rejected] << " rejected, "
+            << counts[RecordType::Replayed] << " replayed, "
+            << counts[RecordType::Lost] << " lost" << std::endl;
+        for (const auto& entry : lost) {
+            out << "  lost (" << reasonName(entry.first) << "): " << entry.second << std::endl;
+        }
+        return true;
+    }
+}
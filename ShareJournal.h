@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <ostream>
+#include "Constants.h"
+
+// Append-only binary journal of found shares and their outcome, used to audit
+// work lost during outages. Records are queued by the caller and written by a
+// background thread, so appending never touches the disk on a mining thread.
+//
+// File layout: "MMSJ", uint16 version, uint16 reserved, then records of
+//   uint8 type, uint8 reason, uint16 pool, uint32 shareId, uint64 unix time (ms),
+//   uint8[4] nonce, uint8[32] result, uint8 textLength, char[textLength] text
+// All integers are little-endian. 'text' is the job id, or the pool name for
+// Pool records.
+namespace ShareJournal {
+    enum class RecordType : uint8_t {
+        Pool = 0,     // Maps a pool index to its address for this run
+        Found,        // Share found by a mining thread
+        Accepted,
+        Rejected,
+        Queued,       // Could not be delivered, kept for replay after reconnecting
+        Replayed,     // Resubmitted after reconnecting
+        Lost          // Never delivered; see LostReason
+    };
+
+    enum class LostReason : uint8_t {
+        None = 0,
+        Expired,        // Older than the job grace period when the pool came back
+        JobSuperseded,  // Pool moved on to another job or session
+        QueueFull,      // Dropped from the pending share queue
+        Shutdown        // Still pending when the miner exited
+    };
+
+    struct Record {
+        RecordType type = RecordType::Found;
+        LostReason reason = LostReason::None;
+        uint16_t pool = 0;
+        uint32_t shareId = 0;
+        uint64_t timeMs = 0;
+        uint8_t nonce[MiningConstants::NONCE_SIZE] = {};
+        uint8_t result[MiningConstants::HASH_SIZE] = {};
+        std::string text;
+    };
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen();
+
+    uint32_t nextShareId();
+    void append(Record record);  // Stamps the time if unset; never blocks on I/O
+    void appendPool(uint16_t index, const std::string& name);
+
+    // Prints every record and a summary of lost shares by reason
+    bool dump(const std::string& path, std::ostream& out);
+
+    const char* typeName(RecordType type);
+    const char* reasonName(LostReason reason);
+}
@@ -0,0 +1,196 @@
+#include "ShareVerifier.h"
+#include "RandomXManager.h"
+#include "Globals.h"
+#include "Constants.h"
+#include "Job.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace ShareVerifier {
+    struct Task {
+        Share share;
+        Callback done;
+        std::chrono::steady_clock::time_point queuedAt;
+    };
+
+    static std::deque<Task> queue;  // Guarded by queueMutex
+    static std::mutex queueMutex;
+    static std::condition_variable queueCV;
+    static std::vector<std::thread> workers;
+    static bool stopping = false;
+    static std::mt19937 sampleRng(std::random_device{}());  // Guarded by queueMutex
+
+    static std::atomic<uint64_t> verified(0);
+    static std::atomic<uint64_t> invalid(0);
+    static std::atomic<uint64_t> skipped(0);
+
+    // Throughput and queue latency, reported per completed window
+    static std::mutex windowMutex;
+    static std::chrono::steady_clock::time_point windowStart;
+    static uint64_t windowCount = 0;
+    static double windowQueueMsSum = 0.0;
+    static double windowQueueMsMax = 0.0;
+    static Stats lastWindow;
+
+    static void recordVerification(double queueMs) {
+        std::lock_guard<std::mutex> lock(windowMutex);
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - windowStart).count();
+        if (elapsed >= NetworkConstants::PROXY_VERIFY_WINDOW_SEC) {
+            lastWindow.sharesPerSec = windowCount / elapsed;
+            lastWindow.avgQueueMs = windowCount ? windowQueueMsSum / windowCount : 0.0;
+            lastWindow.maxQueueMs = windowQueueMsMax;
+            windowStart = now;
+            windowCount = 0;
+            windowQueueMsSum = 0.0;
+            windowQueueMsMax = 0.0;
+        }
+        windowCount++;
+        windowQueueMsSum += queueMs;
+        windowQueueMsMax = (std::max)(windowQueueMsMax, queueMs);
+    }
+
+    bool meetsTarget(const HexCodec::Hash& hash, const std::string& targetHex) {
+        uint64_t target = Job::targetValue(targetHex);
+        return target != 0 && Job::hashMeetsTarget(hash.data(), target);
+    }
+
+    static Verdict verify(const Share& share) {
+        HexCodec::Hash hash;
+        if (!RandomXManager::lightHash(share.seedHash, share.blob.data, share.blob.size, hash.data())) {
+            return Verdict::Error;
+        }
+        if (hash != share.result) {
+            return Verdict::BadHash;
+        }
+        return meetsTarget(hash, share.target) ? Verdict::Valid : Verdict::LowDifficulty;
+    }
+
+    static void worker() {
+        while (true) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueCV.wait(lock, []() { return stopping || !queue.empty(); });
+                if (stopping) return;
+                task = std::move(queue.front());
+                queue.pop_front();
+            }
+
+            double queueMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - task.queuedAt).count();
+            Verdict verdict = verify(task.share);
+            if (verdict == Verdict::Error) {
+                skipped++;
+            } else {
+                verified++;
+                if (verdict != Verdict::Valid) {
+                    invalid++;
+                }
+                recordVerification(queueMs);
+            }
+            task.done(verdict);
+        }
+    }
+
+    bool start(int threads) {
+        if (!workers.empty() || threads <= 0) {
+            return !workers.empty();
+        }
+        {
+            std::lock_guard<std::mutex> lock(windowMutex);
+            windowStart = std::chrono::steady_clock::now();
+        }
+        stopping = false;
+        for (int i = 0; i < threads; i++) {
+            workers.emplace_back(worker);
+        }
+        threadSafePrint("Share verification: " + std::to_string(threads) + " light-mode RandomX threads", true);
+        return true;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueCV.notify_all();
+        for (auto& thread : workers) {
+            thread.join();
+        }
+        workers.clear();
+
+        // Unverified shares still queued are handed back as unverifiable
+        std::deque<Task> remaining;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            remaining.swap(queue);
+        }
+        for (auto& task : remaining) {
+            skipped++;
+            task.done(Verdict::Error);
+        }
+    }
+
+    bool isRunning() {
+        return !workers.empty();
+    }
+
+    Queued submit(Share share, bool always, Callback done) {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (workers.empty() || stopping) {
+                return Queued::NotSampled;
+            }
+
+            // Full verification up to PROXY_VERIFY_SAMPLE_FROM queued shares, then a
+            // falling sample rate down to PROXY_VERIFY_MIN_SAMPLE_RATE near capacity
+            size_t depth = queue.size();
+            if (depth >= NetworkConstants::PROXY_VERIFY_QUEUE && always) {
+                return Queued::Busy;
+            }
+            bool sampled = depth < NetworkConstants::PROXY_VERIFY_QUEUE;
+            if (sampled && !always && depth >= NetworkConstants::PROXY_VERIFY_SAMPLE_FROM) {
+                double rate = static_cast<double>(NetworkConstants::PROXY_VERIFY_QUEUE - depth) /
+                              (NetworkConstants::PROXY_VERIFY_QUEUE - NetworkConstants::PROXY_VERIFY_SAMPLE_FROM);
+                rate = (std::max)(rate, NetworkConstants::PROXY_VERIFY_MIN_SAMPLE_RATE);
+                sampled = std::uniform_real_distribution<double>(0.0, 1.0)(sampleRng) < rate;
+            }
+            if (!sampled) {
+                skipped++;
+                return Queued::NotSampled;
+            }
+            queue.push_back({std::move(share), std::move(done), std::chrono::steady_clock::now()});
+        }
+        queueCV.notify_one();
+        return Queued::Yes;
+    }
+
+    Stats getStats() {
+        Stats stats;
+        {
+            std::lock_guard<std::mutex> lock(windowMutex);
+            // No verifications for a whole window: report idle rather than stale figures
+            double sinceWindow = std::chrono::duration<double>(std::chrono::steady_clock::now() - windowStart).count();
+            if (sinceWindow < 2 * NetworkConstants::PROXY_VERIFY_WINDOW_SEC) {
+                stats = lastWindow;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stats.queueDepth = queue.size();
+        }
+        stats.verified = verified.load();
+        stats.invalid = invalid.load();
+        stats.skipped = skipped.load();
+        return stats;
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "HexCodec.h"
+
+// Verifies shares from downstream miners with light-mode RandomX before they
+// are relayed upstream. Shares are queued to dedicated threads; when the queue
+// backs up, only a sample is verified so verification cost stays bounded.
+namespace ShareVerifier {
+    enum class Verdict {
+        Valid,
+        BadHash,         // Result does not match the hash of the blob
+        LowDifficulty,   // Hash does not meet the job target
+        Error            // Could not hash (e.g. invalid seed); treated as unverified
+    };
+
+    struct Share {
+        std::string seedHash;
+        std::string target;      // Stratum target hex of the job
+        HexCodec::Blob blob;     // Hashing blob with the miner's nonce in place
+        HexCodec::Hash result;   // Hash claimed by the miner
+    };
+
+    struct Stats {
+        uint64_t verified = 0;
+        uint64_t invalid = 0;
+        uint64_t skipped = 0;        // Passed through unverified because of backlog
+        size_t queueDepth = 0;
+        double sharesPerSec = 0.0;   // Over the last completed window
+        double avgQueueMs = 0.0;     // Queue wait over the last completed window
+        double maxQueueMs = 0.0;
+    };
+
+    enum class Queued {
+        Yes,          // 'done' will run
+        NotSampled,   // Relay unverified; 'done' never runs
+        Busy          // Queue full and the share must be verified; refuse it
+    };
+
+    using Callback = std::function<void(Verdict)>;
+
+    bool start(int threads);
+    void stop();
+    bool isRunning();
+
+    // Queues a share for verification; 'done' runs on a verifier thread.
+    // 'always' bypasses sampling, for suspect miners; such a share is never
+    // passed through unverified, so a full queue returns Busy for it.
+    Queued submit(Share share, bool always, Callback done);
+
+    Stats getStats();
+
+    // True if the hash meets a stratum target (4- or 8-byte little-endian hex)
+    bool meetsTarget(const HexCodec::Hash& hash, const std::string& targetHex);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+// Socket headers for both platforms: WinSock on Windows, BSD sockets elsewhere,
+// with the WinSock names the code uses mapped onto the POSIX calls
+#ifdef _WIN32
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <csignal>
+
+using SOCKET = int;
+constexpr SOCKET INVALID_SOCKET = -1;
+constexpr int SOCKET_ERROR = -1;
+constexpr int SD_RECEIVE = SHUT_RD;
+constexpr int SD_SEND = SHUT_WR;
+constexpr int SD_BOTH = SHUT_RDWR;
+
+inline int closesocket(SOCKET sock) { return close(sock); }
+inline int WSAGetLastError() { return errno; }
+inline const char* gai_strerrorA(int status) { return gai_strerror(status); }
+#endif
+
+// WSAStartup on Windows; elsewhere ignores SIGPIPE, so a send to a closed peer
+// fails with EPIPE instead of ending the process
+inline bool startSockets() {
+#ifdef _WIN32
+    WSADATA wsaData;
+    return WSAStartup(MAKEWORD(2, 2), &wsaData) == 0;
+#else
+    signal(SIGPIPE, SIG_IGN);
+    return true;
+#endif
+}
+
+inline void stopSockets() {
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
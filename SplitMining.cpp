@@ -0,0 +1,650 @@
+#include "SplitMining.h"
+#include "Connector.h"
+#include "RandomXManager.h"
+#include "MiningStats.h"
+#include "Globals.h"
+#include "Config.h"
+#include "Constants.h"
+#include "picojson.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include "Sockets.h"
+
+namespace SplitMining {
+    static constexpr size_t MAX_ENDPOINTS = MiningConstants::MAX_SPLIT_ENDPOINTS + 1;
+
+    // A submitted share waiting for the endpoint's response
+    struct SubmitWaiter {
+        bool done = false;
+        std::string response;
+    };
+
+    // Stratum session of one split endpoint (endpoint index = position + 1)
+    struct Session {
+        SplitEndpoint endpoint;
+        std::string name;
+        std::thread thread;
+
+        std::mutex socketMutex;                 // Guards sends and closing
+        SOCKET sock = INVALID_SOCKET;
+        std::string poolId;                     // Session thread only
+        std::atomic<bool> connected{false};
+        std::atomic<uint64_t> requestId{1};     // 1 is the login
+        int reconnectAttempts = 0;
+
+        std::mutex jobMutex;
+        std::shared_ptr<const Job> job;         // Guarded by jobMutex
+        uint32_t nextNonce = 0;                 // Guarded by jobMutex
+        std::atomic<uint64_t> jobSequence{0};   // Sequence of the newest job
+        std::string waitingSeed;                // Seed last reported as not matching the dataset
+
+        std::mutex submitMutex;
+        std::condition_variable submitCV;
+        std::unordered_map<uint64_t, std::shared_ptr<SubmitWaiter>> submitWaiters;
+        std::atomic<uint64_t> acceptedShares{0};
+        std::atomic<uint64_t> rejectedShares{0};
+    };
+
+    // Hashes per endpoint, one cache line per thread so the hash path never shares one
+    struct alignas(64) ThreadCounters {
+        std::atomic<uint64_t> hashes[MAX_ENDPOINTS];
+        std::atomic<uint64_t> staleHashes[MAX_ENDPOINTS];
+    };
+
+    static bool active = false;                 // Set before the mining threads start
+    static std::atomic<bool> stopping(false);
+    static std::vector<std::unique_ptr<Session>> sessions;
+    static std::vector<int> weights;            // Per endpoint, percent
+    static int numThreads = 0;
+    static std::unique_ptr<std::atomic<int>[]> assignment;    // Endpoint per mining thread
+    static std::unique_ptr<ThreadCounters[]> counters;
+    static std::atomic<bool> ready[MAX_ENDPOINTS];
+    static std::thread schedulerThread;
+    static std::chrono::steady_clock::time_point startTime;
+    static std::mt19937 backoffRng(std::random_device{}());
+
+    static void interruptibleSleep(std::chrono::milliseconds duration) {
+        auto end = std::chrono::steady_clock::now() + duration;
+        while (!stopping && std::chrono::steady_clock::now() < end) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+
+    // Same jittered exponential backoff as the main session
+    static std::chrono::milliseconds nextReconnectDelay(Session& session) {
+        int64_t delay = NetworkConstants::RECONNECT_BACKOFF_BASE_MS;
+        for (int i = 0; i < session.reconnectAttempts && delay < NetworkConstants::RECONNECT_BACKOFF_MAX_MS; i++) {
+            delay *= 2;
+        }
+        delay = (std::min)(delay, static_cast<int64_t>(NetworkConstants::RECONNECT_BACKOFF_MAX_MS));
+        session.reconnectAttempts++;
+        std::uniform_int_distribution<int64_t> jitter(delay / 2, delay);
+        return std::chrono::milliseconds(jitter(backoffRng));
+    }
+
+    static bool sendLine(Session& session, const picojson::object& message) {
+        std::string line = picojson::value(message).serialize() + "\n";
+        std::lock_guard<std::mutex> lock(session.socketMutex);
+        return session.sock != INVALID_SOCKET &&
+            send(session.sock, line.c_str(), static_cast<int>(line.size()), 0) != SOCKET_ERROR;
+    }
+
+    static void closeSession(Session& session) {
+        session.connected = false;
+        {
+            std::lock_guard<std::mutex> lock(session.socketMutex);
+            if (session.sock != INVALID_SOCKET) {
+                closesocket(session.sock);
+                session.sock = INVALID_SOCKET;
+            }
+        }
+        // Shares waiting for this connection will not get an answer
+        std::lock_guard<std::mutex> lock(session.submitMutex);
+        session.submitCV.notify_all();
+    }
+
+    static void setJob(Session& session, const picojson::object& jobObj) {
+        try {
+            std::string jobId = jobObj.at("job_id").get<std::string>();
+            std::string blob = jobObj.at("blob").get<std::string>();
+            std::string target = jobObj.at("target").get<std::string>();
+            uint64_t height = static_cast<uint64_t>(jobObj.at("height").get<double>());
+            std::string seedHash = jobObj.at("seed_hash").get<std::string>();
+
+            HexCodec::Blob blobBytes;
+            HexCodec::Hash seedBytes;
+            if (!HexCodec::decode(blob, blobBytes) ||
+                blobBytes.size < MiningConstants::NONCE_OFFSET + MiningConstants::NONCE_SIZE ||
+                !HexCodec::decode(seedHash, seedBytes) || Job::targetValue(target) == 0) {
+                threadSafePrint("Split " + session.name + ": invalid job " + jobId, true);
+                return;
+            }
+
+            auto job = std::make_shared<Job>(jobId, blob, target, static_cast<uint32_t>(height), seedHash);
+            job->receivedAt = std::chrono::steady_clock::now();
+            {
+                std::lock_guard<std::mutex> lock(session.jobMutex);
+                if (session.job && session.job->getJobId() == jobId) {
+                    return;
+                }
+                job->sequence = session.jobSequence.load() + 1;
+                session.job = job;
+                session.nextNonce = 0;
+                session.jobSequence = job->sequence;
+            }
+
+            // The dataset follows the main pool; a split endpoint only builds it if nothing has yet
+            if (!RandomXManager::isInitialized()) {
+                RandomXManager::initialize(seedHash);
+            }
+            if (seedHash != RandomXManager::getCurrentSeedHash() && seedHash != session.waitingSeed) {
+                session.waitingSeed = seedHash;
+                threadSafePrint("Split " + session.name + ": job on another seed than the dataset, "
+                    "paused until the seeds match", true);
+            }
+            threadSafePrint("Split " + session.name + ": new job " + jobId + " at height " +
+                std::to_string(height) + ", difficulty " + std::to_string(static_cast<uint64_t>(job->getDifficulty())), true);
+        }
+        catch (const std::exception& e) {
+            threadSafePrint("Split " + session.name + ": error processing job: " + std::string(e.what()), true);
+        }
+    }
+
+    // Returns false if the session has to be dropped
+    static bool handleMessage(Session& session, const std::string& line) {
+        picojson::value v;
+        std::string err = picojson::parse(v, line);
+        if (!err.empty() || !v.is<picojson::object>()) {
+            threadSafePrint("Split " + session.name + ": invalid message", true);
+            return true;
+        }
+        const picojson::object& obj = v.get<picojson::object>();
+        if (config.debugMode) {
+            threadSafePrint("Split " + session.name + " received: " + line, true);
+        }
+
+        auto method = obj.find("method");
+        if (method != obj.end() && method->second.is<std::string>()) {
+            auto params = obj.find("params");
+            if (method->second.get<std::string>() == "job" && params != obj.end() &&
+                params->second.is<picojson::object>()) {
+                setJob(session, params->second.get<picojson::object>());
+            }
+            return true;
+        }
+
+        auto id = obj.find("id");
+        if (id == obj.end() || !id->second.is<double>()) {
+            return true;
+        }
+        uint64_t requestId = static_cast<uint64_t>(id->second.get<double>());
+
+        // Login response
+        if (requestId == 1 && !session.connected) {
+            auto result = obj.find("result");
+            if (result == obj.end() || !result->second.is<picojson::object>()) {
+                auto error = obj.find("error");
+                threadSafePrint("Split " + session.name + ": login failed: " +
+                    (error != obj.end() ? error->second.serialize() : line), true);
+                return false;
+            }
+            const picojson::object& resultObj = result->second.get<picojson::object>();
+            auto poolId = resultObj.find("id");
+            session.poolId = poolId != resultObj.end() && poolId->second.is<std::string>() ?
+                poolId->second.get<std::string>() : "1";
+            session.connected = true;
+            session.reconnectAttempts = 0;
+            threadSafePrint("Split " + session.name + ": logged in", true);
+            auto job = resultObj.find("job");
+            if (job != resultObj.end() && job->second.is<picojson::object>()) {
+                setJob(session, job->second.get<picojson::object>());
+            }
+            return true;
+        }
+
+        std::lock_guard<std::mutex> lock(session.submitMutex);
+        auto waiter = session.submitWaiters.find(requestId);
+        if (waiter != session.submitWaiters.end()) {
+            waiter->second->done = true;
+            waiter->second->response = line;
+            session.submitCV.notify_all();
+        }
+        return true;
+    }
+
+    static bool login(Session& session) {
+        std::vector<Connector::Attempt> attempts;
+        SOCKET sock = Connector::connect(session.endpoint.address, std::to_string(session.endpoint.port), attempts);
+        if (sock == INVALID_SOCKET) {
+            threadSafePrint("Split " + session.name + ": connect failed: " + Connector::describe(attempts), true);
+            return false;
+        }
+        int optval = 1;
+        setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, reinterpret_cast<char*>(&optval), sizeof(optval));
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<char*>(&optval), sizeof(optval));
+        {
+            std::lock_guard<std::mutex> lock(session.socketMutex);
+            session.sock = sock;
+        }
+
+        picojson::object params;
+        params["agent"] = picojson::value(config.userAgent);
+        params["login"] = picojson::value(session.endpoint.wallet.empty() ? config.walletAddress : session.endpoint.wallet);
+        params["pass"] = picojson::value(session.endpoint.password.empty() ? config.password : session.endpoint.password);
+        params["worker"] = picojson::value(session.endpoint.worker.empty() ? config.workerName : session.endpoint.worker);
+        picojson::object request;
+        request["id"] = picojson::value(1.0);
+        request["jsonrpc"] = picojson::value("2.0");
+        request["method"] = picojson::value("login");
+        request["params"] = picojson::value(params);
+        if (!sendLine(session, request)) {
+            threadSafePrint("Split " + session.name + ": failed to send login", true);
+            return false;
+        }
+        return true;
+    }
+
+    // Reads the session until it fails, goes silent or the miner stops
+    static void readSession(Session& session) {
+        std::string buffer;
+        auto lastReceive = std::chrono::steady_clock::now();
+        bool keepaliveSent = false;
+        std::vector<pollfd> fds(1);
+        fds[0].fd = session.sock;
+        fds[0].events = POLLIN;
+        while (!stopping) {
+            int ready = Connector::pollSockets(fds, 1000);
+            if (ready < 0) {
+                return;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (ready > 0) {
+                std::vector<std::string> lines;
+                if (!PoolClient::readLines(session.sock, buffer, lines)) {
+                    return;
+                }
+                lastReceive = now;
+                keepaliveSent = false;
+                for (const auto& line : lines) {
+                    if (!handleMessage(session, line)) {
+                        return;
+                    }
+                }
+                continue;
+            }
+
+            // Same silence handling as the main session: keepalived first, then give up
+            auto silentSec = std::chrono::duration_cast<std::chrono::seconds>(now - lastReceive).count();
+            if (!session.connected && silentSec >= NetworkConstants::SOCKET_TIMEOUT_SEC) {
+                threadSafePrint("Split " + session.name + ": no login response", true);
+                return;
+            }
+            if (config.idleTimeoutSec > 0 && silentSec >= config.idleTimeoutSec) {
+                threadSafePrint("Split " + session.name + ": silent for " + std::to_string(silentSec) +
+                    "s, reconnecting", true);
+                return;
+            }
+            if (session.connected && config.keepaliveSec > 0 && !keepaliveSent && silentSec >= config.keepaliveSec) {
+                picojson::object params;
+                params["id"] = picojson::value(session.poolId);
+                picojson::object request;
+                request["id"] = picojson::value(static_cast<double>(++session.requestId));
+                request["jsonrpc"] = picojson::value("2.0");
+                request["method"] = picojson::value("keepalived");
+                request["params"] = picojson::value(params);
+                keepaliveSent = sendLine(session, request);
+            }
+        }
+    }
+
+    static void runSession(Session& session) {
+        while (!stopping) {
+            if (login(session)) {
+                readSession(session);
+            }
+            closeSession(session);
+            {
+                std::lock_guard<std::mutex> lock(session.jobMutex);
+                session.job.reset();
+            }
+            if (!stopping) {
+                auto delay = nextReconnectDelay(session);
+                threadSafePrint("Split " + session.name + ": reconnecting in " +
+                    std::to_string(delay.count()) + " ms", true);
+                interruptibleSleep(delay);
+            }
+        }
+    }
+
+    // The main session is usable if it has a job on the dataset's seed
+    static bool mainReady(const std::string& datasetSeed) {
+        std::lock_guard<std::mutex> lock(PoolClient::jobMutex);
+        return !PoolClient::jobQueue.empty() && PoolClient::isJobUsable() &&
+            PoolClient::jobQueue.front().getSeedHash() == datasetSeed;
+    }
+
+    static bool sessionReady(Session& session, const std::string& datasetSeed) {
+        std::lock_guard<std::mutex> lock(session.jobMutex);
+        return session.connected && session.job && session.job->getSeedHash() == datasetSeed;
+    }
+
+    // Returns true if an endpoint got or lost work since the last call
+    static bool updateReady() {
+        std::string datasetSeed = RandomXManager::getCurrentSeedHash();
+        bool changed = false;
+        for (size_t e = 0; e <= sessions.size(); e++) {
+            bool isReady = e == 0 ? mainReady(datasetSeed) : sessionReady(*sessions[e - 1], datasetSeed);
+            changed |= ready[e].exchange(isReady) != isReady;
+        }
+        return changed;
+    }
+
+    // Hands the thread slots of the next slice to ready endpoints by weight. Each
+    // endpoint earns its weighted share of the threads per slice and pays one per slot
+    // it gets, so fractions carry over: 70/30 on 4 threads alternates 3/1 and 2/2.
+    // Threads stay on their endpoint when it keeps slots, so only the difference
+    // changes job.
+    static void rebalance(std::vector<double>& credit) {
+        // Only the threads the HTTP API leaves mining are dealt out; the others idle on the main session
+        int mining = miningPaused ? 0 : (std::min)((std::max)(activeThreads.load(), 0), numThreads);
+        size_t count = sessions.size() + 1;
+        double readyWeight = 0.0;
+        for (size_t e = 0; e < count; e++) {
+            if (ready[e]) {
+                readyWeight += weights[e];
+            } else {
+                credit[e] = 0.0;
+            }
+        }
+
+        // Nothing to mine anywhere: leave the threads on the main session, which idles them
+        std::vector<int> slots(count, 0);
+        if (readyWeight == 0.0) {
+            slots[0] = mining;
+        } else {
+            for (size_t e = 0; e < count; e++) {
+                if (ready[e]) {
+                    credit[e] += mining * weights[e] / readyWeight;
+                }
+            }
+            for (int slot = 0; slot < mining; slot++) {
+                size_t best = count;
+                for (size_t e = 0; e < count; e++) {
+                    if (ready[e] && (best == count || credit[e] > credit[best])) {
+                        best = e;
+                    }
+                }
+                slots[best]++;
+                credit[best] -= 1.0;
+            }
+        }
+
+        std::vector<int> next(numThreads, -1);
+        for (int t = mining; t < numThreads; t++) {
+            next[t] = 0;
+            assignment[t] = 0;
+        }
+        for (int t = 0; t < mining; t++) {
+            int current = assignment[t].load();
+            if (slots[current] > 0) {
+                next[t] = current;
+                slots[current]--;
+            }
+        }
+        int moved = 0;
+        for (int t = 0; t < numThreads; t++) {
+            if (next[t] >= 0) continue;
+            for (size_t e = 0; e < count; e++) {
+                if (slots[e] > 0) {
+                    next[t] = static_cast<int>(e);
+                    slots[e]--;
+                    break;
+                }
+            }
+            assignment[t] = next[t];
+            moved++;
+        }
+
+        // Job switches of the main session complete once its own threads are on the new job
+        int mainThreads = static_cast<int>(std::count(next.begin(), next.begin() + mining, 0));
+        MiningStats::setJobSwitchThreads(mainThreads);
+        if (config.debugMode && moved > 0) {
+            threadSafePrint("Split: moved " + std::to_string(moved) + " threads, main pool has " +
+                std::to_string(mainThreads) + "/" + std::to_string(numThreads), true);
+        }
+    }
+
+    static void schedule() {
+        std::vector<double> credit(sessions.size() + 1, 0.0);
+        while (!stopping) {
+            updateReady();
+            rebalance(credit);
+
+            // The slice ends early when an endpoint comes or goes, so no thread waits on one without work
+            auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(MiningConstants::SPLIT_SLICE_MS);
+            while (!stopping && std::chrono::steady_clock::now() < end) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                if (updateReady()) {
+                    break;
+                }
+            }
+        }
+    }
+
+    void start() {
+        if (config.splits.empty() || config.proxyMode) {
+            return;
+        }
+        stopping = false;
+        numThreads = config.numThreads;
+        startTime = std::chrono::steady_clock::now();
+        assignment.reset(new std::atomic<int>[numThreads]);
+        counters.reset(new ThreadCounters[numThreads]);
+        for (int t = 0; t < numThreads; t++) {
+            assignment[t] = 0;
+            for (size_t e = 0; e < MAX_ENDPOINTS; e++) {
+                counters[t].hashes[e] = 0;
+                counters[t].staleHashes[e] = 0;
+            }
+        }
+        weights.assign(1, config.getMainWeight());
+        for (const auto& split : config.splits) {
+            auto session = std::make_unique<Session>();
+            session->endpoint = split;
+            session->name = split.address + ":" + std::to_string(split.port);
+            sessions.push_back(std::move(session));
+            weights.push_back(split.weight);
+        }
+        for (auto& session : sessions) {
+            Session* s = session.get();
+            s->thread = std::thread([s]() { runSession(*s); });
+        }
+        schedulerThread = std::thread(schedule);
+        active = true;
+        threadSafePrint("Splitting hashpower: main pool " + std::to_string(weights[0]) + "%, " +
+            std::to_string(sessions.size()) + " split endpoints", true);
+    }
+
+    void stop() {
+        if (!active) {
+            return;
+        }
+        stopping = true;
+        if (schedulerThread.joinable()) {
+            schedulerThread.join();
+        }
+        for (auto& session : sessions) {
+            if (session->thread.joinable()) {
+                session->thread.join();
+            }
+        }
+        sessions.clear();
+        active = false;
+    }
+
+    bool isActive() {
+        return active;
+    }
+
+    int endpointFor(int threadId) {
+        if (!active || threadId < 0 || threadId >= numThreads) {
+            return 0;
+        }
+        return assignment[threadId].load(std::memory_order_relaxed);
+    }
+
+    bool getWork(int endpoint, Work& work) {
+        if (!active || endpoint <= 0 || endpoint > static_cast<int>(sessions.size())) {
+            return false;
+        }
+        Session& session = *sessions[endpoint - 1];
+        std::lock_guard<std::mutex> lock(session.jobMutex);
+        if (!session.job || !session.connected) {
+            return false;
+        }
+        // A hash on another seed's dataset would be worthless
+        if (session.job->getSeedHash() != RandomXManager::getCurrentSeedHash()) {
+            return false;
+        }
+        work.job = session.job;
+        work.nonce = session.nextNonce++;
+        return true;
+    }
+
+    void recordHash(int threadId, int endpoint, uint64_t jobSequence) {
+        if (!active || threadId < 0 || threadId >= numThreads || endpoint < 0 ||
+            endpoint > static_cast<int>(sessions.size())) {
+            return;
+        }
+        ThreadCounters& thread = counters[threadId];
+        thread.hashes[endpoint].fetch_add(1, std::memory_order_relaxed);
+        if (endpoint > 0 && jobSequence < sessions[endpoint - 1]->jobSequence.load(std::memory_order_relaxed)) {
+            thread.staleHashes[endpoint].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    PoolClient::ShareStatus submitShare(int endpoint, const std::string& jobId,
+                                        const std::string& nonce, const std::string& result) {
+        if (!active || endpoint <= 0 || endpoint > static_cast<int>(sessions.size())) {
+            return PoolClient::ShareStatus::Rejected;
+        }
+        Session& session = *sessions[endpoint - 1];
+        if (!session.connected) {
+            session.rejectedShares++;
+            threadSafePrint("Split " + session.name + ": disconnected, share for job " + jobId + " dropped", true);
+            return PoolClient::ShareStatus::Rejected;
+        }
+
+        uint64_t id = ++session.requestId;
+        auto waiter = std::make_shared<SubmitWaiter>();
+        {
+            std::lock_guard<std::mutex> lock(session.submitMutex);
+            session.submitWaiters[id] = waiter;
+        }
+        picojson::object params;
+        params["id"] = picojson::value(session.poolId);
+        params["job_id"] = picojson::value(jobId);
+        params["nonce"] = picojson::value(nonce);
+        params["result"] = picojson::value(result);
+        params["algo"] = picojson::value("rx/0");
+        picojson::object request;
+        request["id"] = picojson::value(static_cast<double>(id));
+        request["jsonrpc"] = picojson::value("2.0");
+        request["method"] = picojson::value("submit");
+        request["params"] = picojson::value(params);
+        bool sent = sendLine(session, request);
+
+        std::string response;
+        {
+            std::unique_lock<std::mutex> lock(session.submitMutex);
+            if (sent) {
+                session.submitCV.wait_for(lock, std::chrono::seconds(NetworkConstants::SUBMIT_TIMEOUT_SEC),
+                    [&]() { return waiter->done || !session.connected; });
+            }
+            response = waiter->response;
+            session.submitWaiters.erase(id);
+        }
+
+        // {"result":{"status":"OK"}} or {"error":{"message":"..."}}
+        picojson::value v;
+        std::string status = sent ? "no response" : "send failed";
+        bool accepted = false;
+        if (!response.empty() && picojson::parse(v, response).empty() && v.is<picojson::object>()) {
+            const picojson::object& obj = v.get<picojson::object>();
+            auto resultIt = obj.find("result");
+            auto errorIt = obj.find("error");
+            if (errorIt != obj.end() && errorIt->second.is<picojson::object>()) {
+                const picojson::object& error = errorIt->second.get<picojson::object>();
+                auto message = error.find("message");
+                status = message != error.end() && message->second.is<std::string>() ?
+                    message->second.get<std::string>() : errorIt->second.serialize();
+            } else if (resultIt != obj.end() && resultIt->second.is<picojson::object>()) {
+                const picojson::object& resultObj = resultIt->second.get<picojson::object>();
+                auto statusIt = resultObj.find("status");
+                status = statusIt != resultObj.end() && statusIt->second.is<std::string>() ?
+                    statusIt->second.get<std::string>() : "OK";
+                accepted = status == "OK";
+            }
+        }
+
+        if (accepted) {
+            session.acceptedShares++;
+            return PoolClient::ShareStatus::Accepted;
+        }
+        session.rejectedShares++;
+        threadSafePrint("Split " + session.name + ": share rejected: " + status, true);
+        return PoolClient::isStaleReject(status) ? PoolClient::ShareStatus::Stale : PoolClient::ShareStatus::Rejected;
+    }
+
+    std::vector<EndpointStats> getStats() {
+        std::vector<EndpointStats> stats;
+        if (!active) {
+            return stats;
+        }
+        double elapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        uint64_t allHashes = 0;
+        for (size_t e = 0; e <= sessions.size(); e++) {
+            EndpointStats endpoint;
+            endpoint.weight = weights[e];
+            endpoint.ready = ready[e];
+            for (int t = 0; t < numThreads; t++) {
+                endpoint.hashes += counters[t].hashes[e].load();
+                endpoint.staleHashes += counters[t].staleHashes[e].load();
+                if (assignment[t].load() == static_cast<int>(e)) {
+                    endpoint.threads++;
+                }
+            }
+            if (e == 0) {
+                int pool = PoolClient::activePool.load();
+                endpoint.name = !config.daemonAddress.empty() ? "daemon " + config.daemonAddress :
+                    pool >= 0 && pool < static_cast<int>(PoolClient::poolList.size()) ?
+                    PoolClient::poolList[pool].address + ":" + std::to_string(PoolClient::poolList[pool].port) : "main pool";
+                endpoint.connected = PoolClient::isJobUsable();
+                for (const auto& health : PoolClient::getPoolHealth()) {
+                    endpoint.acceptedShares += health.acceptedShares;
+                    endpoint.rejectedShares += health.rejectedShares;
+                }
+            } else {
+                Session& session = *sessions[e - 1];
+                endpoint.name = session.name;
+                endpoint.connected = session.connected;
+                endpoint.acceptedShares = session.acceptedShares;
+                endpoint.rejectedShares = session.rejectedShares;
+            }
+            endpoint.hashrate = elapsedSec > 0.0 ? endpoint.hashes / elapsedSec : 0.0;
+            allHashes += endpoint.hashes;
+            stats.push_back(endpoint);
+        }
+        for (auto& endpoint : stats) {
+            endpoint.hashShare = allHashes == 0 ? 0.0 : 100.0 * endpoint.hashes / allHashes;
+        }
+        return stats;
+    }
+}
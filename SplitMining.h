@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Job.h"
+#include "PoolClient.h"
+
+// Splits the hashpower of one process between the main pool session (endpoint 0,
+// with its failover list) and extra pool/wallet endpoints by weight, e.g. 70/30.
+// Each extra endpoint has its own light stratum session. A scheduler hands out
+// mining threads per time slice, carrying fractions over so the weights hold
+// exactly over time while as few threads as possible change endpoint. Every
+// endpoint hashes with the one RandomX dataset; an endpoint whose job is on
+// another seed gets no threads until its seed matches, and its weight goes to
+// the others meanwhile.
+namespace SplitMining {
+    struct Work {
+        std::shared_ptr<const Job> job;
+        uint32_t nonce = 0;
+    };
+
+    struct EndpointStats {
+        std::string name;               // host:port
+        int weight = 0;                 // Configured percentage
+        int threads = 0;                // Assigned in the current slice
+        bool connected = false;
+        bool ready = false;             // Has a job on the dataset's seed
+        uint64_t hashes = 0;
+        uint64_t staleHashes = 0;       // Completed after the endpoint had sent a newer job
+        uint64_t acceptedShares = 0;
+        uint64_t rejectedShares = 0;
+        double hashrate = 0.0;          // Effective H/s since start
+        double hashShare = 0.0;         // Percent of all hashes
+    };
+
+    // Starts a session per configured split endpoint and the scheduler.
+    // Does nothing, and endpointFor always returns 0, without splits.
+    void start();
+    void stop();
+    bool isActive();
+
+    // Endpoint a mining thread should hash for in the current slice; 0 is the main session
+    int endpointFor(int threadId);
+
+    // Current job of a split endpoint and a nonce no other thread gets; false if none
+    bool getWork(int endpoint, Work& work);
+
+    // Counts a completed hash towards an endpoint's effective hashrate
+    void recordHash(int threadId, int endpoint, uint64_t jobSequence);
+
+    PoolClient::ShareStatus submitShare(int endpoint, const std::string& jobId,
+                                        const std::string& nonce, const std::string& result);
+
+    // Endpoint 0 first
+    std::vector<EndpointStats> getStats();
+}
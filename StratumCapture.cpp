@@ -0,0 +1,162 @@
+#include "StratumCapture.h"
+#include "Globals.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace StratumCapture {
+    static const char* FILE_HEADER = "# MoneroMiner stratum capture v1";
+
+    static std::ofstream captureFile;
+    static std::string capturePath;
+    static std::chrono::steady_clock::time_point captureStart;
+    static std::deque<Entry> queue;  // Guarded by queueMutex
+    static std::mutex queueMutex;
+    static std::condition_variable queueCV;
+    static std::thread writerThread;
+    static bool stopWriter = false;
+    static std::atomic<bool> opened(false);
+
+    // Batches queued entries into a single write and flush
+    static void writerLoop() {
+        std::string buffer;
+        std::unique_lock<std::mutex> lock(queueMutex);
+        while (true) {
+            queueCV.wait(lock, []() { return stopWriter || !queue.empty(); });
+            if (queue.empty() && stopWriter) {
+                break;
+            }
+            std::deque<Entry> batch;
+            batch.swap(queue);
+            lock.unlock();
+
+            buffer.clear();
+            for (const auto& entry : batch) {
+                buffer += std::to_string(entry.timeUs);
+                buffer += ' ';
+                buffer += static_cast<char>(entry.direction);
+                buffer += ' ';
+                buffer += entry.line;
+                buffer += '\n';
+            }
+            captureFile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            captureFile.flush();
+            if (!captureFile) {
+                threadSafePrint("Failed to write stratum capture " + capturePath, true);
+                captureFile.clear();
+            }
+
+            lock.lock();
+        }
+    }
+
+    bool open(const std::string& path) {
+        if (opened) {
+            return true;
+        }
+        captureFile.open(path, std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!captureFile) {
+            threadSafePrint("Failed to open stratum capture " + path, true);
+            return false;
+        }
+        captureFile << FILE_HEADER << '\n';
+        captureFile.flush();
+
+        capturePath = path;
+        captureStart = std::chrono::steady_clock::now();
+        stopWriter = false;
+        writerThread = std::thread(writerLoop);
+        opened = true;
+        threadSafePrint("Recording stratum session to " + path, true);
+        return true;
+    }
+
+    void close() {
+        if (!opened) {
+            return;
+        }
+        opened = false;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopWriter = true;
+        }
+        queueCV.notify_one();
+        writerThread.join();
+        captureFile.close();
+    }
+
+    bool isOpen() {
+        return opened;
+    }
+
+    void record(Direction direction, const std::string& line) {
+        if (!opened) {
+            return;
+        }
+        Entry entry;
+        entry.timeUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - captureStart).count());
+        entry.direction = direction;
+        entry.line = line;
+        // Keep one entry per line even for unexpected embedded line breaks
+        for (char& c : entry.line) {
+            if (c == '\n' || c == '\r') c = ' ';
+        }
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queue.push_back(std::move(entry));
+        }
+        queueCV.notify_one();
+    }
+
+    bool load(const std::string& path, std::vector<Entry>& entries) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            threadSafePrint("Cannot open stratum capture " + path, true);
+            return false;
+        }
+        std::string line;
+        if (!std::getline(in, line) || line.rfind(FILE_HEADER, 0) != 0) {
+            threadSafePrint(path + " is not a stratum capture", true);
+            return false;
+        }
+
+        size_t lineNumber = 1;
+        while (std::getline(in, line)) {
+            lineNumber++;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty()) continue;
+
+            // "<time> <direction> <text>"; a capture cut off mid-write ends early
+            size_t space = line.find(' ');
+            if (space == std::string::npos || space + 2 > line.size() ||
+                (space + 2 < line.size() && line[space + 2] != ' ')) {
+                threadSafePrint(path + ":" + std::to_string(lineNumber) + ": malformed entry, stopping", true);
+                break;
+            }
+            Entry entry;
+            try {
+                entry.timeUs = std::stoull(line.substr(0, space));
+            } catch (const std::exception&) {
+                threadSafePrint(path + ":" + std::to_string(lineNumber) + ": malformed time, stopping", true);
+                break;
+            }
+            char direction = line[space + 1];
+            if (direction != '<' && direction != '>' && direction != '!') {
+                threadSafePrint(path + ":" + std::to_string(lineNumber) + ": unknown direction, stopping", true);
+                break;
+            }
+            entry.direction = static_cast<Direction>(direction);
+            entry.line = space + 3 <= line.size() ? line.substr(space + 3) : std::string();
+            entries.push_back(std::move(entry));
+        }
+        return true;
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Capture of the raw stratum lines of the active pool session, for replaying a
+// real session later (see StratumReplay). Lines are queued by the caller and
+// written by a background thread, so recording never touches the disk on a
+// mining thread.
+//
+// Text file, one entry per line after a "#" header line:
+//   <microseconds since capture start> <direction> <raw stratum line>
+// Timestamps come from the monotonic clock. Direction is '<' for lines from the
+// pool, '>' for lines sent to it and '!' for client events (connects,
+// failovers), whose text is free-form.
+namespace StratumCapture {
+    enum class Direction : char {
+        Received = '<',
+        Sent = '>',
+        Event = '!'
+    };
+
+    struct Entry {
+        uint64_t timeUs = 0;
+        Direction direction = Direction::Received;
+        std::string line;
+    };
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen();
+
+    void record(Direction direction, const std::string& line);  // Never blocks on I/O
+
+    bool load(const std::string& path, std::vector<Entry>& entries);
+}
@@ -0,0 +1,1113 @@
+#include "StratumProxy.h"
+#include "PoolClient.h"
+#include "Globals.h"
+#include "Config.h"
+#include "Constants.h"
+#include "HexCodec.h"
+#include "ShareVerifier.h"
+#include "Vardiff.h"
+#include "picojson.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "Sockets.h"
+#ifndef _WIN32
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <cerrno>
+#endif
+
+namespace StratumProxy {
+    // Blob byte each miner keeps fixed: the most significant nonce byte
+    static constexpr int FIXED_BYTE_OFFSET = MiningConstants::NONCE_OFFSET + MiningConstants::NONCE_SIZE - 1;
+
+#ifdef _WIN32
+    static constexpr int SEND_FLAGS = 0;
+#else
+    static constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#endif
+
+    static bool setNonBlocking(SOCKET socket) {
+#ifdef _WIN32
+        u_long mode = 1;
+        return ioctlsocket(socket, FIONBIO, &mode) == 0;
+#else
+        int flags = fcntl(socket, F_GETFL, 0);
+        return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+    }
+
+    static bool wouldBlock() {
+#ifdef _WIN32
+        return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+    }
+
+    // Readiness notification for the listener and miner sockets: epoll on Linux,
+    // WSAPoll on Windows. wake() interrupts wait() from any thread.
+    class Poller {
+    public:
+        struct Event {
+            SOCKET socket;
+            bool readable;
+            bool writable;
+            bool error;
+        };
+
+        bool init();
+        void shutdown();
+        bool add(SOCKET socket);
+        void remove(SOCKET socket);
+        void setWantWrite(SOCKET socket, bool enable);
+        void wake();
+        bool wait(int timeoutMs, std::vector<Event>& events);  // Wakeups are consumed here
+
+    private:
+#ifdef _WIN32
+        std::vector<WSAPOLLFD> fds;
+        std::unordered_map<SOCKET, size_t> index;
+        SOCKET wakeRead = INVALID_SOCKET;
+        SOCKET wakeWrite = INVALID_SOCKET;
+#else
+        int epollFd = -1;
+        int wakeFd = -1;
+        std::vector<epoll_event> ready;
+#endif
+    };
+
+#ifdef _WIN32
+    // WSAPoll has no eventfd equivalent, so wakeups go through a loopback socket pair
+    bool Poller::init() {
+        SOCKET listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (listener == INVALID_SOCKET) {
+            return false;
+        }
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int addrLen = sizeof(addr);
+        bool ok = bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != SOCKET_ERROR &&
+                  listen(listener, 1) != SOCKET_ERROR &&
+                  getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &addrLen) != SOCKET_ERROR;
+        if (ok) {
+            wakeWrite = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            ok = wakeWrite != INVALID_SOCKET &&
+                 ::connect(wakeWrite, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != SOCKET_ERROR;
+        }
+        if (ok) {
+            wakeRead = accept(listener, nullptr, nullptr);
+            ok = wakeRead != INVALID_SOCKET && setNonBlocking(wakeRead) && setNonBlocking(wakeWrite);
+        }
+        closesocket(listener);
+        if (!ok) {
+            shutdown();
+            return false;
+        }
+        WSAPOLLFD fd = {};
+        fd.fd = wakeRead;
+        fd.events = POLLRDNORM;
+        fds.push_back(fd);
+        index[wakeRead] = 0;
+        return true;
+    }
+
+    void Poller::shutdown() {
+        if (wakeRead != INVALID_SOCKET) closesocket(wakeRead);
+        if (wakeWrite != INVALID_SOCKET) closesocket(wakeWrite);
+        wakeRead = wakeWrite = INVALID_SOCKET;
+        fds.clear();
+        index.clear();
+    }
+
+    bool Poller::add(SOCKET socket) {
+        WSAPOLLFD fd = {};
+        fd.fd = socket;
+        fd.events = POLLRDNORM;
+        index[socket] = fds.size();
+        fds.push_back(fd);
+        return true;
+    }
+
+    void Poller::remove(SOCKET socket) {
+        auto it = index.find(socket);
+        if (it == index.end()) return;
+        size_t pos = it->second;
+        index.erase(it);
+        if (pos != fds.size() - 1) {
+            fds[pos] = fds.back();
+            index[fds[pos].fd] = pos;
+        }
+        fds.pop_back();
+    }
+
+    void Poller::setWantWrite(SOCKET socket, bool enable) {
+        auto it = index.find(socket);
+        if (it != index.end()) {
+            fds[it->second].events = POLLRDNORM | (enable ? POLLWRNORM : 0);
+        }
+    }
+
+    void Poller::wake() {
+        char byte = 1;
+        send(wakeWrite, &byte, 1, 0);
+    }
+
+    bool Poller::wait(int timeoutMs, std::vector<Event>& events) {
+        events.clear();
+        int count = WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), timeoutMs);
+        if (count == SOCKET_ERROR) {
+            return false;
+        }
+        for (size_t i = 0; i < fds.size() && count > 0; i++) {
+            short revents = fds[i].revents;
+            if (revents == 0) continue;
+            count--;
+            if (fds[i].fd == wakeRead) {
+                char drain[64];
+                while (recv(wakeRead, drain, sizeof(drain), 0) > 0) {}
+                continue;
+            }
+            events.push_back({fds[i].fd,
+                              (revents & (POLLRDNORM | POLLHUP)) != 0,
+                              (revents & POLLWRNORM) != 0,
+                              (revents & (POLLERR | POLLNVAL)) != 0});
+        }
+        return true;
+    }
+#else
+    bool Poller::init() {
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epollFd < 0 || wakeFd < 0) {
+            shutdown();
+            return false;
+        }
+        ready.resize(1024);
+        return add(wakeFd);
+    }
+
+    void Poller::shutdown() {
+        if (wakeFd >= 0) ::close(wakeFd);
+        if (epollFd >= 0) ::close(epollFd);
+        wakeFd = epollFd = -1;
+    }
+
+    bool Poller::add(SOCKET socket) {
+        epoll_event event = {};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = socket;
+        return epoll_ctl(epollFd, EPOLL_CTL_ADD, socket, &event) == 0;
+    }
+
+    void Poller::remove(SOCKET socket) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, socket, nullptr);
+    }
+
+    void Poller::setWantWrite(SOCKET socket, bool enable) {
+        epoll_event event = {};
+        event.events = EPOLLIN | EPOLLRDHUP | (enable ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+        event.data.fd = socket;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, socket, &event);
+    }
+
+    void Poller::wake() {
+        uint64_t one = 1;
+        ssize_t written = ::write(wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+
+    bool Poller::wait(int timeoutMs, std::vector<Event>& events) {
+        events.clear();
+        int count = epoll_wait(epollFd, ready.data(), static_cast<int>(ready.size()), timeoutMs);
+        if (count < 0) {
+            return errno == EINTR;
+        }
+        for (int i = 0; i < count; i++) {
+            const epoll_event& event = ready[i];
+            if (event.data.fd == wakeFd) {
+                uint64_t value;
+                ssize_t drained = ::read(wakeFd, &value, sizeof(value));
+                (void)drained;
+                continue;
+            }
+            events.push_back({event.data.fd,
+                              (event.events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) != 0,
+                              (event.events & EPOLLOUT) != 0,
+                              (event.events & EPOLLERR) != 0});
+        }
+        return true;
+    }
+#endif
+
+    // A job notification as the miner saw it. Every notification gets its own job
+    // id (miners drop the connection on a repeated id), so a share's job id tells
+    // which upstream job and which target it was found for.
+    struct SentJob {
+        std::string id;
+        std::string upstreamJobId;
+        uint64_t target;
+    };
+
+    struct Miner {
+        uint64_t connId = 0;
+        SOCKET socket = INVALID_SOCKET;
+        std::string address;
+        std::string sessionId;   // Stratum "id" handed out at login
+        std::string agent;
+        int slot = -1;           // Fixed nonce byte; -1 until logged in
+        std::string recvBuffer;
+        std::string sendBuffer;
+        bool closeAfterSend = false;
+        bool closing = false;
+        std::chrono::steady_clock::time_point lastActivity;
+        uint64_t accepted = 0;
+        uint64_t rejected = 0;
+        uint64_t invalid = 0;
+        uint64_t verified = 0;   // Shares that passed local verification
+        std::unique_ptr<Vardiff> vardiff;  // Null when miners get the upstream target
+        std::string target;      // Stratum target of the next job notification
+        uint64_t targetValue = 0;
+        std::deque<SentJob> sentJobs;  // Newest first
+        uint64_t nextJobSeq = 0;
+    };
+
+    // Upstream jobs still accepting shares: the current one and its predecessor
+    struct ProxyJob {
+        std::string jobId;
+        std::string blob;
+        HexCodec::Blob blobBytes;
+        std::string target;
+        uint64_t targetValue = 0;
+        uint64_t difficulty = 0;
+        std::string seedHash;
+        uint32_t height = 0;
+        std::unordered_set<uint32_t> nonces;  // Submitted nonces, for duplicate detection
+
+        // Job params split around the per-miner fields (nonce byte, job id
+        // suffix, target, session id)
+        std::string paramsHead;
+        std::string paramsMiddle;
+        std::string paramsTail;
+    };
+
+    struct RelayTask {
+        uint64_t connId;
+        picojson::value requestId;
+        std::string jobId;
+        std::string nonce;
+        std::string result;
+        bool verified = false;
+    };
+
+    struct RelayResult {
+        uint64_t connId;
+        bool accepted;
+        bool verified;
+        bool failedVerification;
+        std::string response;
+    };
+
+    static Poller poller;
+    static std::atomic<bool> running(false);
+
+    // Latest upstream job not yet applied, handed over from the PoolClient thread
+    static std::mutex upstreamMutex;
+    static std::unique_ptr<Job> upstreamJob;
+
+    // Owned by the event loop thread
+    static std::unordered_map<SOCKET, std::unique_ptr<Miner>> miners;
+    static std::unordered_map<uint64_t, Miner*> minersById;
+    static std::vector<SOCKET> closingMiners;
+    static std::vector<bool> slotsInUse(NetworkConstants::PROXY_MAX_MINERS, false);
+    static std::deque<ProxyJob> jobs;  // Newest first
+    static uint64_t nextConnId = 1;
+    static std::mt19937_64 sessionRng(std::random_device{}());
+
+    // Shares waiting for the relay threads, and their upstream verdicts
+    static std::deque<RelayTask> relayQueue;
+    static std::mutex relayMutex;
+    static std::condition_variable relayCV;
+    static bool stopRelays = false;
+    static std::deque<RelayResult> relayResults;
+    static std::mutex relayResultsMutex;
+
+    static std::atomic<size_t> minerCount(0);
+    static std::atomic<uint64_t> jobsSent(0);
+    static std::atomic<uint64_t> sharesRelayed(0);
+    static std::atomic<uint64_t> sharesAccepted(0);
+    static std::atomic<uint64_t> sharesRejected(0);
+    static std::atomic<uint64_t> sharesInvalid(0);
+    static std::atomic<uint64_t> sharesCounted(0);
+    static std::atomic<double> lastFanoutMs(0.0);
+
+    static std::string resultResponse(const picojson::value& id, const std::string& resultJson) {
+        return "{\"id\":" + id.serialize() + ",\"jsonrpc\":\"2.0\",\"error\":null,\"result\":" + resultJson + "}\n";
+    }
+
+    static std::string resultResponse(const picojson::value& id, const picojson::object& result) {
+        return resultResponse(id, picojson::value(result).serialize());
+    }
+
+    static std::string statusResponse(const picojson::value& id, const std::string& status) {
+        picojson::object result;
+        result["status"] = picojson::value(status);
+        return resultResponse(id, result);
+    }
+
+    static std::string errorResponse(const picojson::value& id, const std::string& message) {
+        picojson::object error;
+        error["code"] = picojson::value(-1.0);
+        error["message"] = picojson::value(message);
+
+        picojson::object response;
+        response["id"] = id;
+        response["jsonrpc"] = picojson::value("2.0");
+        response["error"] = picojson::value(error);
+        response["result"] = picojson::value();
+        return picojson::value(response).serialize() + "\n";
+    }
+
+    // Picks the miner's target for its next notification of 'job'. Returns true
+    // if vardiff moved it.
+    static bool refreshTarget(Miner& miner, const ProxyJob& job, std::chrono::steady_clock::time_point now) {
+        if (!miner.vardiff) {
+            miner.target = job.target;
+            miner.targetValue = job.targetValue;
+            return false;
+        }
+        bool changed = miner.vardiff->update(now, job.difficulty);
+        if (changed || miner.target.empty()) {
+            miner.target = Job::difficultyToTarget(miner.vardiff->getDifficulty());
+            miner.targetValue = Job::targetValue(miner.target);
+        }
+        return changed;
+    }
+
+    // Appends the job params object for one miner: the upstream job with the
+    // miner's nonce byte patched into the blob, its own job id and target
+    static void appendJobParams(std::string& out, const ProxyJob& job, Miner& miner) {
+        std::string seq = std::to_string(miner.nextJobSeq++);
+        miner.sentJobs.push_front({job.jobId + "." + seq, job.jobId, miner.targetValue});
+        while (miner.sentJobs.size() > NetworkConstants::PROXY_MINER_JOB_HISTORY) {
+            miner.sentJobs.pop_back();
+        }
+
+        char fixedByte[2];
+        uint8_t slot = static_cast<uint8_t>(miner.slot);
+        HexCodec::encode(&slot, 1, fixedByte);
+        out.append(job.paramsHead);
+        out.append(fixedByte, sizeof(fixedByte));
+        out.append(job.paramsMiddle);
+        out.append(seq);
+        out.append("\",\"target\":\"");
+        out.append(miner.target);
+        out.append(job.paramsTail);
+        out.append(miner.sessionId);
+        out.append("\"}");
+    }
+
+    static void closeLater(Miner& miner, const std::string& reason) {
+        if (miner.closing) return;
+        miner.closing = true;
+        closingMiners.push_back(miner.socket);
+        if (config.debugMode || miner.slot >= 0) {
+            threadSafePrint("Miner " + miner.address + " disconnected: " + reason, true);
+        }
+    }
+
+    static void closeMiners() {
+        for (SOCKET socket : closingMiners) {
+            auto it = miners.find(socket);
+            if (it == miners.end()) continue;
+            Miner& miner = *it->second;
+            if (miner.slot >= 0) {
+                slotsInUse[miner.slot] = false;
+                minerCount--;
+            }
+            minersById.erase(miner.connId);
+            poller.remove(socket);
+            closesocket(socket);
+            miners.erase(it);
+        }
+        closingMiners.clear();
+    }
+
+    static void queueSend(Miner& miner, const std::string& data) {
+        if (miner.closing) return;
+        size_t offset = 0;
+        if (miner.sendBuffer.empty()) {
+            int sent = send(miner.socket, data.data(), static_cast<int>(data.size()), SEND_FLAGS);
+            if (sent < 0) {
+                if (!wouldBlock()) {
+                    closeLater(miner, "send failed");
+                    return;
+                }
+                sent = 0;
+            }
+            offset = static_cast<size_t>(sent);
+            if (offset == data.size()) return;
+            poller.setWantWrite(miner.socket, true);
+        }
+        miner.sendBuffer.append(data, offset, std::string::npos);
+        if (miner.sendBuffer.size() > NetworkConstants::PROXY_MAX_SEND_BACKLOG) {
+            closeLater(miner, "not reading, send backlog full");
+        }
+    }
+
+    static void flushSend(Miner& miner) {
+        while (!miner.sendBuffer.empty()) {
+            int sent = send(miner.socket, miner.sendBuffer.data(),
+                            static_cast<int>(miner.sendBuffer.size()), SEND_FLAGS);
+            if (sent < 0) {
+                if (!wouldBlock()) {
+                    closeLater(miner, "send failed");
+                }
+                return;
+            }
+            miner.sendBuffer.erase(0, static_cast<size_t>(sent));
+        }
+        poller.setWantWrite(miner.socket, false);
+        if (miner.closeAfterSend) {
+            closeLater(miner, "closed by proxy");
+        }
+    }
+
+    static void sendJob(Miner& miner, const ProxyJob& job) {
+        std::string notification = "{\"jsonrpc\":\"2.0\",\"method\":\"job\",\"params\":";
+        appendJobParams(notification, job, miner);
+        notification.append("}\n");
+        queueSend(miner, notification);
+        jobsSent++;
+    }
+
+    static int allocateSlot() {
+        for (size_t i = 0; i < slotsInUse.size(); i++) {
+            if (!slotsInUse[i]) {
+                slotsInUse[i] = true;
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    static void handleLogin(Miner& miner, const picojson::value& id, const picojson::object& params) {
+        if (miner.slot >= 0) {
+            queueSend(miner, errorResponse(id, "Already logged in"));
+            return;
+        }
+        int slot = allocateSlot();
+        if (slot < 0) {
+            threadSafePrint("Refusing miner " + miner.address + ": all " +
+                std::to_string(NetworkConstants::PROXY_MAX_MINERS) + " nonce slots in use", true);
+            miner.closeAfterSend = true;
+            queueSend(miner, errorResponse(id, "Proxy full"));
+            if (miner.sendBuffer.empty()) {
+                closeLater(miner, "proxy full");
+            }
+            return;
+        }
+
+        miner.slot = slot;
+        minerCount++;
+        uint64_t session = sessionRng();
+        miner.sessionId = HexCodec::encode(reinterpret_cast<const uint8_t*>(&session), sizeof(session));
+        if (params.find("agent") != params.end() && params.at("agent").is<std::string>()) {
+            miner.agent = params.at("agent").get<std::string>();
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (config.proxyShareInterval > 0) {
+            miner.vardiff = std::make_unique<Vardiff>(config.proxyShareInterval,
+                                                      NetworkConstants::VARDIFF_START_DIFFICULTY, now);
+        }
+
+        std::string result = "{\"id\":\"" + miner.sessionId + "\"";
+        if (!jobs.empty()) {
+            refreshTarget(miner, jobs.front(), now);
+            result.append(",\"job\":");
+            appendJobParams(result, jobs.front(), miner);
+        }
+        result.append(",\"extensions\":[\"algo\",\"nicehash\",\"keepalive\"],\"status\":\"OK\"}");
+        queueSend(miner, resultResponse(id, result));
+
+        threadSafePrint("Miner " + miner.address + " logged in" +
+            (miner.agent.empty() ? "" : " (" + miner.agent + ")") +
+            ", nonce byte " + std::to_string(slot), true);
+    }
+
+    // Relay queue and results are shared with the relay and verifier threads
+    static bool enqueueRelay(RelayTask task) {
+        {
+            std::lock_guard<std::mutex> lock(relayMutex);
+            if (relayQueue.size() >= NetworkConstants::PROXY_MAX_RELAY_QUEUE) {
+                return false;
+            }
+            relayQueue.push_back(std::move(task));
+        }
+        relayCV.notify_one();
+        return true;
+    }
+
+    static void postResult(RelayResult result) {
+        {
+            std::lock_guard<std::mutex> lock(relayResultsMutex);
+            relayResults.push_back(std::move(result));
+        }
+        poller.wake();
+    }
+
+    // Runs on a verifier thread
+    static void onVerified(RelayTask& task, ShareVerifier::Verdict verdict) {
+        if (verdict == ShareVerifier::Verdict::BadHash || verdict == ShareVerifier::Verdict::LowDifficulty) {
+            postResult({task.connId, false, false, true, errorResponse(task.requestId,
+                verdict == ShareVerifier::Verdict::BadHash ? "Invalid share" : "Low difficulty share")});
+            return;
+        }
+        // Verdict::Error means the share could not be checked; relay it unverified
+        task.verified = verdict == ShareVerifier::Verdict::Valid;
+        picojson::value requestId = task.requestId;
+        uint64_t connId = task.connId;
+        if (!enqueueRelay(std::move(task))) {
+            postResult({connId, false, false, false, errorResponse(requestId, "Proxy busy")});
+        }
+    }
+
+    // Sends the current job again if vardiff moved the miner's target
+    static void retarget(Miner& miner) {
+        if (miner.vardiff && !jobs.empty() && refreshTarget(miner, jobs.front(), std::chrono::steady_clock::now())) {
+            if (config.debugMode) {
+                threadSafePrint("Miner " + miner.address + " difficulty " +
+                    std::to_string(miner.vardiff->getDifficulty()), true);
+            }
+            sendJob(miner, jobs.front());
+        }
+    }
+
+    // A share the miner got wrong; after PROXY_MAX_INVALID_SHARES the miner is
+    // disconnected once its pending responses are sent
+    static void countInvalidShare(Miner& miner) {
+        miner.invalid++;
+        if (miner.invalid >= NetworkConstants::PROXY_MAX_INVALID_SHARES && !miner.closeAfterSend) {
+            threadSafePrint("Miner " + miner.address + " sent " + std::to_string(miner.invalid) +
+                " invalid shares, disconnecting", true);
+            miner.closeAfterSend = true;
+        }
+    }
+
+    static void handleSubmit(Miner& miner, const picojson::value& id, const picojson::object& params) {
+        // Stale and duplicate submits happen to honest miners around job switches,
+        // so only malformed or wrong shares count against the miner
+        auto refuse = [&](const std::string& message, bool invalid) {
+            sharesInvalid++;
+            if (invalid) {
+                countInvalidShare(miner);
+            }
+            queueSend(miner, errorResponse(id, message));
+            if (config.debugMode) {
+                threadSafePrint("Share from " + miner.address + " refused: " + message, true);
+            }
+            if (miner.closeAfterSend && miner.sendBuffer.empty()) {
+                closeLater(miner, "too many invalid shares");
+            }
+        };
+        auto param = [&](const char* name) {
+            auto it = params.find(name);
+            return it != params.end() && it->second.is<std::string>() ? it->second.get<std::string>() : std::string();
+        };
+
+        if (miner.slot < 0 || param("id") != miner.sessionId) {
+            refuse("Unauthenticated", true);
+            return;
+        }
+
+        std::string jobId = param("job_id");
+        auto sent = std::find_if(miner.sentJobs.begin(), miner.sentJobs.end(),
+                                 [&](const SentJob& candidate) { return candidate.id == jobId; });
+        auto job = jobs.end();
+        if (sent != miner.sentJobs.end()) {
+            job = std::find_if(jobs.begin(), jobs.end(),
+                               [&](const ProxyJob& candidate) { return candidate.jobId == sent->upstreamJobId; });
+        }
+        if (job == jobs.end()) {
+            refuse("Block expired", false);
+            return;
+        }
+
+        std::string nonce = param("nonce");
+        uint8_t nonceBytes[MiningConstants::NONCE_SIZE];
+        if (nonce.size() != 2 * sizeof(nonceBytes) || !HexCodec::decode(nonce.c_str(), nonce.size(), nonceBytes)) {
+            refuse("Invalid nonce", true);
+            return;
+        }
+        if (nonceBytes[MiningConstants::NONCE_SIZE - 1] != static_cast<uint8_t>(miner.slot)) {
+            refuse("Invalid nonce; is miner not compatible with NiceHash?", true);
+            return;
+        }
+
+        std::string result = param("result");
+        HexCodec::Hash hash;
+        if (!HexCodec::decode(result, hash)) {
+            refuse("Invalid result", true);
+            return;
+        }
+        if (!Job::hashMeetsTarget(hash.data(), sent->target)) {
+            refuse("Low difficulty share", true);
+            return;
+        }
+
+        uint32_t nonceKey = 0;
+        for (int i = 0; i < MiningConstants::NONCE_SIZE; i++) {
+            nonceKey |= static_cast<uint32_t>(nonceBytes[i]) << (8 * i);
+        }
+        if (!job->nonces.insert(nonceKey).second) {
+            refuse("Duplicate share", false);
+            return;
+        }
+
+        if (miner.vardiff) {
+            miner.vardiff->addShare(std::chrono::steady_clock::now());
+        }
+
+        // Shares below the upstream target only measure the miner's hashrate
+        if (!Job::hashMeetsTarget(hash.data(), job->targetValue)) {
+            miner.accepted++;
+            sharesCounted++;
+            queueSend(miner, statusResponse(id, "OK"));
+            retarget(miner);
+            return;
+        }
+
+        RelayTask task{miner.connId, id, job->jobId, HexCodec::encode(nonceBytes, sizeof(nonceBytes)), HexCodec::encode(hash)};
+
+        // Verify before relaying; new miners and miners caught before bypass sampling
+        if (ShareVerifier::isRunning()) {
+            ShareVerifier::Share share;
+            share.seedHash = job->seedHash;
+            share.target = job->target;
+            share.blob = job->blobBytes;
+            std::memcpy(share.blob.data + MiningConstants::NONCE_OFFSET, nonceBytes, sizeof(nonceBytes));
+            share.result = hash;
+            bool always = miner.invalid > 0 || miner.verified < NetworkConstants::PROXY_VERIFY_TRUST_SHARES;
+            auto pending = std::make_shared<RelayTask>(std::move(task));
+            ShareVerifier::Queued queued = ShareVerifier::submit(std::move(share), always,
+                [pending](ShareVerifier::Verdict verdict) { onVerified(*pending, verdict); });
+            if (queued == ShareVerifier::Queued::Yes) {
+                retarget(miner);
+                return;
+            }
+            if (queued == ShareVerifier::Queued::Busy) {
+                // Suspect miners' shares are never relayed unverified; the miner may resubmit
+                job->nonces.erase(nonceKey);
+                refuse("Proxy busy", false);
+                return;
+            }
+            task = std::move(*pending);
+        }
+
+        if (!enqueueRelay(std::move(task))) {
+            job->nonces.erase(nonceKey);
+            refuse("Proxy busy", false);
+            return;
+        }
+        retarget(miner);
+    }
+
+    static void handleMessage(Miner& miner, const std::string& line) {
+        picojson::value message;
+        std::string err = picojson::parse(message, line);
+        if (!err.empty() || !message.is<picojson::object>()) {
+            closeLater(miner, "malformed request");
+            return;
+        }
+        const picojson::object& obj = message.get<picojson::object>();
+        picojson::value id = obj.find("id") != obj.end() ? obj.at("id") : picojson::value();
+        std::string method = obj.find("method") != obj.end() && obj.at("method").is<std::string>() ?
+            obj.at("method").get<std::string>() : std::string();
+        picojson::object params;
+        if (obj.find("params") != obj.end() && obj.at("params").is<picojson::object>()) {
+            params = obj.at("params").get<picojson::object>();
+        }
+
+        if (method == "login") {
+            handleLogin(miner, id, params);
+        } else if (method == "submit") {
+            handleSubmit(miner, id, params);
+        } else if (method == "keepalived") {
+            queueSend(miner, statusResponse(id, "KEEPALIVED"));
+        } else if (method == "getjob" && miner.slot >= 0 && !jobs.empty()) {
+            std::string params;
+            refreshTarget(miner, jobs.front(), std::chrono::steady_clock::now());
+            appendJobParams(params, jobs.front(), miner);
+            queueSend(miner, resultResponse(id, params));
+        } else {
+            queueSend(miner, errorResponse(id, "Unsupported method"));
+        }
+    }
+
+    static void readMiner(Miner& miner) {
+        char data[NetworkConstants::MAX_RECEIVE_BUFFER];
+        while (!miner.closing) {
+            int received = recv(miner.socket, data, sizeof(data), 0);
+            if (received == 0) {
+                closeLater(miner, "connection closed");
+                return;
+            }
+            if (received < 0) {
+                if (!wouldBlock()) {
+                    closeLater(miner, "receive failed");
+                }
+                break;
+            }
+            miner.recvBuffer.append(data, received);
+            miner.lastActivity = std::chrono::steady_clock::now();
+
+            size_t start = 0;
+            size_t pos;
+            while (!miner.closing && (pos = miner.recvBuffer.find('\n', start)) != std::string::npos) {
+                std::string line = miner.recvBuffer.substr(start, pos - start);
+                start = pos + 1;
+                if (!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+                if (!line.empty()) {
+                    handleMessage(miner, line);
+                }
+            }
+            miner.recvBuffer.erase(0, start);
+            if (miner.recvBuffer.size() > NetworkConstants::PROXY_MAX_LINE) {
+                closeLater(miner, "request too long");
+            }
+        }
+    }
+
+    static void acceptMiners(SOCKET listener) {
+        while (true) {
+            sockaddr_storage addr = {};
+            socklen_t addrLen = sizeof(addr);
+            SOCKET socket = accept(listener, reinterpret_cast<sockaddr*>(&addr), &addrLen);
+            if (socket == INVALID_SOCKET) {
+                return;
+            }
+            if (miners.size() >= NetworkConstants::PROXY_MAX_CONNECTIONS || !setNonBlocking(socket)) {
+                closesocket(socket);
+                continue;
+            }
+            int optval = 1;
+            setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<char*>(&optval), sizeof(optval));
+
+            char host[NI_MAXHOST] = "?";
+            char port[NI_MAXSERV] = "?";
+            getnameinfo(reinterpret_cast<sockaddr*>(&addr), addrLen, host, sizeof(host), port, sizeof(port),
+                        NI_NUMERICHOST | NI_NUMERICSERV);
+
+            auto miner = std::make_unique<Miner>();
+            miner->connId = nextConnId++;
+            miner->socket = socket;
+            miner->address = std::string(host) + ":" + port;
+            miner->lastActivity = std::chrono::steady_clock::now();
+            if (!poller.add(socket)) {
+                closesocket(socket);
+                continue;
+            }
+            minersById[miner->connId] = miner.get();
+            miners[socket] = std::move(miner);
+        }
+    }
+
+    // Moves to the newest upstream job and sends it to every logged-in miner
+    static void applyUpstreamJob() {
+        std::unique_ptr<Job> job;
+        {
+            std::lock_guard<std::mutex> lock(upstreamMutex);
+            job.swap(upstreamJob);
+        }
+        if (!job) return;
+
+        ProxyJob proxyJob;
+        proxyJob.jobId = job->getJobId();
+        proxyJob.blob = job->getBlob();
+        HexCodec::decode(proxyJob.blob, proxyJob.blobBytes);  // Validated by PoolClient
+        proxyJob.target = job->getTarget();
+        proxyJob.targetValue = Job::targetValue(proxyJob.target);
+        proxyJob.difficulty = static_cast<uint64_t>(Job::targetDifficulty(proxyJob.target));
+        proxyJob.seedHash = job->getSeedHash();
+        proxyJob.height = job->getHeight();
+        if (proxyJob.targetValue == 0) {
+            threadSafePrint("Proxy: ignoring job " + proxyJob.jobId + " with invalid target " + proxyJob.target, true);
+            return;
+        }
+
+        // Serialized once per job; only the nonce byte, job id suffix, target and
+        // session id differ per miner
+        std::string jobId = picojson::value(proxyJob.jobId).serialize();
+        proxyJob.paramsHead = "{\"blob\":\"" + proxyJob.blob.substr(0, 2 * FIXED_BYTE_OFFSET);
+        proxyJob.paramsMiddle = proxyJob.blob.substr(2 * FIXED_BYTE_OFFSET + 2) + "\",\"job_id\":" +
+            jobId.substr(0, jobId.size() - 1) + ".";
+        proxyJob.paramsTail = "\",\"height\":" + std::to_string(proxyJob.height) +
+            ",\"seed_hash\":" + picojson::value(proxyJob.seedHash).serialize() +
+            ",\"algo\":\"rx/0\",\"id\":\"";
+        jobs.push_front(std::move(proxyJob));
+        while (jobs.size() > 2) {
+            jobs.pop_back();
+        }
+
+        const ProxyJob& current = jobs.front();
+        auto start = std::chrono::steady_clock::now();
+        uint64_t sent = 0;
+        for (auto& entry : miners) {
+            Miner& miner = *entry.second;
+            if (miner.slot < 0 || miner.closing) continue;
+            refreshTarget(miner, current, start);
+            sendJob(miner, current);
+            sent++;
+        }
+        double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        lastFanoutMs = elapsedMs;
+        threadSafePrint("Job " + current.jobId + " (difficulty " + std::to_string(current.difficulty) + ") sent to " +
+            std::to_string(sent) + " miners in " + std::to_string(elapsedMs) + " ms", true);
+    }
+
+    static void relayWorker() {
+        while (true) {
+            RelayTask task;
+            {
+                std::unique_lock<std::mutex> lock(relayMutex);
+                relayCV.wait(lock, []() { return stopRelays || !relayQueue.empty(); });
+                if (stopRelays) return;
+                task = std::move(relayQueue.front());
+                relayQueue.pop_front();
+            }
+
+            sharesRelayed++;
+            PoolClient::ShareStatus status = PoolClient::submitShare(task.jobId, task.nonce, task.result, "rx/0");
+            RelayResult result;
+            result.connId = task.connId;
+            result.accepted = status == PoolClient::ShareStatus::Accepted;
+            result.verified = task.verified;
+            result.failedVerification = false;
+            if (result.accepted) {
+                sharesAccepted++;
+                result.response = statusResponse(task.requestId, "OK");
+            } else {
+                sharesRejected++;
+                result.response = errorResponse(task.requestId, status == PoolClient::ShareStatus::Queued ?
+                    "Upstream pool unavailable, share queued" : "Rejected by pool");
+            }
+
+            postResult(std::move(result));
+        }
+    }
+
+    static void deliverRelayResults() {
+        std::deque<RelayResult> results;
+        {
+            std::lock_guard<std::mutex> lock(relayResultsMutex);
+            results.swap(relayResults);
+        }
+        for (const auto& result : results) {
+            auto it = minersById.find(result.connId);
+            if (it == minersById.end()) continue;  // Miner left before the pool answered
+            Miner& miner = *it->second;
+            if (result.failedVerification) {
+                sharesInvalid++;
+                countInvalidShare(miner);
+            } else if (result.accepted) {
+                miner.accepted++;
+            } else {
+                miner.rejected++;
+            }
+            if (result.verified) {
+                miner.verified++;
+            }
+            queueSend(miner, result.response);
+            if (miner.closeAfterSend && miner.sendBuffer.empty()) {
+                closeLater(miner, "too many invalid shares");
+            }
+        }
+    }
+
+    static void dropIdleMiners() {
+        auto now = std::chrono::steady_clock::now();
+        for (auto& entry : miners) {
+            Miner& miner = *entry.second;
+            int timeoutSec = miner.slot >= 0 ? NetworkConstants::PROXY_MINER_IDLE_TIMEOUT_SEC :
+                                               NetworkConstants::PROXY_LOGIN_TIMEOUT_SEC;
+            if (now - miner.lastActivity > std::chrono::seconds(timeoutSec)) {
+                closeLater(miner, miner.slot >= 0 ? "idle timeout" : "no login");
+            }
+        }
+    }
+
+    static SOCKET openListener(const std::string& bindAddress, int port) {
+        struct addrinfo hints = {}, *result = nullptr;
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_protocol = IPPROTO_TCP;
+        hints.ai_flags = AI_PASSIVE;
+        int status = getaddrinfo(bindAddress.empty() ? nullptr : bindAddress.c_str(),
+                                 std::to_string(port).c_str(), &hints, &result);
+        if (status != 0) {
+            threadSafePrint("Proxy: cannot resolve " + bindAddress + ": " + gai_strerrorA(status), true);
+            return INVALID_SOCKET;
+        }
+
+        SOCKET listener = INVALID_SOCKET;
+        for (struct addrinfo* ptr = result; ptr != nullptr; ptr = ptr->ai_next) {
+            listener = socket(ptr->ai_family, ptr->ai_socktype, ptr->ai_protocol);
+            if (listener == INVALID_SOCKET) continue;
+            int optval = 1;
+            setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char*>(&optval), sizeof(optval));
+            if (bind(listener, ptr->ai_addr, static_cast<int>(ptr->ai_addrlen)) != SOCKET_ERROR &&
+                listen(listener, SOMAXCONN) != SOCKET_ERROR && setNonBlocking(listener)) {
+                break;
+            }
+            closesocket(listener);
+            listener = INVALID_SOCKET;
+        }
+        freeaddrinfo(result);
+        if (listener == INVALID_SOCKET) {
+            threadSafePrint("Proxy: cannot listen on " + bindAddress + ":" + std::to_string(port), true);
+        }
+        return listener;
+    }
+
+    void onUpstreamJob(const Job& job) {
+        {
+            std::lock_guard<std::mutex> lock(upstreamMutex);
+            upstreamJob = std::make_unique<Job>(job);
+        }
+        if (running) {
+            poller.wake();
+        }
+    }
+
+    bool run(const std::string& bindAddress, int port) {
+        SOCKET listener = openListener(bindAddress, port);
+        if (listener == INVALID_SOCKET) {
+            return false;
+        }
+        if (!poller.init() || !poller.add(listener)) {
+            threadSafePrint("Proxy: failed to initialize socket polling", true);
+            poller.shutdown();
+            closesocket(listener);
+            return false;
+        }
+
+        ShareVerifier::start(config.proxyVerifyThreads);
+        stopRelays = false;
+        std::vector<std::thread> relays;
+        for (int i = 0; i < NetworkConstants::PROXY_RELAY_THREADS; i++) {
+            relays.emplace_back(relayWorker);
+        }
+        running = true;
+        threadSafePrint("Stratum proxy listening on " + bindAddress + ":" + std::to_string(port), true);
+
+        bool ok = true;
+        std::vector<Poller::Event> events;
+        auto lastHousekeeping = std::chrono::steady_clock::now();
+        auto lastStats = lastHousekeeping;
+        applyUpstreamJob();
+        while (!shouldStop && !PoolClient::shouldStop) {
+            if (!poller.wait(1000, events)) {
+                threadSafePrint("Proxy: socket polling failed", true);
+                ok = false;
+                break;
+            }
+            for (const auto& event : events) {
+                if (event.socket == listener) {
+                    acceptMiners(listener);
+                    continue;
+                }
+                auto it = miners.find(event.socket);
+                if (it == miners.end() || it->second->closing) continue;
+                Miner& miner = *it->second;
+                if (event.error) {
+                    closeLater(miner, "socket error");
+                    continue;
+                }
+                if (event.writable) {
+                    flushSend(miner);
+                }
+                if (event.readable) {
+                    readMiner(miner);
+                }
+            }
+            applyUpstreamJob();
+            deliverRelayResults();
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastHousekeeping >= std::chrono::seconds(1)) {
+                lastHousekeeping = now;
+                dropIdleMiners();
+                for (auto& entry : miners) {
+                    if (entry.second->slot >= 0 && !entry.second->closing) {
+                        retarget(*entry.second);
+                    }
+                }
+            }
+            if (now - lastStats >= std::chrono::seconds(NetworkConstants::PROXY_STATS_INTERVAL_SEC)) {
+                lastStats = now;
+                ProxyStats stats = getStats();
+                threadSafePrint("Proxy: " + std::to_string(stats.miners) + " miners | shares relayed " +
+                    std::to_string(stats.sharesRelayed) + ", accepted " + std::to_string(stats.sharesAccepted) +
+                    ", rejected " + std::to_string(stats.sharesRejected) + ", invalid " +
+                    std::to_string(stats.sharesInvalid) + ", below pool target " +
+                    std::to_string(stats.sharesCounted) + " | last job fan-out " +
+                    std::to_string(stats.lastFanoutMs) + " ms", true);
+                if (ShareVerifier::isRunning()) {
+                    ShareVerifier::Stats verify = ShareVerifier::getStats();
+                    threadSafePrint("Proxy verification: " + std::to_string(verify.sharesPerSec) + " shares/s, queue " +
+                        std::to_string(verify.queueDepth) + " (wait avg " + std::to_string(verify.avgQueueMs) +
+                        " ms, max " + std::to_string(verify.maxQueueMs) + " ms) | verified " +
+                        std::to_string(verify.verified) + ", invalid " + std::to_string(verify.invalid) +
+                        ", unverified " + std::to_string(verify.skipped), true);
+                }
+            }
+            closeMiners();
+        }
+
+        running = false;
+        ShareVerifier::stop();
+        {
+            std::lock_guard<std::mutex> lock(relayMutex);
+            stopRelays = true;
+        }
+        relayCV.notify_all();
+        for (auto& relay : relays) {
+            relay.join();
+        }
+        for (auto& entry : miners) {
+            closeLater(*entry.second, "proxy stopped");
+        }
+        closeMiners();
+        closesocket(listener);
+        poller.shutdown();
+        return ok;
+    }
+
+    ProxyStats getStats() {
+        ProxyStats stats;
+        stats.miners = minerCount.load();
+        stats.jobsSent = jobsSent.load();
+        stats.sharesRelayed = sharesRelayed.load();
+        stats.sharesAccepted = sharesAccepted.load();
+        stats.sharesRejected = sharesRejected.load();
+        stats.sharesInvalid = sharesInvalid.load();
+        stats.sharesCounted = sharesCounted.load();
+        stats.lastFanoutMs = lastFanoutMs.load();
+        return stats;
+    }
+}
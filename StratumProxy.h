@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "Job.h"
+
+// Stratum proxy: fronts many downstream miners with the single upstream
+// PoolClient session. Each miner gets a fixed nonce byte (NiceHash-style, the
+// last nonce byte at NONCE_OFFSET + 3), so up to PROXY_MAX_MINERS miners search
+// disjoint nonce ranges of the same upstream job. With vardiff each miner gets
+// its own, easier target; only shares that also meet the upstream target are
+// relayed upstream (unchanged), the rest just measure the miner's hashrate.
+namespace StratumProxy {
+    struct ProxyStats {
+        size_t miners = 0;
+        uint64_t jobsSent = 0;          // Job notifications sent to miners
+        uint64_t sharesRelayed = 0;
+        uint64_t sharesAccepted = 0;
+        uint64_t sharesRejected = 0;    // Rejected upstream, or not delivered
+        uint64_t sharesInvalid = 0;     // Refused by the proxy (bad nonce, stale job, duplicate)
+        uint64_t sharesCounted = 0;     // Met the miner's target but not the upstream one
+        double lastFanoutMs = 0.0;      // Time to queue the last job to every miner
+    };
+
+    // Called by PoolClient for every new upstream job; safe from any thread
+    void onUpstreamJob(const Job& job);
+
+    // Listens on bindAddress:port and serves miners until shouldStop is set
+    bool run(const std::string& bindAddress, int port);
+
+    ProxyStats getStats();
+}
@@ -0,0 +1,361 @@
+#include "StratumReplay.h"
+#include "StratumCapture.h"
+#include "Globals.h"
+#include "Constants.h"
+#include "picojson.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Sockets.h"
+
+namespace StratumReplay {
+    struct ScriptedJob {
+        uint64_t timeUs = 0;
+        picojson::object params;
+        bool inLogin = false;   // Arrived in a login response rather than a job notification
+    };
+
+    static std::vector<ScriptedJob> jobs;
+    static picojson::object loginResult;   // First captured login result, without its job
+    static uint64_t originUs = 0;          // Capture time that maps to the start of the replay
+    static double replaySpeed = 1.0;
+
+    static SOCKET listener = INVALID_SOCKET;
+    static std::thread serverThread;
+    static std::atomic<bool> stopping(false);
+    static std::atomic<bool> finished(false);
+
+    static std::mutex reportMutex;
+    static Report report;   // Guarded by reportMutex
+
+    static bool parseObject(const std::string& line, picojson::object& obj) {
+        picojson::value v;
+        if (!picojson::parse(v, line).empty() || !v.is<picojson::object>()) {
+            return false;
+        }
+        obj = v.get<picojson::object>();
+        return true;
+    }
+
+    // Collects the pool's side of the session: the first login result and every job,
+    // whether sent as a notification or in the login response of a reconnect
+    static void buildScript(const std::vector<StratumCapture::Entry>& entries) {
+        bool haveLogin = false;
+        bool haveOrigin = false;
+        for (const auto& entry : entries) {
+            if (entry.direction != StratumCapture::Direction::Received) continue;
+            picojson::object obj;
+            if (!parseObject(entry.line, obj)) continue;
+
+            ScriptedJob job;
+            job.timeUs = entry.timeUs;
+            auto method = obj.find("method");
+            auto result = obj.find("result");
+            if (method != obj.end()) {
+                auto params = obj.find("params");
+                if (!method->second.is<std::string>() || method->second.get<std::string>() != "job" ||
+                    params == obj.end() || !params->second.is<picojson::object>()) {
+                    continue;
+                }
+                job.params = params->second.get<picojson::object>();
+            } else if (result != obj.end() && result->second.is<picojson::object>()) {
+                // Share and keepalive responses carry only a status; a login result has the session id
+                picojson::object resultObj = result->second.get<picojson::object>();
+                auto id = resultObj.find("id");
+                if (id == resultObj.end() || !id->second.is<std::string>()) continue;
+                auto loginJob = resultObj.find("job");
+                bool hasJob = loginJob != resultObj.end() && loginJob->second.is<picojson::object>();
+                if (hasJob) {
+                    job.params = loginJob->second.get<picojson::object>();
+                }
+                if (!haveLogin) {
+                    haveLogin = true;
+                    resultObj.erase("job");
+                    loginResult = resultObj;
+                    job.inLogin = true;
+                    if (!haveOrigin) {
+                        originUs = entry.timeUs;
+                        haveOrigin = true;
+                    }
+                }
+                if (!hasJob) continue;
+            } else {
+                continue;
+            }
+
+            if (!haveOrigin) {
+                originUs = entry.timeUs;
+                haveOrigin = true;
+            }
+            jobs.push_back(std::move(job));
+        }
+
+        if (!haveLogin) {
+            loginResult["id"] = picojson::value("replay");
+            loginResult["status"] = picojson::value("OK");
+        }
+    }
+
+    static std::string response(const picojson::value& id, const picojson::value& result) {
+        picojson::object obj;
+        obj["id"] = id;
+        obj["jsonrpc"] = picojson::value("2.0");
+        obj["error"] = picojson::value();
+        obj["result"] = result;
+        return picojson::value(obj).serialize() + "\n";
+    }
+
+    static std::string statusResponse(const picojson::value& id, const std::string& status) {
+        picojson::object result;
+        result["status"] = picojson::value(status);
+        return response(id, picojson::value(result));
+    }
+
+    static std::string jobNotification(const picojson::object& params) {
+        picojson::object obj;
+        obj["jsonrpc"] = picojson::value("2.0");
+        obj["method"] = picojson::value("job");
+        obj["params"] = picojson::value(params);
+        return picojson::value(obj).serialize() + "\n";
+    }
+
+    static bool sendAll(SOCKET sock, const std::string& data) {
+        return send(sock, data.c_str(), static_cast<int>(data.length()), 0) != SOCKET_ERROR;
+    }
+
+    // State of the replayed session; reconnects continue where the last connection left off
+    struct Session {
+        SOCKET socket = INVALID_SOCKET;
+        std::string buffer;
+        bool loggedIn = false;
+        size_t nextJob = 0;
+        bool started = false;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point drainStart;
+    };
+
+    static std::chrono::steady_clock::time_point dueTime(const Session& session, size_t index) {
+        double seconds = static_cast<double>(jobs[index].timeUs - (std::min)(jobs[index].timeUs, originUs)) /
+                         1e6 / replaySpeed;
+        return session.start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(seconds));
+    }
+
+    static bool handleRequest(Session& session, const std::string& line) {
+        picojson::object request;
+        if (!parseObject(line, request)) {
+            return true;
+        }
+        picojson::value id = request.count("id") ? request["id"] : picojson::value();
+        std::string method = request.count("method") && request["method"].is<std::string>()
+            ? request["method"].get<std::string>() : std::string();
+
+        if (method == "login") {
+            // The captured login job, or on a reconnect the job the pool last sent
+            picojson::object result = loginResult;
+            if (!session.started) {
+                session.started = true;
+                session.start = std::chrono::steady_clock::now();
+            }
+            if (session.nextJob < jobs.size() && jobs[session.nextJob].inLogin) {
+                result["job"] = picojson::value(jobs[session.nextJob++].params);
+                std::lock_guard<std::mutex> lock(reportMutex);
+                report.jobsSent++;
+            } else if (session.nextJob > 0) {
+                result["job"] = picojson::value(jobs[session.nextJob - 1].params);
+            }
+            session.loggedIn = true;
+            return sendAll(session.socket, response(id, picojson::value(result)));
+        }
+        if (method == "submit") {
+            std::string jobId;
+            if (request["params"].is<picojson::object>()) {
+                const picojson::object& params = request["params"].get<picojson::object>();
+                auto it = params.find("job_id");
+                if (it != params.end() && it->second.is<std::string>()) jobId = it->second.get<std::string>();
+            }
+            bool stale = session.nextJob == 0 || !jobs[session.nextJob - 1].params.count("job_id") ||
+                         jobs[session.nextJob - 1].params.at("job_id").to_str() != jobId;
+            {
+                std::lock_guard<std::mutex> lock(reportMutex);
+                report.sharesSubmitted++;
+                if (stale) report.sharesStale++;
+            }
+            return sendAll(session.socket, statusResponse(id, "OK"));
+        }
+        if (method == "keepalived") {
+            {
+                std::lock_guard<std::mutex> lock(reportMutex);
+                report.keepalives++;
+            }
+            return sendAll(session.socket, statusResponse(id, "KEEPALIVED"));
+        }
+
+        picojson::object error;
+        error["code"] = picojson::value(-1.0);
+        error["message"] = picojson::value("Unsupported method " + method);
+        picojson::object obj;
+        obj["id"] = id;
+        obj["jsonrpc"] = picojson::value("2.0");
+        obj["error"] = picojson::value(error);
+        return sendAll(session.socket, picojson::value(obj).serialize() + "\n");
+    }
+
+    static void closeClient(Session& session) {
+        if (session.socket != INVALID_SOCKET) {
+            closesocket(session.socket);
+            session.socket = INVALID_SOCKET;
+        }
+        session.buffer.clear();
+        session.loggedIn = false;
+    }
+
+    static void serve() {
+        Session session;
+        while (!stopping) {
+            // Sleep until the next job is due, but keep answering requests
+            auto now = std::chrono::steady_clock::now();
+            auto wait = std::chrono::milliseconds(100);
+            if (session.loggedIn && session.nextJob < jobs.size()) {
+                auto untilDue = std::chrono::duration_cast<std::chrono::milliseconds>(dueTime(session, session.nextJob) - now);
+                wait = (std::max)(std::chrono::milliseconds(0), (std::min)(wait, untilDue));
+            }
+
+            fd_set readSet;
+            FD_ZERO(&readSet);
+            FD_SET(listener, &readSet);
+            SOCKET maxSocket = listener;
+            if (session.socket != INVALID_SOCKET) {
+                FD_SET(session.socket, &readSet);
+                maxSocket = (std::max)(maxSocket, session.socket);
+            }
+            struct timeval tv = { 0, static_cast<long>(wait.count() * 1000) };
+            if (select(static_cast<int>(maxSocket) + 1, &readSet, nullptr, nullptr, &tv) < 0) {
+                threadSafePrint("Replay: select failed: " + std::to_string(WSAGetLastError()), true);
+                break;
+            }
+
+            if (FD_ISSET(listener, &readSet)) {
+                SOCKET client = accept(listener, nullptr, nullptr);
+                if (client != INVALID_SOCKET) {
+                    closeClient(session);
+                    session.socket = client;
+                    std::lock_guard<std::mutex> lock(reportMutex);
+                    report.connections++;
+                }
+            }
+
+            if (session.socket != INVALID_SOCKET && FD_ISSET(session.socket, &readSet)) {
+                char data[NetworkConstants::MAX_RECEIVE_BUFFER];
+                int received = recv(session.socket, data, sizeof(data), 0);
+                if (received <= 0) {
+                    closeClient(session);
+                } else {
+                    session.buffer.append(data, received);
+                    size_t pos;
+                    while (session.socket != INVALID_SOCKET && (pos = session.buffer.find('\n')) != std::string::npos) {
+                        std::string line = session.buffer.substr(0, pos);
+                        session.buffer.erase(0, pos + 1);
+                        if (!handleRequest(session, line)) {
+                            closeClient(session);
+                        }
+                    }
+                }
+            }
+
+            if (!session.loggedIn) continue;
+
+            now = std::chrono::steady_clock::now();
+            while (session.nextJob < jobs.size() && dueTime(session, session.nextJob) <= now) {
+                if (!sendAll(session.socket, jobNotification(jobs[session.nextJob].params))) {
+                    closeClient(session);
+                    break;
+                }
+                session.nextJob++;
+                std::lock_guard<std::mutex> lock(reportMutex);
+                report.jobsSent++;
+            }
+
+            if (session.nextJob == jobs.size() && !finished) {
+                if (session.drainStart == std::chrono::steady_clock::time_point()) {
+                    session.drainStart = now;
+                } else if (now - session.drainStart >= std::chrono::milliseconds(NetworkConstants::REPLAY_DRAIN_MS)) {
+                    std::lock_guard<std::mutex> lock(reportMutex);
+                    report.replaySec = std::chrono::duration<double>(now - session.start).count();
+                    finished = true;
+                }
+            }
+        }
+        closeClient(session);
+    }
+
+    bool start(const std::string& path, double speed, int& port) {
+        std::vector<StratumCapture::Entry> entries;
+        if (!StratumCapture::load(path, entries)) {
+            return false;
+        }
+        jobs.clear();
+        loginResult.clear();
+        buildScript(entries);
+        if (jobs.empty()) {
+            threadSafePrint("Replay: no jobs in " + path, true);
+            return false;
+        }
+        replaySpeed = speed;
+
+        listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        socklen_t addrLen = sizeof(addr);
+        if (listener == INVALID_SOCKET ||
+            bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR ||
+            listen(listener, 1) == SOCKET_ERROR ||
+            getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &addrLen) == SOCKET_ERROR) {
+            threadSafePrint("Replay: cannot listen on loopback: " + std::to_string(WSAGetLastError()), true);
+            if (listener != INVALID_SOCKET) {
+                closesocket(listener);
+                listener = INVALID_SOCKET;
+            }
+            return false;
+        }
+        port = ntohs(addr.sin_port);
+
+        {
+            std::lock_guard<std::mutex> lock(reportMutex);
+            report = Report();
+            report.capturedLines = entries.size();
+            report.jobsTotal = jobs.size();
+            report.capturedSec = (jobs.back().timeUs - (std::min)(jobs.back().timeUs, originUs)) / 1e6;
+        }
+        stopping = false;
+        finished = false;
+        serverThread = std::thread(serve);
+        threadSafePrint("Replaying " + std::to_string(jobs.size()) + " jobs from " + path +
+            " at " + std::to_string(speed) + "x on 127.0.0.1:" + std::to_string(port), true);
+        return true;
+    }
+
+    bool isFinished() {
+        return finished;
+    }
+
+    void stop() {
+        if (!serverThread.joinable()) {
+            return;
+        }
+        stopping = true;
+        serverThread.join();
+        closesocket(listener);
+        listener = INVALID_SOCKET;
+    }
+
+    Report getReport() {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        return report;
+    }
+}
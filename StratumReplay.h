@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Replays a stratum capture (see StratumCapture) as a pool on a loopback port.
+// The miner connects to it like any pool, so captured jobs go through the
+// normal job listener and processNewJob path, at the captured pace divided by
+// 'speed'. Logins get the captured login response; shares and keepalives are
+// answered OK, since the captured answers belong to other shares.
+namespace StratumReplay {
+    struct Report {
+        size_t capturedLines = 0;
+        uint64_t jobsSent = 0;          // Job notifications replayed, including a login job
+        uint64_t jobsTotal = 0;
+        uint64_t sharesSubmitted = 0;
+        uint64_t sharesStale = 0;       // Submitted for a job other than the last one sent
+        uint64_t keepalives = 0;
+        uint64_t connections = 0;
+        double capturedSec = 0.0;       // Span of the replayed jobs in the capture
+        double replaySec = 0.0;         // Wall time from the first login to the end of the replay
+    };
+
+    // Loads the capture and starts serving on 127.0.0.1; 'port' receives the port
+    bool start(const std::string& path, double speed, int& port);
+    bool isFinished();  // Every job has been sent and the drain period has passed
+    void stop();
+    Report getReport();
+}
@@ -5,6 +5,7 @@
 #include <atomic>
 #include <chrono>
 #include <mutex>
+#include <thread>
 
 // Forward declaration of formatHashrate function
 std::string formatHashrate(double hashrate);
@@ -1,5 +1,6 @@
 #include "Utils.h"
 #include "Globals.h"
+#include "Logger.h"
 #include <sstream>
 #include <iomanip>
 #include <mutex>
@@ -8,58 +9,6 @@
 #include <chrono>
 #include "Types.h"
 
-extern std::mutex consoleMutex;
-extern std::mutex logfileMutex;
-extern std::ofstream logFile;
-extern bool debugMode;
-
-// Static mutex for thread-safe printing
-static std::mutex printMutex;
-
-// Explicit template instantiations for bytesToHex
-template std::string bytesToHex<std::vector<uint8_t>::iterator>(
-    std::vector<uint8_t>::iterator begin,
-    std::vector<uint8_t>::iterator end
-);
-
-template std::string bytesToHex<const uint8_t*>(
-    const uint8_t* begin,
-    const uint8_t* end
-);
-
-std::string bytesToHex(const std::vector<uint8_t>& bytes) {
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0');
-    for (const auto& byte : bytes) {
-        ss << std::setw(2) << static_cast<int>(byte);
-    }
-    return ss.str();
-}
-
-template<typename Iterator>
-std::string bytesToHex(Iterator begin, Iterator end) {
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0');
-    for (auto it = begin; it != end; ++it) {
-        ss << std::setw(2) << static_cast<int>(*it);
-    }
-    return ss.str();
-}
-
-// Explicit template instantiations
-template std::string bytesToHex<uint8_t*>(uint8_t*, uint8_t*);
-template std::string bytesToHex<std::vector<uint8_t>::const_iterator>(std::vector<uint8_t>::const_iterator, std::vector<uint8_t>::const_iterator);
-
-std::vector<uint8_t> hexToBytes(const std::string& hex) {
-    std::vector<uint8_t> bytes;
-    for (size_t i = 0; i < hex.length(); i += 2) {
-        std::string byteString = hex.substr(i, 2);
-        uint8_t byte = static_cast<uint8_t>(std::stoi(byteString, nullptr, 16));
-        bytes.push_back(byte);
-    }
-    return bytes;
-}
-
 std::string formatThreadId(int threadId) {
     std::stringstream ss;
     ss << "Thread-" << threadId;
@@ -87,19 +36,18 @@ std::string getCurrentTimestamp() {
     auto now_c = std::chrono::system_clock::to_time_t(now);
     std::stringstream ss;
     struct tm timeinfo;
+#ifdef _WIN32
     localtime_s(&timeinfo, &now_c);
+#else
+    localtime_r(&now_c, &timeinfo);
+#endif
     ss << std::put_time(&timeinfo, "[%Y-%m-%d %H:%M:%S] ");
     return ss.str();
 }
 
-void threadSafePrint(const std::string& message, bool addNewline) {
-    std::lock_guard<std::mutex> lock(consoleMutex);
-    std::cout << message;
-    if (addNewline) std::cout << std::endl;
-    if (logFile.is_open()) {
-        logFile << message;
-        if (addNewline) logFile << std::endl;
-    }
+// Queued for the logger's drain thread; never waits on console or file I/O
+void threadSafePrint(const std::string& message, bool toLogFile) {
+    Logger::write(Logger::Level::Info, message, toLogFile);
 }
 
 std::string formatHashrate(double hashrate) {
@@ -118,19 +66,10 @@ std::string formatHashrate(double hashrate) {
 }
 
 void initializeLogging(const std::string& filename) {
-    std::lock_guard<std::mutex> lock(consoleMutex);
-    if (logFile.is_open()) {
-        logFile.close();
-    }
-    logFile.open(filename, std::ios::app);
-    if (!logFile.is_open()) {
-        std::cerr << "Failed to open log file: " << filename << std::endl;
-    }
+    Logger::start();
+    Logger::openFile(filename);
 }
 
 void cleanupLogging() {
-    std::lock_guard<std::mutex> lock(consoleMutex);
-    if (logFile.is_open()) {
-        logFile.close();
-    }
+    Logger::stop();
 } 
\ No newline at end of file
@@ -7,16 +7,15 @@
 // Logging functions
 void initializeLogging(const std::string& filename);
 void cleanupLogging();
-void threadSafePrint(const std::string& message, bool addNewline = true);
+void threadSafePrint(const std::string& message, bool toLogFile = true);
 
 // Utility functions
 std::string getCurrentTimestamp();
 std::string formatHashrate(double hashrate);
-std::string bytesToHex(const std::vector<uint8_t>& bytes);
-template<typename Iterator>
-std::string bytesToHex(Iterator begin, Iterator end);
-std::vector<uint8_t> hexToBytes(const std::string& hex);
 
 // Utility functions for string formatting and printing
 std::string formatThreadId(int threadId);
-std::string formatRuntime(uint64_t seconds); 
\ No newline at end of file
+std::string formatRuntime(uint64_t seconds);
+
+// Resident memory of this process in bytes, 0 if unknown
+uint64_t getResidentMemoryBytes(); 
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "Vardiff.h"
+#include "Constants.h"
+#include <algorithm>
+
+Vardiff::Vardiff(int shareIntervalSec, uint64_t startDifficulty, Clock::time_point now)
+    : shareInterval(static_cast<double>((std::max)(shareIntervalSec, 1))),
+      difficulty((std::max)(startDifficulty, static_cast<uint64_t>(1))),
+      windowStart(now),
+      lastRetarget(now) {}
+
+void Vardiff::addShare(Clock::time_point now) {
+    samples.push_back({now, difficulty});
+    sharesSinceRetarget++;
+    trim(now);
+}
+
+void Vardiff::trim(Clock::time_point now) {
+    auto oldest = now - std::chrono::seconds(NetworkConstants::VARDIFF_WINDOW_SEC);
+    if (windowStart < oldest) {
+        windowStart = oldest;
+    }
+    while (!samples.empty() &&
+           (samples.front().time < windowStart || samples.size() > NetworkConstants::VARDIFF_WINDOW_SHARES)) {
+        // Dropping a share also drops the time it took to find it
+        windowStart = (std::max)(windowStart, samples.front().time);
+        samples.pop_front();
+    }
+}
+
+double Vardiff::windowSeconds(Clock::time_point now) const {
+    return std::chrono::duration<double>(now - windowStart).count();
+}
+
+double Vardiff::getHashrate(Clock::time_point now) const {
+    double seconds = windowSeconds(now);
+    if (samples.empty() || seconds <= 0.0) {
+        return 0.0;
+    }
+    double hashes = 0.0;
+    for (const auto& sample : samples) {
+        hashes += static_cast<double>(sample.difficulty);
+    }
+    return hashes / seconds;
+}
+
+bool Vardiff::update(Clock::time_point now, uint64_t ceiling) {
+    ceiling = (std::max)(ceiling, static_cast<uint64_t>(1));
+    uint64_t floor = (std::min)(NetworkConstants::VARDIFF_MIN_DIFFICULTY, ceiling);
+    if (difficulty > ceiling) {
+        difficulty = ceiling;
+        return true;
+    }
+
+    double sinceRetarget = std::chrono::duration<double>(now - lastRetarget).count();
+    if (sinceRetarget < shareInterval && sharesSinceRetarget < NetworkConstants::VARDIFF_RETARGET_SHARES) {
+        return false;
+    }
+    trim(now);
+
+    double seconds = windowSeconds(now);
+    double hashrate = getHashrate(now);
+    if (samples.empty()) {
+        // No share yet: wait until one was clearly overdue, then assume one was
+        // just about to arrive
+        if (seconds < 2 * shareInterval) {
+            return false;
+        }
+        hashrate = static_cast<double>(difficulty) / seconds;
+    }
+    lastRetarget = now;
+    sharesSinceRetarget = 0;
+
+    double wanted = hashrate * shareInterval;
+    double current = static_cast<double>(difficulty);
+    wanted = (std::min)((std::max)(wanted, current / NetworkConstants::VARDIFF_MAX_STEP),
+                        current * NetworkConstants::VARDIFF_MAX_STEP);
+    wanted = (std::min)((std::max)(wanted, static_cast<double>(floor)), static_cast<double>(ceiling));
+    if (wanted > current * (1.0 - NetworkConstants::VARDIFF_TOLERANCE) &&
+        wanted < current * (1.0 + NetworkConstants::VARDIFF_TOLERANCE)) {
+        return false;
+    }
+    uint64_t next = static_cast<uint64_t>(wanted);
+    if (next == difficulty) {
+        return false;
+    }
+    difficulty = next;
+    return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+
+// Variable difficulty for one downstream miner. Estimates the miner's hashrate
+// from the shares it found in a rolling window (each share weighted by the
+// difficulty it was found at) and picks the difficulty that yields one share
+// per share interval. Time is always passed in, so a given share sequence
+// always produces the same targets.
+class Vardiff {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    Vardiff(int shareIntervalSec, uint64_t startDifficulty, Clock::time_point now);
+
+    // Records a share found at the current difficulty
+    void addShare(Clock::time_point now);
+
+    // Retargets at most once per share interval, or sooner once enough shares
+    // arrived. The difficulty never exceeds 'ceiling' (the upstream difficulty),
+    // which is applied immediately. Returns true if the difficulty changed.
+    bool update(Clock::time_point now, uint64_t ceiling);
+
+    uint64_t getDifficulty() const { return difficulty; }
+
+    // Estimated hashes per second over the current window; 0 until a share arrives
+    double getHashrate(Clock::time_point now) const;
+
+private:
+    struct Sample {
+        Clock::time_point time;
+        uint64_t difficulty;
+    };
+
+    void trim(Clock::time_point now);
+    double windowSeconds(Clock::time_point now) const;
+
+    double shareInterval;
+    uint64_t difficulty;
+    std::deque<Sample> samples;
+    Clock::time_point windowStart;   // Start of the observed period the samples cover
+    Clock::time_point lastRetarget;
+    int sharesSinceRetarget = 0;
+};
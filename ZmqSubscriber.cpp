@@ -0,0 +1,202 @@
+#include "ZmqSubscriber.h"
+#include "Connector.h"
+#include "Globals.h"
+#include "Constants.h"
+#include "Sockets.h"
+#include <cstring>
+
+namespace {
+    // ZMTP 3.0 frame flags
+    constexpr uint8_t FLAG_MORE = 0x01;
+    constexpr uint8_t FLAG_LONG = 0x02;
+    constexpr uint8_t FLAG_COMMAND = 0x04;
+    constexpr size_t GREETING_SIZE = 64;
+    constexpr size_t MAX_FRAME_SIZE = 1 << 20;  // Chain notifications are a few hundred bytes
+
+    // A frame with a one- or eight-byte (network order) size
+    std::string frame(uint8_t flags, const std::string& body) {
+        std::string out;
+        if (body.size() > 255) {
+            out += static_cast<char>(flags | FLAG_LONG);
+            for (int shift = 56; shift >= 0; shift -= 8) {
+                out += static_cast<char>((static_cast<uint64_t>(body.size()) >> shift) & 0xFF);
+            }
+        } else {
+            out += static_cast<char>(flags);
+            out += static_cast<char>(body.size());
+        }
+        return out + body;
+    }
+
+    // READY command announcing our socket type, with the NULL mechanism's metadata format
+    std::string readyCommand() {
+        std::string body;
+        body += static_cast<char>(5);
+        body += "READY";
+        const std::string name = "Socket-Type";
+        const std::string value = "SUB";
+        body += static_cast<char>(name.size());
+        body += name;
+        body += std::string(3, '\0');
+        body += static_cast<char>(value.size());
+        body += value;
+        return frame(FLAG_COMMAND, body);
+    }
+}
+
+ZmqSubscriber::~ZmqSubscriber() {
+    close();
+}
+
+void ZmqSubscriber::close() {
+    if (sock != INVALID_SOCKET) {
+        closesocket(sock);
+        sock = INVALID_SOCKET;
+    }
+    buffer.clear();
+    partial.clear();
+}
+
+bool ZmqSubscriber::sendAll(const std::string& data) {
+    return send(sock, data.c_str(), static_cast<int>(data.size()), 0) == static_cast<int>(data.size());
+}
+
+bool ZmqSubscriber::recvExact(uint8_t* data, size_t size) {
+    size_t got = 0;
+    while (got < size) {
+        fd_set readSet;
+        FD_ZERO(&readSet);
+        FD_SET(sock, &readSet);
+        struct timeval timeout = { NetworkConstants::SOCKET_TIMEOUT_SEC, 0 };
+        if (select(static_cast<int>(sock) + 1, &readSet, nullptr, nullptr, &timeout) <= 0) {
+            return false;
+        }
+        int n = recv(sock, reinterpret_cast<char*>(data + got), static_cast<int>(size - got), 0);
+        if (n <= 0) {
+            return false;
+        }
+        got += n;
+    }
+    return true;
+}
+
+bool ZmqSubscriber::readFrame(uint8_t& flags, std::string& body) {
+    uint8_t header[9];
+    if (!recvExact(header, 2)) {
+        return false;
+    }
+    flags = header[0];
+    uint64_t size = header[1];
+    if (flags & FLAG_LONG) {
+        if (!recvExact(header + 2, 7)) {
+            return false;
+        }
+        size = 0;
+        for (int i = 1; i < 9; i++) {
+            size = (size << 8) | header[i];
+        }
+    }
+    if (size > MAX_FRAME_SIZE) {
+        return false;
+    }
+    body.resize(static_cast<size_t>(size));
+    return size == 0 || recvExact(reinterpret_cast<uint8_t*>(&body[0]), body.size());
+}
+
+bool ZmqSubscriber::connect(const std::string& host, int port, const std::string& topic) {
+    close();
+
+    std::vector<Connector::Attempt> attempts;
+    sock = Connector::connect(host, std::to_string(port), attempts);
+    if (sock == INVALID_SOCKET) {
+        threadSafePrint("ZMQ: cannot connect to " + host + ":" + std::to_string(port), true);
+        return false;
+    }
+    int optval = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<char*>(&optval), sizeof(optval));
+
+    // Greeting: signature, version 3.0, NULL mechanism, client role
+    std::string greeting(GREETING_SIZE, '\0');
+    greeting[0] = static_cast<char>(0xFF);
+    greeting[9] = 0x7F;
+    greeting[10] = 3;
+    greeting[11] = 0;
+    std::memcpy(&greeting[12], "NULL", 4);
+    uint8_t peerGreeting[GREETING_SIZE];
+    if (!sendAll(greeting) || !recvExact(peerGreeting, GREETING_SIZE)) {
+        threadSafePrint("ZMQ: greeting failed", true);
+        close();
+        return false;
+    }
+    if (peerGreeting[0] != 0xFF || peerGreeting[9] != 0x7F || peerGreeting[10] < 3 ||
+        std::memcmp(peerGreeting + 12, "NULL", 4) != 0) {
+        threadSafePrint("ZMQ: peer does not speak ZMTP 3 with the NULL mechanism", true);
+        close();
+        return false;
+    }
+
+    // Exchange READY commands, then subscribe (ZMTP 3.0 subscription message)
+    uint8_t flags = 0;
+    std::string body;
+    if (!sendAll(readyCommand()) || !readFrame(flags, body) || !(flags & FLAG_COMMAND) ||
+        body.size() < 6 || body.compare(0, 6, "\x05READY") != 0) {
+        threadSafePrint("ZMQ: handshake failed", true);
+        close();
+        return false;
+    }
+    if (!sendAll(frame(0, std::string(1, '\x01') + topic))) {
+        threadSafePrint("ZMQ: subscribe failed", true);
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool ZmqSubscriber::parseFrames(std::vector<std::string>& messages) {
+    while (buffer.size() >= 2) {
+        uint8_t flags = static_cast<uint8_t>(buffer[0]);
+        size_t headerSize = (flags & FLAG_LONG) ? 9 : 2;
+        if (buffer.size() < headerSize) break;
+        uint64_t size = static_cast<uint8_t>(buffer[1]);
+        if (flags & FLAG_LONG) {
+            size = 0;
+            for (size_t i = 1; i < 9; i++) {
+                size = (size << 8) | static_cast<uint8_t>(buffer[i]);
+            }
+        }
+        if (size > MAX_FRAME_SIZE) {
+            threadSafePrint("ZMQ: oversized frame", true);
+            return false;
+        }
+        if (buffer.size() < headerSize + size) break;
+
+        // Commands after the handshake (e.g. PING) carry nothing a subscriber needs
+        if (!(flags & FLAG_COMMAND)) {
+            partial.append(buffer, headerSize, static_cast<size_t>(size));
+            if (!(flags & FLAG_MORE)) {
+                messages.push_back(std::move(partial));
+                partial.clear();
+            }
+        }
+        buffer.erase(0, headerSize + static_cast<size_t>(size));
+    }
+    return true;
+}
+
+bool ZmqSubscriber::read(std::vector<std::string>& messages) {
+    if (sock == INVALID_SOCKET) {
+        return false;
+    }
+    char data[NetworkConstants::MAX_RECEIVE_BUFFER];
+    int n = recv(sock, data, sizeof(data), 0);
+    if (n <= 0) {
+        close();
+        return false;
+    }
+    buffer.append(data, n);
+    if (!parseFrames(messages)) {
+        close();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Sockets.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Minimal ZeroMQ SUB socket: speaks ZMTP 3.0 with the NULL mechanism over a
+// plain TCP connection, which is what monerod's --zmq-pub endpoint accepts.
+// Only what a subscriber needs: handshake, one topic subscription and reading
+// published messages (multipart frames are joined into one message).
+class ZmqSubscriber {
+public:
+    ZmqSubscriber() = default;
+    ~ZmqSubscriber();
+    ZmqSubscriber(const ZmqSubscriber&) = delete;
+    ZmqSubscriber& operator=(const ZmqSubscriber&) = delete;
+
+    // Connects and subscribes to messages starting with 'topic'; blocks for the handshake
+    bool connect(const std::string& host, int port, const std::string& topic);
+    void close();
+    bool isConnected() const { return sock != INVALID_SOCKET; }
+    SOCKET getSocket() const { return sock; }  // For select()
+
+    // Reads what is available and appends complete messages. False if the
+    // connection was lost or the peer broke the protocol.
+    bool read(std::vector<std::string>& messages);
+
+private:
+    bool recvExact(uint8_t* data, size_t size);
+    bool sendAll(const std::string& data);
+    bool readFrame(uint8_t& flags, std::string& body);   // Blocking, used during the handshake
+    bool parseFrames(std::vector<std::string>& messages);
+
+    SOCKET sock = INVALID_SOCKET;
+    std::string buffer;    // Received bytes not yet forming a frame
+    std::string partial;   // Frames of a multipart message received so far
+};
@@ -0,0 +1,105 @@
+/**
+ * HexCodecBench.cpp - Microbenchmark for the hex codec
+ *
+ * Compares the previous stringstream / substr+stoi conversions against each
+ * HexCodec implementation supported by the host CPU, on a 32-byte hash and a
+ * 76-byte hashing blob.
+ *
+ * Build (from the repository root):
+ *   cl /O2 /std:c++17 /EHsc /I. bench\HexCodecBench.cpp HexCodec.cpp
+ *   g++ -O2 -std=c++17 -I. bench/HexCodecBench.cpp HexCodec.cpp -o hexbench
+ */
+
+#include "HexCodec.h"
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    // Previous implementations, kept here only as the baseline
+    std::string legacyBytesToHex(const std::vector<uint8_t>& bytes) {
+        std::stringstream ss;
+        ss << std::hex << std::setfill('0');
+        for (const auto& byte : bytes) {
+            ss << std::setw(2) << static_cast<int>(byte);
+        }
+        return ss.str();
+    }
+
+    std::vector<uint8_t> legacyHexToBytes(const std::string& hex) {
+        std::vector<uint8_t> bytes;
+        for (size_t i = 0; i < hex.length(); i += 2) {
+            std::string byteString = hex.substr(i, 2);
+            uint8_t byte = static_cast<uint8_t>(std::stoi(byteString, nullptr, 16));
+            bytes.push_back(byte);
+        }
+        return bytes;
+    }
+
+    volatile uint64_t sink = 0;
+
+    template<typename Fn>
+    double nsPerOp(size_t iterations, Fn fn) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; i++) {
+            fn();
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    }
+
+    void report(const std::string& name, double ns, double baselineNs) {
+        std::cout << "  " << std::left << std::setw(22) << name
+                  << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << ns << " ns/op"
+                  << std::setw(9) << std::setprecision(1) << (baselineNs / ns) << "x" << std::endl;
+    }
+
+    void runCase(const std::string& label, size_t size, size_t iterations) {
+        std::vector<uint8_t> bytes(size);
+        for (size_t i = 0; i < size; i++) {
+            bytes[i] = static_cast<uint8_t>(i * 131 + 7);
+        }
+        const std::string hex = legacyBytesToHex(bytes);
+
+        std::cout << label << " (" << size << " bytes), encode:" << std::endl;
+        double baseline = nsPerOp(iterations, [&]() { sink += legacyBytesToHex(bytes).size(); });
+        report("legacy stringstream", baseline, baseline);
+        for (auto impl : {HexCodec::Impl::Scalar, HexCodec::Impl::SSSE3, HexCodec::Impl::AVX2}) {
+            if (!HexCodec::isSupported(impl)) continue;
+            HexCodec::setImpl(impl);
+            char out[2 * MiningConstants::MAX_BLOB_SIZE];
+            double ns = nsPerOp(iterations, [&]() {
+                HexCodec::encode(bytes.data(), bytes.size(), out);
+                sink += static_cast<uint8_t>(out[0]);
+            });
+            report(HexCodec::implName(impl), ns, baseline);
+        }
+
+        std::cout << label << " (" << size << " bytes), decode:" << std::endl;
+        baseline = nsPerOp(iterations, [&]() { sink += legacyHexToBytes(hex).size(); });
+        report("legacy substr+stoi", baseline, baseline);
+        for (auto impl : {HexCodec::Impl::Scalar, HexCodec::Impl::SSSE3, HexCodec::Impl::AVX2}) {
+            if (!HexCodec::isSupported(impl)) continue;
+            HexCodec::setImpl(impl);
+            HexCodec::Blob blob;
+            double ns = nsPerOp(iterations, [&]() {
+                HexCodec::decode(hex, blob);
+                sink += blob.data[0];
+            });
+            report(HexCodec::implName(impl), ns, baseline);
+        }
+    }
+}
+
+int main() {
+    std::cout << "HexCodec microbenchmark (best implementation: "
+              << HexCodec::implName(HexCodec::activeImpl()) << ")" << std::endl;
+    runCase("Hash", MiningConstants::HASH_SIZE, 2000000);
+    runCase("Blob", 76, 1000000);
+    return 0;
+}
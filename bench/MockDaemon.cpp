@@ -0,0 +1,521 @@
+/**
+ * MockDaemon.cpp - Stand-in monerod for testing solo mining (--daemon)
+ *
+ * Serves the parts of the daemon interface MoneroMiner's daemon work source
+ * uses: JSON-RPC get_block_template, get_last_block_header and submit_block on
+ * the RPC port, and a ZeroMQ publisher (ZMTP 3.0, NULL mechanism) sending
+ * json-minimal-chain_main notifications like monerod's --zmq-pub. The chain
+ * advances on a timer (fixed or Poisson intervals) or when a block is
+ * submitted. Submitted blocks must be an unmodified current template apart
+ * from the nonce; proof of work is not checked.
+ *
+ * Build (from the repository root):
+ *   cl /O2 /std:c++17 /EHsc /I. bench\MockDaemon.cpp HexCodec.cpp
+ *   g++ -O2 -std=c++17 -pthread -I. bench/MockDaemon.cpp HexCodec.cpp -o mockdaemon
+ */
+
+#include "HexCodec.h"
+#include "picojson.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Winsock names on both platforms, as far as this tool uses them
+#ifdef _WIN32
+    constexpr int SEND_FLAGS = 0;
+
+    bool startSockets() {
+        WSADATA wsaData;
+        return WSAStartup(MAKEWORD(2, 2), &wsaData) == 0;
+    }
+
+    void stopSockets() {
+        WSACleanup();
+    }
+#else
+    using SOCKET = int;
+    constexpr SOCKET INVALID_SOCKET = -1;
+    constexpr int SOCKET_ERROR = -1;
+    constexpr int SD_BOTH = SHUT_RDWR;
+    constexpr int SEND_FLAGS = MSG_NOSIGNAL;   // A closed peer gives EPIPE, not SIGPIPE
+
+    int closesocket(SOCKET socket) {
+        return close(socket);
+    }
+
+    bool startSockets() {
+        return true;
+    }
+
+    void stopSockets() {}
+#endif
+
+    constexpr size_t TEMPLATE_HISTORY = 16;    // Templates of the current height submit_block accepts
+    constexpr int NONCE_OFFSET = 39;
+    constexpr int NONCE_SIZE = 4;
+    const std::string CHAIN_TOPIC = "json-minimal-chain_main";
+
+    struct Options {
+        std::string bindAddress = "127.0.0.1";
+        int rpcPort = 18081;
+        int zmqPort = 18083;                   // 0 disables the publisher
+        uint64_t difficulty = 10000;
+        int blockIntervalMs = 120000;
+        bool poisson = false;
+        int durationSec = 0;
+        uint64_t rngSeed = 1;
+    };
+
+    struct Stats {
+        std::atomic<uint64_t> requests{0};
+        std::atomic<uint64_t> templates{0};
+        std::atomic<uint64_t> blocks{0};       // Chain advances, timed or submitted
+        std::atomic<uint64_t> accepted{0};
+        std::atomic<uint64_t> rejected{0};
+        std::atomic<uint64_t> notifications{0};
+        std::atomic<uint64_t> subscribers{0};
+    };
+
+    Options options;
+    Stats stats;
+    std::atomic<bool> stopping(false);
+
+    std::mutex chainMutex;
+    uint64_t height = 3000000;                 // Height of the next block
+    std::string tipHash;                       // Id of the last block
+    std::string seedHash;
+    std::vector<std::string> templates;        // Blobs handed out for the current height
+    std::mt19937_64 rng;                       // Guarded by chainMutex
+
+    std::mutex subscribersMutex;
+    std::vector<SOCKET> subscribers;
+
+    void log(const std::string& message) {
+        static std::mutex logMutex;
+        std::lock_guard<std::mutex> lock(logMutex);
+        std::cout << message << std::endl;
+    }
+
+    std::string randomHex(size_t bytes) {
+        std::vector<uint8_t> data(bytes);
+        for (auto& byte : data) {
+            byte = static_cast<uint8_t>(rng());
+        }
+        return HexCodec::encode(data.data(), data.size());
+    }
+
+    // Versions, timestamp varint and previous block id: the part of the header before the nonce
+    std::string headerPrefix() {
+        std::string header = "1010";
+        uint64_t timestamp = static_cast<uint64_t>(std::time(nullptr));
+        for (int i = 0; i < 5; i++) {
+            uint8_t byte = static_cast<uint8_t>((timestamp >> (7 * i)) & 0x7F) | (i < 4 ? 0x80 : 0x00);
+            header += HexCodec::encode(&byte, 1);
+        }
+        return header + tipHash;
+    }
+
+    // ZMTP frame with a short or long size
+    std::string zmqFrame(uint8_t flags, const std::string& body) {
+        std::string out;
+        if (body.size() > 255) {
+            out += static_cast<char>(flags | 0x02);
+            for (int shift = 56; shift >= 0; shift -= 8) {
+                out += static_cast<char>((static_cast<uint64_t>(body.size()) >> shift) & 0xFF);
+            }
+        } else {
+            out += static_cast<char>(flags);
+            out += static_cast<char>(body.size());
+        }
+        return out + body;
+    }
+
+    void publish(const std::string& message) {
+        std::string frame = zmqFrame(0, message);
+        std::lock_guard<std::mutex> lock(subscribersMutex);
+        for (auto it = subscribers.begin(); it != subscribers.end();) {
+            if (send(*it, frame.c_str(), static_cast<int>(frame.size()), SEND_FLAGS) != static_cast<int>(frame.size())) {
+                closesocket(*it);
+                it = subscribers.erase(it);
+                continue;
+            }
+            ++it;
+        }
+        stats.notifications++;
+    }
+
+    // Appends a block to the chain and announces it like monerod's chain_main feed
+    void advanceChain(const std::string& reason) {
+        picojson::object notify;
+        {
+            std::lock_guard<std::mutex> lock(chainMutex);
+            std::string prev = tipHash;
+            tipHash = randomHex(32);
+            notify["first_height"] = picojson::value(static_cast<double>(height));
+            notify["first_prev_id"] = picojson::value(prev);
+            picojson::array ids;
+            ids.push_back(picojson::value(tipHash));
+            notify["ids"] = picojson::value(ids);
+            height++;
+            templates.clear();
+        }
+        stats.blocks++;
+        publish(CHAIN_TOPIC + ":" + picojson::value(notify).serialize());
+        log("Block " + std::to_string(height - 1) + " (" + reason + ")");
+    }
+
+    picojson::object blockTemplate() {
+        std::lock_guard<std::mutex> lock(chainMutex);
+        std::string header = headerPrefix();
+        std::string minerTx = "02" + randomHex(60);  // Stands in for the coinbase transaction
+        std::string blob = header + "00000000" + minerTx + "00";
+        templates.push_back(blob);
+        if (templates.size() > TEMPLATE_HISTORY) {
+            templates.erase(templates.begin());
+        }
+        stats.templates++;
+
+        picojson::object result;
+        result["blockhashing_blob"] = picojson::value(header + "00000000" + randomHex(32) + "01");
+        result["blocktemplate_blob"] = picojson::value(blob);
+        result["difficulty"] = picojson::value(static_cast<double>(options.difficulty));
+        result["expected_reward"] = picojson::value(600000000000.0);
+        result["height"] = picojson::value(static_cast<double>(height));
+        result["prev_hash"] = picojson::value(tipHash);
+        result["reserved_offset"] = picojson::value(0.0);
+        result["seed_hash"] = picojson::value(seedHash);
+        result["status"] = picojson::value("OK");
+        return result;
+    }
+
+    // Accepts a current template with only the nonce changed
+    bool acceptBlock(const std::string& blob, std::string& error) {
+        std::lock_guard<std::mutex> lock(chainMutex);
+        size_t nonceStart = NONCE_OFFSET * 2;
+        size_t nonceEnd = nonceStart + NONCE_SIZE * 2;
+        for (const auto& candidate : templates) {
+            if (candidate.size() == blob.size() &&
+                candidate.compare(0, nonceStart, blob, 0, nonceStart) == 0 &&
+                candidate.compare(nonceEnd, std::string::npos, blob, nonceEnd, std::string::npos) == 0) {
+                return true;
+            }
+        }
+        error = "Block not accepted";
+        return false;
+    }
+
+    std::string rpcResponse(const picojson::value& id, const picojson::object* result, const std::string& error) {
+        picojson::object message;
+        message["id"] = id;
+        message["jsonrpc"] = picojson::value("2.0");
+        if (result) {
+            message["result"] = picojson::value(*result);
+        } else {
+            picojson::object errorObj;
+            errorObj["code"] = picojson::value(-7.0);
+            errorObj["message"] = picojson::value(error);
+            message["error"] = picojson::value(errorObj);
+        }
+        return picojson::value(message).serialize();
+    }
+
+    std::string handleRpc(const std::string& body) {
+        picojson::value v;
+        if (!picojson::parse(v, body).empty() || !v.is<picojson::object>()) {
+            return rpcResponse(picojson::value(), nullptr, "Parse error");
+        }
+        picojson::object request = v.get<picojson::object>();
+        picojson::value id = request["id"];
+        std::string method = request["method"].is<std::string>() ? request["method"].get<std::string>() : "";
+
+        if (method == "get_block_template") {
+            picojson::object result = blockTemplate();
+            return rpcResponse(id, &result, "");
+        }
+        if (method == "get_last_block_header") {
+            picojson::object header;
+            picojson::object result;
+            {
+                std::lock_guard<std::mutex> lock(chainMutex);
+                header["hash"] = picojson::value(tipHash);
+                header["height"] = picojson::value(static_cast<double>(height - 1));
+            }
+            result["block_header"] = picojson::value(header);
+            result["status"] = picojson::value("OK");
+            return rpcResponse(id, &result, "");
+        }
+        if (method == "submit_block") {
+            const picojson::value& params = request["params"];
+            std::string error = "Wrong block blob";
+            if (params.is<picojson::array>() && !params.get<picojson::array>().empty() &&
+                params.get<picojson::array>()[0].is<std::string>() &&
+                acceptBlock(params.get<picojson::array>()[0].get<std::string>(), error)) {
+                stats.accepted++;
+                advanceChain("submitted");
+                picojson::object result;
+                result["status"] = picojson::value("OK");
+                return rpcResponse(id, &result, "");
+            }
+            stats.rejected++;
+            log("Rejected block: " + error);
+            return rpcResponse(id, nullptr, error);
+        }
+        return rpcResponse(id, nullptr, "Method not found");
+    }
+
+    // One request per connection, as the miner sends them
+    void serveHttp(SOCKET client) {
+        std::string request;
+        char data[8192];
+        size_t headerEnd = std::string::npos;
+        size_t contentLength = 0;
+        while (true) {
+            int n = recv(client, data, sizeof(data), 0);
+            if (n <= 0) break;
+            request.append(data, n);
+            if (headerEnd == std::string::npos && (headerEnd = request.find("\r\n\r\n")) != std::string::npos) {
+                std::string headers = request.substr(0, headerEnd);
+                for (char& c : headers) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+                size_t pos = headers.find("content-length:");
+                if (pos != std::string::npos) {
+                    contentLength = std::strtoull(headers.c_str() + pos + 15, nullptr, 10);
+                }
+            }
+            if (headerEnd != std::string::npos && request.size() >= headerEnd + 4 + contentLength) break;
+        }
+
+        std::string status = "200 OK";
+        std::string body;
+        if (headerEnd == std::string::npos || request.compare(0, 15, "POST /json_rpc ") != 0) {
+            status = "404 Not Found";
+        } else {
+            stats.requests++;
+            body = handleRpc(request.substr(headerEnd + 4, contentLength));
+        }
+        std::string response = "HTTP/1.1 " + status + "\r\nContent-Type: application/json\r\n"
+                               "Content-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+        send(client, response.c_str(), static_cast<int>(response.size()), SEND_FLAGS);
+        closesocket(client);
+    }
+
+    bool recvExact(SOCKET sock, uint8_t* out, size_t size) {
+        size_t got = 0;
+        while (got < size) {
+            int n = recv(sock, reinterpret_cast<char*>(out + got), static_cast<int>(size - got), 0);
+            if (n <= 0) return false;
+            got += n;
+        }
+        return true;
+    }
+
+    // ZMTP 3.0 handshake as a PUB socket, then waits for the subscription
+    void serveSubscriber(SOCKET client) {
+        std::string greeting(64, '\0');
+        greeting[0] = static_cast<char>(0xFF);
+        greeting[9] = 0x7F;
+        greeting[10] = 3;
+        std::memcpy(&greeting[12], "NULL", 4);
+        std::string ready = "\x05READY";
+        ready += static_cast<char>(11);
+        ready += "Socket-Type";
+        ready += std::string("\0\0\0\x03", 4);
+        ready += "PUB";
+
+        uint8_t peer[64];
+        uint8_t header[2];
+        std::string body;
+        bool ok = send(client, greeting.c_str(), 64, SEND_FLAGS) == 64 && recvExact(client, peer, 64) &&
+                  std::memcmp(peer + 12, "NULL", 4) == 0;
+        std::string readyFrame = zmqFrame(0x04, ready);
+        ok = ok && send(client, readyFrame.c_str(), static_cast<int>(readyFrame.size()), SEND_FLAGS) > 0;
+        // Peer READY, then the subscription message ("\x01" + topic)
+        for (int frame = 0; ok && frame < 2; frame++) {
+            ok = recvExact(client, header, 2) && !(header[0] & 0x02);
+            body.assign(ok ? header[1] : 0, '\0');
+            ok = ok && (body.empty() || recvExact(client, reinterpret_cast<uint8_t*>(&body[0]), body.size()));
+        }
+        if (!ok || body.empty() || body[0] != '\x01' || CHAIN_TOPIC.compare(0, body.size() - 1, body, 1) != 0) {
+            log("ZMQ subscriber handshake failed");
+            closesocket(client);
+            return;
+        }
+        stats.subscribers++;
+        log("ZMQ subscriber for '" + body.substr(1) + "'");
+        std::lock_guard<std::mutex> lock(subscribersMutex);
+        subscribers.push_back(client);
+    }
+
+    SOCKET openListener(int port) {
+        struct addrinfo hints = {}, *result = nullptr;
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        if (getaddrinfo(options.bindAddress.c_str(), std::to_string(port).c_str(), &hints, &result) != 0) {
+            return INVALID_SOCKET;
+        }
+        SOCKET listener = INVALID_SOCKET;
+        for (auto* ptr = result; ptr != nullptr; ptr = ptr->ai_next) {
+            listener = socket(ptr->ai_family, ptr->ai_socktype, ptr->ai_protocol);
+            if (listener == INVALID_SOCKET) continue;
+            int optval = 1;
+            setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char*>(&optval), sizeof(optval));
+            if (bind(listener, ptr->ai_addr, static_cast<int>(ptr->ai_addrlen)) != SOCKET_ERROR &&
+                listen(listener, SOMAXCONN) != SOCKET_ERROR) {
+                break;
+            }
+            closesocket(listener);
+            listener = INVALID_SOCKET;
+        }
+        freeaddrinfo(result);
+        return listener;
+    }
+
+    void acceptLoop(SOCKET listener, void (*serve)(SOCKET)) {
+        while (!stopping) {
+            SOCKET client = accept(listener, nullptr, nullptr);
+            if (client == INVALID_SOCKET) {
+                if (stopping) break;
+                continue;
+            }
+            int optval = 1;
+            setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<char*>(&optval), sizeof(optval));
+            serve(client);
+        }
+    }
+
+    // Timed blocks, as found by the rest of the network
+    void blockTimer() {
+        std::mt19937_64 timerRng(options.rngSeed + 1);
+        while (!stopping) {
+            double waitMs = options.blockIntervalMs;
+            if (options.poisson) {
+                double u = static_cast<double>((timerRng() >> 11) + 1) * (1.0 / 9007199254740993.0);
+                waitMs = -std::log(u) * options.blockIntervalMs;
+            }
+            auto due = Clock::now() + std::chrono::microseconds(static_cast<int64_t>(waitMs * 1000));
+            while (!stopping && Clock::now() < due) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            if (!stopping) {
+                advanceChain("network");
+            }
+        }
+    }
+
+    void printUsage() {
+        std::cout << "Usage: mockdaemon [options]\n"
+                  << "  --bind ADDRESS          Listen address (default: 127.0.0.1)\n"
+                  << "  --rpc-port PORT         JSON-RPC port (default: 18081)\n"
+                  << "  --zmq-port PORT         ZMQ publisher port (default: 18083, 0 = off)\n"
+                  << "  --difficulty N          Network difficulty (default: 10000)\n"
+                  << "  --block-interval MS     Time between network blocks (default: 120000)\n"
+                  << "  --poisson               Exponential block intervals with that mean\n"
+                  << "  --duration SEC          Exit after SEC seconds (default: run until killed)\n"
+                  << "  --rng-seed N            Seed for block ids and intervals (default: 1)\n";
+    }
+
+    bool parseArgs(int argc, char* argv[]) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--bind" && hasValue) options.bindAddress = argv[++i];
+            else if (arg == "--rpc-port" && hasValue) options.rpcPort = std::stoi(argv[++i]);
+            else if (arg == "--zmq-port" && hasValue) options.zmqPort = std::stoi(argv[++i]);
+            else if (arg == "--difficulty" && hasValue) options.difficulty = (std::max)(std::stoull(argv[++i]), 1ULL);
+            else if (arg == "--block-interval" && hasValue) options.blockIntervalMs = (std::max)(std::stoi(argv[++i]), 1);
+            else if (arg == "--poisson") options.poisson = true;
+            else if (arg == "--duration" && hasValue) options.durationSec = std::stoi(argv[++i]);
+            else if (arg == "--rng-seed" && hasValue) options.rngSeed = std::stoull(argv[++i]);
+            else return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        if (!parseArgs(argc, argv)) {
+            printUsage();
+            return 1;
+        }
+    } catch (const std::exception&) {
+        printUsage();
+        return 1;
+    }
+
+    if (!startSockets()) {
+        std::cerr << "WSAStartup failed" << std::endl;
+        return 1;
+    }
+    SOCKET rpcListener = openListener(options.rpcPort);
+    SOCKET zmqListener = options.zmqPort > 0 ? openListener(options.zmqPort) : INVALID_SOCKET;
+    if (rpcListener == INVALID_SOCKET || (options.zmqPort > 0 && zmqListener == INVALID_SOCKET)) {
+        std::cerr << "Cannot listen on " << options.bindAddress << std::endl;
+        stopSockets();
+        return 1;
+    }
+
+    rng.seed(options.rngSeed);
+    tipHash = randomHex(32);
+    seedHash = randomHex(32);
+    log("Mock daemon: RPC on " + options.bindAddress + ":" + std::to_string(options.rpcPort) +
+        (options.zmqPort > 0 ? ", ZMQ on port " + std::to_string(options.zmqPort) : ", no ZMQ") +
+        ", difficulty " + std::to_string(options.difficulty));
+
+    std::thread rpcThread(acceptLoop, rpcListener, serveHttp);
+    std::thread zmqThread;
+    if (zmqListener != INVALID_SOCKET) {
+        zmqThread = std::thread(acceptLoop, zmqListener, serveSubscriber);
+    }
+    std::thread timer(blockTimer);
+
+    auto start = Clock::now();
+    while (options.durationSec <= 0 || Clock::now() - start < std::chrono::seconds(options.durationSec)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    stopping = true;
+    timer.join();
+    for (SOCKET listener : { rpcListener, zmqListener }) {
+        if (listener == INVALID_SOCKET) continue;
+        shutdown(listener, SD_BOTH);  // Unblocks accept on Linux
+        closesocket(listener);        // ...and on Windows
+    }
+    rpcThread.join();
+    if (zmqThread.joinable()) zmqThread.join();
+    {
+        std::lock_guard<std::mutex> lock(subscribersMutex);
+        for (SOCKET subscriber : subscribers) closesocket(subscriber);
+    }
+    log("requests=" + std::to_string(stats.requests) + " templates=" + std::to_string(stats.templates) +
+        " blocks=" + std::to_string(stats.blocks) + " accepted=" + std::to_string(stats.accepted) +
+        " rejected=" + std::to_string(stats.rejected) + " notifications=" + std::to_string(stats.notifications) +
+        " subscribers=" + std::to_string(stats.subscribers));
+    stopSockets();
+    return 0;
+}
@@ -0,0 +1,832 @@
+/**
+ * MockPool.cpp - Mock Monero stratum pool for integration and load testing
+ *
+ * Serves the stratum dialect MoneroMiner speaks (login with job, job notify,
+ * submit, keepalived) without a real pool or daemon. Jobs come either from a
+ * randomized stream (fixed or Poisson intervals, seeded so runs repeat) or from
+ * a script. Submits are checked for job, nonce and duplicates, then against the
+ * target (claimed hash) or a real light-mode RandomX hash, and can be rejected
+ * or delayed on purpose. Sessions can be dropped on a timer or from the script,
+ * and keepalives can go unanswered to look like a dead pool.
+ *
+ * Script lines (delays in ms after the previous line, '#' starts a comment):
+ *   <delay> job              new job at the current height
+ *   <delay> block            new height
+ *   <delay> seed             new height with a new seed hash
+ *   <delay> difficulty <N>   share difficulty for the following jobs
+ *   <delay> disconnect       drop every session
+ *
+ * Build (from the repository root):
+ *   cl /O2 /std:c++17 /EHsc /I. bench\MockPool.cpp HexCodec.cpp
+ *   g++ -O2 -std=c++17 -pthread -I. bench/MockPool.cpp HexCodec.cpp -o mockpool
+ * Add /DMOCK_POOL_RANDOMX (-DMOCK_POOL_RANDOMX) and the RandomX library for
+ * --verify randomx.
+ */
+
+#include "Job.h"
+#include "HexCodec.h"
+#include "picojson.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#ifdef _WIN32
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <unistd.h>
+#endif
+#ifdef MOCK_POOL_RANDOMX
+#include "randomx.h"
+#endif
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Winsock names on both platforms, as far as this tool uses them
+#ifdef _WIN32
+    constexpr int SEND_FLAGS = 0;
+
+    bool startSockets() {
+        WSADATA wsaData;
+        return WSAStartup(MAKEWORD(2, 2), &wsaData) == 0;
+    }
+
+    void stopSockets() {
+        WSACleanup();
+    }
+#else
+    using SOCKET = int;
+    constexpr SOCKET INVALID_SOCKET = -1;
+    constexpr int SOCKET_ERROR = -1;
+    constexpr int SD_BOTH = SHUT_RDWR;
+    constexpr int SEND_FLAGS = MSG_NOSIGNAL;   // A closed peer gives EPIPE, not SIGPIPE
+
+    int closesocket(SOCKET socket) {
+        return close(socket);
+    }
+
+    bool startSockets() {
+        return true;
+    }
+
+    void stopSockets() {}
+#endif
+
+    constexpr size_t JOB_HISTORY = 4;          // Jobs a submit may still refer to
+    constexpr size_t MAX_LINE = 16384;
+    constexpr int NONCE_OFFSET = 39;
+
+    enum class VerifyMode { None, Target, RandomX };
+
+    struct Options {
+        std::string bindAddress = "127.0.0.1";
+        int port = 3333;
+        uint64_t difficulty = 10000;
+        int jobIntervalMs = 30000;
+        bool poisson = false;
+        int jobsPerBlock = 1;
+        int seedEvery = 2048;                  // Heights per seed hash, as on mainnet
+        std::string scriptFile;
+        bool loopScript = false;
+        VerifyMode verify = VerifyMode::Target;
+        double rejectRate = 0.0;
+        int latencyMs = 0;
+        int latencyJitterMs = 0;
+        int disconnectAfterSec = 0;
+        bool keepalive = true;
+        bool loginJob = true;
+        int durationSec = 0;
+        int statsSec = 10;
+        uint64_t rngSeed = 1;
+    };
+
+    struct PoolJob {
+        std::string id;
+        uint64_t height = 0;
+        std::string blob;
+        std::string seedHash;
+        std::string target;
+        uint64_t targetValue = 0;
+        Clock::time_point sentAt;
+        std::unordered_set<uint32_t> nonces;
+    };
+
+    struct Stats {
+        std::atomic<uint64_t> sessions{0};
+        std::atomic<uint64_t> logins{0};
+        std::atomic<uint64_t> jobs{0};
+        std::atomic<uint64_t> notifications{0};
+        std::atomic<uint64_t> submits{0};
+        std::atomic<uint64_t> accepted{0};
+        std::atomic<uint64_t> rejected{0};     // Valid, but rejected by --reject-rate
+        std::atomic<uint64_t> invalid{0};      // Bad hash, low difficulty or malformed
+        std::atomic<uint64_t> stale{0};
+        std::atomic<uint64_t> duplicates{0};
+        std::atomic<uint64_t> keepalives{0};
+        std::atomic<uint64_t> disconnects{0};
+        std::atomic<uint64_t> shareAgeMsSum{0}; // Job notify to submit, accepted shares
+    };
+
+    // Outgoing lines, each due at a given time (for --latency)
+    struct Session {
+        SOCKET socket = INVALID_SOCKET;
+        std::string address;
+        std::string id;
+        std::atomic<bool> loggedIn{false};
+        Clock::time_point connectedAt;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::multimap<Clock::time_point, std::string> outbox;
+        bool closed = false;
+        std::atomic<bool> readerDone{false};
+        std::atomic<bool> writerDone{false};
+        std::thread reader;
+        std::thread writer;
+    };
+
+    Options options;
+    Stats stats;
+    std::atomic<bool> stopping(false);
+
+    std::mutex jobsMutex;
+    std::vector<PoolJob> jobs;                  // Newest first
+    uint64_t nextJobId = 1;
+    uint64_t height = 1000000;
+    std::string seedHash;
+    uint64_t difficulty = 0;
+    std::mt19937_64 jobRng;                     // Job thread only, seeded for repeatable streams
+
+    std::mutex sessionsMutex;
+    std::vector<std::shared_ptr<Session>> sessions;
+
+    std::mutex responseRngMutex;
+    std::mt19937_64 responseRng;
+
+    void log(const std::string& message) {
+        static std::mutex logMutex;
+        std::lock_guard<std::mutex> lock(logMutex);
+        std::cout << message << std::endl;
+    }
+
+    std::string randomHex(size_t bytes) {
+        std::vector<uint8_t> data(bytes);
+        for (auto& byte : data) {
+            byte = static_cast<uint8_t>(jobRng());
+        }
+        return HexCodec::encode(data.data(), data.size());
+    }
+
+    // A mainnet-shaped hashing blob: versions, timestamp varint, previous block
+    // id, nonce (zero), merkle root and transaction count
+    std::string makeBlob() {
+        std::string blob = "1010";
+        uint64_t timestamp = static_cast<uint64_t>(std::time(nullptr));
+        for (int i = 0; i < 5; i++) {
+            uint8_t byte = static_cast<uint8_t>((timestamp >> (7 * i)) & 0x7F) | (i < 4 ? 0x80 : 0x00);
+            blob += HexCodec::encode(&byte, 1);
+        }
+        blob += randomHex(32);
+        blob += "00000000";
+        blob += randomHex(32);
+        blob += "01";
+        return blob;
+    }
+
+#ifdef MOCK_POOL_RANDOMX
+    // One light-mode VM, re-keyed when the seed changes; slow, but exact
+    class RandomXBackend {
+    public:
+        ~RandomXBackend() {
+            if (vm) randomx_destroy_vm(vm);
+            if (cache) randomx_release_cache(cache);
+        }
+
+        bool hash(const std::string& seed, const uint8_t* blob, size_t size, uint8_t* out) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (seed != currentSeed) {
+                uint8_t key[32];
+                if (seed.size() != 64 || !HexCodec::decode(seed.c_str(), seed.size(), key)) {
+                    return false;
+                }
+                randomx_flags flags = randomx_get_flags();
+                if (!cache) cache = randomx_alloc_cache(flags);
+                if (!cache) return false;
+                randomx_init_cache(cache, key, sizeof(key));
+                if (!vm) vm = randomx_create_vm(flags, cache, nullptr);
+                else randomx_vm_set_cache(vm, cache);
+                if (!vm) return false;
+                currentSeed = seed;
+            }
+            randomx_calculate_hash(vm, blob, size, out);
+            return true;
+        }
+
+    private:
+        std::mutex mutex;
+        randomx_cache* cache = nullptr;
+        randomx_vm* vm = nullptr;
+        std::string currentSeed;
+    };
+
+    RandomXBackend randomxBackend;
+#endif
+
+    void queueLine(Session& session, const std::string& line, int delayMs = 0) {
+        {
+            std::lock_guard<std::mutex> lock(session.mutex);
+            if (session.closed) return;
+            session.outbox.emplace(Clock::now() + std::chrono::milliseconds(delayMs), line + "\n");
+        }
+        session.cv.notify_one();
+    }
+
+    void closeSession(Session& session) {
+        {
+            std::lock_guard<std::mutex> lock(session.mutex);
+            if (session.closed) return;
+            session.closed = true;
+        }
+        session.cv.notify_one();
+        shutdown(session.socket, SD_BOTH);
+        stats.disconnects++;
+    }
+
+    picojson::object jobObject(const PoolJob& job) {
+        picojson::object params;
+        params["blob"] = picojson::value(job.blob);
+        params["job_id"] = picojson::value(job.id);
+        params["target"] = picojson::value(job.target);
+        params["height"] = picojson::value(static_cast<double>(job.height));
+        params["seed_hash"] = picojson::value(job.seedHash);
+        params["algo"] = picojson::value("rx/0");
+        return params;
+    }
+
+    std::string response(const picojson::value& id, const picojson::value& error, const picojson::value& result) {
+        picojson::object message;
+        message["id"] = id;
+        message["jsonrpc"] = picojson::value("2.0");
+        message["error"] = error;
+        message["result"] = result;
+        return picojson::value(message).serialize();
+    }
+
+    std::string errorResponse(const picojson::value& id, const std::string& text) {
+        picojson::object error;
+        error["code"] = picojson::value(-1.0);
+        error["message"] = picojson::value(text);
+        return response(id, picojson::value(error), picojson::value());
+    }
+
+    std::string statusResponse(const picojson::value& id, const std::string& status) {
+        picojson::object result;
+        result["status"] = picojson::value(status);
+        return response(id, picojson::value(), picojson::value(result));
+    }
+
+    // Creates a job and sends it to every logged-in session
+    void publishJob(bool newBlock, bool newSeed) {
+        picojson::object params;
+        {
+            std::lock_guard<std::mutex> lock(jobsMutex);
+            if (newSeed || seedHash.empty()) {
+                seedHash = randomHex(32);
+            }
+            if (newBlock || newSeed) {
+                height++;
+            }
+            PoolJob job;
+            job.id = std::to_string(nextJobId++);
+            job.height = height;
+            job.blob = makeBlob();
+            job.seedHash = seedHash;
+            job.target = Job::difficultyToTarget(difficulty);
+            job.targetValue = Job::targetValue(job.target);
+            job.sentAt = Clock::now();
+            params = jobObject(job);
+            jobs.insert(jobs.begin(), std::move(job));
+            if (jobs.size() > JOB_HISTORY) {
+                jobs.pop_back();
+            }
+        }
+        stats.jobs++;
+
+        picojson::object notify;
+        notify["jsonrpc"] = picojson::value("2.0");
+        notify["method"] = picojson::value("job");
+        notify["params"] = picojson::value(params);
+        std::string line = picojson::value(notify).serialize();
+
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        for (auto& session : sessions) {
+            if (session->loggedIn) {
+                queueLine(*session, line);
+                stats.notifications++;
+            }
+        }
+    }
+
+    void disconnectAll() {
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        for (auto& session : sessions) {
+            closeSession(*session);
+        }
+        log("Dropped all sessions");
+    }
+
+    void handleLogin(Session& session, const picojson::value& id) {
+        session.loggedIn = true;
+        stats.logins++;
+        picojson::object result;
+        result["id"] = picojson::value(session.id);
+        result["status"] = picojson::value("OK");
+        picojson::array extensions;
+        extensions.push_back(picojson::value("algo"));
+        extensions.push_back(picojson::value("keepalive"));
+        result["extensions"] = picojson::value(extensions);
+        {
+            std::lock_guard<std::mutex> lock(jobsMutex);
+            if (options.loginJob && !jobs.empty()) {
+                result["job"] = picojson::value(jobObject(jobs.front()));
+            }
+        }
+        queueLine(session, response(id, picojson::value(), picojson::value(result)));
+        log("Login from " + session.address);
+    }
+
+    void handleSubmit(Session& session, const picojson::value& id, const picojson::object& params) {
+        stats.submits++;
+        auto param = [&](const char* name) {
+            auto it = params.find(name);
+            return it != params.end() && it->second.is<std::string>() ? it->second.get<std::string>() : std::string();
+        };
+        auto refuse = [&](const std::string& text, std::atomic<uint64_t>& counter) {
+            counter++;
+            queueLine(session, errorResponse(id, text));
+        };
+
+        if (!session.loggedIn || param("id") != session.id) {
+            refuse("Unauthenticated", stats.invalid);
+            return;
+        }
+        uint8_t nonce[4];
+        HexCodec::Hash claimed;
+        std::string nonceHex = param("nonce");
+        if (nonceHex.size() != 8 || !HexCodec::decode(nonceHex.c_str(), nonceHex.size(), nonce) ||
+            !HexCodec::decode(param("result"), claimed)) {
+            refuse("Malformed share", stats.invalid);
+            return;
+        }
+
+        std::string jobId = param("job_id");
+        std::string seed;
+        HexCodec::Blob blob;
+        uint64_t target = 0;
+        Clock::time_point sentAt;
+        {
+            std::lock_guard<std::mutex> lock(jobsMutex);
+            auto job = std::find_if(jobs.begin(), jobs.end(), [&](const PoolJob& j) { return j.id == jobId; });
+            if (job == jobs.end() || job->height != jobs.front().height) {
+                refuse("Block expired", stats.stale);
+                return;
+            }
+            uint32_t key = nonce[0] | (nonce[1] << 8) | (nonce[2] << 16) | (static_cast<uint32_t>(nonce[3]) << 24);
+            if (!job->nonces.insert(key).second) {
+                refuse("Duplicate share", stats.duplicates);
+                return;
+            }
+            seed = job->seedHash;
+            HexCodec::decode(job->blob, blob);
+            target = job->targetValue;
+            sentAt = job->sentAt;
+        }
+        std::memcpy(blob.data + NONCE_OFFSET, nonce, sizeof(nonce));
+
+        if (options.verify == VerifyMode::RandomX) {
+#ifdef MOCK_POOL_RANDOMX
+            HexCodec::Hash actual;
+            if (!randomxBackend.hash(seed, blob.data, blob.size, actual.data()) || actual != claimed) {
+                refuse("Invalid share", stats.invalid);
+                return;
+            }
+#endif
+        }
+        if (options.verify != VerifyMode::None && !Job::hashMeetsTarget(claimed.data(), target)) {
+            refuse("Low difficulty share", stats.invalid);
+            return;
+        }
+
+        int delayMs = options.latencyMs;
+        bool reject = false;
+        {
+            std::lock_guard<std::mutex> lock(responseRngMutex);
+            if (options.latencyJitterMs > 0) {
+                delayMs += static_cast<int>(responseRng() % (options.latencyJitterMs + 1));
+            }
+            reject = std::uniform_real_distribution<double>(0.0, 1.0)(responseRng) < options.rejectRate;
+        }
+        if (reject) {
+            stats.rejected++;
+            queueLine(session, errorResponse(id, "Share rejected by mock pool"), delayMs);
+            return;
+        }
+        stats.accepted++;
+        stats.shareAgeMsSum += static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - sentAt).count());
+        queueLine(session, statusResponse(id, "OK"), delayMs);
+    }
+
+    void handleLine(Session& session, const std::string& line) {
+        picojson::value message;
+        if (!picojson::parse(message, line).empty() || !message.is<picojson::object>()) {
+            log("Malformed request from " + session.address);
+            closeSession(session);
+            return;
+        }
+        const picojson::object& obj = message.get<picojson::object>();
+        picojson::value id = obj.count("id") ? obj.at("id") : picojson::value();
+        std::string method = obj.count("method") && obj.at("method").is<std::string>() ?
+            obj.at("method").get<std::string>() : std::string();
+        picojson::object params;
+        if (obj.count("params") && obj.at("params").is<picojson::object>()) {
+            params = obj.at("params").get<picojson::object>();
+        }
+
+        if (method == "login") {
+            handleLogin(session, id);
+        } else if (method == "submit") {
+            handleSubmit(session, id, params);
+        } else if (method == "keepalived") {
+            stats.keepalives++;
+            if (options.keepalive) {
+                queueLine(session, statusResponse(id, "KEEPALIVED"));
+            }
+        } else {
+            queueLine(session, errorResponse(id, "Unsupported method"));
+        }
+    }
+
+    void readLoop(std::shared_ptr<Session> session) {
+        std::string buffer;
+        char data[4096];
+        while (true) {
+            int received = recv(session->socket, data, sizeof(data), 0);
+            if (received <= 0) break;
+            buffer.append(data, received);
+            size_t pos;
+            while ((pos = buffer.find('\n')) != std::string::npos) {
+                std::string line = buffer.substr(0, pos);
+                buffer.erase(0, pos + 1);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                if (!line.empty()) handleLine(*session, line);
+            }
+            if (buffer.size() > MAX_LINE) break;
+        }
+        closeSession(*session);
+        session->readerDone = true;
+    }
+
+    void writeLoop(std::shared_ptr<Session> session) {
+        std::unique_lock<std::mutex> lock(session->mutex);
+        while (!session->closed) {
+            if (session->outbox.empty()) {
+                session->cv.wait(lock);
+                continue;
+            }
+            auto due = session->outbox.begin()->first;
+            if (Clock::now() < due) {
+                session->cv.wait_until(lock, due);
+                continue;
+            }
+            std::string line = std::move(session->outbox.begin()->second);
+            session->outbox.erase(session->outbox.begin());
+            lock.unlock();
+            bool ok = send(session->socket, line.data(), static_cast<int>(line.size()), SEND_FLAGS) == static_cast<int>(line.size());
+            lock.lock();
+            if (!ok) break;
+        }
+        lock.unlock();
+        closeSession(*session);
+        session->writerDone = true;
+    }
+
+    // Joins sessions whose threads have finished; drops sessions past --disconnect-after
+    void reapSessions() {
+        std::vector<std::shared_ptr<Session>> finished;
+        {
+            std::lock_guard<std::mutex> lock(sessionsMutex);
+            auto now = Clock::now();
+            for (auto it = sessions.begin(); it != sessions.end();) {
+                Session& session = **it;
+                if (options.disconnectAfterSec > 0 &&
+                    now - session.connectedAt > std::chrono::seconds(options.disconnectAfterSec)) {
+                    closeSession(session);
+                }
+                if (session.readerDone && session.writerDone) {
+                    finished.push_back(*it);
+                    it = sessions.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        for (auto& session : finished) {
+            session->reader.join();
+            session->writer.join();
+            closesocket(session->socket);
+            log("Session " + session->address + " closed");
+        }
+    }
+
+    void acceptLoop(SOCKET listener) {
+        uint64_t nextSession = 1;
+        while (!stopping) {
+            sockaddr_storage addr = {};
+            socklen_t addrLen = sizeof(addr);
+            SOCKET socket = accept(listener, reinterpret_cast<sockaddr*>(&addr), &addrLen);
+            if (socket == INVALID_SOCKET) {
+                continue;
+            }
+            char host[NI_MAXHOST] = "?";
+            char port[NI_MAXSERV] = "?";
+            getnameinfo(reinterpret_cast<sockaddr*>(&addr), addrLen, host, sizeof(host), port, sizeof(port),
+                        NI_NUMERICHOST | NI_NUMERICSERV);
+
+            auto session = std::make_shared<Session>();
+            session->socket = socket;
+            session->address = std::string(host) + ":" + port;
+            session->id = "mock" + std::to_string(nextSession++);
+            session->connectedAt = Clock::now();
+            stats.sessions++;
+            std::lock_guard<std::mutex> lock(sessionsMutex);
+            session->reader = std::thread(readLoop, session);
+            session->writer = std::thread(writeLoop, session);
+            sessions.push_back(session);
+        }
+    }
+
+    bool sleepFor(std::chrono::milliseconds duration) {
+        auto end = Clock::now() + duration;
+        while (!stopping && Clock::now() < end) {
+            std::this_thread::sleep_for((std::min)(std::chrono::duration_cast<std::chrono::milliseconds>(end - Clock::now()),
+                                                   std::chrono::milliseconds(50)));
+        }
+        return !stopping;
+    }
+
+    void randomJobs() {
+        std::exponential_distribution<double> poisson(1.0 / options.jobIntervalMs);
+        int jobsAtHeight = 1;
+        while (true) {
+            double waitMs = options.poisson ? poisson(jobRng) : options.jobIntervalMs;
+            if (!sleepFor(std::chrono::milliseconds(static_cast<int64_t>(waitMs)))) return;
+            bool newBlock = ++jobsAtHeight > options.jobsPerBlock;
+            if (newBlock) jobsAtHeight = 1;
+            bool newSeed = newBlock && options.seedEvery > 0 && (height + 1) % options.seedEvery == 0;
+            publishJob(newBlock, newSeed);
+        }
+    }
+
+    struct ScriptStep {
+        int delayMs;
+        std::string command;
+        uint64_t argument;
+    };
+
+    bool loadScript(const std::string& path, std::vector<ScriptStep>& steps) {
+        std::ifstream file(path);
+        if (!file) {
+            std::cerr << "Cannot open script " << path << std::endl;
+            return false;
+        }
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line)) {
+            lineNumber++;
+            line = line.substr(0, line.find('#'));
+            std::istringstream in(line);
+            ScriptStep step{0, "", 0};
+            if (!(in >> step.delayMs)) continue;
+            in >> step.command;
+            if (step.command == "difficulty" && !(in >> step.argument)) step.command.clear();
+            if (step.command != "job" && step.command != "block" && step.command != "seed" &&
+                step.command != "difficulty" && step.command != "disconnect") {
+                std::cerr << path << ":" << lineNumber << ": unknown command" << std::endl;
+                return false;
+            }
+            steps.push_back(step);
+        }
+        return true;
+    }
+
+    void scriptedJobs(const std::vector<ScriptStep>& steps) {
+        do {
+            for (const auto& step : steps) {
+                if (!sleepFor(std::chrono::milliseconds(step.delayMs))) return;
+                if (step.command == "job") {
+                    publishJob(false, false);
+                } else if (step.command == "block") {
+                    publishJob(true, false);
+                } else if (step.command == "seed") {
+                    publishJob(true, true);
+                } else if (step.command == "difficulty") {
+                    std::lock_guard<std::mutex> lock(jobsMutex);
+                    difficulty = (std::max)(step.argument, static_cast<uint64_t>(1));
+                } else if (step.command == "disconnect") {
+                    disconnectAll();
+                }
+            }
+        } while (options.loopScript);
+        log("Script finished");
+    }
+
+    void printStats(double seconds) {
+        uint64_t accepted = stats.accepted.load();
+        std::ostringstream out;
+        out << "[" << static_cast<int>(seconds) << "s] sessions " << stats.sessions << " (logins " << stats.logins
+            << ", disconnects " << stats.disconnects << ") | jobs " << stats.jobs << ", notifications "
+            << stats.notifications << " | submits " << stats.submits << ": accepted " << accepted
+            << ", rejected " << stats.rejected << ", invalid " << stats.invalid << ", stale " << stats.stale
+            << ", duplicate " << stats.duplicates << " | keepalives " << stats.keepalives;
+        if (accepted > 0) {
+            out << " | avg share age " << stats.shareAgeMsSum / accepted << " ms";
+        }
+        log(out.str());
+    }
+
+    SOCKET openListener() {
+        struct addrinfo hints = {}, *result = nullptr;
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        if (getaddrinfo(options.bindAddress.c_str(), std::to_string(options.port).c_str(), &hints, &result) != 0) {
+            return INVALID_SOCKET;
+        }
+        SOCKET listener = INVALID_SOCKET;
+        for (auto* ptr = result; ptr != nullptr; ptr = ptr->ai_next) {
+            listener = socket(ptr->ai_family, ptr->ai_socktype, ptr->ai_protocol);
+            if (listener == INVALID_SOCKET) continue;
+            int optval = 1;
+            setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char*>(&optval), sizeof(optval));
+            if (bind(listener, ptr->ai_addr, static_cast<int>(ptr->ai_addrlen)) != SOCKET_ERROR &&
+                listen(listener, SOMAXCONN) != SOCKET_ERROR) {
+                break;
+            }
+            closesocket(listener);
+            listener = INVALID_SOCKET;
+        }
+        freeaddrinfo(result);
+        return listener;
+    }
+
+    void printUsage() {
+        std::cout << "Usage: mockpool [options]\n"
+                  << "  --bind ADDRESS          Listen address (default: 127.0.0.1)\n"
+                  << "  --port PORT             Listen port (default: 3333)\n"
+                  << "  --difficulty N          Share difficulty (default: 10000)\n"
+                  << "  --job-interval MS       Time between jobs (default: 30000)\n"
+                  << "  --poisson               Exponential job intervals with that mean (bursty)\n"
+                  << "  --jobs-per-block N      Jobs per height (default: 1)\n"
+                  << "  --seed-every N          Heights per seed hash (default: 2048, 0 = never)\n"
+                  << "  --script FILE           Scripted job stream instead of random jobs\n"
+                  << "  --loop                  Repeat the script\n"
+                  << "  --verify MODE           none, target or randomx (default: target)\n"
+                  << "  --reject-rate P         Reject this fraction of valid shares (default: 0)\n"
+                  << "  --latency MS            Delay submit responses (default: 0)\n"
+                  << "  --latency-jitter MS     Add up to MS random delay\n"
+                  << "  --disconnect-after SEC  Drop every session SEC seconds after it connects\n"
+                  << "  --no-keepalive          Leave keepalived requests unanswered\n"
+                  << "  --no-login-job          Send the first job only with the next notify\n"
+                  << "  --duration SEC          Exit after SEC seconds (default: run until killed)\n"
+                  << "  --stats SEC             Stats interval (default: 10)\n"
+                  << "  --rng-seed N            Seed for the random job stream (default: 1)\n";
+    }
+
+    bool parseArgs(int argc, char* argv[]) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--bind" && hasValue) options.bindAddress = argv[++i];
+            else if (arg == "--port" && hasValue) options.port = std::stoi(argv[++i]);
+            else if (arg == "--difficulty" && hasValue) options.difficulty = std::stoull(argv[++i]);
+            else if (arg == "--job-interval" && hasValue) options.jobIntervalMs = (std::max)(std::stoi(argv[++i]), 1);
+            else if (arg == "--poisson") options.poisson = true;
+            else if (arg == "--jobs-per-block" && hasValue) options.jobsPerBlock = (std::max)(std::stoi(argv[++i]), 1);
+            else if (arg == "--seed-every" && hasValue) options.seedEvery = std::stoi(argv[++i]);
+            else if (arg == "--script" && hasValue) options.scriptFile = argv[++i];
+            else if (arg == "--loop") options.loopScript = true;
+            else if (arg == "--verify" && hasValue) {
+                std::string mode = argv[++i];
+                if (mode == "none") options.verify = VerifyMode::None;
+                else if (mode == "target") options.verify = VerifyMode::Target;
+                else if (mode == "randomx") options.verify = VerifyMode::RandomX;
+                else return false;
+            }
+            else if (arg == "--reject-rate" && hasValue) options.rejectRate = std::stod(argv[++i]);
+            else if (arg == "--latency" && hasValue) options.latencyMs = std::stoi(argv[++i]);
+            else if (arg == "--latency-jitter" && hasValue) options.latencyJitterMs = std::stoi(argv[++i]);
+            else if (arg == "--disconnect-after" && hasValue) options.disconnectAfterSec = std::stoi(argv[++i]);
+            else if (arg == "--no-keepalive") options.keepalive = false;
+            else if (arg == "--no-login-job") options.loginJob = false;
+            else if (arg == "--duration" && hasValue) options.durationSec = std::stoi(argv[++i]);
+            else if (arg == "--stats" && hasValue) options.statsSec = (std::max)(std::stoi(argv[++i]), 1);
+            else if (arg == "--rng-seed" && hasValue) options.rngSeed = std::stoull(argv[++i]);
+            else return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        if (!parseArgs(argc, argv)) {
+            printUsage();
+            return 1;
+        }
+    } catch (const std::exception&) {
+        printUsage();
+        return 1;
+    }
+#ifndef MOCK_POOL_RANDOMX
+    if (options.verify == VerifyMode::RandomX) {
+        std::cerr << "--verify randomx needs a build with MOCK_POOL_RANDOMX" << std::endl;
+        return 1;
+    }
+#endif
+    std::vector<ScriptStep> script;
+    if (!options.scriptFile.empty() && !loadScript(options.scriptFile, script)) {
+        return 1;
+    }
+
+    if (!startSockets()) {
+        std::cerr << "WSAStartup failed" << std::endl;
+        return 1;
+    }
+    SOCKET listener = openListener();
+    if (listener == INVALID_SOCKET) {
+        std::cerr << "Cannot listen on " << options.bindAddress << ":" << options.port << std::endl;
+        stopSockets();
+        return 1;
+    }
+
+    jobRng.seed(options.rngSeed);
+    responseRng.seed(options.rngSeed + 1);
+    difficulty = options.difficulty;
+    if (script.empty()) {
+        publishJob(false, true);  // Initial job for the first logins
+    }
+    log("Mock pool listening on " + options.bindAddress + ":" + std::to_string(options.port) +
+        (script.empty() ? "" : ", script " + options.scriptFile));
+
+    std::thread acceptor(acceptLoop, listener);
+    std::thread jobSource = script.empty() ? std::thread(randomJobs) : std::thread(scriptedJobs, script);
+
+    auto start = Clock::now();
+    auto lastStats = start;
+    while (options.durationSec <= 0 || Clock::now() - start < std::chrono::seconds(options.durationSec)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        reapSessions();
+        if (Clock::now() - lastStats >= std::chrono::seconds(options.statsSec)) {
+            lastStats = Clock::now();
+            printStats(std::chrono::duration<double>(lastStats - start).count());
+        }
+    }
+
+    stopping = true;
+    jobSource.join();
+    shutdown(listener, SD_BOTH);  // Unblocks accept on Linux
+    closesocket(listener);        // ...and on Windows
+    acceptor.join();
+    disconnectAll();
+    while (true) {
+        reapSessions();
+        {
+            std::lock_guard<std::mutex> lock(sessionsMutex);
+            if (sessions.empty()) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    printStats(std::chrono::duration<double>(Clock::now() - start).count());
+    stopSockets();
+    return 0;
+}
@@ -0,0 +1,348 @@
+/**
+ * PipelineBench.cpp - Microbenchmarks for the mining pipeline
+ *
+ * Times each step a job and a share go through, calling the miner's own code:
+ *   job_parse            stratum job line -> picojson -> PoolClient::parseJob
+ *   job_blob_bytes       Job::getBlobBytes, hex blob -> bytes with the nonce
+ *   hex_decode_blob      HexCodec::decode of a 76-byte hashing blob
+ *   hex_encode_hash      HexCodec::encode of a 32-byte hash
+ *   check_hash           RandomXManager::checkHash, target expansion + comparison
+ *   calculate_difficulty Job::calculateDifficulty
+ *   submit_serialize     hash and nonce to hex + PoolClient::createSubmitRequest
+ *   hash_step/threads:N  MiningThreadData::calculateHash on N threads at once:
+ *                        blob copy, nonce insertion, RandomX hash, target check
+ *
+ * hash_step hashes in light mode (cache only, no 2 GB dataset), so its absolute
+ * figure is higher than mining's; it tracks the per-hash overhead and how it
+ * scales with threads.
+ *
+ * Each benchmark runs for at least --min-time seconds per repetition and the
+ * median of --repetitions is reported. --json FILE writes the results in Google
+ * Benchmark's JSON layout, so its compare.py can diff two versions.
+ *
+ * Build (from the repository root) with the project's sources but MoneroMiner.cpp,
+ * which holds main, and the RandomX library:
+ *   cl /O2 /std:c++17 /EHsc /I. bench\PipelineBench.cpp <sources> randomx.lib ws2_32.lib
+ *   g++ -O2 -std=c++17 -pthread -I. bench/PipelineBench.cpp \
+ *       $(grep -o 'ClCompile Include="[^"]*"' MoneroMiner.vcxproj | cut -d'"' -f2 | grep -v MoneroMiner.cpp) \
+ *       -lrandomx -o pipelinebench
+ *
+ * Usage:
+ *   pipelinebench [--threads N] [--min-time SEC] [--repetitions N] [--filter TEXT] [--json FILE]
+ */
+
+#include "Job.h"
+#include "HexCodec.h"
+#include "Constants.h"
+#include "MiningThreadData.h"
+#include "PoolClient.h"
+#include "RandomXManager.h"
+#include "picojson.h"
+#include "randomx.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    const char* BLOB =
+        "0b0b98bea7e805e0010a2126d287a2a0cc833d312cb786385a7c2f9de69d25537f584a9bc9977b00000000666fd8753bf61a8631f12984e3fd44f4014eca629276817b56f32e9b68bd82f416";
+    const char* TARGET = "f3220000";   // Difficulty 120001, a typical pool share target
+    const char* HASH_STEP_TARGET = "01000000";   // Rarely met, so hash_step prints no shares
+    const char* JOB_LINE =
+        "{\"jsonrpc\":\"2.0\",\"method\":\"job\",\"params\":{\"blob\":\"0b0b98bea7e805e0010a2126d287a2a0cc833d312cb786385a7c2f9de69d25537f584a9bc9977b00000000666fd8753bf61a8631f12984e3fd44f4014eca629276817b56f32e9b68bd82f416\","
+        "\"job_id\":\"297614521987654\",\"target\":\"f3220000\",\"algo\":\"rx/0\",\"height\":3123456,"
+        "\"seed_hash\":\"b0e9b6f3c7a2d4e85f1c3a9b7d6e2f4a8c5b1d3e7f9a2c4b6d8e0f1a3c5b7d9e\"}}";
+
+    struct Options {
+        int threads = static_cast<int>((std::max)(1u, std::thread::hardware_concurrency()));
+        double minTime = 0.5;
+        int repetitions = 5;
+        std::string filter;
+        std::string jsonFile;
+    };
+
+    struct Result {
+        std::string name;
+        uint64_t iterations = 0;   // Per repetition, per thread
+        double medianNs = 0.0;
+        double minNs = 0.0;
+        double maxNs = 0.0;
+        int threads = 1;
+    };
+
+    volatile uint64_t sink = 0;
+
+    // ns per call of fn over 'iterations' calls
+    double timeIterations(uint64_t iterations, const std::function<void()>& fn) {
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            fn();
+        }
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+    }
+
+    // Doubles the iteration count until one run takes minTime, then repeats it;
+    // 'timeRun' gives ns per iteration for a run of the given length
+    Result measure(const Options& options, const std::string& name,
+                   const std::function<double(uint64_t)>& timeRun) {
+        uint64_t iterations = 1;
+        for (;;) {
+            double ns = timeRun(iterations);
+            if (ns * iterations >= options.minTime * 1e9 || iterations >= (1ULL << 40)) break;
+            iterations *= 2;
+        }
+        std::vector<double> samples;
+        for (int r = 0; r < options.repetitions; r++) {
+            samples.push_back(timeRun(iterations));
+        }
+        std::sort(samples.begin(), samples.end());
+        Result result;
+        result.name = name;
+        result.iterations = iterations;
+        result.medianNs = samples[samples.size() / 2];
+        result.minNs = samples.front();
+        result.maxNs = samples.back();
+        return result;
+    }
+
+    Result runSingle(const Options& options, const std::string& name, const std::function<void()>& fn) {
+        return measure(options, name, [&](uint64_t iterations) { return timeIterations(iterations, fn); });
+    }
+
+    // The same per-thread work on N threads released together; ns per call per thread
+    Result runThreaded(const Options& options, const std::string& name, int threads,
+                       const std::function<std::function<void()>(int)>& makeWork) {
+        std::vector<std::function<void()>> work;
+        for (int t = 0; t < threads; t++) {
+            work.push_back(makeWork(t));
+        }
+        auto timeAll = [&](uint64_t iterations) -> double {
+            std::atomic<int> ready(0);
+            std::atomic<bool> go(false);
+            std::vector<double> ns(threads);
+            std::vector<std::thread> pool;
+            for (int t = 0; t < threads; t++) {
+                pool.emplace_back([&, t]() {
+                    ready++;
+                    while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+                    ns[t] = timeIterations(iterations, work[t]);
+                });
+            }
+            while (ready.load() < threads) std::this_thread::yield();
+            go.store(true, std::memory_order_release);
+            for (auto& thread : pool) thread.join();
+            double sum = 0.0;
+            for (double value : ns) sum += value;
+            return sum / threads;
+        };
+
+        Result result = measure(options, name, timeAll);
+        result.threads = threads;
+        return result;
+    }
+
+    // The job listener's parse of a notify line, then PoolClient::parseJob
+    bool parseJob(const std::string& line, Job& job) {
+        picojson::value v;
+        if (!picojson::parse(v, line).empty() || !v.is<picojson::object>()) return false;
+        const picojson::object& obj = v.get<picojson::object>();
+        return PoolClient::parseJob(obj.at("params").get<picojson::object>(), job);
+    }
+
+    // Per-thread state of hash_step: its own job copy and light-mode VM
+    struct HashWorker {
+        Job job;
+        randomx_vm* vm = nullptr;
+
+        // The mining thread's loop body: blob bytes of its job copy, then the hash
+        void step() {
+            sink += MiningThreadData::calculateHash(vm, job.getBlobBytes(), job.getNonce(), HASH_STEP_TARGET);
+            job.incrementNonce();
+        }
+    };
+
+    bool matches(const Options& options, const std::string& name) {
+        return options.filter.empty() || name.find(options.filter) != std::string::npos;
+    }
+
+    void print(const Result& result) {
+        std::cout << "  " << std::left << std::setw(24) << result.name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12) << result.medianNs << " ns/op"
+                  << "  (min " << result.minNs << ", max " << result.maxNs << ", "
+                  << result.iterations << " iterations)" << std::endl;
+    }
+
+    // Google Benchmark's JSON layout, one entry per benchmark (median as real_time)
+    std::string toJson(const std::vector<Result>& results, const Options& options) {
+        char date[32];
+        time_t now = time(nullptr);
+        strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+        picojson::object context;
+        context["date"] = picojson::value(std::string(date));
+        context["executable"] = picojson::value(std::string(DefaultConfig::USER_AGENT));
+        context["num_cpus"] = picojson::value(static_cast<double>(std::thread::hardware_concurrency()));
+        context["hex_codec"] = picojson::value(std::string(HexCodec::implName(HexCodec::activeImpl())));
+        context["repetitions"] = picojson::value(static_cast<double>(options.repetitions));
+        context["randomx"] = picojson::value(std::string("light"));
+
+        picojson::array benchmarks;
+        for (const auto& result : results) {
+            picojson::object entry;
+            entry["name"] = picojson::value(result.name);
+            entry["run_type"] = picojson::value(std::string("iteration"));
+            entry["iterations"] = picojson::value(static_cast<double>(result.iterations));
+            entry["real_time"] = picojson::value(result.medianNs);
+            entry["cpu_time"] = picojson::value(result.medianNs);
+            entry["min_time"] = picojson::value(result.minNs);
+            entry["max_time"] = picojson::value(result.maxNs);
+            entry["threads"] = picojson::value(static_cast<double>(result.threads));
+            entry["time_unit"] = picojson::value(std::string("ns"));
+            benchmarks.push_back(picojson::value(entry));
+        }
+
+        picojson::object root;
+        root["context"] = picojson::value(context);
+        root["benchmarks"] = picojson::value(benchmarks);
+        return picojson::value(root).serialize(true);
+    }
+
+    bool parseArgs(int argc, char* argv[], Options& options) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--threads" && hasValue) options.threads = (std::max)(1, std::stoi(argv[++i]));
+            else if (arg == "--min-time" && hasValue) options.minTime = std::stod(argv[++i]);
+            else if (arg == "--repetitions" && hasValue) options.repetitions = (std::max)(1, std::stoi(argv[++i]));
+            else if (arg == "--filter" && hasValue) options.filter = argv[++i];
+            else if (arg == "--json" && hasValue) options.jsonFile = argv[++i];
+            else {
+                std::cerr << "Unknown argument: " << arg << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        std::cerr << "Usage: pipelinebench [--threads N] [--min-time SEC] [--repetitions N] "
+                     "[--filter TEXT] [--json FILE]" << std::endl;
+        return 1;
+    }
+
+    Job job;
+    if (!parseJob(JOB_LINE, job)) {
+        std::cerr << "Benchmark job does not parse" << std::endl;
+        return 1;
+    }
+    std::vector<uint8_t> blobBytes = job.getBlobBytes();
+    std::vector<uint8_t> hash(MiningConstants::HASH_SIZE);
+    for (size_t i = 0; i < hash.size(); i++) {
+        hash[i] = static_cast<uint8_t>(i * 97 + 13);
+    }
+    const std::string blobHex = BLOB;
+
+    std::cout << "Mining pipeline microbenchmarks (hex codec: "
+              << HexCodec::implName(HexCodec::activeImpl()) << ")" << std::endl;
+    std::vector<Result> results;
+    auto add = [&](const std::string& name, const std::function<void()>& fn) {
+        if (!matches(options, name)) return;
+        results.push_back(runSingle(options, name, fn));
+        print(results.back());
+    };
+
+    add("job_parse", [&]() {
+        Job parsed;
+        sink += parseJob(JOB_LINE, parsed) ? parsed.height : 0;
+    });
+    add("job_blob_bytes", [&]() {
+        job.incrementNonce();
+        sink += job.getBlobBytes()[42];
+    });
+    add("hex_decode_blob", [&]() {
+        HexCodec::Blob blob;
+        HexCodec::decode(blobHex, blob);
+        sink += blob.data[0];
+    });
+    add("hex_encode_hash", [&]() {
+        hash[0]++;
+        sink += HexCodec::encode(hash).size();
+    });
+    add("check_hash", [&]() {
+        hash[31]++;
+        sink += RandomXManager::checkHash(hash.data(), TARGET);
+    });
+    add("calculate_difficulty", [&]() {
+        sink += static_cast<uint64_t>(job.calculateDifficulty());
+    });
+    uint64_t submitId = 0;
+    add("submit_serialize", [&]() {
+        submitId++;
+        std::string result = HexCodec::encode(hash);
+        std::string nonce = MiningThreadData::nonceHex(static_cast<uint32_t>(submitId));
+        sink += PoolClient::createSubmitRequest(submitId, "0f3a6c21-7d42-4b1e-9a55-3c8e2d1f6b90", job.getJobId(),
+                                                nonce, result, "rx/0").size();
+    });
+
+    randomx_flags flags = randomx_get_flags();
+    randomx_cache* cache = randomx_alloc_cache(flags);
+    if (!cache) {
+        std::cerr << "Failed to allocate the RandomX cache" << std::endl;
+        return 1;
+    }
+    HexCodec::Hash seed;
+    HexCodec::decode(job.getSeedHash(), seed);
+    randomx_init_cache(cache, seed.data(), seed.size());
+    std::vector<HashWorker> workers(options.threads);
+    for (int t = 0; t < options.threads; t++) {
+        workers[t].job = job;
+        workers[t].job.setNonce(static_cast<uint32_t>(t) * (0xFFFFFFFFu / options.threads));
+        workers[t].vm = randomx_create_vm(flags, cache, nullptr);
+        if (!workers[t].vm) {
+            std::cerr << "Failed to create a RandomX VM" << std::endl;
+            return 1;
+        }
+    }
+    // 1, 2, 4, ... threads, and --threads itself
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < options.threads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(options.threads);
+    for (int threads : threadCounts) {
+        std::string name = "hash_step/threads:" + std::to_string(threads);
+        if (!matches(options, name)) continue;
+        results.push_back(runThreaded(options, name, threads, [&](int t) {
+            HashWorker* worker = &workers[t];
+            return std::function<void()>([worker]() { worker->step(); });
+        }));
+        print(results.back());
+    }
+    for (auto& worker : workers) randomx_destroy_vm(worker.vm);
+    randomx_release_cache(cache);
+
+    if (!options.jsonFile.empty()) {
+        std::ofstream file(options.jsonFile);
+        file << toJson(results, options) << std::endl;
+        if (!file) {
+            std::cerr << "Failed to write " << options.jsonFile << std::endl;
+            return 1;
+        }
+        std::cout << "Results written to " << options.jsonFile << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,149 @@
+/**
+ * VardiffSim.cpp - Deterministic simulation of the proxy vardiff controller
+ *
+ * Drives Vardiff with simulated rigs whose shares arrive as a Poisson process
+ * (exponential waits of difficulty / hashrate seconds), on a simulated clock
+ * and a fixed-seed generator, so every run produces the same output. Reports
+ * how quickly each rig settles and the share interval it settles at, and exits
+ * with 1 if a rig not capped by the pool difficulty misses the interval by
+ * more than a factor of two.
+ *
+ * Build (from the repository root):
+ *   cl /O2 /std:c++17 /EHsc /I. bench\VardiffSim.cpp Vardiff.cpp
+ *   g++ -O2 -std=c++17 -I. bench/VardiffSim.cpp Vardiff.cpp -o vardiffsim
+ */
+
+#include "Vardiff.h"
+#include "Constants.h"
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr int SHARE_INTERVAL_SEC = NetworkConstants::DEFAULT_PROXY_SHARE_INTERVAL_SEC;
+    constexpr uint64_t POOL_DIFFICULTY = 1000000;
+    constexpr double RUN_SEC = 4 * 3600.0;
+    constexpr double SETTLED_SEC = 3600.0;   // Intervals are measured after this
+
+    struct Rig {
+        std::string name;
+        double hashrate;
+        double throttledHashrate;  // From half-time on, e.g. a rig throttling
+    };
+
+    struct Result {
+        uint64_t shares = 0;
+        uint64_t settledShares = 0;
+        uint64_t retargets = 0;
+        double settleSec = -1.0;    // First time the difficulty was within 25% of ideal
+        uint64_t finalDifficulty = 0;
+        double meanInterval = 0.0;  // After SETTLED_SEC
+        bool capped = false;
+    };
+
+    // Exponential wait from the raw generator output, identical on every standard library
+    double exponential(std::mt19937_64& rng, double mean) {
+        double u = static_cast<double>((rng() >> 11) + 1) * (1.0 / 9007199254740993.0);
+        return -std::log(u) * mean;
+    }
+
+    Vardiff::Clock::time_point at(double seconds) {
+        return Vardiff::Clock::time_point(
+            std::chrono::duration_cast<Vardiff::Clock::duration>(std::chrono::duration<double>(seconds)));
+    }
+
+    Result simulate(const Rig& rig, uint64_t seed) {
+        std::mt19937_64 rng(seed);
+        Vardiff vardiff(SHARE_INTERVAL_SEC, NetworkConstants::VARDIFF_START_DIFFICULTY, at(0.0));
+        vardiff.update(at(0.0), POOL_DIFFICULTY);
+
+        Result result;
+        double now = 0.0;
+        double nextTick = 1.0;  // The proxy also retargets from its once-a-second housekeeping
+        double hashrate = rig.hashrate;
+        double nextShare = exponential(rng, vardiff.getDifficulty() / hashrate);
+        double firstSettledShare = -1.0;
+        double lastShare = 0.0;
+
+        while (now < RUN_SEC) {
+            bool share = nextShare < nextTick;
+            now = share ? nextShare : nextTick;
+            if (now >= RUN_SEC / 2 && hashrate != rig.throttledHashrate) {
+                hashrate = rig.throttledHashrate;
+                nextShare = now + exponential(rng, vardiff.getDifficulty() / hashrate);
+                result.settleSec = -1.0;
+                continue;
+            }
+
+            if (share) {
+                vardiff.addShare(at(now));
+                result.shares++;
+                if (now >= RUN_SEC - SETTLED_SEC) {
+                    if (firstSettledShare < 0.0) firstSettledShare = now;
+                    result.settledShares++;
+                    lastShare = now;
+                }
+            } else {
+                nextTick += 1.0;
+            }
+
+            bool changed = vardiff.update(at(now), POOL_DIFFICULTY);
+            if (changed) {
+                result.retargets++;
+            }
+            if (share || changed) {
+                // Waits are memoryless, so a new difficulty simply restarts the wait
+                nextShare = now + exponential(rng, vardiff.getDifficulty() / hashrate);
+            }
+
+            double ideal = (std::min)(hashrate * SHARE_INTERVAL_SEC, static_cast<double>(POOL_DIFFICULTY));
+            double ratio = vardiff.getDifficulty() / ideal;
+            if (result.settleSec < 0.0 && ratio > 0.75 && ratio < 1.25) {
+                result.settleSec = now >= RUN_SEC / 2 ? now - RUN_SEC / 2 : now;
+            }
+        }
+
+        result.finalDifficulty = vardiff.getDifficulty();
+        result.capped = hashrate * SHARE_INTERVAL_SEC > POOL_DIFFICULTY;
+        if (result.settledShares > 1) {
+            result.meanInterval = (lastShare - firstSettledShare) / (result.settledShares - 1);
+        }
+        return result;
+    }
+}
+
+int main() {
+    const std::vector<Rig> rigs = {
+        {"phone", 40.0, 40.0},
+        {"laptop", 1500.0, 1500.0},
+        {"desktop", 12000.0, 12000.0},
+        {"threadripper", 90000.0, 90000.0},
+        {"farm", 2000000.0, 2000000.0},
+        {"throttling", 20000.0, 4000.0},
+    };
+
+    std::cout << "Vardiff simulation: " << SHARE_INTERVAL_SEC << "s share interval, pool difficulty "
+              << POOL_DIFFICULTY << ", " << RUN_SEC / 3600 << "h per rig (hashrate changes at half time)\n\n";
+    std::cout << std::left << std::setw(14) << "Rig" << std::right
+              << std::setw(12) << "H/s" << std::setw(10) << "Shares" << std::setw(11) << "Retargets"
+              << std::setw(10) << "Settle s" << std::setw(12) << "Difficulty" << std::setw(13) << "Interval s" << "\n";
+
+    bool ok = true;
+    uint64_t seed = 1;
+    for (const auto& rig : rigs) {
+        Result result = simulate(rig, seed++);
+        bool miss = !result.capped &&
+            (result.meanInterval < SHARE_INTERVAL_SEC / 2.0 || result.meanInterval > SHARE_INTERVAL_SEC * 2.0);
+        ok = ok && !miss;
+        std::cout << std::left << std::setw(14) << rig.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << rig.throttledHashrate << std::setw(10) << result.shares
+                  << std::setw(11) << result.retargets << std::setw(10) << result.settleSec
+                  << std::setw(12) << result.finalDifficulty << std::setw(13) << result.meanInterval
+                  << (result.capped ? "  (capped by pool difficulty)" : "") << (miss ? "  MISSED" : "") << "\n";
+    }
+    return ok ? 0 : 1;
+}